@@ -9,12 +9,15 @@
 
 #include <stdint.h>
 
+#define TRACK_ENCODED_SIZE 160 // encoded GPS track carried by one message, see utils/track.h
+
 /**
  * @brief Sensor Data Structure
  *
  * @details This structure contains the data collected from various sensors.
  * It includes information such as device battery level, accelerometer data, temperature, humidity,
- * gas level, steps, and heart rate.
+ * gas level, steps, heart rate and heart rate variability summaries, GPS position and track,
+ * geofence transitions and BLE scan statistics.
  *
  */
 typedef struct SensorData
@@ -36,6 +39,26 @@ typedef struct SensorData
     float gps_speed;      // km/h
     float gps_altitude;   // meters
     float gps_accuracy;   // meters
+    char track[TRACK_ENCODED_SIZE]; // fixes kept since the last upload, delta encoded
+    int geofence;         // fence of the last transition
+    bool geofence_inside;
+    int hr_strap;         // strap of the heart rate summary
+    uint16_t hr_period;   // seconds covered by the summary
+    uint8_t hr_min;       // BPM over the period
+    uint8_t hr_max;
+    int8_t hr_contact;    // 1 skin contact, 0 lost during the period, -1 not reported
+    int32_t hr_energy;    // kJ, -1 if the strap does not send it
+    uint16_t hrv_beats;   // RR-intervals in the HRV window, 0 if too few for a summary
+    uint16_t hrv_artifacts; // RR-intervals rejected during the period
+    float hrv_rmssd;      // ms
+    float hrv_sdnn;       // ms
+    float hrv_pnn50;      // %
+    float bt_scan_duty;   // % of the time the scanner received, -1 when no BLE stats are pending
+    uint32_t bt_reconnects;
+    uint32_t bt_reconnect_avg_ms; // strap lost to subscribed again
+    uint32_t bt_reconnect_max_ms;
+    int8_t bt_tx_power;   // dBm
+    uint32_t bt_radio_ms_per_hour; // scan and connection events, averaged since boot
 } sensor_data_t;
 
 typedef struct
@@ -57,6 +80,10 @@ typedef struct
     bool gps_speed;
     bool gps_altitude;
     bool gps_accuracy;
+    bool track;
+    bool geofence;
+    bool hr_summary;
+    bool bt_stats;
 } sensor_data_flags_t;
 
 typedef struct
@@ -73,7 +100,7 @@ typedef struct
  */
 typedef struct
 {
-    char json[512];
+    char json[1024];
 } processed_data_t;
 
 #endif
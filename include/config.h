@@ -39,16 +39,90 @@
 #define TOKEN_REFRESH_MARGIN_MS 300000  // 5 minuter
 #define DEFAULT_TOKEN_EXPIRY_MS 3600000 // 1 timme
 
+// Retry/backoff settings (budgets per message class are in retryPolicy.cpp)
+#define RETRY_JITTER_PERCENT 25
+#define BREAKER_FAILURE_THRESHOLD 5     // consecutive failures before the breaker opens
+#define BREAKER_OPEN_TIMEOUT_MS 60000   // time before a probe request is allowed
+#define OFFLINE_BUFFER_CAPACITY 8       // payloads parked while the backend is unreachable
+
+// Fixed buffers for the auth and HTTP path (no heap allocation per request)
+#define HTTP_STREAM_CHUNK_SIZE 64   // response bodies are streamed in chunks of this size
+#define HTTP_DEBUG_BODY_SIZE 128    // start of telemetry responses kept for DEBUG logging
+#define AUTH_TOKEN_MAX_LEN 512      // including terminator
+#define AUTH_HEADER_MAX_LEN (AUTH_TOKEN_MAX_LEN + 7) // "Bearer " + token
+#define AUTH_PAYLOAD_SIZE 256       // serialized login request
+#define JSON_ARENA_SIZE 1024        // ArduinoJson arena for the login document
+
+// Uplink compression, the backend must accept "Content-Encoding: gzip"
+// #define USE_PAYLOAD_COMPRESSION
+#define COMPRESSION_MIN_SIZE 128 // smaller payloads are always sent as is
+
+// WiFi fast reconnect: the last good BSSID and channel are kept in NVS and tried before scanning
+#define USE_WIFI_FAST_CONNECT
+// #define WIFI_REUSE_IP_CONFIG // also skip DHCP, only safe with an address reserved on the router
+
+// Modem low power: DTR sleep between uses, the modem stays registered instead of powering off
+#define USE_MODEM_LOW_POWER
+#define MODEM_PSM_TAU "00100001"         // requested T3412 periodic TAU, 1 h
+#define MODEM_PSM_ACTIVE_TIME "00000101" // requested T3324 active time, 10 s
+#define MODEM_EDRX_CYCLE "0101"          // requested eDRX cycle, 81.92 s
+#define MODEM_AWAKE_MW 250               // power model for the energy counters
+#define MODEM_SLEEP_MW 5
+
+// Modem multiplexing: CMUX channels for data, GNSS and control instead of one AT command stream,
+// DTR sleep is not used while the multiplexer runs
+// #define USE_MODEM_CMUX
+
+// GNSS: the modem streams NMEA to its GNSS UART (MODEM_GPS_RX_PIN) or the CMUX GNSS channel instead
+// of being polled with AT+CGNSSINFO; without either, polling stays in use. The sentinel boards
+// (T-SIM7670G-S3, T-A7670) have no GNSS UART wired, so they poll unless USE_MODEM_CMUX is on, and
+// CMUX is off by default because it rules out DTR sleep, which saves more than streaming at 1 Hz
+#define USE_GNSS_NMEA_STREAM
+#define GNSS_NMEA_RATE_HZ 1            // 1, 2, 5 or 10
+#define GNSS_NMEA_BAUD 115200          // modem GNSS UART
+#define GNSS_STREAM_RETRY_MS 300000    // a stream that fell back to polling is tried again
+
+// GNSS duty cycling: engine off while stationary, fix interval from speed and battery
+#define GNSS_MOVING_INTERVAL_MS 30000
+#define GNSS_FAST_INTERVAL_MS 5000     // at GNSS_FAST_SPEED_KN and above
+#define GNSS_FAST_SPEED_KN 8.0f
+#define GNSS_ACQUIRE_TIMEOUT_MS 120000 // stationary without a fix, give up until the heartbeat
+#define GNSS_HEARTBEAT_MS 1800000      // stationary fix, keeps hot starts possible
+#define GNSS_ACTIVE_MW 110             // power model for the energy counters
+
+// Assisted GNSS: the modem fetches assistance data (AT+CAGPS) at engine starts while on LTE
+#define USE_AGNSS
+#define AGNSS_VALIDITY_S 86400       // fetched data is trusted while younger than this
+#define AGNSS_FETCH_TIMEOUT_MS 10000 // longest the GNSS channel is held waiting for the fetch
+
+// Position filter: Kalman filtered position and velocity from the fixes, weighted by their DOP
+#define KF_ACCEL_NOISE 1.0f // m/s^2, white acceleration of the motion model
+#define KF_UERE_M 4.0f      // m of position error per unit of HDOP
+#define KF_MIN_SATELLITES 4 // fixes from fewer satellites are ignored
+
+// GPS track: only fixes off the dead-reckoned track are kept, uploaded delta encoded in batches;
+// polygon geofences (GEOFENCE_LIST in secrets.h) are evaluated on the device
+#define USE_TRACK_PROCESSING
+#define TRACK_TOLERANCE_M 25.0f // distance from the predicted position that keeps a fix
+#define TRACK_MAX_GAP_MS 600000 // a fix is kept at least this often
+#define TRACK_FLUSH_POINTS 8    // kept fixes that trigger an upload
+#define TRACK_FLUSH_MS 300000   // kept fixes are uploaded at least this often
+#define GEOFENCE_CONFIRM_FIXES 2 // fixes on the other side before a transition is reported
+
 // Mutex declarations
 extern SemaphoreHandle_t serialMutex;
 extern SemaphoreHandle_t modemMutex;
 extern SemaphoreHandle_t networkEventMutex;
+extern SemaphoreHandle_t authMutex;
 
 // Modem settings (NETWORK_APN is set in secrets.h)
 // #define TINY_GSM_RX_BUFFER 1024
 // #define LILYGO_T_A7670 //temp
 #define TINY_GSM_USE_GPRS true
 #define TINY_GSM_USE_WIFI false
+#define MODEM_BAUD_DEFAULT 115200 // rate the modem boots with
+#define MODEM_BAUD_RATE 460800    // negotiated with AT+IPR once the modem answers
+#define MODEM_RX_BUFFER_SIZE 4096 // UART driver ring, HTTPS bodies arrive in bursts
 
 #ifdef LILYGO_T_A7670
 // RGB macros
@@ -74,6 +148,15 @@ extern SemaphoreHandle_t networkEventMutex;
 // Macros for Polar H9
 #define STRAP_NAME "POLAR H9 EC351E2B"
 #define STRAP_ADDRESS "a0:9e:1a:ec:35:1e"
+#define STRAP_ADDRESSES STRAP_ADDRESS // comma separated whitelist, up to HR_MAX_STRAPS straps
+#define HR_SUMMARY_MS 15000           // a heart rate and HRV summary is sent this often per strap
+#define HRV_WINDOW_MS 60000           // RR-intervals the HRV is computed over, up to a minute
+#define BT_SCAN_FAST_MS 30000         // 50% duty scan after a strap is lost
+#define BT_SCAN_MEDIUM_MS 300000      // 10% duty scan until then, 2.5% after
+#define BT_RSSI_TARGET_DBM -75        // connection TX power is lowered while straps are stronger
+#define BT_TX_MAX_DBM 9
+#define BT_TX_MIN_DBM -12
+#define BT_CONN_EVENT_US 500          // radio on per connection event, for the radio time estimate
 #define HEARTRATE_SERVICE_UUID "180D"
 #define HEARTRATE_CHAR_UUID "2A37"
 
@@ -123,6 +206,11 @@ extern SemaphoreHandle_t networkEventMutex;
 #define STEP_THRESHOLD 1.5f
 #define STEP_MIN_TIME_MS 400
 
+// Motion detection, stationary after STATIONARY_TIMEOUT_MS without a 2 s window whose total
+// acceleration spread (g) exceeds MOTION_THRESHOLD
+#define MOTION_THRESHOLD 0.08f
+#define STATIONARY_TIMEOUT_MS 60000
+
 // Kalibrering
 #define X_OFFSET 0.0737f
 #define Y_OFFSET -0.6132f
@@ -0,0 +1,51 @@
+/**
+ * @file agnss.h
+ * @brief Assisted GNSS Data
+ *
+ * @details This file contains the declaration of the Agnss class, which has the modem fetch
+ * assistance data (ephemeris and almanac predictions) with AT+CAGPS so that a start without a
+ * recent fix does not have to decode the ephemeris from the sky, which takes most of a cold start.
+ *
+ * AT+CAGPS downloads the data from SIMCom's server and loads it into the engine in one go; these
+ * modems document no command that loads data handed over by the host, so the firmware neither
+ * downloads nor stores the data itself. It lives in the modem and is lost when the modem is powered
+ * off, AgnssValidity decides whether a start still counts as assisted. The class is owned by the
+ * GPS task.
+ */
+
+#ifndef AGNSS_H
+#define AGNSS_H
+
+#include "network/agnssValidity.h"
+#include <cstdint>
+
+/**
+ * @brief Assistance counters
+ */
+typedef struct
+{
+    uint32_t fetches;       // data fetched by the modem
+    uint32_t fetchFailures; // including fetches that did not answer within AGNSS_FETCH_TIMEOUT_MS
+    uint32_t assistedStarts;
+    uint32_t ageS; // age of the data in the modem, 0 if there is none
+} agnss_stats_t;
+
+class Agnss
+{
+public:
+    Agnss();
+
+    bool inject();
+
+    agnss_stats_t getStats() const;
+
+private:
+    bool fetch();
+
+    AgnssValidity validity; // on millis() and ModemPower's cold boot count
+    agnss_stats_t stats;
+};
+
+extern Agnss agnss;
+
+#endif
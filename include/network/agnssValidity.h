@@ -0,0 +1,38 @@
+/**
+ * @file agnssValidity.h
+ * @brief Assisted GNSS Data Validity
+ *
+ * @details This file contains the declaration of the AgnssValidity class, which decides whether
+ * the assistance data the modem fetched can still be counted on and when a failed fetch may be
+ * tried again. The data lives in the modem, so it is valid only while the modem has not been
+ * powered up again since the fetch and the data is younger than AGNSS_VALIDITY_S.
+ *
+ * Time and the modem's power-up count are passed in, so the rules can be checked on the host.
+ */
+
+#ifndef AGNSS_VALIDITY_H
+#define AGNSS_VALIDITY_H
+
+#include <cstdint>
+
+class AgnssValidity
+{
+public:
+    AgnssValidity();
+
+    void onAttempt(uint32_t now);
+    void onFetched(uint32_t now, uint32_t boot);
+
+    bool isValid(uint32_t now, uint32_t boot) const;
+    bool mayFetch(uint32_t now) const;
+    uint32_t getAgeS(uint32_t now, uint32_t boot) const;
+
+private:
+    bool fetched;
+    uint32_t fetchedMs;   // time of the last successful fetch
+    uint32_t fetchedBoot; // modem power-up of that fetch
+    bool attempted;
+    uint32_t lastAttempt; // time of the last fetch attempt
+};
+
+#endif
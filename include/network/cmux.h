@@ -0,0 +1,103 @@
+/**
+ * @file cmux.h
+ * @brief Modem UART Multiplexer (3GPP TS 27.010 CMUX)
+ *
+ * @details This file contains the declaration of the Cmux class and its CmuxChannel streams. After
+ * AT+CMUX=0 the modem UART carries frames for several virtual serial ports (DLCs), so HTTPS on the
+ * data channel, GNSS polling and status queries can each have their own TinyGsm instance and lock
+ * instead of taking turns on one AT command stream.
+ *
+ * While the multiplexer is not running every channel passes straight through to the UART, so the
+ * same TinyGsm instances work before AT+CMUX=0 and after the modem was powered off.
+ */
+
+#ifndef CMUX_H
+#define CMUX_H
+
+#include "network/cmuxDemux.h"
+#include <Arduino.h>
+
+/**
+ * @brief Virtual channels, the value is the DLCI
+ */
+typedef enum
+{
+    MODEM_CHANNEL_DATA = 1,    // HTTPS and the data connection
+    MODEM_CHANNEL_GNSS = 2,    // GNSS polling
+    MODEM_CHANNEL_CONTROL = 3, // network setup and status queries
+} modem_channel_t;
+
+/**
+ * @brief Frame counters
+ */
+typedef struct
+{
+    uint32_t framesIn;
+    uint32_t framesOut;
+    uint32_t fcsErrors;
+    uint32_t droppedFrames;
+    uint32_t rxOverflows; // a channel's receive buffer was full, bytes were lost
+    uint32_t flowStops;   // a channel was paused with MSC because its buffer filled up
+} cmux_stats_t;
+
+class Cmux;
+
+class CmuxChannel : public Stream
+{
+public:
+    CmuxChannel(Cmux& mux, modem_channel_t dlci);
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    int availableForWrite() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+private:
+    friend class Cmux;
+
+    Cmux& mux;
+    modem_channel_t dlci;
+    CmuxRing& rx;
+};
+
+class Cmux
+{
+public:
+    explicit Cmux(Stream& link);
+
+    bool begin(uint32_t timeoutMs);
+    void end();
+    void reset();
+    bool isActive() const;
+
+    void poll();
+    cmux_stats_t getStats() const;
+
+private:
+    friend class CmuxChannel;
+
+    size_t send(uint8_t dlci, const uint8_t* data, size_t length);
+    void release(uint8_t dlci);
+    void sendFrame(
+        uint8_t dlci, uint8_t control, bool command, const uint8_t* info, size_t length);
+    void writeFrame(
+        uint8_t dlci, uint8_t control, bool command, const uint8_t* info, size_t length);
+    bool openDlc(uint8_t dlci, uint32_t timeoutMs);
+
+    Stream& link;
+    SemaphoreHandle_t lock; // one reader of the UART at a time, whole frames on write
+    CmuxDemux demux;
+    volatile bool active;
+    uint32_t framesOut;
+};
+
+extern Cmux cmux;
+extern CmuxChannel cmuxDataChannel;
+extern CmuxChannel cmuxGnssChannel;
+extern CmuxChannel cmuxControlChannel;
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * @file cmuxCodec.h
+ * @brief 3GPP TS 27.010 Basic Mode Frame Codec
+ *
+ * @details This file contains the frame encoder and the incremental frame decoder used by the CMUX
+ * layer. A frame is: flag (0xF9), address, control, length (1 or 2 bytes), information, FCS, flag.
+ *
+ * The decoder takes one byte at a time and keeps no more than one frame, so it can run on bytes as
+ * the UART delivers them; frames that fail the FCS or do not fit CMUX_MAX_INFO are counted and
+ * skipped.
+ */
+
+#ifndef CMUX_CODEC_H
+#define CMUX_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define CMUX_FLAG 0xF9
+#define CMUX_EA 0x01
+#define CMUX_CR 0x02
+#define CMUX_PF 0x10
+
+// Frame types, P/F bit cleared
+#define CMUX_SABM 0x2F
+#define CMUX_UA 0x63
+#define CMUX_DM 0x0F
+#define CMUX_DISC 0x43
+#define CMUX_UIH 0xEF
+
+// Multiplexer control messages on DLCI 0, C/R bit cleared
+#define CMUX_MSG_CLD 0xC1 // close down
+#define CMUX_MSG_MSC 0xE1 // modem status
+
+#define CMUX_MAX_INFO 256 // longest information field accepted
+#define CMUX_FRAME_OVERHEAD 7 // flags, address, control, two length bytes, FCS
+
+/**
+ * @brief One decoded frame, the information field points into the decoder
+ */
+typedef struct
+{
+    uint8_t dlci;
+    uint8_t control; // frame type with the P/F bit cleared
+    bool pf;
+    bool command;    // C/R bit as sent
+    const uint8_t* info;
+    size_t length;
+} cmux_frame_t;
+
+class CmuxCodec
+{
+public:
+    CmuxCodec();
+
+    static size_t encode(uint8_t dlci, uint8_t control, bool command, const uint8_t* info,
+        size_t length, uint8_t* out, size_t outSize);
+    static uint8_t fcs(const uint8_t* data, size_t length);
+
+    bool decode(uint8_t byte, cmux_frame_t& frame);
+    void reset();
+
+    uint32_t getFcsErrors() const;
+    uint32_t getDroppedFrames() const;
+
+private:
+    enum State
+    {
+        WAIT_FLAG,
+        ADDRESS,
+        CONTROL,
+        LENGTH,
+        LENGTH2,
+        INFO,
+        FCS,
+        END
+    };
+
+    State state;
+    uint8_t header[4];
+    size_t headerLength;
+    size_t length;
+    size_t received;
+    uint8_t info[CMUX_MAX_INFO];
+    uint8_t receivedFcs;
+    uint32_t fcsErrors;
+    uint32_t droppedFrames;
+};
+
+#endif
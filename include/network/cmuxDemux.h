@@ -0,0 +1,77 @@
+/**
+ * @file cmuxDemux.h
+ * @brief CMUX Receive Side: Frame Routing and Flow Control
+ *
+ * @details This file contains the CmuxDemux class, which decodes the bytes the modem sends in CMUX
+ * mode, files each channel's data into that channel's receive ring and answers the frames that
+ * need an answer. When a ring fills up to CMUX_FLOW_STOP_FREE it asks the modem to pause that
+ * channel with an MSC command carrying FC=1, and lets it go on with FC=0 once the reader has
+ * drained the ring to CMUX_FLOW_RESUME_FREE. The other channels keep flowing meanwhile.
+ *
+ * The caller writes the returned reply frames to the UART and serializes feed() and release().
+ */
+
+#ifndef CMUX_DEMUX_H
+#define CMUX_DEMUX_H
+
+#include "network/cmuxCodec.h"
+#include <TinyGsmFifo.h>
+
+#ifndef CMUX_CHANNEL_RX_BUFFER
+#define CMUX_CHANNEL_RX_BUFFER 2048
+#endif
+
+#define CMUX_CHANNELS 4 // DLCI 0 (multiplexer control) and three data channels
+
+// Free space of a channel's ring at which the modem is paused and resumed. Frames the modem sent
+// before it saw the pause still arrive, the headroom has to hold them.
+#ifndef CMUX_FLOW_STOP_FREE
+#define CMUX_FLOW_STOP_FREE (CMUX_CHANNEL_RX_BUFFER / 2)
+#endif
+#ifndef CMUX_FLOW_RESUME_FREE
+#define CMUX_FLOW_RESUME_FREE (CMUX_CHANNEL_RX_BUFFER * 3 / 4)
+#endif
+
+#define CMUX_FRAME_SIZE 31 // N1, default information size for basic mode
+#define CMUX_REPLY_SIZE (CMUX_FRAME_SIZE + CMUX_FRAME_OVERHEAD)
+
+typedef TinyGsmFifo<uint8_t, CMUX_CHANNEL_RX_BUFFER> CmuxRing;
+
+class CmuxDemux
+{
+public:
+    CmuxDemux();
+
+    void reset();
+    size_t feed(uint8_t byte, uint8_t* reply, size_t replySize);
+    size_t release(uint8_t dlci, uint8_t* reply, size_t replySize);
+
+    static size_t modemStatus(uint8_t dlci, bool stop, uint8_t* out, size_t outSize);
+
+    CmuxRing& ring(uint8_t dlci);
+    bool isOpened(uint8_t dlci) const;
+    bool isRefused(uint8_t dlci) const;
+    bool isStopped(uint8_t dlci) const;
+    bool isClosed() const;
+
+    uint32_t getFramesIn() const;
+    uint32_t getRxOverflows() const;
+    uint32_t getFlowStops() const;
+    const CmuxCodec& getCodec() const;
+
+private:
+    size_t dispatch(const cmux_frame_t& frame, uint8_t* reply, size_t replySize);
+    size_t handleControl(const cmux_frame_t& frame, uint8_t* reply, size_t replySize);
+
+    CmuxCodec codec;
+    CmuxRing rings[CMUX_CHANNELS - 1]; // DLCI 0 carries no data
+    volatile uint8_t opened;  // bit per DLCI, set by UA
+    volatile uint8_t refused; // bit per DLCI, set by DM
+    volatile uint8_t stopped; // bit per DLCI, the modem was asked to pause it
+    volatile bool closed;     // the modem closed the multiplexer
+    uint32_t framesIn;
+    uint32_t rxOverflows;
+    uint32_t flowStops;
+};
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @file gnssReceiver.h
+ * @brief Streaming NMEA GNSS Receiver
+ *
+ * @details This file contains the declaration of the GnssReceiver class, which feeds the NMEA
+ * sentences the modem pushes at a fixed rate into TinyGPSPlus. It reads from a stream that carries
+ * nothing but NMEA (the modem's GNSS UART or the CMUX GNSS channel), so no AT command is involved.
+ *
+ * Only the task that polls writes the fix. Any task can read the latest fix without a lock: fixes
+ * alternate between two slots and a sequence counter publishes the newest one, a reader only
+ * retries if a new fix was published while it was copying.
+ */
+
+#ifndef GNSS_RECEIVER_H
+#define GNSS_RECEIVER_H
+
+#include "network/gps.h"
+#include <Arduino.h>
+#include <TinyGPSPlus.h>
+#include <atomic>
+
+/**
+ * @brief Parser counters
+ */
+typedef struct
+{
+    uint32_t bytes;
+    uint32_t sentences;      // passed the checksum
+    uint32_t checksumErrors;
+    uint32_t fixes;          // fixes published
+} gnss_stats_t;
+
+class GnssReceiver
+{
+public:
+    GnssReceiver();
+
+    void begin(Stream& source);
+    void end();
+    bool isStreaming() const;
+
+    size_t poll();
+    uint32_t getLastSentenceMs() const;
+    bool getFix(gps_location_t& location) const;
+    gnss_stats_t getStats() const;
+
+private:
+    void publish();
+
+    Stream* source;
+    TinyGPSPlus parser;
+    uint32_t lastSentenceMs;
+    std::atomic<uint32_t> sequence; // fixes published, the newest is in slots[sequence & 1]
+    gps_location_t slots[2];
+    gnss_stats_t stats;
+};
+
+extern GnssReceiver gnssReceiver;
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @file gnssScheduler.h
+ * @brief Adaptive GNSS Duty Cycling
+ *
+ * @details This file contains the declaration of the GnssScheduler class, which decides when the
+ * GNSS engine runs and how often a fix is reported. The accelerometer task reports whether the
+ * device is moving and the battery task reports the charge; the GPS task asks the scheduler whether
+ * the engine should be on and how long to wait before the next fix.
+ *
+ * While the device is stationary the engine is switched off once the resting position is known.
+ * It comes back on with a hot start when motion is detected, and for a heartbeat fix at a long
+ * interval so the ephemeris stays fresh enough for the next hot start. The fix interval shortens
+ * at speed and stretches as the battery runs down.
+ *
+ * A run only ends at rest once it has a fix of its own; the fix that ended the previous run does
+ * not count, so a heartbeat start keeps the engine on until it gets one or times out. Motion and
+ * battery are set from other tasks and are atomic, everything else is called from the GPS task
+ * with its millis() time.
+ */
+
+#ifndef GNSS_SCHEDULER_H
+#define GNSS_SCHEDULER_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Motion as seen by the accelerometer
+ */
+typedef enum
+{
+    MOTION_UNKNOWN,    // no report yet, treated as moving
+    MOTION_STATIONARY,
+    MOTION_MOVING,
+} motion_state_t;
+
+/**
+ * @brief Scheduler counters
+ */
+typedef struct
+{
+    uint32_t fixes;           // fixes reported
+    uint32_t acquisitions;    // engine starts
+    uint32_t timeouts;        // acquisitions given up while stationary
+    uint32_t lastTimeToFixMs; // engine start to first valid fix
+    uint32_t avgTimeToFixMs;  // smoothed over acquisitions
+    uint32_t assisted;        // engine starts with assistance data injected
+    uint32_t avgAssistedTimeToFixMs;   // smoothed over assisted acquisitions
+    uint32_t avgUnassistedTimeToFixMs; // and over the others
+    uint32_t onTimeMs;        // engine on time, including the running stretch
+    uint32_t energyMj;        // estimated GNSS energy, from onTimeMs
+    uint32_t energyPerFixMj;
+    uint32_t intervalMs;      // current fix interval
+} gnss_schedule_stats_t;
+
+class GnssScheduler
+{
+public:
+    GnssScheduler();
+
+    void setMotion(bool moving, uint32_t now);
+    motion_state_t getMotion() const;
+    void setBatteryPercent(int percent);
+
+    bool wantEngineOn(uint32_t now) const;
+    bool fixDue(uint32_t now) const;
+    uint32_t fixInterval() const;
+
+    void onEngineOn(uint32_t now, bool assisted = false);
+    void onEngineOff(uint32_t now);
+    void onFix(float speedKnots, uint32_t now);
+
+    gnss_schedule_stats_t getStats(uint32_t now) const;
+
+private:
+    static void average(uint32_t& avg, uint32_t ttf);
+    uint32_t restingSince() const;
+    bool fixedAtRest() const;
+
+    std::atomic<uint8_t> motion;         // motion_state_t
+    std::atomic<uint32_t> motionSince;
+    std::atomic<int8_t> batteryPercent;  // -1 if unknown
+
+    bool engineOn;
+    bool fixedSinceOn;    // a fix was reported since the engine started
+    bool assistedStart;   // the engine started with assistance data
+    uint32_t engineSince; // engine start or stop
+    bool hasFix;
+    uint32_t lastFix;
+    float lastSpeed;      // knots, of the last fix
+    gnss_schedule_stats_t stats;
+};
+
+extern GnssScheduler gnssScheduler;
+
+#endif
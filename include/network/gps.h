@@ -25,13 +25,24 @@ public:
 
     bool enableGPS();
     bool disableGPS();
+    bool hotStart();
     bool isGPSEnabled();
     bool getGPSLocation(gps_location_t& location);
     bool waitForGPSFix(unsigned long timeoutMs = 120000);
     bool getLastLocation(gps_location_t& location);
     void printStatus();
 
+    bool startNmeaStream();
+    void stopNmeaStream();
+    bool isStreaming() const;
+    bool canStream() const;
+    bool pollNmeaStream();
+
 private:
+    static const uint8_t NMEA_PORT_USB = 0;  // modem default, not connected on these boards
+    static const uint8_t NMEA_PORT_UART = 1; // the AT UART, or the multiplexer while CMUX runs
+
+    bool setNmeaPort(uint8_t port);
 
     
     gps_location_t lastGPSLocation;
@@ -0,0 +1,41 @@
+/**
+ * @file handoverPolicy.h
+ * @brief Make-Before-Break Handover Policy
+ *
+ * @details This file contains the HandoverPolicy class, which decides when the network manager
+ * warms up LTE and when it may take it down again. LTE is wanted while WiFi keeps failing at boot,
+ * once a working WiFi link has been down for longer than a fast reconnect takes, and while WiFi is
+ * connected with a smoothed RSSI below WIFI_RSSI_WARMUP_DBM. It is released only after WiFi has
+ * been good for HANDOVER_HOLD_MS.
+ */
+
+#ifndef HANDOVER_POLICY_H
+#define HANDOVER_POLICY_H
+
+#include <cstdint>
+
+class HandoverPolicy
+{
+public:
+    HandoverPolicy();
+
+    void begin(uint32_t now);
+    void onWiFiConnected(int16_t rssi);
+    void onWiFiLost(uint32_t now);
+    bool updateRssi(int16_t rssi);
+
+    int16_t getRssi() const;
+    bool isDegraded() const;
+
+    bool isLteWanted(uint32_t now, bool wifiConnected, bool wifiGaveUp);
+    bool canReleaseLte(uint32_t now, bool wifiConnected) const;
+
+private:
+    uint32_t wifiDownSince;
+    uint32_t lastLteWanted;
+    int16_t rssiAverage;
+    bool degraded;
+    bool wifiWorked; // the grace period only applies once WiFi has connected
+};
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * @file linkScorer.h
+ * @brief Link Quality Scoring for Transport Selection
+ *
+ * @details This file contains the declaration of the LinkScorer class, which tracks success rate,
+ * latency and signal strength per transport and picks the one that delivers the most requests per
+ * joule. The energy of a request is estimated from the radio's active power times the observed
+ * latency, plus the fixed tail energy the radio spends before it returns to idle.
+ *
+ * Between two links that are both up, the one used for the previous request is kept until the
+ * other scores LINK_SWITCH_MARGIN better, so two similar links do not take turns.
+ */
+
+#ifndef LINK_SCORER_H
+#define LINK_SCORER_H
+
+#include <cstdint>
+
+/**
+ * @brief Transport used for one uplink request
+ */
+enum Transport
+{
+    TRANSPORT_NONE,
+    TRANSPORT_WIFI,
+    TRANSPORT_LTE,
+    TRANSPORT_COUNT
+};
+
+/**
+ * @brief Energy model of one transport
+ */
+typedef struct
+{
+    uint16_t activePowerMw; // average draw while a request is in flight
+    uint16_t tailEnergyMj;  // energy spent after a request before the radio idles
+    uint16_t priorLatencyMs; // latency assumed before the first sample
+    int16_t signalFloorDbm; // signal at which the link is barely usable
+    int16_t signalGoodDbm;  // signal above which the link is considered good
+} link_profile_t;
+
+/**
+ * @brief Exported state of one transport
+ */
+typedef struct
+{
+    float successRate;    // smoothed share of requests that got an HTTP response
+    float latencyMs;      // smoothed request latency
+    int16_t signalDbm;    // last reported signal strength, 0 if unknown
+    float energyMj;       // estimated energy per request
+    float score;          // delivered requests per joule, weighted by signal
+    uint32_t samples;
+    uint32_t failures;
+} link_stats_t;
+
+class LinkScorer
+{
+public:
+    LinkScorer();
+
+    void setProfile(Transport transport, const link_profile_t& profile);
+
+    void recordResult(Transport transport, bool delivered, uint32_t latencyMs);
+    void updateSignal(Transport transport, int16_t signalDbm);
+
+    float score(Transport transport) const;
+    Transport pick(bool wifiUp, bool lteUp, Transport current) const;
+
+    link_stats_t getStats(Transport transport) const;
+
+private:
+    float energyMj(Transport transport) const;
+    float signalFactor(Transport transport) const;
+
+    link_profile_t profiles[TRANSPORT_COUNT];
+    link_stats_t stats[TRANSPORT_COUNT];
+};
+
+#endif
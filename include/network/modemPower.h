@@ -0,0 +1,78 @@
+/**
+ * @file modemPower.h
+ * @brief Modem Power-State Manager
+ *
+ * @details This file contains the declaration of the ModemPower class, which owns access to the
+ * modem. Tasks take the modem through acquire() and give it back with release() instead of using
+ * the modem mutex directly. Once low power is configured, release() lets the modem sleep via DTR
+ * and acquire() wakes it, so a send after a quiet period costs a DTR wake instead of a cold boot.
+ *
+ * While asleep the modem stays registered. 3GPP PSM and eDRX timers are requested from the network
+ * so that the radio can also sleep between uplinks.
+ *
+ * Each caller names the channel it talks on. While the CMUX multiplexer runs every channel has its
+ * own lock, so a GNSS poll no longer waits behind an HTTPS upload; otherwise all channels share the
+ * modem mutex.
+ */
+
+#ifndef MODEM_POWER_H
+#define MODEM_POWER_H
+
+#include "network/cmux.h"
+#include <Arduino.h>
+#include <cstdint>
+
+/**
+ * @brief Wake and energy counters
+ */
+typedef struct
+{
+    uint32_t wakes;
+    uint32_t wakeFailures;
+    uint32_t lastWakeLatencyMs;
+    uint32_t maxWakeLatencyMs;
+    uint32_t coldBoots;
+    uint32_t awakeMs;   // time the modem was powered and awake
+    uint32_t asleepMs;  // time the modem was powered and sleeping
+    uint32_t energyMj;  // estimate from awakeMs and asleepMs
+} modem_power_stats_t;
+
+class ModemPower
+{
+public:
+    ModemPower();
+
+    void begin();
+
+    bool acquire(modem_channel_t channel, TickType_t wait);
+    void release(modem_channel_t channel);
+
+    bool configureLowPower(uint8_t step);
+    bool startMultiplexer();
+    void multiplexerLost();
+    void poweredOn();
+    void poweredOff();
+
+    bool isLowPowerReady() const;
+    modem_power_stats_t getStats();
+
+private:
+    bool wake();
+    void sleep();
+    void account();
+
+    SemaphoreHandle_t channelMutex[CMUX_CHANNELS];
+    SemaphoreHandle_t held[CMUX_CHANNELS]; // the mutex each channel's holder took
+    bool echoOn[CMUX_CHANNELS]; // channels opened since echo was last turned off on them
+    bool powered;
+    bool lowPowerReady;
+    bool asleep;
+    uint32_t stateSince;
+    uint32_t energyRemainderUj;
+    modem_power_stats_t stats;
+    portMUX_TYPE statsLock; // guards stats and the accounting state, taken by getStats()
+};
+
+extern ModemPower modemPower;
+
+#endif
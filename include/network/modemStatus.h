@@ -0,0 +1,56 @@
+/**
+ * @file modemStatus.h
+ * @brief Cached Modem Status
+ *
+ * @details This file contains the declaration of the ModemStatusCache class, which keeps the SIM,
+ * registration, data connection and signal state of the modem. The cache is fed by unsolicited
+ * result codes (+CPIN, +CEREG, +CGEV, +CSQ) and by the answers of queries that were made anyway.
+ * A value younger than its TTL is used instead of a new AT query.
+ *
+ * The cache does no locking of its own. URCs are parsed inside waitResponse() of whichever channel
+ * they arrive on, so the network manager keeps every access under one spinlock.
+ */
+
+#ifndef MODEM_STATUS_H
+#define MODEM_STATUS_H
+
+#include <cstdint>
+
+class ModemStatusCache
+{
+public:
+    ModemStatusCache();
+
+    void reset();
+    void setUrcReporting(bool enabled);
+    bool onUrc(const char* urc, const char* args, uint32_t now);
+
+    bool getSimReady(uint32_t now, bool& ready) const;
+    void setSimReady(bool ready, uint32_t now);
+
+    bool getRegistration(uint32_t now, int8_t& status) const;
+    void setRegistration(int8_t status, uint32_t now);
+
+    bool getDataActive(uint32_t now, bool& active) const;
+    void setDataActive(bool active, uint32_t now);
+    bool isDataLost() const;
+
+    bool getSignal(uint32_t now, int16_t& value) const;
+    void setSignal(int16_t value, uint32_t now);
+
+private:
+    static bool fresh(uint32_t since, uint32_t now, uint32_t ttl);
+
+    bool urcReporting; // registration and data events are reported by URC
+    bool simReady;
+    int8_t registration;
+    bool dataActive;
+    bool dataLost;     // set by a deactivation URC, cleared when the data state is set again
+    int16_t csq;
+    uint32_t simSince; // 0 means unknown
+    uint32_t registrationSince;
+    uint32_t dataSince;
+    uint32_t signalSince;
+};
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file modemTransport.h
+ * @brief Modem UART Transport
+ *
+ * @details This file contains the declaration of the ModemTransport class, the Stream that TinyGSM
+ * talks to the modem through. It owns the UART setup (receive ring size, hardware flow control
+ * where the board wires RTS/CTS, baud rate) and counts the bytes moved in each direction.
+ */
+
+#ifndef MODEM_TRANSPORT_H
+#define MODEM_TRANSPORT_H
+
+#include <Arduino.h>
+#include <HardwareSerial.h>
+#include <atomic>
+
+/**
+ * @brief Throughput and error counters
+ */
+typedef struct
+{
+    uint32_t baud;
+    uint32_t bytesIn;
+    uint32_t bytesOut;
+    uint32_t rxOverflows; // UART FIFO or driver ring overflowed, bytes were lost
+    uint32_t rxErrors;    // framing, parity and break errors
+} modem_transport_stats_t;
+
+class ModemTransport : public Stream
+{
+public:
+    explicit ModemTransport(HardwareSerial& serial);
+
+    void begin(uint32_t baud);
+    void setBaud(uint32_t baud);
+    uint32_t getBaud() const;
+    bool hasFlowControl() const;
+
+    modem_transport_stats_t getStats() const;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    int availableForWrite() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+private:
+    HardwareSerial& serial;
+    bool started;
+    uint32_t currentBaud;
+    // Counted by the reading and writing tasks and the UART event task, read by anyone
+    std::atomic<uint32_t> bytesIn;
+    std::atomic<uint32_t> bytesOut;
+    std::atomic<uint32_t> rxOverflows;
+    std::atomic<uint32_t> rxErrors;
+};
+
+extern ModemTransport modemTransport;
+
+#endif
@@ -4,15 +4,89 @@
  *
  * @details This file contains the declaration of the Network class, which manages
  * WiFi and LTE connections with automatic fallback capabilities.
+ *
+ * Connections are driven by two state machines, one for WiFi and one for the LTE modem, that
+ * maintainConnection() advances by one short step per call. Waits are timers, not delays, so the
+ * calling task is never held for longer than a single modem command.
  */
 
 #ifndef NETWORK_H
 #define NETWORK_H
 
+#include "network/handoverPolicy.h"
+#include "network/linkScorer.h"
+#include "network/modemStatus.h"
 #include "utilities.h"
 #include <cstdint>
 #include <TinyGsmClient.h>
 
+/**
+ * @brief WiFi connection states
+ */
+enum WiFiState
+{
+    WIFI_STATE_IDLE,       // waiting for the next scan
+    WIFI_STATE_SCANNING,   // asynchronous scan for the configured SSID running
+    WIFI_STATE_CONNECTING, // WiFi.begin() issued, waiting for an IP
+    WIFI_STATE_CONNECTED
+};
+
+/**
+ * @brief LTE connection states
+ */
+enum LteState
+{
+    LTE_STATE_OFF,         // modem powered down or parked in low power, fallback not needed
+    LTE_STATE_POWERING,    // power key sequence and boot wait
+    LTE_STATE_PROBING,     // waiting for the modem to answer AT
+    LTE_STATE_INIT,        // echo, error reports, time zone and network mode
+    LTE_STATE_BAUD,        // flow control and the UART rate change
+    LTE_STATE_LOW_POWER,   // DTR sleep, PSM and eDRX requests
+    LTE_STATE_URCS,        // registration, data connection and signal reports
+    LTE_STATE_MULTIPLEXER, // switching the UART to CMUX
+    LTE_STATE_SIM_WAIT,    // waiting for the SIM to be ready
+    LTE_STATE_REGISTERING, // waiting for network registration
+    LTE_STATE_ATTACHING,   // defining and activating the PDP context
+    LTE_STATE_OPENING,     // opening the socket service (AT+NETOPEN)
+    LTE_STATE_CONNECTED
+};
+
+/**
+ * @brief Connection timing and counters
+ */
+typedef struct
+{
+    uint32_t wifiConnects;
+    uint32_t wifiFailures;
+    uint32_t lastWifiConnectMs;  // from scan start to IP
+    uint32_t lteConnects;
+    uint32_t lteFailures;
+    uint32_t lastLteConnectMs;   // from modem power-on or re-attach start to data connection
+    uint32_t lteReattaches;      // data connection lost and attached again without a power cycle
+    uint32_t lastTimeToConnectMs; // from losing connectivity to having any link again
+    uint32_t longestStepMs;       // longest single maintainConnection() call
+    uint32_t fastConnects;        // WiFi connects that skipped the scan
+    uint32_t fastConnectFailures; // fast connects that fell back to a full scan
+    uint32_t lteWarmups;          // LTE started while WiFi was still connected
+    uint32_t handovers;           // uplink switched between WiFi and LTE
+    uint32_t statusUrcs;          // status URCs that updated the modem status cache
+    uint32_t statusCacheHits;     // modem status checks answered without an AT query
+} network_metrics_t;
+
+/**
+ * @brief Last good WiFi association, persisted in NVS for fast reconnects
+ */
+typedef struct
+{
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip; // IP configuration, only used with WIFI_REUSE_IP_CONFIG
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+} wifi_fast_connect_t;
+
 /**
  * @brief Network management class for WiFi and LTE connectivity
  *
@@ -25,24 +99,81 @@ public:
     Network();
     void begin();
 
-    bool connectWiFi(const char* ssid, const char* password);
     void disconnectWiFi();
     bool isWiFiConnected() const;
 
-    bool connectLTE(const char* apn);
     void disconnectLTE();
     bool isLTEConnected();
 
     bool isConnected();
-    void maintainConnection(const char* ssid, const char* password, const char* apn);
+    Transport acquireUplink();
+    void releaseUplink(Transport transport, bool delivered, uint32_t latencyMs);
+    link_stats_t getLinkStats(Transport transport);
+    uint32_t maintainConnection(const char* ssid, const char* password, const char* apn);
+
+    WiFiState getWiFiState() const;
+    LteState getLteState() const;
+    network_metrics_t getMetrics() const;
+
+    void onWiFiEvent();
+    void onModemUrc(const char* urc, const char* args);
 
 private:
-    bool enableModem();
+    uint32_t stepWiFi(const char* ssid, const char* password, uint32_t now);
+    uint32_t stepLTE(const char* apn, uint32_t now);
+    bool stepPowerSequence(uint32_t now);
+    bool startFastConnect(const char* ssid, const char* password);
+    void rememberAssociation(const char* ssid);
+    void forgetAssociation();
+    void startLTE(uint32_t now);
+    uint8_t getLteUsers();
+    void failLTE(const char* reason);
+    void setLteState(LteState state, uint32_t now);
+    bool sendSetupCommand(const char* command, uint32_t now);
+    void completeLTE(uint32_t now);
+    bool checkSimReady(uint32_t now);
+    RegStatus checkRegistration(uint32_t now);
+    bool checkDataConnection(uint32_t now);
+    int16_t checkSignalQuality(uint32_t now);
+    void resetModemStatus();
     bool disableModem();
+    void updateConnectedBit();
+
+    WiFiState wifiState;
+    LteState lteState;
+    uint32_t wifiStateSince;
+    uint32_t wifiAttemptStart;
+    uint32_t lteStateSince;
+    uint8_t wifiAttempts;
+    uint8_t lteRetries;
+    uint8_t powerStep;
+    uint8_t setupStep;    // command within the current LTE state
+    bool commandPending;  // a command was issued and its final result has not been read yet
+    uint32_t commandSince;
+    bool urcReporting;
+    uint32_t lastLteAttempt;
+    uint32_t lastLteCheck;
+    uint32_t outageSince;
 
-    bool wifiConnected;
     bool lteConnected;
     bool modemEnabled;
+    bool connectedBitSet;
+    bool connectedBitValid;
+
+    wifi_fast_connect_t fastConnect;
+    bool fastConnectValid;
+    bool fastAttempt;
+
+    HandoverPolicy handover;
+    uint8_t lteUsers; // requests currently pinned to LTE
+    Transport lastUplink;
+    LinkScorer linkScorer;
+    ModemStatusCache modemStatus;
+    mutable portMUX_TYPE statusLock; // guards modemStatus and the status counters in metrics
+    portMUX_TYPE uplinkLock; // guards lteUsers, lastUplink and linkScorer
+
+    TaskHandle_t ownerTask;
+    network_metrics_t metrics;
 };
 
 extern Network network;
@@ -0,0 +1,42 @@
+/**
+ * @file offlineBuffer.h
+ * @brief Offline Buffer for Undelivered Payloads
+ *
+ * @details This file contains the declaration of the OfflineBuffer class, a fixed-capacity ring of
+ * processed payloads that could not be delivered. When the buffer is full the oldest payload is
+ * overwritten, so the newest readings always survive an outage.
+ *
+ * The buffer is owned by the communication task and is not thread-safe.
+ */
+
+#ifndef OFFLINE_BUFFER_H
+#define OFFLINE_BUFFER_H
+
+#include "SensorData.h"
+#include "config.h"
+#include <cstddef>
+#include <cstdint>
+
+class OfflineBuffer
+{
+public:
+    OfflineBuffer();
+
+    bool push(const processed_data_t& data);
+    bool peek(processed_data_t& data) const;
+    bool pop();
+    void clear();
+
+    size_t size() const;
+    bool isEmpty() const;
+    bool isFull() const;
+    uint32_t getDroppedCount() const;
+
+private:
+    processed_data_t entries[OFFLINE_BUFFER_CAPACITY];
+    size_t head;
+    size_t count;
+    uint32_t dropped;
+};
+
+#endif
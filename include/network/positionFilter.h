@@ -0,0 +1,82 @@
+/**
+ * @file positionFilter.h
+ * @brief Kalman Filtered Position and Velocity
+ *
+ * @details This file contains the declaration of the PositionFilter class, a constant-velocity
+ * Kalman filter over GNSS fixes. Each fix is weighted by its reported dilution of precision, fixes
+ * with too few satellites or too far from the prediction are rejected, and the estimate can be
+ * read at any time, extrapolated to the moment it is asked for.
+ *
+ * The accelerometer has no heading reference on this board, so it cannot be integrated into a
+ * horizontal velocity. It contributes what it can measure: while it reports the device as
+ * stationary, a zero-velocity update pins the velocity and keeps jitter from walking the position.
+ *
+ * Positions are metres east and north of a local origin that follows the device. The model and
+ * noise are the same on both axes, so they share one 2x2 covariance and the filter needs a few
+ * dozen bytes of float state.
+ *
+ * Only the GPS task calls it: every fix goes in, the motion state read from the scheduler becomes
+ * the zero-velocity update, and the reported position comes out of getEstimate().
+ */
+
+#ifndef POSITION_FILTER_H
+#define POSITION_FILTER_H
+
+#include <cstdint>
+
+/**
+ * @brief Filtered estimate
+ */
+typedef struct
+{
+    float latitude;
+    float longitude;
+    float speed;    // m/s
+    float course;   // degrees from north, meaningless when speed is near zero
+    float accuracy; // m, one standard deviation of the position
+} position_estimate_t;
+
+/**
+ * @brief Filter counters
+ */
+typedef struct
+{
+    uint32_t updates;      // fixes accepted
+    uint32_t rejected;     // fixes gated as outliers or with too few satellites
+    uint32_t resets;       // restarts from a fix after a gap or repeated rejections
+    uint32_t stationary;   // zero-velocity updates
+    float lastInnovation;  // m, distance of the last accepted fix from the prediction
+} position_filter_stats_t;
+
+class PositionFilter
+{
+public:
+    PositionFilter();
+
+    void reset();
+    bool isValid() const;
+
+    bool update(float latitude, float longitude, float hdop, int satellites, uint32_t now);
+    void zeroVelocity(uint32_t now);
+    bool getEstimate(uint32_t now, position_estimate_t& estimate) const;
+
+    position_filter_stats_t getStats() const;
+
+private:
+    void predict(uint32_t now);
+    void start(float latitude, float longitude, float variance, uint32_t now);
+    void recenter();
+
+    bool valid;
+    double originLat;   // degrees, the local frame's origin
+    double originLon;
+    float metersPerDegLon;
+    float x[2];         // east, north position in metres
+    float v[2];         // east, north velocity in m/s
+    float p00, p01, p11; // position/velocity covariance, shared by both axes
+    uint32_t time;      // ms, time of the state
+    uint8_t rejectedRun; // consecutive rejections
+    position_filter_stats_t stats;
+};
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @file responseSink.h
+ * @brief Streaming HTTP Response Handlers
+ *
+ * @details This file contains the ResponseSink interface and its implementations. The HTTP
+ * transports feed the response body to a sink in small chunks instead of collecting it into a
+ * String, so the memory used per request does not depend on the size of the backend response.
+ *
+ * - DiscardSink: the body is not read at all, only the status code matters
+ * - CaptureSink: keeps the first bytes of the body in a caller-provided buffer
+ * - JsonTokenSink: extracts the JWT token and its lifetime while the body streams past
+ */
+
+#ifndef RESPONSE_SINK_H
+#define RESPONSE_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Receiver for a streamed HTTP response body
+ */
+class ResponseSink
+{
+public:
+    virtual ~ResponseSink() {}
+
+    /**
+     * @brief Called once the status line has been received
+     * @param code HTTP status code
+     * @param contentLength Body length, or -1 if unknown
+     */
+    virtual void begin(int code, int contentLength) {}
+
+    /**
+     * @brief Consume the next chunk of the body
+     * @return false to stop reading, the rest of the body is then skipped
+     */
+    virtual bool write(const uint8_t* data, size_t length) = 0;
+
+    /**
+     * @brief Called after the last chunk, also when reading stopped early
+     */
+    virtual void end() {}
+
+    /**
+     * @brief Whether the transport should read the body at all
+     */
+    virtual bool wantsBody() const
+    {
+        return true;
+    }
+};
+
+/**
+ * @brief Sink for requests where only the status code matters
+ */
+class DiscardSink : public ResponseSink
+{
+public:
+    bool write(const uint8_t* data, size_t length) override;
+    bool wantsBody() const override;
+};
+
+/**
+ * @brief Sink that keeps the start of the body in a fixed buffer
+ *
+ * @details The buffer is always null-terminated. Reading stops once the buffer is full.
+ */
+class CaptureSink : public ResponseSink
+{
+public:
+    CaptureSink(char* buffer, size_t size);
+
+    void begin(int code, int contentLength) override;
+    bool write(const uint8_t* data, size_t length) override;
+
+    const char* c_str() const;
+    size_t length() const;
+    bool isTruncated() const;
+
+private:
+    char* buffer;
+    size_t size;
+    size_t used;
+    bool truncated;
+};
+
+/**
+ * @brief Sink that extracts "token" and "expires_in" from a JSON body
+ *
+ * @details A small scanner that follows JSON strings, keys and values without building a
+ * document. The first string value of a "token" key is copied into the caller's buffer, and the
+ * first integer value of an "expires_in" key is kept as lifetime. Keys are matched at any depth,
+ * so both {"token": ...} and {"data": {"token": ...}} are accepted. A token value containing an
+ * escape sequence is rejected rather than decoded.
+ */
+class JsonTokenSink : public ResponseSink
+{
+public:
+    JsonTokenSink(char* token, size_t tokenSize);
+
+    void begin(int code, int contentLength) override;
+    bool write(const uint8_t* data, size_t length) override;
+
+    bool hasToken() const;
+    bool hasExpiresIn() const;
+    uint32_t getExpiresIn() const;
+
+    /**
+     * @brief Whether the token did not fit in the buffer or contained an escape sequence
+     */
+    bool hasError() const;
+
+private:
+    static const size_t KEY_MAX_LEN = 16;
+
+    enum Field
+    {
+        FIELD_NONE,
+        FIELD_TOKEN,
+        FIELD_EXPIRES_IN
+    };
+
+    bool consume(char c);
+    void endKey();
+    void endValue();
+
+    char* token;
+    size_t tokenSize;
+    size_t tokenLen;
+    bool tokenDone;
+
+    char key[KEY_MAX_LEN];
+    size_t keyLen;
+    bool keyOverflow;
+
+    Field field;
+    bool inString;
+    bool escaped;
+    bool expectValue;
+    bool capturingToken;
+    bool inNumber;
+
+    uint32_t expiresIn;
+    bool expiresDone;
+    bool error;
+};
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file retryPolicy.h
+ * @brief Retry, Backoff and Circuit Breaker Policy
+ *
+ * @details This file contains the declaration of the RetryPolicy and CircuitBreaker classes, which
+ * are shared by the tasks that talk to the backend. RetryPolicy computes exponential backoff delays
+ * with jitter and enforces a retry budget per message class. CircuitBreaker stops requests to a
+ * failing backend for a cool-down period so that data can be parked in the offline buffer instead.
+ *
+ * A RetryPolicy is only read once its budgets are set, so one can be used from several tasks. Its
+ * breaker is shared by the authentication and communication tasks and locks internally. Time and
+ * randomness are injected so the policy can be driven by a fake clock on the host.
+ */
+
+#ifndef RETRY_POLICY_H
+#define RETRY_POLICY_H
+
+#include <cstdint>
+#include <mutex>
+
+typedef uint32_t (*retry_clock_fn_t)();
+typedef uint32_t (*retry_random_fn_t)(uint32_t upperBound);
+
+/**
+ * @brief Traffic classes with separate retry budgets
+ */
+enum MessageClass
+{
+    MSG_CLASS_AUTH,
+    MSG_CLASS_TELEMETRY,
+    MSG_CLASS_QUEUE,
+    MSG_CLASS_COUNT
+};
+
+/**
+ * @brief Retry budget for one message class
+ */
+typedef struct
+{
+    uint8_t maxAttempts;  // total attempts including the first one
+    uint32_t baseDelayMs; // delay before the second attempt
+    uint32_t maxDelayMs;  // cap for the exponential growth
+} retry_budget_t;
+
+/**
+ * @brief Circuit breaker guarding a remote endpoint
+ *
+ * @details The breaker opens after a number of consecutive failures. While open, requests are
+ * rejected until the open timeout has elapsed, after which a single probe request is allowed
+ * (half-open). A successful probe closes the breaker, a failed probe opens it again.
+ */
+class CircuitBreaker
+{
+public:
+    enum State
+    {
+        STATE_CLOSED,
+        STATE_OPEN,
+        STATE_HALF_OPEN
+    };
+
+    CircuitBreaker(uint8_t failureThreshold, uint32_t openTimeoutMs, retry_clock_fn_t clock);
+
+    bool allowRequest();
+    void recordSuccess();
+    void recordFailure();
+    void cancelRequest();
+    void reset();
+
+    State getState() const;
+    uint8_t getConsecutiveFailures() const;
+    uint32_t getTripCount() const;
+
+private:
+    void trip();
+
+    mutable std::mutex lock;
+    retry_clock_fn_t clock;
+    uint8_t failureThreshold;
+    uint32_t openTimeoutMs;
+
+    State state;
+    uint8_t consecutiveFailures;
+    uint32_t openedAt;
+    uint32_t tripCount;
+    bool probeInFlight;
+};
+
+/**
+ * @brief Exponential backoff with jitter and per-class retry budgets
+ */
+class RetryPolicy
+{
+public:
+    RetryPolicy(retry_clock_fn_t clock = nullptr, retry_random_fn_t random = nullptr);
+
+    void setBudget(MessageClass cls, const retry_budget_t& budget);
+    const retry_budget_t& getBudget(MessageClass cls) const;
+
+    bool shouldRetry(MessageClass cls, uint8_t attempt) const;
+    uint32_t backoffDelay(MessageClass cls, uint8_t attempt) const;
+
+    static bool isRetryableStatus(int httpCode);
+    static bool isBackendFailure(int httpCode);
+
+    CircuitBreaker& breaker();
+    retry_clock_fn_t getClock() const;
+
+private:
+    retry_clock_fn_t clock;
+    retry_random_fn_t random;
+    retry_budget_t budgets[MSG_CLASS_COUNT];
+    CircuitBreaker backendBreaker;
+};
+
+#endif
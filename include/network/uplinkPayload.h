@@ -0,0 +1,23 @@
+/**
+ * @file uplinkPayload.h
+ * @brief Uplink Payload and Request Formatting
+ *
+ * @details This file contains the functions that format what the backend receives: the sensor JSON
+ * built by the processing task, the Authorization header of a send and the login document of the
+ * authentication request. They write into caller-provided buffers and the login document takes its
+ * memory from the allocator passed in, so formatting a send never touches the heap.
+ */
+
+#ifndef UPLINK_PAYLOAD_H
+#define UPLINK_PAYLOAD_H
+
+#include "SensorData.h"
+#include <ArduinoJson.h>
+#include <cstddef>
+
+bool createJson(const sensor_data_t& data, char* buffer, size_t bufferSize);
+bool createBearerHeader(const char* token, char* header, size_t headerSize);
+size_t createLoginPayload(ArduinoJson::Allocator* allocator, const char* username,
+    const char* password, char* buffer, size_t bufferSize);
+
+#endif
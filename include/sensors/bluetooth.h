@@ -1,19 +1,35 @@
 /**
  * @file bluetooth.h
  * @brief Bluetooth Client Class
- * 
- * @details This file contains the declaration of the BluetoothClient class, which is used to manage
- * 
+ *
+ * @details This file contains the declaration of the BluetoothClient class, a BLE central that
+ * connects to every heart rate strap on the STRAP_ADDRESSES whitelist, up to HR_MAX_STRAPS at a
+ * time. Each strap has its own connection state machine and a HeartRateBuffer that receives every
+ * notification, RR-intervals included; the Bluetooth task drains the buffers in batches.
+ *
+ * The whitelist is loaded into the controller's filter accept list, so the passive scan only
+ * reports straps, and a ScanPolicy sets the scan duty cycle and the connection transmit power.
+ * Each link negotiates the parameters of its ConnectionProfile: short intervals while it is set up
+ * or transfers in bulk, long ones with slave latency while heart rate streams.
+ *
  */
 
 #ifndef BLUETOOTH_H
 #define BLUETOOTH_H
 
+#include "sensors/connectionProfile.h"
+#include "sensors/heartRateBuffer.h"
+#include "sensors/scanPolicy.h"
+#include "utils/addressSet.h"
 #include <NimBLEDevice.h>
 
+#ifndef HR_MAX_STRAPS
+#define HR_MAX_STRAPS 3 // NimBLE's default connection limit
+#endif
+
 /**
  * @brief Class to handle Bluetooth client operations
- * 
+ *
  */
 class BluetoothClient : public NimBLEClientCallbacks
 {
@@ -33,48 +49,85 @@ public:
     void loop();
 
     uint8_t getHeartRate() const;
+    size_t getStrapCount() const;
+    bool isStrapConnected(size_t strap) const;
+    size_t readSamples(size_t strap, hr_sample_t* out, size_t max);
+    size_t getPendingSamples(size_t strap) const;
+    uint32_t getDroppedSamples(size_t strap) const;
+    scan_stats_t getScanStats() const;
+    int8_t getTxPower() const;
+    ble_radio_stats_t getRadioStats() const;
+
+    bool beginBulkTransfer(size_t strap);
+    void endBulkTransfer(size_t strap);
 
     void onConnect(NimBLEClient *pClient) override;
     void onDisconnect(NimBLEClient *pClient, int reason) override;
     void setConnectFlag(const NimBLEAdvertisedDevice *device);
 
 private:
-    void onHeartRateNotify(NimBLERemoteCharacteristic *, uint8_t *, size_t, bool);
-    void cleanupClient();
-    void checkWatchdog();
-    bool isConnected() const;
+    /**
+     * @brief Connection and notifications of one whitelisted strap
+     */
+    struct Strap
+    {
+        NimBLEAddress address;   // as advertised, with its type
+        bool seen = false;       // advertising, a connection can be attempted
+        NimBLEClient* pClient = nullptr;
+        ConnectionState state = STATE_SCANNING;
+        uint32_t stateStartTime = 0;
+        uint32_t lastConnectionAttempt = 0;
+        uint32_t lastHeartRateUpdate = 0;
+        uint32_t lostAt = 0;     // disconnected, if reconnecting
+        bool reconnecting = false;
+        int rssi = 0;            // smoothed dBm, 0 if not measured yet
+        ConnectionProfile link;
+        uint8_t connectionAttempts = 0;
+        uint16_t heartRate = 0;  // latest bpm
+        HeartRateBuffer samples;
+    };
+
+    Strap* findStrap(const NimBLEClient* client);
+    bool isBusy() const;
+    bool needsScan() const;
+
+    void onHeartRateNotify(Strap& strap, uint8_t *, size_t);
+    void cleanupClient(Strap& strap);
+    void checkWatchdog(Strap& strap);
+    bool isConnected(const Strap& strap) const;
     bool isScanning() const;
+    bool startScan();
     void restartScanning();
-    
-    void setConnectionState(ConnectionState newState);
-    void startConnectionAttempt();
-    void handleConnectionFailure();
-    void discoverServices();
-    void subscribeToCharacteristic(NimBLERemoteCharacteristic* characteristic);
-
-    uint8_t heartRate = 255;
-    bool doConnect = false;
-    NimBLEAddress targetDeviceAddress;
-    bool hasTargetDevice = false;
-    
-    NimBLEClient* pClient = nullptr;
-    
-    uint32_t lastHeartRateUpdate = 0;
-    uint32_t lastConnectionAttempt = 0;
-    uint8_t connectionAttempts = 0;
+    void tuneTxPower();
+    bool applyProfile(Strap& strap, ble_profile_t profile);
+    void updateLinks();
+
+    void setConnectionState(Strap& strap, ConnectionState newState);
+    void startConnectionAttempt(Strap& strap);
+    void handleConnectionFailure(Strap& strap);
+    void discoverServices(Strap& strap);
+    void subscribeToCharacteristic(Strap& strap, NimBLERemoteCharacteristic* characteristic);
+
+    AddressSet whitelist;
+    Strap straps[HR_MAX_STRAPS];
+    size_t strapCount = 0;
+    ScanPolicy scanPolicy;
+    scan_params_t scanParams = {};  // of the running scan
+    int8_t txPower = 0;             // connection transmit power, dBm
+    uint32_t lastRssiPoll = 0;
+    uint32_t startTime = 0;
 
     // configuration
     static const uint8_t MAX_CONNECTION_ATTEMPTS = 3;
     static const uint32_t CONNECTION_DELAY_MS = 3000;
+    static const uint32_t CONNECT_TIMEOUT_MS = 3000;  // the strap was advertising moments ago
     static const uint32_t HEARTRATE_TIMEOUT_MS = 30000;  // 30 seconds is enough
-    
-    ConnectionState connectionState = STATE_SCANNING;
-    uint32_t stateStartTime = 0;
+    static const uint32_t RSSI_POLL_MS = 5000;
 };
 
 /**
  * @brief Class to handle Bluetooth scan callbacks
- * 
+ *
  */
 class ScanCallbacks : public NimBLEScanCallbacks
 {
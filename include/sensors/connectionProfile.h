@@ -0,0 +1,82 @@
+/**
+ * @file connectionProfile.h
+ * @brief BLE Connection Profiles and Radio Time Accounting
+ *
+ * @details This file contains the ConnectionProfile class, which holds the connection parameters
+ * the Bluetooth client negotiates with a strap for what the link is doing, and estimates the
+ * radio-on time they cost.
+ *
+ * - Setup: short intervals, so connecting, discovery and subscription take few round trips.
+ * - Streaming: heart rate arrives about once a second, so the interval is long and the strap may
+ *   skip events with nothing to send (slave latency), on the 1M PHY for range.
+ * - Bulk: short intervals, no latency and the 2M PHY, for transfers such as strap logs.
+ *
+ * The radio-on time is integrated from the negotiated interval: every connection event costs
+ * BT_CONN_EVENT_US of transmit and receive, and bulk transfers are counted as keeping the radio
+ * busy throughout.
+ */
+
+#ifndef CONNECTION_PROFILE_H
+#define CONNECTION_PROFILE_H
+
+#include <cstdint>
+
+#define BLE_PHY_1M_MASK 0x01 // HCI PHY preference masks
+#define BLE_PHY_2M_MASK 0x02
+
+/**
+ * @brief What a link is used for
+ */
+typedef enum
+{
+    BLE_PROFILE_NONE,      // not connected
+    BLE_PROFILE_SETUP,
+    BLE_PROFILE_STREAMING,
+    BLE_PROFILE_BULK,
+} ble_profile_t;
+
+/**
+ * @brief Connection parameters, in the units of the HCI
+ */
+typedef struct
+{
+    uint16_t minInterval; // 1.25 ms
+    uint16_t maxInterval;
+    uint16_t latency;     // connection events the peripheral may skip
+    uint16_t timeout;     // supervision timeout, 10 ms
+    uint8_t phyMask;
+} ble_conn_params_t;
+
+/**
+ * @brief Radio-on time of the Bluetooth client
+ */
+typedef struct
+{
+    uint32_t scanMs;       // receiving while scanning
+    uint32_t connectionMs; // connection events, estimated
+    uint32_t onMsPerHour;  // both, averaged since begin
+} ble_radio_stats_t;
+
+class ConnectionProfile
+{
+public:
+    ConnectionProfile();
+
+    static const ble_conn_params_t& params(ble_profile_t profile);
+
+    void set(ble_profile_t profile, uint32_t now);
+    ble_profile_t get() const;
+    void onNegotiated(uint16_t interval, uint32_t now);
+    uint32_t getRadioOnMs(uint32_t now) const;
+
+private:
+    uint64_t radioOnUs(uint32_t now) const;
+    void integrate(uint32_t now);
+
+    ble_profile_t profile;
+    uint16_t interval; // negotiated, 1.25 ms, the profile's longest until known
+    uint32_t since;    // of the current profile and interval
+    uint64_t onUs;     // before since
+};
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * @file heartRateBuffer.h
+ * @brief Heart Rate Notification Ring Buffer
+ *
+ * @details This file contains the HeartRateBuffer class, which queues heart rate notifications for
+ * one strap between the BLE host task, which pushes every notification as it arrives, and the
+ * Bluetooth task, which drains them in batches. No beat or RR-interval is lost between two reads
+ * of the task.
+ *
+ * The queue is the lock-free single-producer/single-consumer TinyGsmFifo the modem UART uses. When
+ * it is full, new notifications are dropped and counted rather than overwriting ones the consumer
+ * may be reading.
+ */
+
+#ifndef HEART_RATE_BUFFER_H
+#define HEART_RATE_BUFFER_H
+
+#include "sensors/heartRateMeasurement.h"
+#include <TinyGsmFifo.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef HR_BUFFER_CAPACITY
+#define HR_BUFFER_CAPACITY 32 // notifications, about half a minute at one per second
+#endif
+
+/**
+ * @brief One heart rate notification
+ */
+typedef struct
+{
+    uint32_t time; // ms, when it arrived
+    hrm_measurement_t measurement;
+} hr_sample_t;
+
+class HeartRateBuffer
+{
+public:
+    HeartRateBuffer();
+
+    bool push(const hr_sample_t& sample);
+    size_t pop(hr_sample_t* out, size_t max);
+
+    size_t size() const;
+    uint32_t getDropped() const;
+
+private:
+    mutable TinyGsmFifo<hr_sample_t, HR_BUFFER_CAPACITY> samples; // size() only reads the indices
+    std::atomic<uint32_t> dropped;
+};
+
+#endif
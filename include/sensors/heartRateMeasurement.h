@@ -0,0 +1,39 @@
+/**
+ * @file heartRateMeasurement.h
+ * @brief Heart Rate Measurement Characteristic Parser
+ *
+ * @details This file contains the parser for the Bluetooth Heart Rate Measurement characteristic
+ * (0x2A37). A notification starts with a flags byte that says which fields follow:
+ *
+ * - bit 0: heart rate as uint16 instead of uint8
+ * - bits 1-2: sensor contact supported (bit 2) and detected (bit 1)
+ * - bit 3: energy expended, uint16 kJ, present
+ * - bit 4: one or more RR-intervals, uint16 in 1/1024 s, follow
+ *
+ * All fields are little-endian. The parser checks the length before every field, so a truncated
+ * or malformed notification is rejected instead of being read past its end.
+ */
+
+#ifndef HEART_RATE_MEASUREMENT_H
+#define HEART_RATE_MEASUREMENT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define HRM_MAX_RR 9 // RR-intervals that fit a notification at the default ATT MTU
+
+/**
+ * @brief Decoded notification
+ */
+typedef struct
+{
+    uint16_t bpm;
+    int8_t contact;          // 1 skin contact, 0 no contact, -1 not supported by the strap
+    int32_t energy;          // kJ since the strap's last reset, -1 if not sent
+    uint8_t rrCount;
+    uint16_t rr[HRM_MAX_RR]; // 1/1024 s, oldest first
+} hrm_measurement_t;
+
+bool parseHeartRateMeasurement(const uint8_t* data, size_t length, hrm_measurement_t& measurement);
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * @file hrvAnalyzer.h
+ * @brief Streaming Heart Rate Variability Analyzer
+ *
+ * @details This file contains the HrvAnalyzer class, which computes the time-domain HRV measures
+ * RMSSD, SDNN and pNN50 over a sliding window of the most recent HRV_WINDOW_MS of RR-intervals.
+ *
+ * Each interval updates integer running sums (of the intervals, their squares, the squared
+ * successive differences and the differences over 50 ms) when it enters the window and again when
+ * it leaves it, so a summary costs O(1) and the sums never drift. Intervals outside a physiological
+ * range or that jump by more than HRV_MAX_CHANGE_PCT from the previous one are rejected as
+ * artifacts (missed or ectopic beats), the first ones against the median of HRV_SEED_BEATS; a
+ * successive difference is never taken across a rejected interval or a gap in the notifications.
+ */
+
+#ifndef HRV_ANALYZER_H
+#define HRV_ANALYZER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define HRV_MAX_BEATS 256 // intervals kept, a one minute window at up to 256 BPM
+#define HRV_SEED_BEATS 5  // first intervals, their median is the first artifact reference
+
+/**
+ * @brief HRV over the current window
+ */
+typedef struct
+{
+    uint16_t beats;    // intervals in the window
+    uint16_t meanRr;   // ms
+    float rmssd;       // ms
+    float sdnn;        // ms
+    float pnn50;       // %
+} hrv_summary_t;
+
+class HrvAnalyzer
+{
+public:
+    HrvAnalyzer();
+
+    void reset();
+    bool addInterval(uint16_t rr);
+    void markGap();
+    bool getSummary(hrv_summary_t& summary) const;
+    uint32_t getRejected() const;
+
+private:
+    struct Beat
+    {
+        uint16_t rr;  // ms
+        int16_t diff; // ms from the previous interval, NO_DIFF after a gap
+    };
+    static const int16_t NO_DIFF = INT16_MIN;
+
+    bool accept(uint16_t rr);
+    bool reject();
+    void evictOldest();
+
+    Beat beats[HRV_MAX_BEATS];
+    size_t head;      // oldest interval
+    size_t count;
+    uint32_t sum;     // ms
+    uint64_t sumSquares;
+    uint64_t diffSquares;
+    uint32_t diffs;
+    uint32_t nn50;
+
+    uint16_t last;    // last accepted interval, 0 after a gap
+    uint16_t reference; // last accepted interval, kept across gaps for artifact rejection
+    uint16_t seed[HRV_SEED_BEATS]; // intervals held back until there is a reference
+    size_t seedCount;
+    uint8_t consecutiveRejects;
+    uint32_t rejected;
+};
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * @file scanPolicy.h
+ * @brief Low-Power BLE Scan and Transmit Power Policy
+ *
+ * @details This file contains the ScanPolicy class, which decides how hard the Bluetooth client
+ * scans for straps and how much power it transmits with once they are connected.
+ *
+ * Right after a strap is lost it is most likely still close and advertising fast, so the scan runs
+ * at a high duty cycle to reconnect quickly. The longer it stays missing the more likely it is off
+ * or out of range, and the duty cycle drops in steps to a sparse scan that still finds it within
+ * seconds of it coming back. The scan is passive and filtered by the controller, so scanning costs
+ * only receive time, which the policy accounts for to report the scan duty cycle.
+ *
+ * The connection transmit power follows the weakest connected strap's RSSI: every dB above
+ * BT_RSSI_TARGET_DBM is a dB the link does not need, in steps of BT_TX_STEP_DB and with hysteresis
+ * so it does not toggle on noise. While the fast scan runs after a loss the power stays at the
+ * maximum, so the reconnection does not fail on a link the other straps did not need.
+ */
+
+#ifndef SCAN_POLICY_H
+#define SCAN_POLICY_H
+
+#include <cstdint>
+
+/**
+ * @brief Scan interval and window, the scanner receives for window out of every interval
+ */
+typedef struct
+{
+    uint16_t intervalMs;
+    uint16_t windowMs;
+} scan_params_t;
+
+/**
+ * @brief Scan and reconnect counters
+ */
+typedef struct
+{
+    uint32_t scanTimeMs;      // scanner enabled
+    uint32_t receiveTimeMs;   // of which receiving, from the window and interval
+    float dutyPercent;        // receive time over the time since begin
+    uint32_t reconnects;
+    uint32_t lastReconnectMs; // strap lost to subscribed again
+    uint32_t avgReconnectMs;  // smoothed over reconnects
+    uint32_t maxReconnectMs;
+} scan_stats_t;
+
+class ScanPolicy
+{
+public:
+    ScanPolicy();
+
+    void begin(uint32_t now);
+    void onLost(uint32_t now);
+    void onReconnected(uint32_t downtimeMs);
+
+    scan_params_t params(uint32_t now) const;
+    bool isRecovering(uint32_t now) const;
+    void update(uint32_t now, bool scanning);
+
+    static int8_t tunePower(int8_t current, int rssi);
+    static int8_t maxPower();
+
+    scan_stats_t getStats(uint32_t now) const;
+
+private:
+    uint32_t startTime;
+    uint32_t lostSince;     // latest strap lost, starts the fast scan over
+    uint32_t lastUpdate;
+    bool wasScanning;
+    scan_params_t scanned;  // in force since lastUpdate
+    scan_stats_t stats;
+};
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * @file authTask.h
+ * @brief Authentication Task Header File
+ *
+ * @details This file contains the declaration of the authTask function and the token store it
+ * maintains. The task renews the backend JWT in the background, ahead of TOKEN_REFRESH_MARGIN_MS,
+ * so that the communication task never has to authenticate on the send path.
+ */
+
+#ifndef AUTHTASK_H
+#define AUTHTASK_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Copy the current token if one is ready
+ * @param token Output buffer for the JWT token
+ * @param tokenSize Size of the output buffer, at least AUTH_TOKEN_MAX_LEN
+ * @return true if a token was available and fit in the buffer, false otherwise
+ */
+bool getAuthToken(char* token, size_t tokenSize);
+
+/**
+ * @brief Check whether a token is ready for use
+ */
+bool isAuthTokenReady();
+
+/**
+ * @brief Drop the current token and wake the refresher
+ *
+ * @details Called when the backend rejects the token with 401.
+ */
+void invalidateAuthToken();
+
+/**
+ * @brief Wake the refresher without dropping the current token
+ */
+void requestAuthRefresh();
+
+/**
+ * @brief Authentication task function
+ *
+ * @details Waits for network, authenticates with the backend and sleeps until the token is due
+ * for renewal or a refresh is requested. Failed attempts are retried with backoff.
+ *
+ * @param pvParameters Task parameters (unused)
+ */
+void authTask(void* pvParameters);
+
+#endif
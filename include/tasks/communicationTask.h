@@ -10,106 +10,130 @@
 #ifndef COMMUNICATION_TASK_H
 #define COMMUNICATION_TASK_H
 
+#include "config.h"
+#include "network/responseSink.h"
+#include "network/uplinkPayload.h"
 #include <cstring>
 #include <Arduino.h>
 
+/**
+ * @brief Returned by sendDataWithAuth when no token is ready yet
+ */
+#define HTTP_CODE_AUTH_NOT_READY -100
+
+class WiFiClient;
+class WiFiClientSecure;
+
+/**
+ * @brief WiFi clients of one task
+ *
+ * @details Each client is constructed the first time a URL with its scheme is requested and kept
+ * for every request after that. The auth and communication tasks send concurrently, so each owns
+ * its own set.
+ */
+struct WiFiClients
+{
+  WiFiClientSecure* secure = nullptr;
+  WiFiClient* plain = nullptr;
+};
+
 /**
  * @brief HTTP response structure
  * 
- * @details Contains the response data from HTTP requests including status code,
- * response body, and success flag.
+ * @details Contains the status code and success flag of an HTTP request. The body is
+ * not kept; it is streamed into the ResponseSink passed with the request.
  */
 struct HttpResponse
 {
   int code;
-  String body;
   bool success;
 
   /**
    * @brief Default constructor
    */
   HttpResponse() : code(-1), success(false) {}
-  
+
   /**
    * @brief Constructor with response data
-   * @param c HTTP status code
-   * @param b Response body
+   * @param c HTTP status code, or a negative transport error
    */
-  HttpResponse(int c, const String& b) : code(c), body(b), success(c > 0) {}
+  explicit HttpResponse(int c) : code(c), success(c > 0) {}
 };
 
-/**
- * @brief Parse authentication response and extract JWT token
- * @param response JSON response string from authentication endpoint
- * @param token Output string to store the extracted JWT token
- * @return true if token was successfully extracted, false otherwise
- */
-bool parseAuthResponse(const String& response, String& token);
-
 /**
  * @brief Handle and log HTTP response
- * @param response HTTP response structure containing status and body
+ * @param response HTTP response structure containing the status code
  * @param context Description of the request context for logging
- * @param authType Type of authentication used for the request
  */
 void handleHttpResponse(const HttpResponse& response, const char* context);
 
 /**
  * @brief Perform HTTP request via WiFi
+ * @param clients The calling task's WiFi clients
  * @param url Target URL for the request
- * @param payload JSON payload to send
+ * @param payload Request body, JSON or its gzip-encoded form
+ * @param payloadLength Length of the request body
+ * @param sink Receives the response body in chunks, as far as it asks for it
  * @param authHeader Authorization header (Bearer token, etc.)
- * @return HttpResponse structure with status code and response body
+ * @param contentEncoding Content-Encoding header value, or nullptr for none
+ * @return HttpResponse structure with status code
  */
-HttpResponse performWiFiRequest(const char* url, const char* payload, const char* authHeader = "");
+HttpResponse performWiFiRequest(WiFiClients& clients, const char* url, const uint8_t* payload,
+    size_t payloadLength, ResponseSink& sink, const char* authHeader = "",
+    const char* contentEncoding = nullptr);
 
 /**
  * @brief Perform HTTP request via LTE
  * @param url Target URL for the request
- * @param payload JSON payload to send
+ * @param payload Request body, JSON or its gzip-encoded form
+ * @param payloadLength Length of the request body
+ * @param sink Receives the response body in chunks, as far as it asks for it
  * @param authHeader Authorization header (Bearer token, etc.)
- * @return HttpResponse structure with status code and response body
- */
-HttpResponse performLTERequest(const char* url, const char* payload, const char* authHeader = "");
-
-/**
- * @brief Create Bearer authorization header from JWT token
- * @param token JWT token string
- * @return Formatted Bearer authorization header string
+ * @param contentEncoding Content-Encoding header value, or nullptr for none
+ * @return HttpResponse structure with status code
  */
-String createBearerHeader(const String& token);
+HttpResponse performLTERequest(const char* url, const uint8_t* payload, size_t payloadLength,
+    ResponseSink& sink, const char* authHeader = "", const char* contentEncoding = nullptr);
 
 /**
  * @brief Send sensor data with automatic authentication
  * @param jsonPayload JSON string containing sensor data
+ * @return HTTP status code, a negative value on transport failure, or
+ * HTTP_CODE_AUTH_NOT_READY if no token has been issued yet
  * 
- * @details Automatically handles backend JWT authentication and token refresh.
- * Falls back to plain HTTP if authentication is disabled.
+ * @details Uses the token maintained by the authentication task and never authenticates
+ * inline. If no token is ready the refresher is woken and the caller should requeue the data.
  */
-void sendDataWithAuth(const char* jsonPayload);
+int sendDataWithAuth(const char* jsonPayload);
 
 /**
  * @brief Authenticate with backend server and retrieve JWT token
- * @param token Output string to store the retrieved JWT token
+ * @param token Output buffer to store the retrieved JWT token
+ * @param tokenSize Size of the token buffer
+ * @param lifetimeMs Output token lifetime in milliseconds
  * @return true if authentication successful, false otherwise
  * 
  * @details Sends login credentials to backend authentication endpoint and parses
- * the response to extract JWT token and expiry information. Supports multiple
- * response formats and retry logic on failure.
+ * the response to extract JWT token and expiry information while it streams in.
+ * Supports multiple response formats. The login payload is serialized once and reused. Retries follow the MSG_CLASS_AUTH budget of the shared retry policy
+ * and are skipped while the backend circuit breaker is open.
  */
-bool authenticateWithBackend(String& token);
+bool authenticateWithBackend(char* token, size_t tokenSize, uint32_t& lifetimeMs);
 
 /**
  * @brief Send JSON data with backend-issued JWT authentication
  * @param url Target URL for the request
  * @param jsonPayload JSON string containing data to send
  * @param token JWT token obtained from backend authentication
+ * @return HTTP status code, or a negative value on transport failure
  * 
  * @details Sends authenticated HTTP POST request using Bearer token in Authorization
- * header. Automatically selects WiFi or LTE based on availability and handles
- * authentication errors including token expiry.
+ * header. The transport is picked and pinned per request by Network::acquireUplink(). Only the status
+ * code is used, the body is not read (DEBUG builds keep its start for logging). With
+ * USE_PAYLOAD_COMPRESSION the payload is sent gzip-encoded when that makes it smaller. A 401 response
+ * invalidates the token and wakes the authentication task.
  */
-void sendJson(const char* url, const char* jsonPayload, const String& token);
+int sendJson(const char* url, const char* jsonPayload, const char* token);
 
 /**
  * @brief Main communication task function for FreeRTOS
@@ -120,6 +144,7 @@ void sendJson(const char* url, const char* jsonPayload, const String& token);
  * - Receives sensor data from queue
  * - Sends data with appropriate authentication method
  * - Handles network failures and authentication errors
+ * - Parks undeliverable data in the offline buffer and drains it on recovery
  * - Runs continuously with 2-second intervals
  */
 void communicationTask(void* pvParameters);
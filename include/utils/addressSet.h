@@ -0,0 +1,50 @@
+/**
+ * @file addressSet.h
+ * @brief Bluetooth Address Whitelist
+ *
+ * @details This file contains the AddressSet class, a small open-addressing hash set of 48-bit
+ * Bluetooth device addresses. The whitelist is parsed once from its "aa:bb:cc:dd:ee:ff" text form,
+ * after which a scan result is looked up by its numeric address with one multiply and usually one
+ * probe, without building or lowercasing strings.
+ *
+ * Each address keeps the position it was added at, so the set also maps an address to the index of
+ * the device's state kept elsewhere.
+ *
+ * The set is filled before scanning starts and only read afterwards, so lookups from the BLE host
+ * task need no lock.
+ */
+
+#ifndef ADDRESS_SET_H
+#define ADDRESS_SET_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef ADDRESS_SET_MAX
+#define ADDRESS_SET_MAX 4
+#endif
+
+class AddressSet
+{
+public:
+    AddressSet();
+
+    size_t parse(const char* list);
+    bool add(uint64_t address);
+    int indexOf(uint64_t address) const;
+    uint64_t get(size_t index) const;
+    size_t size() const;
+
+    static bool parseAddress(const char* text, size_t length, uint64_t& address);
+
+private:
+    static const size_t SLOTS = 2 * ADDRESS_SET_MAX; // at most half full, probes stay short
+
+    static size_t slotOf(uint64_t address);
+
+    uint64_t addresses[ADDRESS_SET_MAX]; // in the order they were added
+    int8_t slots[SLOTS];                 // index into addresses, -1 if empty
+    size_t count;
+};
+
+#endif
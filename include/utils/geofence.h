@@ -0,0 +1,86 @@
+/**
+ * @file geofence.h
+ * @brief Polygon Geofences
+ *
+ * @details This file contains the GeofenceSet class, which tells whether a position is inside each
+ * of a few polygons and reports when that changes. Polygons are given as latitude/longitude
+ * vertices and kept as fixed-point integers of 1e-5 degree, the test is an even-odd ray cast in
+ * 64-bit integer arithmetic. A transition is only reported after GEOFENCE_CONFIRM_FIXES fixes in a
+ * row agree, so a position jittering across an edge does not flap.
+ *
+ * The fences from GEOFENCE_LIST (secrets.h) are added once when the GPS task starts, and the task
+ * evaluates every reported fix itself, so the set takes no lock.
+ */
+
+#ifndef GEOFENCE_H
+#define GEOFENCE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef GEOFENCE_MAX_FENCES
+#define GEOFENCE_MAX_FENCES 4
+#endif
+#ifndef GEOFENCE_MAX_VERTICES
+#define GEOFENCE_MAX_VERTICES 8
+#endif
+
+/**
+ * @brief Polygon vertex in degrees
+ */
+typedef struct
+{
+    float latitude;
+    float longitude;
+} geofence_vertex_t;
+
+/**
+ * @brief Polygon as configured
+ */
+typedef struct
+{
+    const char* name;
+    uint8_t count;
+    geofence_vertex_t vertices[GEOFENCE_MAX_VERTICES];
+} geofence_t;
+
+/**
+ * @brief A confirmed change of side
+ */
+typedef struct
+{
+    uint8_t fence;
+    const char* name;
+    bool inside;
+} geofence_event_t;
+
+class GeofenceSet
+{
+public:
+    GeofenceSet();
+
+    bool add(const geofence_t& fence);
+    size_t size() const;
+
+    bool update(int32_t latitude, int32_t longitude, geofence_event_t& event);
+    bool isInside(uint8_t fence) const;
+
+    static bool contains(const int32_t* vertices, uint8_t count, int32_t latitude,
+        int32_t longitude);
+
+private:
+    typedef struct
+    {
+        const char* name;
+        uint8_t count;
+        int32_t vertices[GEOFENCE_MAX_VERTICES * 2]; // latitude, longitude pairs, 1e-5 degree
+        bool known;     // a fix has been evaluated
+        bool inside;    // confirmed side
+        uint8_t streak; // fixes in a row on the other side
+    } fence_state_t;
+
+    fence_state_t fences[GEOFENCE_MAX_FENCES];
+    size_t count;
+};
+
+#endif
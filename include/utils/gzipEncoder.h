@@ -0,0 +1,63 @@
+/**
+ * @file gzipEncoder.h
+ * @brief Small Gzip Encoder for Uplink Payloads
+ *
+ * @details This file contains the GzipEncoder class, which compresses a payload into a gzip stream
+ * (RFC 1952) so it can be sent with "Content-Encoding: gzip". It uses greedy LZ77 matching with a
+ * single hash table and one fixed-Huffman deflate block. That gives up some ratio compared to zlib,
+ * but the encoder needs only GZIP_HASH_SIZE * 2 bytes of state and no heap.
+ *
+ * Telemetry JSON repeats the same keys and number formats, which is what the matcher picks up.
+ */
+
+#ifndef GZIP_ENCODER_H
+#define GZIP_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef GZIP_HASH_BITS
+#define GZIP_HASH_BITS 10
+#endif
+
+#define GZIP_HASH_SIZE (1 << GZIP_HASH_BITS)
+#define GZIP_OVERHEAD 18 // header and trailer bytes around the deflate data
+#define GZIP_MAX_INPUT 65535 // hash table positions are 16 bits
+
+class GzipEncoder
+{
+public:
+    GzipEncoder();
+
+    /**
+     * @brief Compress a payload into a gzip stream
+     * @param input Data to compress
+     * @param length Length of the input, at most GZIP_MAX_INPUT bytes
+     * @param output Buffer for the gzip stream
+     * @param outputSize Size of the output buffer
+     * @return Length of the gzip stream, or 0 if the input is longer than GZIP_MAX_INPUT or the
+     * stream did not fit in the output buffer. Callers send the payload uncompressed then.
+     */
+    size_t compress(const uint8_t* input, size_t length, uint8_t* output, size_t outputSize);
+
+private:
+    void putBits(uint32_t value, uint8_t count);
+    void putCode(uint16_t code, uint8_t count);
+    void putByte(uint8_t value);
+    void putLiteral(uint8_t value);
+    void putMatch(uint16_t length, uint16_t distance);
+    void flushBits();
+
+    static uint32_t crc32(const uint8_t* data, size_t length);
+
+    uint16_t head[GZIP_HASH_SIZE]; // last position + 1 per hash, 0 if empty
+
+    uint8_t* out;
+    size_t outSize;
+    size_t outPos;
+    uint32_t bitBuffer;
+    uint8_t bitCount;
+    bool overflow;
+};
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ * @file jsonArena.h
+ * @brief Fixed Arena Allocator for ArduinoJson
+ *
+ * @details This file contains the JsonArena class, a bump allocator over a fixed buffer that plugs
+ * into ArduinoJson's Allocator interface. Documents created with it never touch the heap. The arena
+ * is released in one step with reset() once every document using it has gone out of scope.
+ *
+ * Only the most recent allocation can grow or shrink in place, which matches how ArduinoJson grows
+ * its string buffer and shrinks its pool after deserialization.
+ */
+
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <ArduinoJson.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+template <size_t N>
+class JsonArena : public ArduinoJson::Allocator
+{
+public:
+    JsonArena() : used(0), last(nullptr), highWater(0), failures(0) {}
+
+    void* allocate(size_t size) override
+    {
+        size_t total = align(HEADER_SIZE + size);
+        if (total > N - used)
+        {
+            failures++;
+            return nullptr;
+        }
+
+        uint8_t* block = buffer + used;
+        memcpy(block, &size, sizeof(size_t));
+        used += total;
+        last = block;
+        if (used > highWater)
+        {
+            highWater = used;
+        }
+        return block + HEADER_SIZE;
+    }
+
+    void deallocate(void* ptr) override
+    {
+        uint8_t* block = header(ptr);
+        if (block && block == last)
+        {
+            used = block - buffer;
+            last = nullptr;
+        }
+    }
+
+    void* reallocate(void* ptr, size_t newSize) override
+    {
+        if (!ptr)
+        {
+            return allocate(newSize);
+        }
+
+        uint8_t* block = header(ptr);
+        if (block == last)
+        {
+            size_t offset = block - buffer;
+            size_t total = align(HEADER_SIZE + newSize);
+            if (total > N - offset)
+            {
+                failures++;
+                return nullptr;
+            }
+            memcpy(block, &newSize, sizeof(size_t));
+            used = offset + total;
+            if (used > highWater)
+            {
+                highWater = used;
+            }
+            return ptr;
+        }
+
+        size_t oldSize;
+        memcpy(&oldSize, block, sizeof(size_t));
+        void* moved = allocate(newSize);
+        if (moved)
+        {
+            memcpy(moved, ptr, oldSize < newSize ? oldSize : newSize);
+        }
+        return moved;
+    }
+
+    /**
+     * @brief Release every allocation at once
+     */
+    void reset()
+    {
+        used = 0;
+        last = nullptr;
+    }
+
+    size_t getUsed() const
+    {
+        return used;
+    }
+
+    size_t getHighWater() const
+    {
+        return highWater;
+    }
+
+    uint32_t getFailures() const
+    {
+        return failures;
+    }
+
+private:
+    static const size_t ALIGNMENT = alignof(std::max_align_t);
+    static const size_t HEADER_SIZE = (sizeof(size_t) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    static size_t align(size_t size)
+    {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    uint8_t* header(void* ptr)
+    {
+        return ptr ? static_cast<uint8_t*>(ptr) - HEADER_SIZE : nullptr;
+    }
+
+    alignas(std::max_align_t) uint8_t buffer[N];
+    size_t used;
+    uint8_t* last;
+    size_t highWater;
+    uint32_t failures;
+};
+
+#endif
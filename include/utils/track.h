@@ -0,0 +1,72 @@
+/**
+ * @file track.h
+ * @brief GPS Track Simplification and Delta Encoding
+ *
+ * @details This file contains the TrackBuffer class, which keeps only the fixes that carry
+ * information and encodes them compactly for the uplink.
+ *
+ * Simplification is online dead reckoning: the position is predicted from the last kept fix and
+ * the velocity between the last two kept fixes, and a fix is only kept when it is more than
+ * TRACK_TOLERANCE_M away from that prediction. Walking in a straight line or standing still keeps
+ * almost nothing, turns and speed changes are kept.
+ *
+ * Coordinates are stored as fixed-point integers of 1e-5 degree (about 1.1 m). drain() writes kept
+ * fixes in the encoded polyline format with a third value per point: latitude, longitude and age in
+ * seconds, each as the zigzag varint of its difference to the previous point, in printable ASCII
+ * (the first point is relative to zero). Summing the values gives the absolute fixed-point numbers.
+ *
+ * The GPS task adds every reported fix and drains the buffer into a sensor message after
+ * TRACK_FLUSH_POINTS kept fixes, after TRACK_FLUSH_MS, or when the engine stops. Nothing else
+ * touches it, so it takes no lock.
+ */
+
+#ifndef TRACK_H
+#define TRACK_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef TRACK_MAX_POINTS
+#define TRACK_MAX_POINTS 32
+#endif
+
+#define TRACK_SCALE 100000 // fixed-point units per degree
+
+/**
+ * @brief One kept fix
+ */
+typedef struct
+{
+    int32_t latitude;  // 1e-5 degree
+    int32_t longitude; // 1e-5 degree
+    uint32_t time;     // ms
+} track_point_t;
+
+class TrackBuffer
+{
+public:
+    TrackBuffer();
+
+    bool add(float latitude, float longitude, uint32_t now);
+    size_t drain(char* out, size_t outSize, uint32_t now);
+    void clear();
+
+    size_t size() const;
+    uint32_t getDroppedCount() const;
+
+    static int32_t toFixed(float degrees);
+    static float deviationMeters(const track_point_t& a, const track_point_t& b);
+
+private:
+    bool predict(uint32_t time, track_point_t& predicted) const;
+    static size_t encodeValue(int32_t value, char* out, size_t outSize);
+
+    track_point_t points[TRACK_MAX_POINTS]; // ring of kept fixes waiting for the uplink
+    size_t head;
+    size_t count;
+    track_point_t last[2];                  // last two kept fixes, newest first
+    uint8_t kept;                           // valid entries in last
+    uint32_t dropped;                       // kept fixes overwritten before the uplink
+};
+
+#endif
@@ -27,10 +27,37 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <ctype.h>
 #include <stdlib.h>
 
-#define _GPRMCterm   "GPRMC"
-#define _GPGGAterm   "GPGGA"
-#define _GNRMCterm   "GNRMC"
-#define _GNGGAterm   "GNGGA"
+// Sentence ids are matched as a GP/GN talker plus the three type letters packed into an integer
+#define _SENTENCE(a, b, c) (((uint32_t)(uint8_t)(a) << 16) | ((uint32_t)(uint8_t)(b) << 8) | (uint8_t)(c))
+#define _RMCsentence _SENTENCE('R', 'M', 'C')
+#define _GGAsentence _SENTENCE('G', 'G', 'A')
+
+// Every character that ends a term or starts a sentence sorts at or below ','
+static inline bool isSpecialChar(char c)
+{
+  return (uint8_t)c <= ',' && (c == ',' || c == '\r' || c == '\n' || c == '*' || c == '$');
+}
+
+// atol() for the plain digit strings NMEA fields hold. Anything else (empty, signs, white space,
+// more than 9 digits) returns false so the caller can fall back to atol() and get exactly its
+// result. On success term points past the digits.
+static inline bool parseDigits(const char *&term, uint32_t &value)
+{
+  const char *p = term;
+  uint32_t v = 0;
+  int n = 0;
+  while ((uint8_t)(*p - '0') <= 9)
+  {
+    if (++n > 9)
+      return false;
+    v = 10 * v + (uint32_t)(*p++ - '0');
+  }
+  if (n == 0)
+    return false;
+  value = v;
+  term = p;
+  return true;
+}
 
 TinyGPSPlus::TinyGPSPlus()
   :  parity(0)
@@ -57,6 +84,58 @@ bool TinyGPSPlus::encode(char c)
 {
   ++encodedCharCount;
 
+  if (isSpecialChar(c))
+    return specialChar(c);
+
+  // ordinary characters
+  if (curTermOffset < sizeof(term) - 1)
+    term[curTermOffset++] = c;
+  if (!isChecksumTerm)
+    parity ^= c;
+  return false;
+}
+
+// Same as calling encode(char) for every character, returns the number of valid sentences
+size_t TinyGPSPlus::encode(const char *buf, size_t len)
+{
+  size_t sentences = 0;
+  encodedCharCount += len;
+
+  // Kept in locals while copying a term: stores into term are char stores, which may alias the
+  // members and would otherwise force them to be reloaded for every character
+  uint8_t p = parity;
+  uint8_t offset = curTermOffset;
+  bool checksumTerm = isChecksumTerm;
+
+  for (size_t i = 0; i < len; ++i)
+  {
+    char c = buf[i];
+    if (!isSpecialChar(c))
+    {
+      if (offset < sizeof(term) - 1)
+        term[offset++] = c;
+      if (!checksumTerm)
+        p ^= c;
+      continue;
+    }
+
+    parity = p;
+    curTermOffset = offset;
+    if (specialChar(c))
+      ++sentences;
+    p = parity;
+    offset = curTermOffset;
+    checksumTerm = isChecksumTerm;
+  }
+
+  parity = p;
+  curTermOffset = offset;
+  return sentences;
+}
+
+// Term terminators and the sentence start
+bool TinyGPSPlus::specialChar(char c)
+{
   switch(c)
   {
   case ',': // term terminators
@@ -76,25 +155,15 @@ bool TinyGPSPlus::encode(char c)
       isChecksumTerm = c == '*';
       return isValidSentence;
     }
-    break;
 
-  case '$': // sentence begin
+  default: // '$', sentence begin
     curTermNumber = curTermOffset = 0;
     parity = 0;
     curSentenceType = GPS_SENTENCE_OTHER;
     isChecksumTerm = false;
     sentenceHasFix = false;
     return false;
-
-  default: // ordinary characters
-    if (curTermOffset < sizeof(term) - 1)
-      term[curTermOffset++] = c;
-    if (!isChecksumTerm)
-      parity ^= c;
-    return false;
   }
-
-  return false;
 }
 
 //
@@ -116,8 +185,15 @@ int32_t TinyGPSPlus::parseDecimal(const char *term)
 {
   bool negative = *term == '-';
   if (negative) ++term;
-  int32_t ret = 100 * (int32_t)atol(term);
-  while (isdigit(*term)) ++term;
+  uint32_t digits;
+  int32_t ret;
+  if (parseDigits(term, digits))
+    ret = 100 * (int32_t)digits;
+  else
+  {
+    ret = 100 * (int32_t)atol(term);
+    while (isdigit(*term)) ++term;
+  }
   if (*term == '.' && isdigit(term[1]))
   {
     ret += 10 * (term[1] - '0');
@@ -131,16 +207,19 @@ int32_t TinyGPSPlus::parseDecimal(const char *term)
 // Parse degrees in that funny NMEA format DDMM.MMMM
 void TinyGPSPlus::parseDegrees(const char *term, RawDegrees &deg)
 {
-  uint32_t leftOfDecimal = (uint32_t)atol(term);
+  uint32_t leftOfDecimal;
+  if (!parseDigits(term, leftOfDecimal))
+  {
+    leftOfDecimal = (uint32_t)atol(term);
+    while (isdigit(*term))
+      ++term;
+  }
   uint16_t minutes = (uint16_t)(leftOfDecimal % 100);
   uint32_t multiplier = 10000000UL;
   uint32_t tenMillionthsOfMinutes = minutes * multiplier;
 
   deg.deg = (int16_t)(leftOfDecimal / 100);
 
-  while (isdigit(*term))
-    ++term;
-
   if (*term == '.')
     while (isdigit(*++term))
     {
@@ -209,12 +288,17 @@ bool TinyGPSPlus::endOfTermHandler()
   // the first term determines the sentence type
   if (curTermNumber == 0)
   {
-    if (!strcmp(term, _GPRMCterm) || !strcmp(term, _GNRMCterm))
-      curSentenceType = GPS_SENTENCE_GPRMC;
-    else if (!strcmp(term, _GPGGAterm) || !strcmp(term, _GNGGAterm))
-      curSentenceType = GPS_SENTENCE_GPGGA;
-    else
-      curSentenceType = GPS_SENTENCE_OTHER;
+    curSentenceType = GPS_SENTENCE_OTHER;
+    if (curTermOffset == 5 && term[0] == 'G' && (term[1] == 'P' || term[1] == 'N'))
+      switch (_SENTENCE(term[2], term[3], term[4]))
+      {
+      case _RMCsentence:
+        curSentenceType = GPS_SENTENCE_GPRMC;
+        break;
+      case _GGAsentence:
+        curSentenceType = GPS_SENTENCE_GPGGA;
+        break;
+      }
 
     // Any custom candidates of this sentence type?
     for (customCandidates = customElts; customCandidates != NULL && strcmp(customCandidates->sentenceName, term) < 0; customCandidates = customCandidates->next);
@@ -387,7 +471,8 @@ void TinyGPSTime::setTime(const char *term)
 
 void TinyGPSDate::setDate(const char *term)
 {
-   newDate = atol(term);
+   if (!parseDigits(term, newDate))
+      newDate = atol(term);
 }
 
 uint16_t TinyGPSDate::year()
@@ -454,7 +539,8 @@ void TinyGPSInteger::commit()
 
 void TinyGPSInteger::set(const char *term)
 {
-   newval = atol(term);
+   if (!parseDigits(term, newval))
+      newval = atol(term);
 }
 
 TinyGPSCustom::TinyGPSCustom(TinyGPSPlus &gps, const char *_sentenceName, int _termNumber)
@@ -26,8 +26,23 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #if defined(ARDUINO) && ARDUINO >= 100
 #include "Arduino.h"
-#else
+#elif defined(ARDUINO)
 #include "WProgram.h"
+#else
+// Host builds (the native tests) provide millis() themselves
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+typedef uint8_t byte;
+unsigned long millis();
+#ifndef TWO_PI
+#define TWO_PI 6.283185307179586476925286766559
+#endif
+#ifndef radians
+#define radians(deg) ((deg) * 0.017453292519943295769236907684886)
+#define degrees(rad) ((rad) * 57.295779513082320876798154814105)
+#define sq(x) ((x) * (x))
+#endif
 #endif
 #include <limits.h>
 
@@ -221,6 +236,7 @@ class TinyGPSPlus
 public:
   TinyGPSPlus();
   bool encode(char c); // process one character received from GPS
+  size_t encode(const char *buf, size_t len); // process a buffer, returns the number of valid sentences
   TinyGPSPlus &operator << (char c) {encode(c); return *this;}
 
   TinyGPSLocation location;
@@ -272,6 +288,7 @@ private:
 
   // internal utilities
   int fromHex(char a);
+  bool specialChar(char c);
   bool endOfTermHandler();
 };
 
@@ -356,9 +356,9 @@ class TinyGsmA7670 :  public TinyGsmA76xx<TinyGsmA7670>,
     //  ^^ Requested number of data bytes (1-1460 bytes)to be read
     int16_t len_confirmed = streamGetIntBefore('\n');
     // ^^ The data length which not read in the buffer
+#ifdef TINY_GSM_USE_HEX
     for (int i = 0; i < len_requested; i++) {
       uint32_t startMillis = millis();
-#ifdef TINY_GSM_USE_HEX
       while (stream.available() < 2 &&
              (millis() - startMillis < sockets[mux]->_timeout)) {
         TINY_GSM_YIELD();
@@ -369,15 +369,27 @@ class TinyGsmA7670 :  public TinyGsmA76xx<TinyGsmA7670>,
       buf[0] = stream.read();
       buf[1] = stream.read();
       char c = strtol(buf, NULL, 16);
+      sockets[mux]->rx.put(c);
+    }
 #else
-      while (!stream.available() &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
+    // Read straight into the socket fifo, one contiguous span at a time
+    uint8_t discard[16];
+    size_t  remaining = len_requested > 0 ? len_requested : 0;
+    while (remaining > 0) {
+      uint8_t* span;
+      size_t   room = sockets[mux]->rx.writeSpan(&span);
+      if (room == 0) {
+        // Fifo full: the data is lost, as with put(), but must still be read
+        span = discard;
+        room = sizeof(discard);
       }
-      char c = stream.read();
-#endif
-      sockets[mux]->rx.put(c);
+      size_t chunk = TinyGsmMin(room, remaining);
+      size_t n     = stream.readBytes(span, chunk);
+      if (span != discard) { sockets[mux]->rx.commit(n); }
+      remaining -= n;
+      if (n < chunk) break;  // timed out
     }
+#endif
     // DBG("### READ:", len_requested, "from", mux);
     // sockets[mux]->sock_available = modemGetAvailable(mux);
     sockets[mux]->sock_available = len_confirmed;
@@ -420,7 +432,6 @@ class TinyGsmA7670 :  public TinyGsmA76xx<TinyGsmA7670>,
    * Utilities
    */
  public:
-  // TODO(vshymanskyy): Optimize this!
   int8_t waitResponse(uint32_t timeout_ms, String& data,
                       GsmConstStr r1 = GFP(GSM_OK),
                       GsmConstStr r2 = GFP(GSM_ERROR),
@@ -431,13 +442,51 @@ class TinyGsmA7670 :  public TinyGsmA76xx<TinyGsmA7670>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    /*String r1s(r1); r1s.trim();
-    String r2s(r2); r2s.trim();
-    String r3s(r3); r3s.trim();
-    String r4s(r4); r4s.trim();
-    String r5s(r5); r5s.trim();
-    DBG("### ..:", r1s, ",", r2s, ",", r3s, ",", r4s, ",", r5s);*/
     data.reserve(64);
+    return waitResponseImpl(timeout_ms, &data, r1, r2, r3, r4, r5);
+  }
+
+  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
+                      GsmConstStr r2 = GFP(GSM_ERROR),
+#if defined TINY_GSM_DEBUG
+                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
+                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
+#else
+                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
+#endif
+                      GsmConstStr r5 = NULL) {
+    return waitResponseImpl(timeout_ms, NULL, r1, r2, r3, r4, r5);
+  }
+
+  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
+                      GsmConstStr r2 = GFP(GSM_ERROR),
+#if defined TINY_GSM_DEBUG
+                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
+                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
+#else
+                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
+#endif
+                      GsmConstStr r5 = NULL) {
+    return waitResponse(1000, r1, r2, r3, r4, r5);
+  }
+
+ protected:
+  // Matches the response with a fixed-size TinyGsmResponseMatcher instead of
+  // growing a String and calling endsWith() for every pattern on every byte.
+  // The response text is only collected when the caller asked for it.
+  int8_t waitResponseImpl(uint32_t timeout_ms, String* data, GsmConstStr r1,
+                          GsmConstStr r2, GsmConstStr r3, GsmConstStr r4,
+                          GsmConstStr r5) {
+    TinyGsmResponseMatcher matcher;
+    // Expected responses first, so they win over a URC ending on the same byte
+    const int8_t expected[5] = {matcher.add(r1), matcher.add(r2),
+                                matcher.add(r3), matcher.add(r4),
+                                matcher.add(r5)};
+    const int8_t ciprxget = matcher.add(GF(GSM_NL "+CIPRXGET:"));
+    const int8_t receive  = matcher.add(GF(GSM_NL "+RECEIVE:"));
+    const int8_t ipclose  = matcher.add(GF("+IPCLOSE:"));
+    const int8_t cipevent = matcher.add(GF("+CIPEVENT:"));
+
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
@@ -447,102 +496,84 @@ class TinyGsmA7670 :  public TinyGsmA76xx<TinyGsmA7670>,
         int8_t a = stream.read();
         // putchar(a);
         if (a <= 0) continue;  // Skip 0x00 bytes, just in case
-        data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
-          index = 1;
-          goto finish;
-        } else if (r2 && data.endsWith(r2)) {
-          index = 2;
-          goto finish;
-        } else if (r3 && data.endsWith(r3)) {
+        if (data) { *data += static_cast<char>(a); }
+        int8_t hit = matcher.push(static_cast<char>(a));
+        if (hit < 0) {
+          if (this->handleStatusUrc(matcher)) {
+            matcher.clear();
+            if (data) { *data = ""; }
+          }
+          continue;
+        }
+        for (uint8_t i = 0; i < 5; i++) {
+          if (hit == expected[i]) { index = i + 1; }
+        }
+        if (index) {
 #if defined TINY_GSM_DEBUG
-          if (r3 == GFP(GSM_CME_ERROR)) {
+          if (index == 3 && r3 == GFP(GSM_CME_ERROR)) {
             streamSkipUntil('\n');  // Read out the error
           }
 #endif
-          index = 3;
-          goto finish;
-        } else if (r4 && data.endsWith(r4)) {
-          index = 4;
           goto finish;
-        } else if (r5 && data.endsWith(r5)) {
-          index = 5;
-          goto finish;
-        } else if (data.endsWith(GF(GSM_NL "+CIPRXGET:"))) {
+        } else if (hit == ciprxget) {
           int8_t mode = streamGetIntBefore(',');
           if (mode == 1) {
             int8_t mux = streamGetIntBefore('\n');
             if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
               sockets[mux]->got_data = true;
             }
-            data = "";
+            matcher.clear();
+            if (data) { *data = ""; }
             // DBG("### Got Data:", mux);
-          } else {
-            data += mode;
+          } else if (data) {
+            *data += mode;
           }
-        } else if (data.endsWith(GF(GSM_NL "+RECEIVE:"))) {
+        } else if (hit == receive) {
           int8_t  mux = streamGetIntBefore(',');
           int16_t len = streamGetIntBefore('\n');
           if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
             sockets[mux]->got_data = true;
             if (len >= 0 && len <= 1024) { sockets[mux]->sock_available = len; }
           }
-          data = "";
+          matcher.clear();
+          if (data) { *data = ""; }
           // DBG("### Got Data:", len, "on", mux);
-        } else if (data.endsWith(GF("+IPCLOSE:"))) {
+        } else if (hit == ipclose) {
           int8_t mux = streamGetIntBefore(',');
           streamSkipUntil('\n');  // Skip the reason code
           if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
             sockets[mux]->sock_connected = false;
           }
-          data = "";
+          matcher.clear();
+          if (data) { *data = ""; }
           DBG("### Closed: ", mux);
-        } else if (data.endsWith(GF("+CIPEVENT:"))) {
+        } else if (hit == cipevent) {
           // Need to close all open sockets and release the network library.
           // User will then need to reconnect.
           DBG("### Network error!");
           if (!isGprsConnected()) { gprsDisconnect(); }
-          data = "";
+          matcher.clear();
+          if (data) { *data = ""; }
         }
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
     if (!index) {
-      data.trim();
-      if (data.length()) { DBG("### Unhandled:", data); }
-      data = "";
+#if defined TINY_GSM_DEBUG
+      char unhandled[TinyGsmResponseMatcher::TAIL_SIZE + 1];
+      if (matcher.copyTail(unhandled, sizeof(unhandled))) {
+        String text(unhandled);
+        text.trim();
+        if (text.length()) { DBG("### Unhandled:", text); }
+      }
+#endif
+      if (data) { *data = ""; }
     }
     // data.replace(GSM_NL, "/");
     // DBG('<', index, '>', data);
     return index;
   }
 
-  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
-  }
-
-  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    return waitResponse(1000, r1, r2, r3, r4, r5);
-  }
-
-
  protected:
   GsmClientA7670* sockets[TINY_GSM_MUX_COUNT];
 };
@@ -409,20 +409,15 @@ class TinyGsmA76xx : public TinyGsmModem<TinyGsmA76xx<modemType>>,
     return thisModem().waitResponse(1000L) == 1;
   }
 
+  // The output port (AT+CGNSSPORTSWITCH) is left to the caller, "0,1" would
+  // put the sentences on the AT UART between command responses
   bool enableNMEAImpl() {
     thisModem().sendAT("+CGNSSTST=1");
-    if (thisModem().waitResponse(1000L) != 1) { return false; }
-    // Select the output port for NMEA sentence
-    thisModem().sendAT("+CGNSSPORTSWITCH=0,1");
-    if (thisModem().waitResponse(1000L) != 1) { return false; }
-    return true;
+    return thisModem().waitResponse(1000L) == 1;
   }
 
   bool disableNMEAImpl() {
     thisModem().sendAT("+CGNSSTST=0");
-    thisModem().waitResponse(1000L);
-    // Select the output port for NMEA sentence
-    thisModem().sendAT("+CGNSSPORTSWITCH=1,0");
     return thisModem().waitResponse(1000L) == 1;
   }
 
@@ -1,10 +1,45 @@
 #ifndef TinyGsmFifo_h
 #define TinyGsmFifo_h
 
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if !defined(__AVR__)
+#include <atomic>
+#define TINY_GSM_FIFO_ATOMIC
+#endif
+
+#ifndef TINY_GSM_FIFO_YIELD
+#if defined(ARDUINO)
+#define TINY_GSM_FIFO_YIELD() yield()
+#else
+#include <thread>
+#define TINY_GSM_FIFO_YIELD() std::this_thread::yield()
+#endif
+#endif
+
+static constexpr size_t tinyGsmFifoRoundUp(size_t v, size_t p = 1)
+{
+    return p >= v ? p : tinyGsmFifoRoundUp(v, p << 1);
+}
+
+// Single-producer/single-consumer ring buffer.
+//
+// One context may write and one other context may read at the same time
+// without a lock, e.g. a UART ISR and a task, or two tasks. The indices run
+// freely and are masked with a power-of-two capacity (N rounded up), so
+// size() is a subtraction and all CAPACITY slots can be used. Each side keeps
+// a cached copy of the other side's index and only reloads it when the
+// cached value says the ring is full or empty.
+//
+// clear() is the exception, it must not race with either side.
 template <class T, unsigned N>
 class TinyGsmFifo
 {
 public:
+    static constexpr size_t CAPACITY = tinyGsmFifoRoundUp(N);
+
     TinyGsmFifo()
     {
         clear();
@@ -12,8 +47,10 @@ public:
 
     void clear()
     {
-        _r = 0;
-        _w = 0;
+        _storeW(0);
+        _storeR(0);
+        _rCache = 0;
+        _wCache = 0;
     }
 
     // writing thread/context API
@@ -26,47 +63,70 @@ public:
 
     int free(void)
     {
-        int s = _r - _w;
-        if (s <= 0)
-            s += N;
-        return s - 1;
+        return static_cast<int>(CAPACITY - (_loadW() - _loadR()));
     }
 
     bool put(const T& c)
     {
-        int i = _w;
-        int j = i;
-        i = _inc(i);
-        if (i == _r) // !writeable()
-            return false;
-        _b[j] = c;
-        _w = i;
+        size_t w = _ownW();
+        if (w - _rCache == CAPACITY)
+        {
+            _rCache = _loadR();
+            if (w - _rCache == CAPACITY) // !writeable()
+                return false;
+        }
+        _b[w & MASK] = c;
+        _storeW(w + 1);
         return true;
     }
 
+    // Contiguous free space at the write position, fill it and then commit()
+    size_t writeSpan(T** p)
+    {
+        size_t w = _ownW();
+        _rCache = _loadR();
+        size_t f = CAPACITY - (w - _rCache);
+        size_t m = CAPACITY - (w & MASK);
+        *p = &_b[w & MASK];
+        return f < m ? f : m;
+    }
+
+    void commit(size_t n)
+    {
+        _storeW(_ownW() + n);
+    }
+
+    // Copies as much of p as fits, returns the number of elements written
+    size_t write(const T* p, size_t n)
+    {
+        size_t done = 0;
+        while (done < n)
+        {
+            T*     span;
+            size_t f = writeSpan(&span);
+            if (f == 0) break;
+            if (f > n - done) f = n - done;
+            memcpy(span, p + done, f * sizeof(T));
+            commit(f);
+            done += f;
+        }
+        return done;
+    }
+
+    // With t set, waits for space, yielding to other tasks while it waits
     int put(const T* p, int n, bool t = false)
     {
-        int c = n;
-        while (c)
+        size_t done = 0;
+        while (done < static_cast<size_t>(n))
         {
-            int f;
-            while ((f = free()) == 0) // wait for space
+            done += write(p + done, n - done);
+            if (done < static_cast<size_t>(n))
             {
-                if (!t) return n - c; // no more space and not blocking
-                /* nothing / just wait */;
+                if (!t) break; // no more space and not blocking
+                TINY_GSM_FIFO_YIELD();
             }
-            // check free space
-            if (c < f) f = c;
-            int w = _w;
-            int m = N - w;
-            // check wrap
-            if (f > m) f = m;
-            memcpy(&_b[w], p, f);
-            _w = _inc(w, f);
-            c -= f;
-            p += f;
         }
-        return n - c;
+        return static_cast<int>(done);
     }
 
     // reading thread/context API
@@ -74,68 +134,127 @@ public:
 
     bool readable(void)
     {
-        return (_r != _w);
+        return _loadR() != _loadW();
     }
 
     size_t size(void)
     {
-        int s = _w - _r;
-        if (s < 0)
-            s += N;
-        return s;
+        return _loadW() - _loadR();
     }
 
     bool get(T* p)
     {
-        int r = _r;
-        if (r == _w) // !readable()
-            return false;
-        *p = _b[r];
-        _r = _inc(r);
+        size_t r = _ownR();
+        if (r == _wCache)
+        {
+            _wCache = _loadW();
+            if (r == _wCache) // !readable()
+                return false;
+        }
+        *p = _b[r & MASK];
+        _storeR(r + 1);
         return true;
     }
 
+    // Contiguous readable data at the read position, use it and then consume()
+    size_t readSpan(const T** p)
+    {
+        size_t r = _ownR();
+        _wCache = _loadW();
+        size_t s = _wCache - r;
+        size_t m = CAPACITY - (r & MASK);
+        *p = &_b[r & MASK];
+        return s < m ? s : m;
+    }
+
+    void consume(size_t n)
+    {
+        _storeR(_ownR() + n);
+    }
+
+    // Copies up to n elements without consuming them
+    size_t peek(T* p, size_t n)
+    {
+        size_t r = _loadR();
+        size_t s = _loadW() - r;
+        if (n > s) n = s;
+        size_t first = CAPACITY - (r & MASK);
+        if (first > n) first = n;
+        memcpy(p, &_b[r & MASK], first * sizeof(T));
+        memcpy(p + first, &_b[0], (n - first) * sizeof(T));
+        return n;
+    }
+
+    size_t read(T* p, size_t n)
+    {
+        size_t done = 0;
+        while (done < n)
+        {
+            const T* span;
+            size_t   s = readSpan(&span);
+            if (s == 0) break;
+            if (s > n - done) s = n - done;
+            memcpy(p + done, span, s * sizeof(T));
+            consume(s);
+            done += s;
+        }
+        return done;
+    }
+
+    // With t set, waits for data, yielding to other tasks while it waits
     int get(T* p, int n, bool t = false)
     {
-        int c = n;
-        while (c)
+        size_t done = 0;
+        while (done < static_cast<size_t>(n))
         {
-            int f;
-            for (;;) // wait for data
+            done += read(p + done, n - done);
+            if (done < static_cast<size_t>(n))
             {
-                f = size();
-                if (f)  break;        // free space
-                if (!t) return n - c; // no space and not blocking
-                /* nothing / just wait */;
+                if (!t) break; // no data and not blocking
+                TINY_GSM_FIFO_YIELD();
             }
-            // check available data
-            if (c < f) f = c;
-            int r = _r;
-            int m = N - r;
-            // check wrap
-            if (f > m) f = m;
-            memcpy(p, &_b[r], f);
-            _r = _inc(r, f);
-            c -= f;
-            p += f;
         }
-        return n - c;
+        return static_cast<int>(done);
     }
 
-	uint8_t peek()
-	{
-		return _b[_r];
-	}
-
-private:
-    int _inc(int i, int n = 1)
+    T peek()
     {
-        return (i + n) % N;
+        return _b[_loadR() & MASK];
     }
 
-    T    _b[N];
-    int  _w;
-    int  _r;
+private:
+    static constexpr size_t MASK = CAPACITY - 1;
+
+#ifdef TINY_GSM_FIFO_ATOMIC
+    // Each side loads the other side's index with acquire and publishes its
+    // own with release, so the data is visible before the index that covers it
+    size_t _loadW() const { return _w.load(std::memory_order_acquire); }
+    size_t _loadR() const { return _r.load(std::memory_order_acquire); }
+    void _storeW(size_t v) { _w.store(v, std::memory_order_release); }
+    void _storeR(size_t v) { _r.store(v, std::memory_order_release); }
+    // A side's own index is only written by itself, it needs no ordering
+    size_t _ownW() const { return _w.load(std::memory_order_relaxed); }
+    size_t _ownR() const { return _r.load(std::memory_order_relaxed); }
+
+    std::atomic<size_t> _w;
+    std::atomic<size_t> _r;
+#else
+    // Single core without <atomic>: a compiler barrier keeps the data access
+    // on the right side of the index update
+    size_t _loadW() const { size_t v = _w; __asm__ __volatile__("" ::: "memory"); return v; }
+    size_t _loadR() const { size_t v = _r; __asm__ __volatile__("" ::: "memory"); return v; }
+    void _storeW(size_t v) { __asm__ __volatile__("" ::: "memory"); _w = v; }
+    void _storeR(size_t v) { __asm__ __volatile__("" ::: "memory"); _r = v; }
+    size_t _ownW() const { return _w; }
+    size_t _ownR() const { return _r; }
+
+    volatile size_t _w;
+    volatile size_t _r;
+#endif
+
+    size_t _rCache; // producer's copy of _r
+    size_t _wCache; // consumer's copy of _w
+    T      _b[CAPACITY];
 };
 
 #endif
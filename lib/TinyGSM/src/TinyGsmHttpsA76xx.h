@@ -46,6 +46,11 @@ public:
     }
 
     bool https_set_url(const String &url, ServerSSLVersion ssl_version = TINYGSM_SSL_AUTO)
+    {
+        return https_set_url(url.c_str(), ssl_version);
+    }
+
+    bool https_set_url(const char *url, ServerSSLVersion ssl_version = TINYGSM_SSL_AUTO)
     {
         // https://github.com/Xinyuan-LilyGO/LilyGO-T-A76XX/issues/243
         // Set SSL Version
@@ -74,6 +79,11 @@ public:
     }
 
     bool https_set_user_agent(const String &userAgent)
+    {
+        return https_set_user_agent(userAgent.c_str());
+    }
+
+    bool https_set_user_agent(const char *userAgent)
     {
         return https_add_header("User-Agent", userAgent);
     }
@@ -208,6 +218,31 @@ public:
     }
 
 
+    int https_body(uint8_t *buffer, int buffer_size, size_t offset)
+    {
+        if (!buffer || buffer_size <= 0) {
+            return 0;
+        }
+
+        thisModem().sendAT("+HTTPREAD=", offset, ",", buffer_size);
+        if (thisModem().waitResponse(3000) != 1) {
+            return 0;
+        }
+        if (thisModem().waitResponse(30000UL, "+HTTPREAD: ") != 1) {
+            return 0;
+        }
+        int length = thisModem().streamGetIntBefore('\n');
+        if (length <= 0) {
+            return 0;
+        }
+        if (length > buffer_size) {
+            length = buffer_size;
+        }
+        int read = thisModem().stream.readBytes(buffer, length);
+        thisModem().waitResponse(5000UL, "+HTTPREAD: 0");
+        return read;
+    }
+
     String https_body()
     {
         int offset = 0;
@@ -10,6 +10,7 @@
 #define SRC_TINYGSMMODEM_H_
 
 #include "TinyGsmCommon.h"
+#include "TinyGsmResponseMatcher.h"
 
 template <class modemType>
 class TinyGsmModem {
@@ -268,6 +269,14 @@ class TinyGsmModem {
     }
   }
 
+  // Status URCs (+CEREG, +CGEV, +CPIN, +CSQ) are passed to this callback with
+  // the rest of their line, so the application can cache modem state instead
+  // of polling it
+  typedef void (*StatusUrcCallback)(const char* urc, const char* args);
+  void setStatusUrcCallback(StatusUrcCallback callback) {
+    statusUrcCallback = callback;
+  }
+
  protected:
   inline bool streamGetLength(char* buf, int8_t numChars,
                               const uint32_t timeout_ms = 1000L) {
@@ -352,6 +361,28 @@ class TinyGsmModem {
     return -9999.0F;
   }
 
+  // Called by waitResponse() for every byte that matched nothing else, only
+  // does work when the data ends in a ':'
+  bool handleStatusUrc(const TinyGsmResponseMatcher& matcher) {
+    if (!statusUrcCallback || matcher.last() != ':') { return false; }
+    // GSM_NL is not defined yet where this file is included
+    static const char* const urcs[] = {"\r\n+CEREG:", "\r\n+CGEV:",
+                                       "\r\n+CPIN:", "\r\n+CSQ:"};
+    for (const char* urc : urcs) {
+      if (!matcher.endsWith(urc)) { continue; }
+      char   args[48];
+      size_t n = thisModem().stream.readBytesUntil('\n', args,
+                                                   sizeof(args) - 1);
+      while (n > 0 && (args[n - 1] == '\r' || args[n - 1] == ' ')) { n--; }
+      args[n] = '\0';
+      statusUrcCallback(urc + 2, args);
+      return true;
+    }
+    return false;
+  }
+
+  StatusUrcCallback statusUrcCallback = NULL;
+
   inline bool streamSkipUntil(const char c, const uint32_t timeout_ms = 1000L) {
     uint32_t startMillis = millis();
     while (millis() - startMillis < timeout_ms) {
@@ -0,0 +1,133 @@
+/**
+ * @file       TinyGsmResponseMatcher.h
+ * @license    LGPL-3.0
+ * @date       Oct 2026
+ */
+
+#ifndef SRC_TINYGSMRESPONSEMATCHER_H_
+#define SRC_TINYGSMRESPONSEMATCHER_H_
+
+#include <assert.h>
+
+#if defined(ARDUINO) || defined(SPARK) || defined(PARTICLE)
+#include "TinyGsmCommon.h"
+#else
+// Host builds (unit tests) have no Arduino core, patterns are plain strings
+#include <stdint.h>
+#include <string.h>
+typedef const char* GsmConstStr;
+#define strlen_P strlen
+#define pgm_read_byte(p) (*reinterpret_cast<const uint8_t*>(p))
+#endif
+
+// Matches the end of a modem response stream against a small set of expected
+// responses and URCs without building a String.
+//
+// The last bytes received are kept in a fixed ring buffer. Each pattern is
+// indexed by its last character, so a byte only costs a comparison for the
+// patterns that end in it; a full suffix compare runs only on those few
+// candidates instead of for every pattern on every byte.
+class TinyGsmResponseMatcher {
+ public:
+  static const uint8_t MAX_PATTERNS    = 16;
+  static const uint8_t TAIL_SIZE       = 64;  // power of two
+  static const uint8_t MAX_PATTERN_LEN = TAIL_SIZE;
+
+  static_assert((TAIL_SIZE & (TAIL_SIZE - 1)) == 0,
+                "TAIL_SIZE must be a power of two");
+
+  TinyGsmResponseMatcher() : patternCount(0), head(0), count(0) {}
+
+  // Adds a pattern and returns its id, or -1 for NULL (an unused response
+  // slot). A pattern that is empty, longer than MAX_PATTERN_LEN or one too
+  // many could never match and is a bug in the caller, so it asserts.
+  int8_t add(GsmConstStr pattern) {
+    if (!pattern) { return -1; }
+    const char* text = reinterpret_cast<const char*>(pattern);
+    size_t      len  = strlen_P(text);
+    assert(patternCount < MAX_PATTERNS);
+    assert(len > 0 && len <= MAX_PATTERN_LEN);
+    if (patternCount >= MAX_PATTERNS || len == 0 || len > MAX_PATTERN_LEN) {
+      return -1;
+    }
+    patterns[patternCount].text = text;
+    patterns[patternCount].len  = static_cast<uint8_t>(len);
+    patterns[patternCount].last = pgm_read_byte(text + len - 1);
+    return static_cast<int8_t>(patternCount++);
+  }
+
+  // Feeds one byte, returns the id of the first pattern (in the order they
+  // were added) that the stream now ends with, or -1
+  int8_t push(char c) {
+    tail[head] = c;
+    head       = (head + 1) & (TAIL_SIZE - 1);
+    if (count < TAIL_SIZE) { count++; }
+
+    for (uint8_t i = 0; i < patternCount; i++) {
+      const Pattern& p = patterns[i];
+      if (p.last == c && p.len <= count && tailMatches(p.text, p.len)) {
+        return static_cast<int8_t>(i);
+      }
+    }
+    return -1;
+  }
+
+  // Whether the stream ends with a pattern that is not in the table
+  bool endsWith(const char* text) const {
+    size_t len = strlen(text);
+    if (len == 0 || len > count) { return false; }
+    for (size_t i = 0; i < len; i++) {
+      if (at(len - i) != text[len - 1 - i]) { return false; }
+    }
+    return true;
+  }
+
+  char last() const {
+    return count ? at(1) : '\0';
+  }
+
+  // Forgets the bytes received so far, the patterns are kept
+  void clear() {
+    count = 0;
+  }
+
+  // Copies the bytes received since the last clear() (at most TAIL_SIZE) as a
+  // C string, for debug output
+  size_t copyTail(char* buf, size_t size) const {
+    if (!size) { return 0; }
+    size_t n = count < size - 1 ? count : size - 1;
+    for (size_t i = 0; i < n; i++) { buf[i] = at(n - i); }
+    buf[n] = '\0';
+    return n;
+  }
+
+ private:
+  struct Pattern {
+    const char* text;
+    uint8_t     len;
+    char        last;
+  };
+
+  // The byte received `back` bytes ago, at(1) is the latest
+  char at(size_t back) const {
+    return tail[(head + TAIL_SIZE - back) & (TAIL_SIZE - 1)];
+  }
+
+  bool tailMatches(const char* text, uint8_t len) const {
+    // The last character already matched
+    for (uint8_t i = 2; i <= len; i++) {
+      if (at(i) != static_cast<char>(pgm_read_byte(text + len - i))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  Pattern patterns[MAX_PATTERNS];
+  char    tail[TAIL_SIZE];
+  uint8_t patternCount;
+  uint8_t head;
+  uint8_t count;
+};
+
+#endif  // SRC_TINYGSMRESPONSEMATCHER_H_
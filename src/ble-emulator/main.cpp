@@ -55,21 +55,42 @@ void setup() {
   Serial.println(NimBLEDevice::getAddress().toString().c_str());
 }
 
+// Sends every beat of the last interval as a strap does: contact detected, uint8 heart rate and
+// the RR-intervals in 1/1024 s, each jittered around the current rate.
+static void notifyHeartRate(int heartRate) {
+  static uint32_t beatClock = 0; // ms of beats sent so far
+  uint8_t hrmData[2 + 2 * 9] = { 0x16, (uint8_t)heartRate };
+  size_t len = 2;
+
+  uint32_t now = millis();
+  if (beatClock == 0 || now - beatClock > 10000) {
+    beatClock = now;
+  }
+  while (beatClock < now && len + 2 <= sizeof(hrmData)) {
+    uint32_t rr = 60000 / heartRate + random(-40, 41);
+    uint32_t rr1024 = (rr * 1024 + 500) / 1000;
+    hrmData[len++] = rr1024 & 0xff;
+    hrmData[len++] = rr1024 >> 8;
+    beatClock += rr;
+  }
+
+  heartRateChar->setValue(hrmData, len);
+  heartRateChar->notify();
+}
+
 void loop() {
   static int batteryLevel = 100;
   static int heartRate = 70;
   static int steps = 0;
 
   batteryLevel = max(0, batteryLevel - 1);
-  heartRate = random(60, 100);
+  heartRate = constrain(heartRate + random(-3, 4), 60, 100);
   steps += random(1, 5);
 
   batteryLevelChar->setValue(batteryLevel);
   batteryLevelChar->notify();
 
-  uint8_t hrmData[2] = { 0x00, (uint8_t)heartRate };
-  heartRateChar->setValue(hrmData, 2);
-  heartRateChar->notify();
+  notifyHeartRate(heartRate);
 
   stepCountChar->setValue(String(steps).c_str());
   stepCountChar->notify();
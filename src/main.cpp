@@ -11,7 +11,9 @@
 
 #include "SensorData.h"
 #include "config.h"
+#include "network/cmux.h"
 #include "tasks/accelerometerTask.h"
+#include "tasks/authTask.h"
 #include "tasks/batteryTask.h"
 #include "tasks/bluetoothTask.h"
 #include "tasks/communicationTask.h"
@@ -37,8 +39,14 @@ EventGroupHandle_t networkEventGroup;
 SemaphoreHandle_t serialMutex;
 SemaphoreHandle_t modemMutex;
 SemaphoreHandle_t networkEventMutex;
+SemaphoreHandle_t authMutex;
 
-TinyGsm modem(SerialAT);
+TaskHandle_t authTaskHandle = NULL;
+
+// One AT command stream per CMUX channel, all on the modem UART until the multiplexer runs
+TinyGsm modem(cmuxDataChannel);
+TinyGsm gnssModem(cmuxGnssChannel);
+TinyGsm controlModem(cmuxControlChannel);
 
 void setup()
 {
@@ -51,8 +59,10 @@ void setup()
     serialMutex = xSemaphoreCreateMutex();
     modemMutex = xSemaphoreCreateMutex();
     networkEventMutex = xSemaphoreCreateMutex();
+    authMutex = xSemaphoreCreateMutex();
 
-    if (serialMutex == NULL || modemMutex == NULL || networkEventMutex == NULL)
+    if (serialMutex == NULL || modemMutex == NULL || networkEventMutex == NULL ||
+        authMutex == NULL)
     {
         Serial.println("Failed to create mutexes!");
         while (1)
@@ -75,6 +85,7 @@ void setup()
     // Medium priority tasks
     xTaskCreate(gasTask, "Gas Task", 4096, NULL, 2, NULL);
     xTaskCreatePinnedToCore(networkStatusTask, "networkStatusTask", 8192, NULL, 2, NULL, 1);
+    xTaskCreatePinnedToCore(authTask, "AuthTask", 8192, NULL, 2, &authTaskHandle, 1);
     //xTaskCreate(bluetoothTask, "Bluetooth Task", 8192, NULL, 2, NULL);
     xTaskCreate(dhtTask, "DHT Task", 8192, NULL, 2, NULL);
 
@@ -0,0 +1,101 @@
+/**
+ * @file agnss.cpp
+ * @brief Assisted GNSS Data Implementation
+ *
+ * @details AT+CAGPS downloads the data over the modem's own PDP context, so it is only tried while
+ * LTE is connected, and a failed fetch is retried after AGNSS_RETRY_MS at the earliest. The modem
+ * accepts the command with OK and reports the download with +AGPS once it is done; the wait for it
+ * holds the GNSS channel, which is the whole modem without CMUX, so it is cut short after
+ * AGNSS_FETCH_TIMEOUT_MS.
+ */
+
+#include "network/agnss.h"
+#include "config.h"
+#include "network/modemPower.h"
+#include "network/network.h"
+#include "utils/threadsafe_serial.h"
+#include <Arduino.h>
+#include <TinyGSM.h>
+
+extern TinyGsm gnssModem;
+extern Network network;
+
+#ifndef AGNSS_FETCH_TIMEOUT_MS
+#define AGNSS_FETCH_TIMEOUT_MS 10000 // longest the GNSS channel is held waiting for +AGPS
+#endif
+
+#define AGNSS_ANSWER_TIMEOUT_MS 1000 // for the OK to AT+CAGPS and the rest of the +AGPS line
+
+Agnss agnss;
+
+Agnss::Agnss()
+{
+    stats = {};
+}
+
+/**
+ * @brief Make sure the engine has assistance data, must be called with the GNSS channel held and
+ * GPS enabled
+ *
+ * @return true if the engine starts assisted
+ */
+bool Agnss::inject()
+{
+    uint32_t now = millis();
+    if (!validity.isValid(now, modemPower.getStats().coldBoots))
+    {
+        if (!network.isLTEConnected() || !validity.mayFetch(now))
+        {
+            return false;
+        }
+        validity.onAttempt(now);
+        if (!fetch())
+        {
+            stats.fetchFailures++;
+            return false;
+        }
+    }
+    stats.assistedStarts++;
+    return true;
+}
+
+agnss_stats_t Agnss::getStats() const
+{
+    agnss_stats_t copy = stats;
+    copy.ageS = validity.getAgeS(millis(), modemPower.getStats().coldBoots);
+    return copy;
+}
+
+/**
+ * @brief Have the modem download and load the assistance data
+ */
+bool Agnss::fetch()
+{
+#if DEBUG
+    uint32_t start = millis();
+#endif
+    gnssModem.sendAT(GF("+CAGPS"));
+    if (gnssModem.waitResponse(AGNSS_ANSWER_TIMEOUT_MS) != 1)
+    {
+        safePrintln("[AGNSS] Modem refused to fetch assistance data");
+        return false;
+    }
+    // +AGPS: success, or +AGPS: followed by the reason the download failed
+    if (gnssModem.waitResponse(AGNSS_FETCH_TIMEOUT_MS, GF("+AGPS: ")) != 1)
+    {
+        safePrintln("[AGNSS] Assistance data fetch timed out");
+        return false;
+    }
+    if (gnssModem.waitResponse(AGNSS_ANSWER_TIMEOUT_MS, GF("success"), GF(GSM_NL)) != 1)
+    {
+        safePrintln("[AGNSS] Modem failed to fetch assistance data");
+        return false;
+    }
+    uint32_t now = millis();
+    validity.onFetched(now, modemPower.getStats().coldBoots);
+    stats.fetches++;
+#if DEBUG
+    safePrintf("[AGNSS] Fetched assistance data in %lu ms\n", now - start);
+#endif
+    return true;
+}
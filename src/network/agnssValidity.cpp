@@ -0,0 +1,73 @@
+/**
+ * @file agnssValidity.cpp
+ * @brief Assisted GNSS Data Validity Implementation
+ *
+ * @details Ages are differences of 32-bit millisecond times, so they stay correct across a wrap of
+ * the clock as long as the data is not older than the wrap period, which AGNSS_VALIDITY_S is far
+ * below.
+ */
+
+#include "network/agnssValidity.h"
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef AGNSS_VALIDITY_S
+#define AGNSS_VALIDITY_S 86400 // fetched data is trusted while younger than this
+#endif
+#ifndef AGNSS_RETRY_MS
+#define AGNSS_RETRY_MS 600000 // between failed fetches
+#endif
+
+AgnssValidity::AgnssValidity()
+    : fetched(false), fetchedMs(0), fetchedBoot(0), attempted(false), lastAttempt(0)
+{
+}
+
+/**
+ * @brief Record that a fetch is being tried, whatever its outcome
+ */
+void AgnssValidity::onAttempt(uint32_t now)
+{
+    attempted = true;
+    lastAttempt = now;
+}
+
+/**
+ * @brief Record a successful fetch
+ *
+ * @param boot The modem's power-up count at the time of the fetch
+ */
+void AgnssValidity::onFetched(uint32_t now, uint32_t boot)
+{
+    fetched = true;
+    fetchedMs = now;
+    fetchedBoot = boot;
+}
+
+/**
+ * @brief Whether the modem still holds the data from the last fetch
+ *
+ * @param boot The modem's power-up count now
+ */
+bool AgnssValidity::isValid(uint32_t now, uint32_t boot) const
+{
+    return fetched && fetchedBoot == boot && (now - fetchedMs) / 1000 < AGNSS_VALIDITY_S;
+}
+
+/**
+ * @brief Whether a fetch may be tried, false for AGNSS_RETRY_MS after the last attempt
+ */
+bool AgnssValidity::mayFetch(uint32_t now) const
+{
+    return !attempted || now - lastAttempt >= AGNSS_RETRY_MS;
+}
+
+/**
+ * @brief Age of the data in the modem, 0 if there is none
+ */
+uint32_t AgnssValidity::getAgeS(uint32_t now, uint32_t boot) const
+{
+    return isValid(now, boot) ? (now - fetchedMs) / 1000 : 0;
+}
@@ -0,0 +1,325 @@
+/**
+ * @file cmux.cpp
+ * @brief Modem UART Multiplexer Implementation
+ *
+ * @details There is no reader task: whichever channel finds its receive buffer empty polls the
+ * UART and hands every complete frame to the channel it belongs to, so a task waiting for its own
+ * response also delivers the others'. Polling and writing share one mutex that is held for a
+ * single frame at most; the per-channel receive buffers are single-producer/single-consumer rings,
+ * the producer side being serialized by that mutex. CmuxDemux does the routing and decides when a
+ * channel is paused, the reader of a paused channel resumes it once it has read enough.
+ *
+ * Frames are sent in basic mode with the default maximum information size of 31 bytes, which the
+ * modem accepts without negotiating parameters.
+ */
+
+#include "network/cmux.h"
+#include "network/modemTransport.h"
+#include "utils/threadsafe_serial.h"
+
+#define CMUX_WRITE_TIMEOUT_MS 1000 // for the mutex, a frame takes well under a millisecond
+#define CMUX_OPEN_POLL_MS 10
+
+Cmux cmux(modemTransport);
+CmuxChannel cmuxDataChannel(cmux, MODEM_CHANNEL_DATA);
+CmuxChannel cmuxGnssChannel(cmux, MODEM_CHANNEL_GNSS);
+CmuxChannel cmuxControlChannel(cmux, MODEM_CHANNEL_CONTROL);
+
+Cmux::Cmux(Stream& link) : link(link), lock(NULL), active(false), framesOut(0)
+{
+}
+
+/**
+ * @brief Open the multiplexer control channel and all virtual channels
+ *
+ * @details Must be called with the modem held, right after the modem answered OK to AT+CMUX=0. On
+ * failure the modem is told to close down, which returns it to AT command mode.
+ *
+ * @param timeoutMs Time each channel has to answer
+ * @return true if the channels now run through the multiplexer
+ */
+bool Cmux::begin(uint32_t timeoutMs)
+{
+    if (lock == NULL)
+    {
+        lock = xSemaphoreCreateMutex();
+        if (lock == NULL)
+        {
+            return false;
+        }
+    }
+
+    active = false;
+    demux.reset();
+
+    for (uint8_t dlci = 0; dlci < CMUX_CHANNELS; dlci++)
+    {
+        if (!openDlc(dlci, timeoutMs))
+        {
+            safePrintf("[CMUX] Channel %d did not open\n", dlci);
+            end();
+            return false;
+        }
+    }
+
+    for (uint8_t dlci = 1; dlci < CMUX_CHANNELS; dlci++)
+    {
+        uint8_t msc[CMUX_REPLY_SIZE];
+        size_t n = CmuxDemux::modemStatus(dlci, false, msc, sizeof(msc));
+        if (xSemaphoreTake(lock, pdMS_TO_TICKS(CMUX_WRITE_TIMEOUT_MS)) == pdTRUE)
+        {
+            link.write(msc, n);
+            framesOut++;
+            demux.ring(dlci).clear();
+            xSemaphoreGive(lock);
+        }
+    }
+
+    active = true;
+    safePrintf("[CMUX] Multiplexer running with %d channels\n", CMUX_CHANNELS - 1);
+    return true;
+}
+
+/**
+ * @brief Close down the multiplexer, the modem returns to AT command mode
+ */
+void Cmux::end()
+{
+    if (lock != NULL)
+    {
+        uint8_t cld[] = {CMUX_MSG_CLD | CMUX_CR, CMUX_EA};
+        sendFrame(0, CMUX_UIH, true, cld, sizeof(cld));
+    }
+    reset();
+}
+
+/**
+ * @brief Forget the multiplexer without telling the modem, e.g. because it was powered off
+ */
+void Cmux::reset()
+{
+    active = false;
+    demux.reset();
+}
+
+bool Cmux::isActive() const
+{
+    return active;
+}
+
+/**
+ * @brief Move what the UART has received into the channels
+ *
+ * @details Returns at once if another task is polling or writing a frame; a poller delivers for
+ * every channel and the caller simply polls again.
+ */
+void Cmux::poll()
+{
+    if (lock == NULL || xSemaphoreTake(lock, 0) != pdTRUE)
+    {
+        return;
+    }
+
+    uint8_t reply[CMUX_REPLY_SIZE];
+    int pending = link.available();
+    while (pending-- > 0)
+    {
+        int c = link.read();
+        if (c < 0)
+        {
+            break;
+        }
+        size_t n = demux.feed((uint8_t)c, reply, sizeof(reply));
+        if (n > 0)
+        {
+            link.write(reply, n);
+            framesOut++;
+        }
+    }
+    if (active && demux.isClosed())
+    {
+        safePrintln("[CMUX] Modem closed the multiplexer");
+        active = false;
+    }
+
+    xSemaphoreGive(lock);
+}
+
+/**
+ * @brief Resume a channel paused by flow control, called by its reader
+ */
+void Cmux::release(uint8_t dlci)
+{
+    if (!demux.isStopped(dlci) || xSemaphoreTake(lock, 0) != pdTRUE)
+    {
+        return; // not paused, or the lock holder polls and the next read tries again
+    }
+    uint8_t msc[CMUX_REPLY_SIZE];
+    size_t n = demux.release(dlci, msc, sizeof(msc));
+    if (n > 0)
+    {
+        link.write(msc, n);
+        framesOut++;
+    }
+    xSemaphoreGive(lock);
+}
+
+cmux_stats_t Cmux::getStats() const
+{
+    cmux_stats_t stats;
+    stats.framesIn = demux.getFramesIn();
+    stats.framesOut = framesOut;
+    stats.fcsErrors = demux.getCodec().getFcsErrors();
+    stats.droppedFrames = demux.getCodec().getDroppedFrames();
+    stats.rxOverflows = demux.getRxOverflows();
+    stats.flowStops = demux.getFlowStops();
+    return stats;
+}
+
+/**
+ * @brief Send data on a channel, split into frames of at most CMUX_FRAME_SIZE bytes
+ *
+ * @return Number of bytes sent
+ */
+size_t Cmux::send(uint8_t dlci, const uint8_t* data, size_t length)
+{
+    size_t done = 0;
+    while (done < length)
+    {
+        size_t n = length - done;
+        if (n > CMUX_FRAME_SIZE)
+        {
+            n = CMUX_FRAME_SIZE;
+        }
+        if (xSemaphoreTake(lock, pdMS_TO_TICKS(CMUX_WRITE_TIMEOUT_MS)) != pdTRUE)
+        {
+            break;
+        }
+        writeFrame(dlci, CMUX_UIH, true, data + done, n);
+        xSemaphoreGive(lock);
+        done += n;
+    }
+    return done;
+}
+
+void Cmux::sendFrame(uint8_t dlci, uint8_t control, bool command, const uint8_t* info,
+    size_t length)
+{
+    if (xSemaphoreTake(lock, pdMS_TO_TICKS(CMUX_WRITE_TIMEOUT_MS)) != pdTRUE)
+    {
+        return;
+    }
+    writeFrame(dlci, control, command, info, length);
+    xSemaphoreGive(lock);
+}
+
+/**
+ * @brief Encode and write one frame, the caller holds the lock
+ */
+void Cmux::writeFrame(uint8_t dlci, uint8_t control, bool command, const uint8_t* info,
+    size_t length)
+{
+    uint8_t frame[CMUX_FRAME_SIZE + CMUX_FRAME_OVERHEAD];
+    size_t n = CmuxCodec::encode(dlci, control, command, info, length, frame, sizeof(frame));
+    if (n > 0)
+    {
+        link.write(frame, n);
+        framesOut++;
+    }
+}
+
+bool Cmux::openDlc(uint8_t dlci, uint32_t timeoutMs)
+{
+    sendFrame(dlci, CMUX_SABM | CMUX_PF, true, NULL, 0);
+    uint32_t start = millis();
+    while (millis() - start < timeoutMs)
+    {
+        poll();
+        if (demux.isOpened(dlci))
+        {
+            return true;
+        }
+        if (demux.isRefused(dlci))
+        {
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(CMUX_OPEN_POLL_MS));
+    }
+    return false;
+}
+
+CmuxChannel::CmuxChannel(Cmux& mux, modem_channel_t dlci)
+    : mux(mux), dlci(dlci), rx(mux.demux.ring(dlci))
+{
+}
+
+int CmuxChannel::available()
+{
+    if (!mux.active)
+    {
+        return mux.link.available();
+    }
+    mux.poll();
+    mux.release(dlci);
+    return (int)rx.size();
+}
+
+int CmuxChannel::read()
+{
+    if (!mux.active)
+    {
+        return mux.link.read();
+    }
+    uint8_t c;
+    if (!rx.get(&c))
+    {
+        mux.poll();
+        if (!rx.get(&c))
+        {
+            return -1;
+        }
+    }
+    mux.release(dlci);
+    return c;
+}
+
+int CmuxChannel::peek()
+{
+    if (!mux.active)
+    {
+        return mux.link.peek();
+    }
+    if (!rx.readable())
+    {
+        mux.poll();
+        if (!rx.readable())
+        {
+            return -1;
+        }
+    }
+    return rx.peek();
+}
+
+void CmuxChannel::flush()
+{
+    mux.link.flush();
+}
+
+int CmuxChannel::availableForWrite()
+{
+    return mux.link.availableForWrite();
+}
+
+size_t CmuxChannel::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t CmuxChannel::write(const uint8_t* buffer, size_t size)
+{
+    if (!mux.active)
+    {
+        return mux.link.write(buffer, size);
+    }
+    return mux.send(dlci, buffer, size);
+}
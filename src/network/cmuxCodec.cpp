@@ -0,0 +1,216 @@
+/**
+ * @file cmuxCodec.cpp
+ * @brief 3GPP TS 27.010 Basic Mode Frame Codec Implementation
+ *
+ * @details The FCS is the reflected CRC-8 of TS 27.010 (x^8 + x^2 + x + 1) over the address,
+ * control and length bytes; UIH frames never cover the information field. A frame is good when the
+ * CRC over the header and the received FCS is 0xCF.
+ */
+
+#include "network/cmuxCodec.h"
+#include <cstring>
+
+#define CMUX_FCS_INIT 0xFF
+#define CMUX_FCS_GOOD 0xCF
+
+// Reflected CRC-8, polynomial 0xE0
+static const uint8_t fcsTable[256] = {
+    0x00, 0x91, 0xE3, 0x72, 0x07, 0x96, 0xE4, 0x75, 0x0E, 0x9F, 0xED, 0x7C,
+    0x09, 0x98, 0xEA, 0x7B, 0x1C, 0x8D, 0xFF, 0x6E, 0x1B, 0x8A, 0xF8, 0x69,
+    0x12, 0x83, 0xF1, 0x60, 0x15, 0x84, 0xF6, 0x67, 0x38, 0xA9, 0xDB, 0x4A,
+    0x3F, 0xAE, 0xDC, 0x4D, 0x36, 0xA7, 0xD5, 0x44, 0x31, 0xA0, 0xD2, 0x43,
+    0x24, 0xB5, 0xC7, 0x56, 0x23, 0xB2, 0xC0, 0x51, 0x2A, 0xBB, 0xC9, 0x58,
+    0x2D, 0xBC, 0xCE, 0x5F, 0x70, 0xE1, 0x93, 0x02, 0x77, 0xE6, 0x94, 0x05,
+    0x7E, 0xEF, 0x9D, 0x0C, 0x79, 0xE8, 0x9A, 0x0B, 0x6C, 0xFD, 0x8F, 0x1E,
+    0x6B, 0xFA, 0x88, 0x19, 0x62, 0xF3, 0x81, 0x10, 0x65, 0xF4, 0x86, 0x17,
+    0x48, 0xD9, 0xAB, 0x3A, 0x4F, 0xDE, 0xAC, 0x3D, 0x46, 0xD7, 0xA5, 0x34,
+    0x41, 0xD0, 0xA2, 0x33, 0x54, 0xC5, 0xB7, 0x26, 0x53, 0xC2, 0xB0, 0x21,
+    0x5A, 0xCB, 0xB9, 0x28, 0x5D, 0xCC, 0xBE, 0x2F, 0xE0, 0x71, 0x03, 0x92,
+    0xE7, 0x76, 0x04, 0x95, 0xEE, 0x7F, 0x0D, 0x9C, 0xE9, 0x78, 0x0A, 0x9B,
+    0xFC, 0x6D, 0x1F, 0x8E, 0xFB, 0x6A, 0x18, 0x89, 0xF2, 0x63, 0x11, 0x80,
+    0xF5, 0x64, 0x16, 0x87, 0xD8, 0x49, 0x3B, 0xAA, 0xDF, 0x4E, 0x3C, 0xAD,
+    0xD6, 0x47, 0x35, 0xA4, 0xD1, 0x40, 0x32, 0xA3, 0xC4, 0x55, 0x27, 0xB6,
+    0xC3, 0x52, 0x20, 0xB1, 0xCA, 0x5B, 0x29, 0xB8, 0xCD, 0x5C, 0x2E, 0xBF,
+    0x90, 0x01, 0x73, 0xE2, 0x97, 0x06, 0x74, 0xE5, 0x9E, 0x0F, 0x7D, 0xEC,
+    0x99, 0x08, 0x7A, 0xEB, 0x8C, 0x1D, 0x6F, 0xFE, 0x8B, 0x1A, 0x68, 0xF9,
+    0x82, 0x13, 0x61, 0xF0, 0x85, 0x14, 0x66, 0xF7, 0xA8, 0x39, 0x4B, 0xDA,
+    0xAF, 0x3E, 0x4C, 0xDD, 0xA6, 0x37, 0x45, 0xD4, 0xA1, 0x30, 0x42, 0xD3,
+    0xB4, 0x25, 0x57, 0xC6, 0xB3, 0x22, 0x50, 0xC1, 0xBA, 0x2B, 0x59, 0xC8,
+    0xBD, 0x2C, 0x5E, 0xCF
+};
+
+static uint8_t crc8(const uint8_t* data, size_t length, uint8_t crc = CMUX_FCS_INIT)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = fcsTable[crc ^ data[i]];
+    }
+    return crc;
+}
+
+CmuxCodec::CmuxCodec() : fcsErrors(0), droppedFrames(0)
+{
+    reset();
+}
+
+void CmuxCodec::reset()
+{
+    state = WAIT_FLAG;
+    headerLength = 0;
+    length = 0;
+    received = 0;
+    receivedFcs = 0;
+}
+
+uint8_t CmuxCodec::fcs(const uint8_t* data, size_t length)
+{
+    return 0xFF - crc8(data, length);
+}
+
+/**
+ * @brief Build one frame
+ *
+ * @return Size of the frame in out, 0 if it does not fit
+ */
+size_t CmuxCodec::encode(uint8_t dlci, uint8_t control, bool command, const uint8_t* info,
+    size_t length, uint8_t* out, size_t outSize)
+{
+    if (length > 0x7FFF || outSize < length + CMUX_FRAME_OVERHEAD)
+    {
+        return 0;
+    }
+
+    size_t n = 0;
+    out[n++] = CMUX_FLAG;
+    out[n++] = (uint8_t)((dlci << 2) | (command ? CMUX_CR : 0) | CMUX_EA);
+    out[n++] = control;
+    if (length <= 127)
+    {
+        out[n++] = (uint8_t)((length << 1) | CMUX_EA);
+    }
+    else
+    {
+        out[n++] = (uint8_t)(length << 1);
+        out[n++] = (uint8_t)(length >> 7);
+    }
+    uint8_t headerFcs = fcs(out + 1, n - 1);
+    if (length)
+    {
+        memcpy(out + n, info, length);
+        n += length;
+    }
+    out[n++] = headerFcs;
+    out[n++] = CMUX_FLAG;
+    return n;
+}
+
+/**
+ * @brief Feed one received byte
+ *
+ * @details Bytes outside frames, frames with a bad FCS and frames longer than CMUX_MAX_INFO are
+ * dropped. A closing flag may also open the next frame.
+ *
+ * @return true when frame holds a complete frame, valid until the next call
+ */
+bool CmuxCodec::decode(uint8_t byte, cmux_frame_t& frame)
+{
+    switch (state)
+    {
+        case WAIT_FLAG:
+            if (byte == CMUX_FLAG)
+            {
+                state = ADDRESS;
+            }
+            return false;
+
+        case ADDRESS:
+            if (byte == CMUX_FLAG)
+            {
+                return false; // repeated flag between frames
+            }
+            header[0] = byte;
+            headerLength = 1;
+            state = CONTROL;
+            return false;
+
+        case CONTROL:
+            header[headerLength++] = byte;
+            state = LENGTH;
+            return false;
+
+        case LENGTH:
+            header[headerLength++] = byte;
+            length = byte >> 1;
+            if (byte & CMUX_EA)
+            {
+                state = length ? INFO : FCS;
+            }
+            else
+            {
+                state = LENGTH2;
+            }
+            received = 0;
+            return false;
+
+        case LENGTH2:
+            header[headerLength++] = byte;
+            length |= (size_t)byte << 7;
+            state = length ? INFO : FCS;
+            return false;
+
+        case INFO:
+            if (received < CMUX_MAX_INFO)
+            {
+                info[received] = byte;
+            }
+            if (++received == length)
+            {
+                state = FCS;
+            }
+            return false;
+
+        case FCS:
+            receivedFcs = byte;
+            state = END;
+            return false;
+
+        case END:
+        {
+            state = ADDRESS; // the closing flag can open the next frame
+            if (byte != CMUX_FLAG)
+            {
+                droppedFrames++;
+                state = WAIT_FLAG;
+                return false;
+            }
+            if (crc8(&receivedFcs, 1, crc8(header, headerLength)) != CMUX_FCS_GOOD)
+            {
+                fcsErrors++;
+                return false;
+            }
+            if (length > CMUX_MAX_INFO)
+            {
+                droppedFrames++;
+                return false;
+            }
+            frame.dlci = header[0] >> 2;
+            frame.command = (header[0] & CMUX_CR) != 0;
+            frame.pf = (header[1] & CMUX_PF) != 0;
+            frame.control = header[1] & ~CMUX_PF;
+            frame.info = info;
+            frame.length = length;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t CmuxCodec::getFcsErrors() const
+{
+    return fcsErrors;
+}
+
+uint32_t CmuxCodec::getDroppedFrames() const
+{
+    return droppedFrames;
+}
@@ -0,0 +1,214 @@
+/**
+ * @file cmuxDemux.cpp
+ * @brief CMUX Receive Side Implementation
+ *
+ * @details MSC on DLCI 0 carries the V.24 signals of one channel. The modem reports its own with
+ * an MSC command after a channel opens and expects it echoed back as the response; the commands
+ * sent from here pause and resume a channel through the FC bit.
+ */
+
+#include "network/cmuxDemux.h"
+#include <cstring>
+
+// V.24 signals sent with MSC: ready to communicate, ready to receive, data valid
+#define CMUX_MSC_SIGNALS 0x8D
+#define CMUX_MSC_FC 0x02 // flow control, the receiver cannot accept frames
+
+CmuxDemux::CmuxDemux() : framesIn(0), rxOverflows(0), flowStops(0)
+{
+    reset();
+}
+
+/**
+ * @brief Forget the frame in progress, the channel states and everything received
+ *
+ * @details The counters are kept, they cover every multiplexer session since boot.
+ */
+void CmuxDemux::reset()
+{
+    codec.reset();
+    for (CmuxRing& rx : rings)
+    {
+        rx.clear();
+    }
+    opened = 0;
+    refused = 0;
+    stopped = 0;
+    closed = false;
+}
+
+/**
+ * @brief Feed one byte received from the modem
+ *
+ * @param reply Buffer for a frame to send back, CMUX_REPLY_SIZE bytes are enough
+ * @return Size of the reply frame, 0 if there is nothing to send
+ */
+size_t CmuxDemux::feed(uint8_t byte, uint8_t* reply, size_t replySize)
+{
+    cmux_frame_t frame;
+    if (!codec.decode(byte, frame))
+    {
+        return 0;
+    }
+    return dispatch(frame, reply, replySize);
+}
+
+/**
+ * @brief Resume a paused channel once its reader has made room, called after reading from it
+ *
+ * @return Size of the MSC frame in reply, 0 if the channel stays as it is
+ */
+size_t CmuxDemux::release(uint8_t dlci, uint8_t* reply, size_t replySize)
+{
+    if (dlci == 0 || dlci >= CMUX_CHANNELS || !(stopped & (1 << dlci)))
+    {
+        return 0;
+    }
+    if (rings[dlci - 1].free() < CMUX_FLOW_RESUME_FREE)
+    {
+        return 0;
+    }
+    size_t n = modemStatus(dlci, false, reply, replySize);
+    if (n > 0)
+    {
+        stopped &= ~(1 << dlci);
+    }
+    return n;
+}
+
+/**
+ * @brief Build an MSC command frame for a channel
+ *
+ * @param stop Ask the modem to stop sending on the channel
+ * @return Size of the frame in out, 0 if it does not fit
+ */
+size_t CmuxDemux::modemStatus(uint8_t dlci, bool stop, uint8_t* out, size_t outSize)
+{
+    uint8_t msc[] = {CMUX_MSG_MSC | CMUX_CR, (2 << 1) | CMUX_EA,
+        (uint8_t)((dlci << 2) | CMUX_CR | CMUX_EA),
+        (uint8_t)(stop ? CMUX_MSC_SIGNALS | CMUX_MSC_FC : CMUX_MSC_SIGNALS)};
+    return CmuxCodec::encode(0, CMUX_UIH, true, msc, sizeof(msc), out, outSize);
+}
+
+CmuxRing& CmuxDemux::ring(uint8_t dlci)
+{
+    return rings[dlci - 1];
+}
+
+bool CmuxDemux::isOpened(uint8_t dlci) const
+{
+    return opened & (1 << dlci);
+}
+
+bool CmuxDemux::isRefused(uint8_t dlci) const
+{
+    return refused & (1 << dlci);
+}
+
+bool CmuxDemux::isStopped(uint8_t dlci) const
+{
+    return stopped & (1 << dlci);
+}
+
+bool CmuxDemux::isClosed() const
+{
+    return closed;
+}
+
+uint32_t CmuxDemux::getFramesIn() const
+{
+    return framesIn;
+}
+
+uint32_t CmuxDemux::getRxOverflows() const
+{
+    return rxOverflows;
+}
+
+uint32_t CmuxDemux::getFlowStops() const
+{
+    return flowStops;
+}
+
+const CmuxCodec& CmuxDemux::getCodec() const
+{
+    return codec;
+}
+
+size_t CmuxDemux::dispatch(const cmux_frame_t& frame, uint8_t* reply, size_t replySize)
+{
+    framesIn++;
+    if (frame.dlci >= CMUX_CHANNELS)
+    {
+        return 0;
+    }
+
+    switch (frame.control)
+    {
+        case CMUX_UA:
+            opened |= 1 << frame.dlci;
+            return 0;
+
+        case CMUX_DM:
+            refused |= 1 << frame.dlci;
+            return 0;
+
+        case CMUX_DISC:
+            opened &= ~(1 << frame.dlci);
+            if (frame.dlci == 0)
+            {
+                closed = true;
+            }
+            return CmuxCodec::encode(
+                frame.dlci, CMUX_UA | CMUX_PF, false, NULL, 0, reply, replySize);
+
+        case CMUX_UIH:
+        {
+            if (frame.dlci == 0)
+            {
+                return handleControl(frame, reply, replySize);
+            }
+            CmuxRing& rx = rings[frame.dlci - 1];
+            if (rx.write(frame.info, frame.length) < frame.length)
+            {
+                rxOverflows++;
+            }
+            uint8_t bit = 1 << frame.dlci;
+            if (!(stopped & bit) && rx.free() < CMUX_FLOW_STOP_FREE)
+            {
+                size_t n = modemStatus(frame.dlci, true, reply, replySize);
+                if (n > 0)
+                {
+                    stopped |= bit;
+                    flowStops++;
+                }
+                return n;
+            }
+            return 0;
+        }
+
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Answer multiplexer control commands from the modem
+ *
+ * @details Only MSC needs an answer here; responses and other messages are ignored.
+ */
+size_t CmuxDemux::handleControl(const cmux_frame_t& frame, uint8_t* reply, size_t replySize)
+{
+    if (frame.length < 2 || !(frame.info[0] & CMUX_CR))
+    {
+        return 0; // responses need no answer
+    }
+    if ((frame.info[0] & ~CMUX_CR) != CMUX_MSG_MSC || frame.length > CMUX_FRAME_SIZE)
+    {
+        return 0;
+    }
+    uint8_t response[CMUX_FRAME_SIZE];
+    memcpy(response, frame.info, frame.length);
+    response[0] &= ~CMUX_CR;
+    return CmuxCodec::encode(0, CMUX_UIH, true, response, frame.length, reply, replySize);
+}
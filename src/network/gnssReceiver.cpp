@@ -0,0 +1,134 @@
+/**
+ * @file gnssReceiver.cpp
+ * @brief Streaming NMEA GNSS Receiver Implementation
+ *
+ * @details TinyGPSPlus parses GGA and RMC, so the modem is asked for just those two sentences.
+ * Units match the AT+CGNSSINFO path: speed in knots, accuracy as a dilution of precision (HDOP
+ * here, PDOP there).
+ */
+
+#include "network/gnssReceiver.h"
+
+#define GNSS_FIX_MAX_AGE_MS 5000 // a fix older than this is reported as invalid
+#define GNSS_READ_CHUNK 128      // bytes handed to the parser at a time
+
+GnssReceiver gnssReceiver;
+
+GnssReceiver::GnssReceiver() : source(NULL), lastSentenceMs(0), sequence(0)
+{
+    memset(slots, 0, sizeof(slots));
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief Start reading NMEA from source, the modem must already be streaming to it
+ */
+void GnssReceiver::begin(Stream& source)
+{
+    this->source = &source;
+    lastSentenceMs = millis();
+}
+
+void GnssReceiver::end()
+{
+    source = NULL;
+}
+
+bool GnssReceiver::isStreaming() const
+{
+    return source != NULL;
+}
+
+/**
+ * @brief Parse everything the source has received, only called by the streaming task
+ *
+ * @return Number of bytes consumed
+ */
+size_t GnssReceiver::poll()
+{
+    if (source == NULL)
+    {
+        return 0;
+    }
+
+    size_t consumed = 0;
+    char chunk[GNSS_READ_CHUNK];
+    int pending = source->available();
+    while (pending > 0)
+    {
+        // At most what is available, so readBytes() never waits for its timeout
+        size_t n = source->readBytes(chunk, min((size_t)pending, sizeof(chunk)));
+        if (n == 0)
+        {
+            break;
+        }
+        pending -= n;
+        consumed += n;
+        if (parser.encode(chunk, n) > 0)
+        {
+            lastSentenceMs = millis();
+            if (parser.location.isUpdated())
+            {
+                publish();
+            }
+        }
+    }
+
+    stats.bytes += consumed;
+    stats.sentences = parser.passedChecksum();
+    stats.checksumErrors = parser.failedChecksum();
+    return consumed;
+}
+
+uint32_t GnssReceiver::getLastSentenceMs() const
+{
+    return lastSentenceMs;
+}
+
+/**
+ * @brief Copy the latest fix, callable from any task
+ *
+ * @return true if the fix is valid and recent
+ */
+bool GnssReceiver::getFix(gps_location_t& location) const
+{
+    uint32_t seq;
+    do
+    {
+        seq = sequence.load(std::memory_order_acquire);
+        location = slots[seq & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while (sequence.load(std::memory_order_relaxed) != seq);
+
+    if (location.valid && millis() - location.timestamp > GNSS_FIX_MAX_AGE_MS)
+    {
+        location.valid = false;
+    }
+    return location.valid;
+}
+
+gnss_stats_t GnssReceiver::getStats() const
+{
+    return stats;
+}
+
+/**
+ * @brief Write the parser's position into the idle slot and make it the newest
+ */
+void GnssReceiver::publish()
+{
+    gps_location_t next;
+    next.latitude = (float)parser.location.lat();
+    next.longitude = (float)parser.location.lng();
+    next.speed = (float)parser.speed.knots();
+    next.altitude = (float)parser.altitude.meters();
+    next.accuracy = (float)parser.hdop.hdop();
+    next.satellites = (int)parser.satellites.value();
+    next.valid = parser.location.isValid();
+    next.timestamp = millis();
+
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    slots[(seq + 1) & 1] = next;
+    sequence.store(seq + 1, std::memory_order_release);
+    stats.fixes++;
+}
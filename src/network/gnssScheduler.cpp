@@ -0,0 +1,251 @@
+/**
+ * @file gnssScheduler.cpp
+ * @brief Adaptive GNSS Duty Cycling Implementation
+ *
+ * @details A stationary device keeps the engine on only until it has one fix at its resting
+ * position, or for GNSS_ACQUIRE_TIMEOUT_MS if no fix comes (typically indoors). The heartbeat fix
+ * every GNSS_HEARTBEAT_MS is well inside the few hours broadcast ephemeris stays valid, so a
+ * restart on motion is a hot start taking seconds rather than a cold start taking a minute.
+ *
+ * Energy is estimated from the engine's on time and GNSS_ACTIVE_MW; the receiver draws next to
+ * nothing with the engine off.
+ */
+
+#include "network/gnssScheduler.h"
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef GNSS_MOVING_INTERVAL_MS
+#define GNSS_MOVING_INTERVAL_MS 30000 // between fixes while moving
+#endif
+#ifndef GNSS_FAST_INTERVAL_MS
+#define GNSS_FAST_INTERVAL_MS 5000 // between fixes at speed
+#endif
+#ifndef GNSS_FAST_SPEED_KN
+#define GNSS_FAST_SPEED_KN 8.0f // about 15 km/h, faster than walking or running
+#endif
+#ifndef GNSS_ACQUIRE_TIMEOUT_MS
+#define GNSS_ACQUIRE_TIMEOUT_MS 120000 // stationary without a fix, the engine is stopped again
+#endif
+#ifndef GNSS_HEARTBEAT_MS
+#define GNSS_HEARTBEAT_MS 1800000 // fix while stationary, keeps the ephemeris hot
+#endif
+#ifndef GNSS_LOW_BATTERY_PERCENT
+#define GNSS_LOW_BATTERY_PERCENT 20 // fix interval x4 below this
+#endif
+#ifndef GNSS_HALF_BATTERY_PERCENT
+#define GNSS_HALF_BATTERY_PERCENT 50 // fix interval x2 below this
+#endif
+#ifndef GNSS_ACTIVE_MW
+#define GNSS_ACTIVE_MW 110 // engine tracking, for the energy counters
+#endif
+
+#define GNSS_TTF_WEIGHT_SHIFT 2 // time to fix average, new sample weighs 1/4
+
+GnssScheduler gnssScheduler;
+
+GnssScheduler::GnssScheduler()
+    : motion(MOTION_UNKNOWN), motionSince(0), batteryPercent(-1), engineOn(false),
+      fixedSinceOn(false), assistedStart(false), engineSince(0), hasFix(false), lastFix(0),
+      lastSpeed(0)
+{
+    stats = {};
+    stats.intervalMs = GNSS_MOVING_INTERVAL_MS;
+}
+
+/**
+ * @brief Report motion, called by the accelerometer task when the state changes
+ */
+void GnssScheduler::setMotion(bool moving, uint32_t now)
+{
+    uint8_t state = moving ? MOTION_MOVING : MOTION_STATIONARY;
+    if (motion.load(std::memory_order_relaxed) != state)
+    {
+        motionSince.store(now, std::memory_order_relaxed);
+        motion.store(state, std::memory_order_release);
+    }
+}
+
+motion_state_t GnssScheduler::getMotion() const
+{
+    return (motion_state_t)motion.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Report the battery charge, called by the battery task
+ */
+void GnssScheduler::setBatteryPercent(int percent)
+{
+    if (percent < 0 || percent > 100)
+    {
+        percent = -1;
+    }
+    batteryPercent.store((int8_t)percent, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Whether the engine should be running now
+ */
+bool GnssScheduler::wantEngineOn(uint32_t now) const
+{
+    if (getMotion() != MOTION_STATIONARY)
+    {
+        return true;
+    }
+
+    if (engineOn)
+    {
+        // Keep going until this run has a resting fix, but not forever without sky view
+        return !fixedAtRest() && now - restingSince() < GNSS_ACQUIRE_TIMEOUT_MS;
+    }
+    return now - engineSince >= GNSS_HEARTBEAT_MS;
+}
+
+/**
+ * @brief Whether the GPS task should report the next valid fix
+ */
+bool GnssScheduler::fixDue(uint32_t now) const
+{
+    if (!engineOn)
+    {
+        return false;
+    }
+    if (!fixedSinceOn || !hasFix)
+    {
+        return true; // first fix of an acquisition, times the acquisition
+    }
+    if (getMotion() == MOTION_STATIONARY && !fixedAtRest())
+    {
+        return true; // the resting position lets the engine stop
+    }
+    return now - lastFix >= fixInterval();
+}
+
+/**
+ * @brief Time between fixes for the last speed and the battery charge
+ */
+uint32_t GnssScheduler::fixInterval() const
+{
+    uint32_t interval =
+        lastSpeed >= GNSS_FAST_SPEED_KN ? GNSS_FAST_INTERVAL_MS : GNSS_MOVING_INTERVAL_MS;
+
+    int8_t battery = batteryPercent.load(std::memory_order_relaxed);
+    if (battery >= 0 && battery < GNSS_LOW_BATTERY_PERCENT)
+    {
+        interval *= 4;
+    }
+    else if (battery >= 0 && battery < GNSS_HALF_BATTERY_PERCENT)
+    {
+        interval *= 2;
+    }
+    return interval;
+}
+
+/**
+ * @brief Record an engine start
+ *
+ * @param assisted Assistance data was injected, the time to fix is averaged separately
+ */
+void GnssScheduler::onEngineOn(uint32_t now, bool assisted)
+{
+    if (engineOn)
+    {
+        return;
+    }
+    engineOn = true;
+    fixedSinceOn = false;
+    assistedStart = assisted;
+    engineSince = now;
+    stats.acquisitions++;
+    if (assisted)
+    {
+        stats.assisted++;
+    }
+}
+
+void GnssScheduler::onEngineOff(uint32_t now)
+{
+    if (!engineOn)
+    {
+        return;
+    }
+    if (!fixedSinceOn)
+    {
+        stats.timeouts++;
+    }
+    stats.onTimeMs += now - engineSince;
+    engineOn = false;
+    engineSince = now;
+}
+
+/**
+ * @brief Record a reported fix
+ *
+ * @param speedKnots Speed over ground of the fix
+ * @param now Time the fix was reported
+ */
+void GnssScheduler::onFix(float speedKnots, uint32_t now)
+{
+    if (!fixedSinceOn)
+    {
+        uint32_t ttf = now - engineSince;
+        stats.lastTimeToFixMs = ttf;
+        average(stats.avgTimeToFixMs, ttf);
+        average(assistedStart ? stats.avgAssistedTimeToFixMs : stats.avgUnassistedTimeToFixMs, ttf);
+        fixedSinceOn = true;
+    }
+
+    hasFix = true;
+    lastFix = now;
+    lastSpeed = speedKnots;
+    stats.fixes++;
+    stats.intervalMs = fixInterval();
+}
+
+gnss_schedule_stats_t GnssScheduler::getStats(uint32_t now) const
+{
+    gnss_schedule_stats_t copy = stats;
+    if (engineOn)
+    {
+        copy.onTimeMs += now - engineSince;
+    }
+    copy.energyMj = (uint32_t)((uint64_t)copy.onTimeMs * GNSS_ACTIVE_MW / 1000);
+    copy.energyPerFixMj = copy.fixes ? copy.energyMj / copy.fixes : 0;
+    return copy;
+}
+
+/**
+ * @brief Fold a time to fix into a running average, the first sample starts it
+ */
+void GnssScheduler::average(uint32_t& avg, uint32_t ttf)
+{
+    if (avg == 0)
+    {
+        avg = ttf;
+        return;
+    }
+    int32_t delta = (int32_t)(ttf - avg);
+    avg += delta / (1 << GNSS_TTF_WEIGHT_SHIFT);
+}
+
+/**
+ * @brief The later of the device coming to rest and the engine starting or stopping
+ */
+uint32_t GnssScheduler::restingSince() const
+{
+    uint32_t since = motionSince.load(std::memory_order_relaxed);
+    return (int32_t)(engineSince - since) > 0 ? engineSince : since;
+}
+
+/**
+ * @brief Whether the current engine run has a fix taken at rest
+ *
+ * @details A fix from before the engine started does not count, otherwise a heartbeat start would
+ * be stopped again at once by the fix that ended the previous run.
+ */
+bool GnssScheduler::fixedAtRest() const
+{
+    return hasFix && (int32_t)(lastFix - restingSince()) >= 0;
+}
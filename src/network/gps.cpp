@@ -1,4 +1,6 @@
 #include "network/gps.h"
+#include "network/cmux.h"
+#include "network/gnssReceiver.h"
 #include "network/network.h"
 #include "config.h"
 #include "utilities.h"
@@ -9,7 +11,18 @@
 
 
 
-extern TinyGsm modem;
+extern TinyGsm gnssModem;
+
+#define SerialGPS Serial2
+#define GNSS_RX_BUFFER_SIZE 1024
+#define GNSS_STREAM_TIMEOUT_MS 10000 // no sentence for this long ends streaming
+
+#ifndef GNSS_NMEA_RATE_HZ
+#define GNSS_NMEA_RATE_HZ 1
+#endif
+#ifndef GNSS_NMEA_BAUD
+#define GNSS_NMEA_BAUD 115200
+#endif
 
 
 GPS::GPS() : lastGPSUpdate(0) {
@@ -25,7 +38,7 @@ bool GPS::enableGPS() {
     safePrintln("[GPS] Enabling GPS...");
     
     // Check if GPS is already enabled
-    if (modem.isEnableGPS()) {
+    if (gnssModem.isEnableGPS()) {
         safePrintln("[GPS] GPS is already enabled");
         return true;
     }
@@ -46,14 +59,14 @@ bool GPS::enableGPS() {
     safePrintln("[Network] Modem power key sequence completed"); */
     
     // Try to enable GPS
-    if (modem.enableGPS(MODEM_GPS_ENABLE_GPIO, MODEM_GPS_ENABLE_LEVEL)) {
+    if (gnssModem.enableGPS(MODEM_GPS_ENABLE_GPIO, MODEM_GPS_ENABLE_LEVEL)) {
         safePrintln("[GPS] GPS enabled successfully");
         
         // Wait a bit for GPS to initialize
         vTaskDelay(pdMS_TO_TICKS(2000));
         
         // Verify GPS is now enabled
-        if (modem.isEnableGPS()) {
+        if (gnssModem.isEnableGPS()) {
             safePrintln("[GPS] GPS enable confirmed");
             return true;
         } else {
@@ -69,7 +82,7 @@ bool GPS::enableGPS() {
 bool GPS::disableGPS() {
     safePrintln("[GPS] Disabling GPS...");
     
-    if (modem.disableGPS()) {
+    if (gnssModem.disableGPS()) {
         safePrintln("[GPS] GPS disabled successfully");
         return true;
     } else {
@@ -78,11 +91,34 @@ bool GPS::disableGPS() {
     }
 }
 
+/**
+ * @brief Restart the engine from the ephemeris and position it kept, must be called with the GNSS
+ * channel held and GPS enabled
+ */
+bool GPS::hotStart() {
+    gnssModem.sendAT(GF("+CGPSHOT"));
+    if (gnssModem.waitResponse(10000L) != 1) {
+        safePrintln("[GPS] Hot start failed");
+        return false;
+    }
+    return true;
+}
+
 bool GPS::isGPSEnabled() {
-    return modem.isEnableGPS();
+    return gnssModem.isEnableGPS();
 }
 
 bool GPS::getGPSLocation(gps_location_t& location) {
+    // While NMEA is streaming the latest fix is already in memory
+    if (gnssReceiver.isStreaming()) {
+        if (!gnssReceiver.getFix(location)) {
+            return false;
+        }
+        lastGPSLocation = location;
+        lastGPSUpdate = millis();
+        return true;
+    }
+
     // Check if GPS is enabled first
     if (!isGPSEnabled()) {
         safePrintln("[GPS] GPS not enabled");
@@ -95,7 +131,7 @@ bool GPS::getGPSLocation(gps_location_t& location) {
     uint8_t status;
     
     // Get GPS data from modem
-    if (modem.getGPS(&status, &lat, &lon, &speed, &alt, &vsat, &usat, &accuracy,
+    if (gnssModem.getGPS(&status, &lat, &lon, &speed, &alt, &vsat, &usat, &accuracy,
                      &year, &month, &day, &hour, &minute, &second)) {
         
         // Fill location structure
@@ -177,4 +213,116 @@ void GPS::printStatus() {
         safePrintln("No GPS data available");
     }
     safePrintln("==================");
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Have the modem push GGA and RMC sentences instead of answering AT+CGNSSINFO
+ *
+ * @details Must be called with the GNSS channel held and GPS enabled. NMEA needs a stream of its
+ * own: the modem's GNSS UART where the board wires it, otherwise the CMUX GNSS channel. On the
+ * plain AT port the sentences would interleave with command responses, so polling stays in use.
+ * Only under CMUX is the raw NMEA port switched to the UART, which is then the multiplexed link;
+ * if the sentences do not show up on the GNSS channel the stream goes quiet and polling resumes.
+ *
+ * @return true if NMEA is streaming
+ */
+bool GPS::startNmeaStream() {
+#ifdef USE_GNSS_NMEA_STREAM
+    if (!canStream()) {
+        safePrintln("[GPS] No stream for NMEA, polling AT+CGNSSINFO");
+        return false;
+    }
+
+    Stream* source;
+#ifdef MODEM_GPS_RX_PIN
+    SerialGPS.setRxBufferSize(GNSS_RX_BUFFER_SIZE);
+    SerialGPS.begin(GNSS_NMEA_BAUD, SERIAL_8N1, MODEM_GPS_RX_PIN, MODEM_GPS_TX_PIN);
+    source = &SerialGPS;
+#else
+    source = &cmuxGnssChannel;
+#endif
+
+    gnssModem.setGPSOutputRate(GNSS_NMEA_RATE_HZ);
+    gnssModem.configNMEASentence(true, false, false, false, true, false, false, false);
+    if (!gnssModem.enableNMEA()) {
+        safePrintln("[GPS] Failed to enable NMEA output, polling AT+CGNSSINFO");
+        return false;
+    }
+#ifndef MODEM_GPS_RX_PIN
+    if (!setNmeaPort(NMEA_PORT_UART)) {
+        safePrintln("[GPS] Failed to route NMEA to the multiplexer, polling AT+CGNSSINFO");
+        gnssModem.disableNMEA();
+        return false;
+    }
+#endif
+
+    gnssReceiver.begin(*source);
+    safePrintf("[GPS] Streaming NMEA at %d Hz\n", GNSS_NMEA_RATE_HZ);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Turn NMEA output off again, must be called with the GNSS channel held
+ */
+void GPS::stopNmeaStream() {
+    gnssReceiver.end();
+    gnssModem.disableNMEA();
+#ifndef MODEM_GPS_RX_PIN
+    // Back to the default, so a closed multiplexer leaves a clean AT port
+    setNmeaPort(NMEA_PORT_USB);
+#endif
+}
+
+bool GPS::isStreaming() const {
+    return gnssReceiver.isStreaming();
+}
+
+/**
+ * @brief Whether this board has a stream NMEA can use right now
+ *
+ * @details The sentinel boards (T-SIM7670G-S3, T-A7670) do not wire the modem's GNSS UART, so they
+ * only stream while the multiplexer runs.
+ */
+bool GPS::canStream() const {
+#if !defined(USE_GNSS_NMEA_STREAM)
+    return false;
+#elif defined(MODEM_GPS_RX_PIN)
+    return true;
+#else
+    return cmux.isActive();
+#endif
+}
+
+/**
+ * @brief Select where the modem writes raw NMEA (AT+CGNSSPORTSWITCH=<parsed>,<nmea>)
+ */
+bool GPS::setNmeaPort(uint8_t port) {
+    gnssModem.sendAT(GF("+CGNSSPORTSWITCH=0,"), port);
+    return gnssModem.waitResponse(1000L) == 1;
+}
+
+/**
+ * @brief Parse the NMEA received so far, without touching the AT channel
+ *
+ * @return false once the stream has gone quiet or lost its channel, the caller then stops it
+ */
+bool GPS::pollNmeaStream() {
+#ifndef MODEM_GPS_RX_PIN
+    // Without the multiplexer the GNSS channel is the AT port again
+    if (!cmux.isActive()) {
+        safePrintln("[GPS] CMUX closed, NMEA stream stopped");
+        gnssReceiver.end();
+        return false;
+    }
+#endif
+    gnssReceiver.poll();
+    if (millis() - gnssReceiver.getLastSentenceMs() > GNSS_STREAM_TIMEOUT_MS) {
+        safePrintln("[GPS] No NMEA received, falling back to polling");
+        gnssReceiver.end();
+        return false;
+    }
+    return true;
+}
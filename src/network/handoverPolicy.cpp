@@ -0,0 +1,114 @@
+/**
+ * @file handoverPolicy.cpp
+ * @brief Make-Before-Break Handover Policy Implementation
+ *
+ * @details The RSSI is averaged with a weight of 1/4 per sample and compared with hysteresis, so a
+ * single weak sample does not start the modem and a recovering link does not stop it too early.
+ */
+
+#include "network/handoverPolicy.h"
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef WIFI_RSSI_WARMUP_DBM
+#define WIFI_RSSI_WARMUP_DBM -75    // smoothed RSSI below this warms up LTE
+#endif
+#ifndef WIFI_RSSI_HYSTERESIS_DB
+#define WIFI_RSSI_HYSTERESIS_DB 5   // RSSI must recover this far above the threshold
+#endif
+#ifndef WIFI_LOSS_GRACE_MS
+#define WIFI_LOSS_GRACE_MS 3000     // WiFi outage before LTE warms up, covers a fast reconnect
+#endif
+#ifndef HANDOVER_HOLD_MS
+#define HANDOVER_HOLD_MS 15000      // LTE stays up this long after it was last needed
+#endif
+
+HandoverPolicy::HandoverPolicy()
+    : wifiDownSince(0), lastLteWanted(0), rssiAverage(0), degraded(false), wifiWorked(false)
+{
+}
+
+/**
+ * @brief WiFi is not up yet
+ */
+void HandoverPolicy::begin(uint32_t now)
+{
+    wifiDownSince = now;
+}
+
+/**
+ * @brief WiFi associated, start the average from the first sample
+ */
+void HandoverPolicy::onWiFiConnected(int16_t rssi)
+{
+    rssiAverage = rssi;
+    degraded = false;
+    wifiWorked = true;
+}
+
+void HandoverPolicy::onWiFiLost(uint32_t now)
+{
+    wifiDownSince = now;
+    degraded = false;
+}
+
+/**
+ * @brief Add an RSSI sample of the connected WiFi link
+ *
+ * @return true if the link changed between degraded and good
+ */
+bool HandoverPolicy::updateRssi(int16_t rssi)
+{
+    rssiAverage = (3 * rssiAverage + rssi) / 4;
+    bool weak = degraded ? rssiAverage < WIFI_RSSI_WARMUP_DBM + WIFI_RSSI_HYSTERESIS_DB
+                         : rssiAverage < WIFI_RSSI_WARMUP_DBM;
+    bool changed = weak != degraded;
+    degraded = weak;
+    return changed;
+}
+
+int16_t HandoverPolicy::getRssi() const
+{
+    return rssiAverage;
+}
+
+bool HandoverPolicy::isDegraded() const
+{
+    return degraded;
+}
+
+/**
+ * @brief Whether the LTE link should be up or coming up, called every network step
+ *
+ * @param wifiGaveUp WiFi failed often enough that LTE is tried regardless of the grace period
+ */
+bool HandoverPolicy::isLteWanted(uint32_t now, bool wifiConnected, bool wifiGaveUp)
+{
+    bool wanted;
+    if (wifiConnected)
+    {
+        wanted = degraded;
+    }
+    else
+    {
+        bool graceOver = wifiWorked && now - wifiDownSince >= WIFI_LOSS_GRACE_MS;
+        wanted = wifiGaveUp || graceOver;
+    }
+    if (wanted)
+    {
+        lastLteWanted = now;
+    }
+    return wanted;
+}
+
+/**
+ * @brief Whether WiFi has been good for long enough to take LTE down
+ *
+ * @details The caller still has to wait for requests pinned to LTE and the send queue.
+ */
+bool HandoverPolicy::canReleaseLte(uint32_t now, bool wifiConnected) const
+{
+    return wifiConnected && now - lastLteWanted >= HANDOVER_HOLD_MS;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file linkScorer.cpp
+ * @brief Link Quality Scoring Implementation
+ *
+ * @details Success rate and latency are exponentially weighted moving averages. A transport that
+ * is not used gets no new samples, so its success rate drifts back towards 1 with every signal
+ * update; otherwise one bad stretch would keep it unused forever.
+ */
+
+#include "network/linkScorer.h"
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef LINK_EWMA_WEIGHT
+#define LINK_EWMA_WEIGHT 0.125f
+#endif
+#ifndef LINK_RECOVERY_WEIGHT
+#define LINK_RECOVERY_WEIGHT 0.02f
+#endif
+#ifndef LINK_SWITCH_MARGIN
+#define LINK_SWITCH_MARGIN 0.2f
+#endif
+
+static const link_profile_t DEFAULT_PROFILES[TRANSPORT_COUNT] = {
+    {0, 0, 0, 0, 0},                // TRANSPORT_NONE
+    {350, 40, 300, -90, -65},       // TRANSPORT_WIFI
+    {800, 1500, 1500, -113, -85},   // TRANSPORT_LTE, RRC tail of several seconds
+};
+
+LinkScorer::LinkScorer()
+{
+    for (int i = 0; i < TRANSPORT_COUNT; i++)
+    {
+        profiles[i] = DEFAULT_PROFILES[i];
+        stats[i].successRate = 1.0f;
+        stats[i].latencyMs = DEFAULT_PROFILES[i].priorLatencyMs;
+        stats[i].signalDbm = 0;
+        stats[i].energyMj = 0;
+        stats[i].score = 0;
+        stats[i].samples = 0;
+        stats[i].failures = 0;
+    }
+}
+
+void LinkScorer::setProfile(Transport transport, const link_profile_t& profile)
+{
+    if (transport > TRANSPORT_NONE && transport < TRANSPORT_COUNT)
+    {
+        profiles[transport] = profile;
+        if (stats[transport].samples == 0)
+        {
+            stats[transport].latencyMs = profile.priorLatencyMs;
+        }
+    }
+}
+
+/**
+ * @brief Record the outcome of one request
+ *
+ * @param transport Transport the request used
+ * @param delivered true if an HTTP response was received, whatever its status
+ * @param latencyMs Time from sending the request to the end of the response
+ */
+void LinkScorer::recordResult(Transport transport, bool delivered, uint32_t latencyMs)
+{
+    if (transport <= TRANSPORT_NONE || transport >= TRANSPORT_COUNT)
+    {
+        return;
+    }
+
+    link_stats_t& s = stats[transport];
+    s.successRate += LINK_EWMA_WEIGHT * ((delivered ? 1.0f : 0.0f) - s.successRate);
+    // Failed requests usually end in a timeout, which says little about the link's latency
+    if (delivered)
+    {
+        s.latencyMs += LINK_EWMA_WEIGHT * ((float)latencyMs - s.latencyMs);
+    }
+    else
+    {
+        s.failures++;
+    }
+    s.samples++;
+}
+
+void LinkScorer::updateSignal(Transport transport, int16_t signalDbm)
+{
+    if (transport <= TRANSPORT_NONE || transport >= TRANSPORT_COUNT)
+    {
+        return;
+    }
+
+    link_stats_t& s = stats[transport];
+    s.signalDbm = signalDbm;
+    s.successRate += LINK_RECOVERY_WEIGHT * (1.0f - s.successRate);
+}
+
+/**
+ * @brief Estimated energy of one request on a transport
+ */
+float LinkScorer::energyMj(Transport transport) const
+{
+    const link_profile_t& p = profiles[transport];
+    return p.activePowerMw * stats[transport].latencyMs / 1000.0f + p.tailEnergyMj;
+}
+
+/**
+ * @brief Signal weight between 0.1 at the floor and 1 at a good signal
+ *
+ * @details Unknown signal (0) counts as good, the success rate still reflects the link.
+ */
+float LinkScorer::signalFactor(Transport transport) const
+{
+    const link_profile_t& p = profiles[transport];
+    int16_t dbm = stats[transport].signalDbm;
+    if (dbm == 0 || dbm >= p.signalGoodDbm)
+    {
+        return 1.0f;
+    }
+    if (dbm <= p.signalFloorDbm)
+    {
+        return 0.1f;
+    }
+    float factor = (float)(dbm - p.signalFloorDbm) / (float)(p.signalGoodDbm - p.signalFloorDbm);
+    return factor < 0.1f ? 0.1f : factor;
+}
+
+/**
+ * @brief Expected delivered requests per joule
+ */
+float LinkScorer::score(Transport transport) const
+{
+    if (transport <= TRANSPORT_NONE || transport >= TRANSPORT_COUNT)
+    {
+        return 0;
+    }
+    float energy = energyMj(transport);
+    if (energy <= 0)
+    {
+        return 0;
+    }
+    return stats[transport].successRate * signalFactor(transport) * 1000.0f / energy;
+}
+
+/**
+ * @brief Pick the transport for the next request
+ *
+ * @details The current transport is kept unless the other one scores LINK_SWITCH_MARGIN better,
+ * so the uplink does not flap between two similar links.
+ *
+ * @param wifiUp Whether WiFi is connected
+ * @param lteUp Whether LTE is connected
+ * @param current Transport used for the previous request
+ * @return Transport to use, TRANSPORT_NONE if neither is up
+ */
+Transport LinkScorer::pick(bool wifiUp, bool lteUp, Transport current) const
+{
+    if (!wifiUp && !lteUp)
+    {
+        return TRANSPORT_NONE;
+    }
+    if (!lteUp)
+    {
+        return TRANSPORT_WIFI;
+    }
+    if (!wifiUp)
+    {
+        return TRANSPORT_LTE;
+    }
+
+    float wifiScore = score(TRANSPORT_WIFI);
+    float lteScore = score(TRANSPORT_LTE);
+
+    if (current == TRANSPORT_LTE)
+    {
+        return wifiScore > lteScore * (1.0f + LINK_SWITCH_MARGIN) ? TRANSPORT_WIFI : TRANSPORT_LTE;
+    }
+    if (current == TRANSPORT_WIFI)
+    {
+        return lteScore > wifiScore * (1.0f + LINK_SWITCH_MARGIN) ? TRANSPORT_LTE : TRANSPORT_WIFI;
+    }
+    return lteScore > wifiScore ? TRANSPORT_LTE : TRANSPORT_WIFI;
+}
+
+link_stats_t LinkScorer::getStats(Transport transport) const
+{
+    if (transport <= TRANSPORT_NONE || transport >= TRANSPORT_COUNT)
+    {
+        return stats[TRANSPORT_NONE];
+    }
+    link_stats_t s = stats[transport];
+    s.energyMj = energyMj(transport);
+    s.score = score(transport);
+    return s;
+}
@@ -0,0 +1,381 @@
+/**
+ * @file modemPower.cpp
+ * @brief Modem Power-State Manager Implementation
+ *
+ * @details With AT+CSCLK=1 the modem enters sleep whenever DTR is high and the UART is idle, and
+ * wakes when DTR is pulled low. The UART needs a short moment after the wake before it answers, so
+ * wake() probes with AT until the modem responds.
+ *
+ * DTR sleep is only used while the modem is held as a whole. With the multiplexer running the
+ * channels are held independently and the modem stays awake.
+ *
+ * Locks are always taken in one order: the modem mutex or the control channel first, then the data
+ * channel, then the GNSS channel. Starting and stopping the multiplexer take the other channels in
+ * that order, so no holder is left on a lock that no longer guards the UART. The counters have
+ * their own spinlock, reading them never waits for a channel.
+ */
+
+#include "network/modemPower.h"
+#include "config.h"
+#include "utilities.h"
+#include "utils/threadsafe_serial.h"
+#include <TinyGSM.h>
+
+extern TinyGsm modem;
+extern TinyGsm gnssModem;
+extern TinyGsm controlModem;
+extern SemaphoreHandle_t modemMutex;
+
+#define MODEM_WAKE_TIMEOUT_MS 1000
+#define MODEM_WAKE_PROBE_MS 50
+#define MODEM_CMUX_OPEN_TIMEOUT_MS 1000 // per channel
+#define MODEM_ECHO_TIMEOUT_MS 300
+
+#ifndef MODEM_AWAKE_MW
+#define MODEM_AWAKE_MW 250
+#endif
+#ifndef MODEM_SLEEP_MW
+#define MODEM_SLEEP_MW 5
+#endif
+
+ModemPower modemPower;
+
+ModemPower::ModemPower()
+    : powered(false), lowPowerReady(false), asleep(false), stateSince(0), energyRemainderUj(0),
+      statsLock(portMUX_INITIALIZER_UNLOCKED)
+{
+    memset(channelMutex, 0, sizeof(channelMutex));
+    memset(held, 0, sizeof(held));
+    memset(echoOn, 0, sizeof(echoOn));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void ModemPower::begin()
+{
+    for (int i = 0; i < CMUX_CHANNELS; i++)
+    {
+        if (channelMutex[i] == NULL)
+        {
+            channelMutex[i] = xSemaphoreCreateMutex();
+        }
+    }
+#ifdef MODEM_DTR_PIN
+    pinMode(MODEM_DTR_PIN, OUTPUT);
+    digitalWrite(MODEM_DTR_PIN, LOW);
+#endif
+}
+
+/**
+ * @brief Take a modem channel and make sure the modem is awake
+ *
+ * @param channel Channel the caller's TinyGsm instance talks on
+ * @details The multiplexer may start or stop while the caller waits, so the lock is checked again
+ * once taken and exchanged for the one that guards the channel now.
+ *
+ * @param channel Channel the caller's TinyGsm instance talks on
+ * @param wait Ticks to wait for the mutex
+ * @return true if the channel is held by the caller and the modem answers, false if the mutex was
+ * not available or the modem did not wake
+ */
+bool ModemPower::acquire(modem_channel_t channel, TickType_t wait)
+{
+    TickType_t start = xTaskGetTickCount();
+    SemaphoreHandle_t mutex = cmux.isActive() ? channelMutex[channel] : modemMutex;
+    while (true)
+    {
+        TickType_t waited = xTaskGetTickCount() - start;
+        if (waited > wait || xSemaphoreTake(mutex, wait - waited) != pdTRUE)
+        {
+            return false;
+        }
+        SemaphoreHandle_t current = cmux.isActive() ? channelMutex[channel] : modemMutex;
+        if (current == mutex)
+        {
+            break;
+        }
+        xSemaphoreGive(mutex);
+        mutex = current;
+    }
+
+    if (asleep && !wake())
+    {
+        xSemaphoreGive(mutex);
+        return false;
+    }
+    held[channel] = mutex;
+    if (echoOn[channel] && cmux.isActive())
+    {
+        // Echo is a per-port setting, the modem's init only turned it off on the plain AT port
+        TinyGsm* channels[] = {nullptr, &modem, &gnssModem, &controlModem};
+        channels[channel]->sendAT(GF("E0"));
+        channels[channel]->waitResponse(MODEM_ECHO_TIMEOUT_MS);
+        echoOn[channel] = false;
+    }
+    return true;
+}
+
+/**
+ * @brief Let the modem sleep and give the channel back
+ */
+void ModemPower::release(modem_channel_t channel)
+{
+    SemaphoreHandle_t mutex = held[channel];
+    held[channel] = NULL;
+    if (mutex == modemMutex && lowPowerReady && !asleep)
+    {
+        sleep();
+    }
+    xSemaphoreGive(mutex);
+}
+
+/**
+ * @brief Send one of the settings for DTR sleep, PSM and eDRX
+ *
+ * @details Must be called with the modem held, after the modem's init (which turns slow clock off),
+ * with step counting up from 0 until it returns true. Each call is one AT exchange. PSM and eDRX
+ * are requests, the network may grant other values or none at all; that only affects how deep the
+ * radio sleeps, not whether DTR sleep works. Sleep starts after the last step.
+ *
+ * @param step 0 enables DTR sleep, 1 requests PSM, 2 requests eDRX
+ * @return true once there is nothing left to send
+ */
+bool ModemPower::configureLowPower(uint8_t step)
+{
+#if defined(USE_MODEM_LOW_POWER) && defined(MODEM_DTR_PIN)
+    switch (step)
+    {
+        case 0:
+            lowPowerReady = false;
+            controlModem.sendAT(GF("+CSCLK=1"));
+            if (controlModem.waitResponse() != 1)
+            {
+                safePrintln("[ModemPower] Failed to enable DTR sleep");
+                return true;
+            }
+            return false;
+
+        case 1:
+            controlModem.sendAT(GF("+CPSMS=1,,,\""), MODEM_PSM_TAU, GF("\",\""),
+                MODEM_PSM_ACTIVE_TIME, GF("\""));
+            if (controlModem.waitResponse() != 1)
+            {
+                safePrintln("[ModemPower] PSM not accepted");
+            }
+            return false;
+
+        default:
+            controlModem.sendAT(GF("+CEDRXS=1,4,\""), MODEM_EDRX_CYCLE, GF("\""));
+            if (controlModem.waitResponse() != 1)
+            {
+                safePrintln("[ModemPower] eDRX not accepted");
+            }
+            lowPowerReady = true;
+            safePrintln("[ModemPower] Low power configured (DTR sleep, PSM, eDRX)");
+            return true;
+    }
+#else
+    return true;
+#endif
+}
+
+/**
+ * @brief Switch the modem UART to the CMUX multiplexer
+ *
+ * @details Must be called with the modem held and the multiplexer not running, after the UART
+ * settings (baud rate, flow control) are final. Once the modem accepts AT+CMUX it no longer speaks
+ * plain AT, so the channels are opened before the modem is given back. Echo is turned off on each
+ * channel by the first acquire() that takes it. If the modem refuses, every channel keeps passing
+ * straight through to the UART under the shared modem mutex.
+ *
+ * @return true if the channels now run through the multiplexer
+ */
+bool ModemPower::startMultiplexer()
+{
+#ifdef USE_MODEM_CMUX
+    if (cmux.isActive())
+    {
+        return true;
+    }
+    controlModem.sendAT(GF("+CMUX=0"));
+    if (controlModem.waitResponse() != 1)
+    {
+        safePrintln("[ModemPower] Modem refused CMUX, staying on a single channel");
+        return false;
+    }
+
+    // Nobody can hold the channel locks yet, keep it that way until the new channels are set up
+    xSemaphoreTake(channelMutex[MODEM_CHANNEL_DATA], portMAX_DELAY);
+    xSemaphoreTake(channelMutex[MODEM_CHANNEL_GNSS], portMAX_DELAY);
+    for (int i = 0; i < CMUX_CHANNELS; i++)
+    {
+        echoOn[i] = true;
+    }
+    bool started = cmux.begin(MODEM_CMUX_OPEN_TIMEOUT_MS);
+    xSemaphoreGive(channelMutex[MODEM_CHANNEL_GNSS]);
+    xSemaphoreGive(channelMutex[MODEM_CHANNEL_DATA]);
+
+    if (!started)
+    {
+        safePrintln("[ModemPower] CMUX channels did not open, staying on a single channel");
+    }
+    return started;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Forget the multiplexer after the modem left it without closing it, e.g. when it rebooted
+ *
+ * @details The caller holds the control channel. The other channels' holders may still be reading
+ * their rings or writing frames, so the multiplexer is only reset once they are done; they then
+ * find it inactive and move over to the modem mutex.
+ */
+void ModemPower::multiplexerLost()
+{
+    if (!cmux.isActive())
+    {
+        // Nobody holds a channel lock, the caller has the whole modem
+        cmux.reset();
+        return;
+    }
+    xSemaphoreTake(channelMutex[MODEM_CHANNEL_DATA], portMAX_DELAY);
+    xSemaphoreTake(channelMutex[MODEM_CHANNEL_GNSS], portMAX_DELAY);
+    cmux.reset();
+    xSemaphoreGive(channelMutex[MODEM_CHANNEL_GNSS]);
+    xSemaphoreGive(channelMutex[MODEM_CHANNEL_DATA]);
+}
+
+/**
+ * @brief Record a cold boot of the modem
+ */
+void ModemPower::poweredOn()
+{
+    account();
+    multiplexerLost();
+    powered = true;
+    asleep = false;
+    lowPowerReady = false;
+    taskENTER_CRITICAL(&statsLock);
+    stats.coldBoots++;
+    taskEXIT_CRITICAL(&statsLock);
+#ifdef MODEM_DTR_PIN
+    digitalWrite(MODEM_DTR_PIN, LOW);
+#endif
+}
+
+/**
+ * @brief Record that the modem was powered off, low power must be configured again after a boot
+ */
+void ModemPower::poweredOff()
+{
+    account();
+    multiplexerLost();
+    powered = false;
+    asleep = false;
+    lowPowerReady = false;
+#ifdef MODEM_DTR_PIN
+    digitalWrite(MODEM_DTR_PIN, LOW);
+#endif
+}
+
+bool ModemPower::isLowPowerReady() const
+{
+    return lowPowerReady;
+}
+
+bool ModemPower::wake()
+{
+    account();
+    uint32_t start = millis();
+#ifdef MODEM_DTR_PIN
+    digitalWrite(MODEM_DTR_PIN, LOW);
+#endif
+    asleep = false;
+
+    bool awake = false;
+    while (millis() - start < MODEM_WAKE_TIMEOUT_MS)
+    {
+        if (controlModem.testAT(MODEM_WAKE_PROBE_MS))
+        {
+            awake = true;
+            break;
+        }
+    }
+
+    uint32_t latency = millis() - start;
+    if (!awake)
+    {
+        // Still counted as asleep, so the next acquire() probes again
+        account();
+        asleep = true;
+        taskENTER_CRITICAL(&statsLock);
+        stats.wakeFailures++;
+        taskEXIT_CRITICAL(&statsLock);
+        safePrintf("[ModemPower] Modem did not wake within %d ms\n", MODEM_WAKE_TIMEOUT_MS);
+        return false;
+    }
+
+    taskENTER_CRITICAL(&statsLock);
+    stats.wakes++;
+    stats.lastWakeLatencyMs = latency;
+    if (latency > stats.maxWakeLatencyMs)
+    {
+        stats.maxWakeLatencyMs = latency;
+    }
+    taskEXIT_CRITICAL(&statsLock);
+    return true;
+}
+
+void ModemPower::sleep()
+{
+    account();
+#ifdef MODEM_DTR_PIN
+    digitalWrite(MODEM_DTR_PIN, HIGH);
+#endif
+    asleep = true;
+}
+
+/**
+ * @brief Add the time since the last state change to the awake or asleep counters
+ */
+void ModemPower::account()
+{
+    uint32_t now = millis();
+    taskENTER_CRITICAL(&statsLock);
+    uint32_t elapsed = now - stateSince;
+    stateSince = now;
+
+    if (!powered)
+    {
+        taskEXIT_CRITICAL(&statsLock);
+        return;
+    }
+
+    uint32_t powerMw;
+    if (asleep)
+    {
+        stats.asleepMs += elapsed;
+        powerMw = MODEM_SLEEP_MW;
+    }
+    else
+    {
+        stats.awakeMs += elapsed;
+        powerMw = MODEM_AWAKE_MW;
+    }
+
+    // mW * ms = uJ, carried over so short intervals are not lost
+    uint64_t energyUj = (uint64_t)powerMw * elapsed + energyRemainderUj;
+    stats.energyMj += (uint32_t)(energyUj / 1000);
+    energyRemainderUj = (uint32_t)(energyUj % 1000);
+    taskEXIT_CRITICAL(&statsLock);
+}
+
+modem_power_stats_t ModemPower::getStats()
+{
+    account();
+    taskENTER_CRITICAL(&statsLock);
+    modem_power_stats_t copy = stats;
+    taskEXIT_CRITICAL(&statsLock);
+    return copy;
+}
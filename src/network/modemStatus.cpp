@@ -0,0 +1,221 @@
+/**
+ * @file modemStatus.cpp
+ * @brief Cached Modem Status Implementation
+ *
+ * @details The SIM state is cached without reporting enabled, the modem announces it by itself.
+ * Registration and data state are only trusted from the cache while URC reporting is on, otherwise
+ * a change would go unnoticed until the TTL runs out.
+ */
+
+#include "network/modemStatus.h"
+#include <cstdlib>
+#include <cstring>
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef MODEM_SIM_TTL_MS
+#define MODEM_SIM_TTL_MS 300000
+#endif
+#ifndef MODEM_REG_TTL_MS
+#define MODEM_REG_TTL_MS 30000
+#endif
+#ifndef MODEM_DATA_TTL_MS
+#define MODEM_DATA_TTL_MS 60000
+#endif
+#ifndef MODEM_SIGNAL_TTL_MS
+#define MODEM_SIGNAL_TTL_MS 30000
+#endif
+
+#define CSQ_UNKNOWN 99
+
+ModemStatusCache::ModemStatusCache()
+{
+    reset();
+}
+
+/**
+ * @brief Forget everything, called when the modem is powered on or off
+ */
+void ModemStatusCache::reset()
+{
+    urcReporting = false;
+    simReady = false;
+    registration = -1;
+    dataActive = false;
+    dataLost = false;
+    csq = CSQ_UNKNOWN;
+    simSince = 0;
+    registrationSince = 0;
+    dataSince = 0;
+    signalSince = 0;
+}
+
+void ModemStatusCache::setUrcReporting(bool enabled)
+{
+    urcReporting = enabled;
+}
+
+bool ModemStatusCache::fresh(uint32_t since, uint32_t now, uint32_t ttl)
+{
+    return since != 0 && now - since < ttl;
+}
+
+/**
+ * @brief Update the cache from an unsolicited result code
+ *
+ * @param urc URC name including the colon, e.g. "+CEREG:"
+ * @param args Rest of the URC line
+ * @param now Current time in milliseconds, must not be 0
+ * @return true if the URC changed the cache
+ */
+bool ModemStatusCache::onUrc(const char* urc, const char* args, uint32_t now)
+{
+    if (strcmp(urc, "+CPIN:") == 0)
+    {
+        setSimReady(strstr(args, "READY") != nullptr, now);
+        return true;
+    }
+
+    if (strcmp(urc, "+CEREG:") == 0)
+    {
+        // The URC is "<stat>[,...]" only with reporting level 1, the answer to AT+CEREG? is
+        // "<n>,<stat>[,...]"; both can end up here if a caller only waited for OK
+        const char* comma = strchr(args, ',');
+        if (comma && !urcReporting)
+        {
+            return false;
+        }
+        int stat = atoi(comma && strchr(comma + 1, ',') == nullptr ? comma + 1 : args);
+        setRegistration((int8_t)stat, now);
+        return true;
+    }
+
+    if (strcmp(urc, "+CGEV:") == 0)
+    {
+        // "NW PDN DEACT", "ME PDN DEACT", "NW DETACH" and so on; check DEACT before ACT
+        if (strstr(args, "DEACT") || strstr(args, "DETACH"))
+        {
+            dataActive = false;
+            dataLost = true;
+            dataSince = now;
+            return true;
+        }
+        if (strstr(args, "ACT"))
+        {
+            setDataActive(true, now);
+            return true;
+        }
+        return false;
+    }
+
+    if (strcmp(urc, "+CSQ:") == 0)
+    {
+        setSignal((int16_t)atoi(args), now);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Cached SIM state
+ *
+ * @return true if the cached value can be used, false if the SIM has to be queried
+ */
+bool ModemStatusCache::getSimReady(uint32_t now, bool& ready) const
+{
+    // A SIM that is not ready yet is queried again, the modem does not always announce READY
+    if (!simReady || !fresh(simSince, now, MODEM_SIM_TTL_MS))
+    {
+        return false;
+    }
+    ready = true;
+    return true;
+}
+
+void ModemStatusCache::setSimReady(bool ready, uint32_t now)
+{
+    simReady = ready;
+    simSince = now;
+}
+
+/**
+ * @brief Cached registration status, a 3GPP <stat> value
+ *
+ * @return true if the cached value can be used, false if the registration has to be queried
+ */
+bool ModemStatusCache::getRegistration(uint32_t now, int8_t& status) const
+{
+    if (!urcReporting || !fresh(registrationSince, now, MODEM_REG_TTL_MS))
+    {
+        return false;
+    }
+    status = registration;
+    return true;
+}
+
+void ModemStatusCache::setRegistration(int8_t status, uint32_t now)
+{
+    registration = status;
+    registrationSince = now;
+}
+
+/**
+ * @brief Cached data connection state
+ *
+ * @details A deactivation URC is always trusted, it reports a loss the moment it happens.
+ *
+ * @return true if the cached value can be used, false if the data connection has to be queried
+ */
+bool ModemStatusCache::getDataActive(uint32_t now, bool& active) const
+{
+    if (dataLost)
+    {
+        active = false;
+        return true;
+    }
+    if (!urcReporting || !fresh(dataSince, now, MODEM_DATA_TTL_MS))
+    {
+        return false;
+    }
+    active = dataActive;
+    return true;
+}
+
+void ModemStatusCache::setDataActive(bool active, uint32_t now)
+{
+    dataActive = active;
+    dataLost = false;
+    dataSince = now;
+}
+
+/**
+ * @brief Whether a deactivation URC arrived since the data state was last set
+ */
+bool ModemStatusCache::isDataLost() const
+{
+    return dataLost;
+}
+
+/**
+ * @brief Cached signal quality, CSQ 0..31 or 99 for unknown
+ *
+ * @return true if the cached value can be used, false if the signal has to be queried
+ */
+bool ModemStatusCache::getSignal(uint32_t now, int16_t& value) const
+{
+    if (!fresh(signalSince, now, MODEM_SIGNAL_TTL_MS))
+    {
+        return false;
+    }
+    value = csq;
+    return true;
+}
+
+void ModemStatusCache::setSignal(int16_t value, uint32_t now)
+{
+    csq = value;
+    signalSince = now;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file modemTransport.cpp
+ * @brief Modem UART Transport Implementation
+ *
+ * @details Reception is done by the ESP-IDF UART driver: the RX FIFO interrupt moves bytes into
+ * the driver's ring buffer and posts to its event queue, so the modem can burst a whole HTTPS
+ * chunk while the reading task is busy. The ring is sized by MODEM_RX_BUFFER_SIZE instead of the
+ * 256 byte Arduino default. With RTS/CTS the modem is also throttled before the ring overflows.
+ */
+
+#include "network/modemTransport.h"
+#include "config.h"
+#include "utilities.h"
+
+#define MODEM_TX_BUFFER_SIZE 1024
+#define MODEM_FLOW_CTRL_THRESHOLD 64 // RX FIFO level at which RTS is raised
+
+ModemTransport modemTransport(SerialAT);
+
+ModemTransport::ModemTransport(HardwareSerial& serial)
+    : serial(serial), started(false), currentBaud(0), bytesIn(0), bytesOut(0), rxOverflows(0),
+      rxErrors(0)
+{
+}
+
+/**
+ * @brief Open the UART, buffer sizes can only be changed before the first begin
+ *
+ * @param baud Rate the modem currently uses
+ */
+void ModemTransport::begin(uint32_t baud)
+{
+    if (started)
+    {
+        setBaud(baud);
+        return;
+    }
+
+    serial.setRxBufferSize(MODEM_RX_BUFFER_SIZE);
+    serial.setTxBufferSize(MODEM_TX_BUFFER_SIZE);
+    serial.onReceiveError([this](hardwareSerial_error_t error) {
+        if (error == UART_BUFFER_FULL_ERROR || error == UART_FIFO_OVF_ERROR)
+        {
+            rxOverflows.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (error != UART_NO_ERROR)
+        {
+            rxErrors.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    serial.begin(baud, SERIAL_8N1, MODEM_RX_PIN, MODEM_TX_PIN);
+#if defined(MODEM_RTS_PIN) && defined(MODEM_CTS_PIN)
+    serial.setPins(MODEM_RX_PIN, MODEM_TX_PIN, MODEM_CTS_PIN, MODEM_RTS_PIN);
+    serial.setHwFlowCtrlMode(HW_FLOWCTRL_CTS_RTS, MODEM_FLOW_CTRL_THRESHOLD);
+#endif
+    currentBaud = baud;
+    started = true;
+}
+
+/**
+ * @brief Change the local baud rate, the modem has to be switched first with AT+IPR
+ */
+void ModemTransport::setBaud(uint32_t baud)
+{
+    if (baud == currentBaud)
+    {
+        return;
+    }
+    serial.flush();
+    serial.updateBaudRate(baud);
+    currentBaud = baud;
+}
+
+uint32_t ModemTransport::getBaud() const
+{
+    return currentBaud;
+}
+
+bool ModemTransport::hasFlowControl() const
+{
+#if defined(MODEM_RTS_PIN) && defined(MODEM_CTS_PIN)
+    return true;
+#else
+    return false;
+#endif
+}
+
+modem_transport_stats_t ModemTransport::getStats() const
+{
+    modem_transport_stats_t copy;
+    copy.baud = currentBaud;
+    copy.bytesIn = bytesIn.load(std::memory_order_relaxed);
+    copy.bytesOut = bytesOut.load(std::memory_order_relaxed);
+    copy.rxOverflows = rxOverflows.load(std::memory_order_relaxed);
+    copy.rxErrors = rxErrors.load(std::memory_order_relaxed);
+    return copy;
+}
+
+int ModemTransport::available()
+{
+    return serial.available();
+}
+
+int ModemTransport::read()
+{
+    int c = serial.read();
+    if (c >= 0)
+    {
+        bytesIn.fetch_add(1, std::memory_order_relaxed);
+    }
+    return c;
+}
+
+int ModemTransport::peek()
+{
+    return serial.peek();
+}
+
+void ModemTransport::flush()
+{
+    serial.flush();
+}
+
+int ModemTransport::availableForWrite()
+{
+    return serial.availableForWrite();
+}
+
+size_t ModemTransport::write(uint8_t c)
+{
+    size_t n = serial.write(c);
+    bytesOut.fetch_add(n, std::memory_order_relaxed);
+    return n;
+}
+
+size_t ModemTransport::write(const uint8_t* buffer, size_t size)
+{
+    size_t n = serial.write(buffer, size);
+    bytesOut.fetch_add(n, std::memory_order_relaxed);
+    return n;
+}
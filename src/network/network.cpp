@@ -1,48 +1,296 @@
 #include "network/network.h"
+#include "network/cmux.h"
+#include "network/modemPower.h"
+#include "network/modemStatus.h"
+#include "network/modemTransport.h"
 #include "config.h"
 #include "utilities.h"
 #include "utils/threadsafe_serial.h"
 #include <Arduino.h>
+#include <Preferences.h>
 #include <TinyGSM.h>
 #include <WiFi.h>
 #include <cstdint>
+#include <cstring>
 #include <sys/types.h>
 
 extern TinyGsm modem;
+extern TinyGsm gnssModem;
+extern TinyGsm controlModem;
 extern EventGroupHandle_t networkEventGroup;
-// extern SemaphoreHandle_t modemMutex;
 extern SemaphoreHandle_t networkEventMutex;
+extern QueueHandle_t httpQueue;
 #define NETWORK_CONNECTED_BIT BIT0
 
-Network::Network() : wifiConnected(false), lteConnected(false), modemEnabled(false) {}
+#define NETWORK_STEP_MS 100         // between steps while a link is being set up
+#define NETWORK_IDLE_POLL_MS 10000  // while the link is stable, WiFi events wake the task earlier
+#define NETWORK_AT_TIMEOUT_MS 300   // per modem query within one step
 
-void Network::begin()
+#define MIN_WIFI_ATTEMPTS 3         // failed WiFi attempts before LTE is tried
+#define WIFI_SCAN_TIMEOUT_MS 8000
+#define WIFI_CONNECT_TIMEOUT_MS 10000
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 3000 // direct connect to the cached BSSID before scanning
+#define WIFI_RETRY_MS 5000          // between WiFi attempts while offline
+#define WIFI_RESCAN_MS 30000        // between WiFi attempts while on LTE
+
+#define WIFI_RSSI_POLL_MS 2000      // RSSI sampling while connected
+
+#define LTE_RETRY_COOLDOWN_MS 60000
+#define LTE_BOOT_WAIT_MS 3000
+#define LTE_PROBE_ATTEMPTS 10
+#define LTE_SIM_ATTEMPTS 10
+#define LTE_REG_TIMEOUT_MS 60000    // from modem power-on until registered
+#define LTE_POLL_MS 1000            // between SIM, registration and AT probes
+#define LTE_CHECK_MS 10000          // between data connection checks once connected
+#define LTE_SETUP_ATTEMPTS 3        // per modem setup command
+#define LTE_ACTIVATE_TIMEOUT_MS 30000 // AT+CGACT until its final result
+#define LTE_NETOPEN_TIMEOUT_MS 75000  // AT+NETOPEN until the service is open, as AT+CIPTIMEOUT
+
+/**
+ * @brief Settings made once the modem answers, those of TinyGSM's init() and the network mode
+ *
+ * @details init() also waits for the SIM, which LTE_STATE_SIM_WAIT polls instead.
+ */
+static const char* const MODEM_INIT_COMMANDS[] = {
+    "E0",
+#ifdef TINY_GSM_DEBUG
+    "+CMEE=2",
+#else
+    "+CMEE=0",
+#endif
+    "+CTZR=0", // no time zone URCs
+    "+CTZU=1", // but keep the clock updated from the network
+#ifndef TINY_GSM_MODEM_SIM7672
+    "+CNMP=2", // MODEM_NETWORK_AUTO
+#endif
+};
+
+/**
+ * @brief URCs that feed the modem status cache
+ *
+ * @details The cache relies on the first STATUS_URCS_REQUIRED. Signal reports only save queries,
+ * CSQ is still polled when the cached value expires.
+ */
+static const char* const STATUS_URC_COMMANDS[] = {"+CEREG=1", "+CGEREP=2,1", "+AUTOCSQ=1,1"};
+#define STATUS_URCS_REQUIRED 2
+
+/**
+ * @brief Socket service settings, those TinyGSM's gprsConnect() makes after the APN
+ */
+static const char* const SOCKET_SETUP_COMMANDS[] = {
+    "+CIPMODE=0",                  // command mode
+    "+CIPSENDMODE=0",              // send without waiting for the peer's TCP ACK
+    "+CIPCCFG=10,0,0,0,1,0,75000", // retries, +RECEIVE headers, synchronous commands
+    "+CIPTIMEOUT=75000,15000,15000",
+};
+
+#define COMMAND_COUNT(commands) ((uint8_t)(sizeof(commands) / sizeof((commands)[0])))
+
+static const char* regStatusName(RegStatus status)
 {
-    safePrintln("[Network] Network hardware initialized (WiFi ready, LTE modem on-demand)");
+    switch (status)
+    {
+        case REG_NO_RESULT:
+            return "REG_NO_RESULT";
+        case REG_UNREGISTERED:
+            return "REG_UNREGISTERED";
+        case REG_SEARCHING:
+            return "REG_SEARCHING";
+        case REG_DENIED:
+            return "REG_DENIED";
+        case REG_OK_HOME:
+            return "REG_OK_HOME";
+        case REG_OK_ROAMING:
+            return "REG_OK_ROAMING";
+#ifdef TINY_GSM_MODEM_SIM7672
+        case REG_SMS_ONLY:
+            return "REG_SMS_ONLY";
+#endif
+        default:
+            return "UNKNOWN";
+    }
 }
 
-bool Network::connectWiFi(const char* ssid, const char* password)
+/**
+ * @brief Query the SIM state with a single AT+CPIN? round trip
+ *
+ * @details getSimStatus() retries internally for up to its timeout, which would block the step.
+ */
+static bool isSimReady()
 {
+    controlModem.sendAT(GF("+CPIN?"));
+    if (controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS, GF("+CPIN:")) != 1)
+    {
+        return false;
+    }
+    int8_t status = controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS, GF("READY"), GF("SIM PIN"),
+        GF("SIM PUK"), GF("NOT INSERTED"), GF("NOT READY"));
+    controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS);
+    return status == 1;
+}
+
+/**
+ * @brief Query the socket service with a single AT+NETOPEN? round trip
+ */
+static bool isNetworkOpen()
+{
+    controlModem.sendAT(GF("+NETOPEN?"));
+    int8_t status =
+        controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS, GF(GSM_NL "+NETOPEN: 1"), GFP(GSM_OK));
+    if (status == 1)
+    {
+        controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS);
+    }
+    return status == 1;
+}
+
+/**
+ * @brief Move the modem UART to MODEM_BAUD_RATE
+ *
+ * @details The rate change and its check stay in one step: until the check, another task taking
+ * the modem could be talking at a rate the modem is not using.
+ *
+ * @return false if the modem answers at neither rate afterwards
+ */
+static bool raiseModemBaud()
+{
+    if (modemTransport.getBaud() == MODEM_BAUD_RATE)
+    {
+        return true;
+    }
+
+    controlModem.sendAT(GF("+IPR="), MODEM_BAUD_RATE);
+    if (controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS) != 1)
+    {
+        safePrintln("[Network] Modem refused baud rate change");
+        return true;
+    }
+    modemTransport.setBaud(MODEM_BAUD_RATE);
+    if (controlModem.testAT(NETWORK_AT_TIMEOUT_MS))
+    {
+        safePrintf("[Network] Modem UART at %d baud\n", MODEM_BAUD_RATE);
+        return true;
+    }
+    modemTransport.setBaud(MODEM_BAUD_DEFAULT);
+    return controlModem.testAT(NETWORK_AT_TIMEOUT_MS);
+}
+
+static void statusUrcHandler(const char* urc, const char* args)
+{
+    network.onModemUrc(urc, args);
+}
+
+#define FAST_CONNECT_NAMESPACE "network"
+#define FAST_CONNECT_KEY "wifi_fast"
+
+static void wifiEventHandler(arduino_event_id_t event)
+{
+    network.onWiFiEvent();
+}
+
+Network::Network()
+    : wifiState(WIFI_STATE_IDLE), lteState(LTE_STATE_OFF), wifiStateSince(0), wifiAttemptStart(0),
+      lteStateSince(0), wifiAttempts(0), lteRetries(0), powerStep(0), setupStep(0),
+      commandPending(false), commandSince(0), urcReporting(false), lastLteAttempt(0),
+      lastLteCheck(0),
+      outageSince(0), lteConnected(false), modemEnabled(false), connectedBitSet(false),
+      connectedBitValid(false), fastConnectValid(false), fastAttempt(false), lteUsers(0),
+      lastUplink(TRANSPORT_NONE), statusLock(portMUX_INITIALIZER_UNLOCKED),
+      uplinkLock(portMUX_INITIALIZER_UNLOCKED), ownerTask(nullptr)
+{
+    memset(&metrics, 0, sizeof(metrics));
+    memset(&fastConnect, 0, sizeof(fastConnect));
+}
+
+/**
+ * @brief Initialize the network manager
+ *
+ * @details Must be called from the task that calls maintainConnection(). WiFi events wake that
+ * task so that connects and disconnects are handled without waiting for the next poll.
+ */
+void Network::begin()
+{
+    ownerTask = xTaskGetCurrentTaskHandle();
+    modemPower.begin();
+    // The modem may report on any channel, so every instance feeds the status cache
+    modem.setStatusUrcCallback(statusUrcHandler);
+    gnssModem.setStatusUrcCallback(statusUrcHandler);
+    controlModem.setStatusUrcCallback(statusUrcHandler);
+    WiFi.mode(WIFI_STA);
+    WiFi.onEvent(wifiEventHandler, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    WiFi.onEvent(wifiEventHandler, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    WiFi.onEvent(wifiEventHandler, ARDUINO_EVENT_WIFI_SCAN_DONE);
+    outageSince = millis();
+    handover.begin(outageSince);
+
+#ifdef USE_WIFI_FAST_CONNECT
+    Preferences prefs;
+    if (prefs.begin(FAST_CONNECT_NAMESPACE, true))
+    {
+        fastConnectValid = prefs.getBytes(FAST_CONNECT_KEY, &fastConnect, sizeof(fastConnect)) ==
+            sizeof(fastConnect);
+        prefs.end();
+    }
 #if DEBUG
-    safePrintln("NETWORK: Connecting to WiFi...");
+    safePrintf("[Network] Fast connect cache %s\n", fastConnectValid ? "loaded" : "empty");
 #endif
-    WiFi.begin(ssid, password);
-    uint32_t start = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - start < 10000)
+#endif
+
+    safePrintln("[Network] Network hardware initialized (WiFi ready, LTE modem on-demand)");
+}
+
+/**
+ * @brief Feed a status URC into the cache, called from waitResponse() of any modem channel
+ *
+ * @details Under CMUX the data, GNSS and control channels are read by different tasks, each
+ * holding only its own channel, so the cache is updated under statusLock. A lost data connection
+ * wakes the network task so that LTE is failed over at once instead of at the next periodic check.
+ */
+void Network::onModemUrc(const char* urc, const char* args)
+{
+    uint32_t now = millis();
+    taskENTER_CRITICAL(&statusLock);
+    bool changed = modemStatus.onUrc(urc, args, now);
+    if (changed)
+    {
+        metrics.statusUrcs++;
+    }
+    bool dataLost = modemStatus.isDataLost();
+    taskEXIT_CRITICAL(&statusLock);
+
+    if (!changed)
     {
-        vTaskDelay(pdMS_TO_TICKS(500));
+        return;
     }
-    wifiConnected = (WiFi.status() == WL_CONNECTED);
 #if DEBUG
-    safePrintln("NETWORK: Connected to WiFI.");
+    safePrintf("[Network] URC %s%s\n", urc, args);
 #endif
-    return wifiConnected;
+    if (dataLost && ownerTask)
+    {
+        xTaskNotifyGive(ownerTask);
+    }
+}
+
+/**
+ * @brief Wake the network task, called from the WiFi event task
+ */
+void Network::onWiFiEvent()
+{
+    if (ownerTask)
+    {
+        xTaskNotifyGive(ownerTask);
+    }
 }
 
 void Network::disconnectWiFi()
 {
     WiFi.disconnect();
-    wifiConnected = false;
+    if (wifiState == WIFI_STATE_CONNECTED)
+    {
+        handover.onWiFiLost(millis());
+    }
+    wifiState = WIFI_STATE_IDLE;
+    wifiStateSince = millis();
 }
 
 bool Network::isWiFiConnected() const
@@ -50,324 +298,969 @@ bool Network::isWiFiConnected() const
     return WiFi.status() == WL_CONNECTED;
 }
 
-bool Network::enableModem()
+/**
+ * @brief Connect straight to the last good access point, skipping the scan
+ *
+ * @return true if a fast connect was started
+ */
+bool Network::startFastConnect(const char* ssid, const char* password)
 {
-    if (modemEnabled)
+#ifdef USE_WIFI_FAST_CONNECT
+    if (!fastConnectValid || strcmp(fastConnect.ssid, ssid) != 0)
     {
-#if DEBUG
-        safePrintln("[Network] Modem already enabled");
+        return false;
+    }
+
+#ifdef WIFI_REUSE_IP_CONFIG
+    if (fastConnect.ip != 0)
+    {
+        WiFi.config(IPAddress(fastConnect.ip), IPAddress(fastConnect.gateway),
+            IPAddress(fastConnect.subnet), IPAddress(fastConnect.dns));
+    }
 #endif
-        return true;
+    WiFi.begin(ssid, password, fastConnect.channel, fastConnect.bssid);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Store the current association if it differs from the cached one
+ *
+ * @details NVS is only written when the access point, channel or address changed.
+ */
+void Network::rememberAssociation(const char* ssid)
+{
+#ifdef USE_WIFI_FAST_CONNECT
+    wifi_fast_connect_t current;
+    memset(&current, 0, sizeof(current));
+    strncpy(current.ssid, ssid, sizeof(current.ssid) - 1);
+    const uint8_t* bssid = WiFi.BSSID();
+    if (bssid)
+    {
+        memcpy(current.bssid, bssid, sizeof(current.bssid));
     }
+    current.channel = WiFi.channel();
+    current.ip = (uint32_t)WiFi.localIP();
+    current.gateway = (uint32_t)WiFi.gatewayIP();
+    current.subnet = (uint32_t)WiFi.subnetMask();
+    current.dns = (uint32_t)WiFi.dnsIP();
 
-    safePrintln("[Network] Initializing modem...");
+    if (fastConnectValid && memcmp(&current, &fastConnect, sizeof(current)) == 0)
+    {
+        return;
+    }
 
-#ifdef BOARD_POWERON_PIN
-    pinMode(BOARD_POWERON_PIN, OUTPUT);
-    digitalWrite(BOARD_POWERON_PIN, HIGH);
+    fastConnect = current;
+    fastConnectValid = true;
+
+    Preferences prefs;
+    if (prefs.begin(FAST_CONNECT_NAMESPACE, false))
+    {
+        prefs.putBytes(FAST_CONNECT_KEY, &fastConnect, sizeof(fastConnect));
+        prefs.end();
+    }
 #if DEBUG
-    safePrintln("[Network] Modem power enabled");
+    safePrintf("[Network] Fast connect cache updated, channel %d\n", fastConnect.channel);
 #endif
 #endif
+}
 
-#ifdef MODEM_RESET_PIN
-    pinMode(MODEM_RESET_PIN, OUTPUT);
-    digitalWrite(MODEM_RESET_PIN, LOW);
-    vTaskDelay(pdMS_TO_TICKS(10));
-    digitalWrite(MODEM_RESET_PIN, HIGH);
-#if DEBUG
-    safePrintln("[Network] Modem reset sequence completed");
+void Network::forgetAssociation()
+{
+#ifdef USE_WIFI_FAST_CONNECT
+    fastConnectValid = false;
+
+    Preferences prefs;
+    if (prefs.begin(FAST_CONNECT_NAMESPACE, false))
+    {
+        prefs.remove(FAST_CONNECT_KEY);
+        prefs.end();
+    }
+#ifdef WIFI_REUSE_IP_CONFIG
+    // Back to DHCP for the full scan path
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
 #endif
 #endif
+}
+
+/**
+ * @brief Advance the WiFi state machine by one step
+ *
+ * @return Milliseconds until the WiFi side wants the next step
+ */
+uint32_t Network::stepWiFi(const char* ssid, const char* password, uint32_t now)
+{
+    bool linkUp = isWiFiConnected();
+
+    // The station reconnected on its own (auto-reconnect), account for it as a connect
+    if (linkUp && (wifiState == WIFI_STATE_IDLE || wifiState == WIFI_STATE_SCANNING))
+    {
+        if (wifiState == WIFI_STATE_SCANNING)
+        {
+            WiFi.scanDelete();
+        }
+        wifiState = WIFI_STATE_CONNECTING;
+    }
 
-    pinMode(BOARD_PWRKEY_PIN, OUTPUT);
-    digitalWrite(BOARD_PWRKEY_PIN, LOW);
-    vTaskDelay(pdMS_TO_TICKS(100));
-    digitalWrite(BOARD_PWRKEY_PIN, HIGH);
-    vTaskDelay(pdMS_TO_TICKS(100));
-    digitalWrite(BOARD_PWRKEY_PIN, LOW);
+    switch (wifiState)
+    {
+        case WIFI_STATE_IDLE:
+        {
+            uint32_t retryMs = lteState == LTE_STATE_CONNECTED ? WIFI_RESCAN_MS : WIFI_RETRY_MS;
+            if (wifiAttempts > 0 && now - wifiStateSince < retryMs)
+            {
+                return retryMs - (now - wifiStateSince);
+            }
+
+            if (startFastConnect(ssid, password))
+            {
 #if DEBUG
-    safePrintln("[Network] Modem power key sequence completed");
+                safePrintf("[Network] Fast connecting on channel %d\n", fastConnect.channel);
 #endif
-
-    SerialAT.begin(115200, SERIAL_8N1, MODEM_RX_PIN, MODEM_TX_PIN);
+                fastAttempt = true;
+                wifiState = WIFI_STATE_CONNECTING;
+                wifiStateSince = now;
+                wifiAttemptStart = now;
+                return NETWORK_STEP_MS;
+            }
 #if DEBUG
-    safePrintln("[Network] Modem serial initialized at 115200 baud");
+            safePrintln("[Network] WiFi not connected, scanning for networks...");
 #endif
+            WiFi.scanNetworks(true, false, false, 300, 0, ssid);
+            wifiState = WIFI_STATE_SCANNING;
+            wifiStateSince = now;
+            wifiAttemptStart = now;
+            return NETWORK_STEP_MS;
+        }
 
-    vTaskDelay(pdMS_TO_TICKS(3000));
+        case WIFI_STATE_SCANNING:
+        {
+            int16_t found = WiFi.scanComplete();
+            if (found == WIFI_SCAN_RUNNING && now - wifiStateSince < WIFI_SCAN_TIMEOUT_MS)
+            {
+                return NETWORK_STEP_MS;
+            }
+            WiFi.scanDelete();
 
+            if (found > 0)
+            {
 #if DEBUG
-    safePrintln("[Network] Testing modem responsiveness...");
+                safePrintln("[Network] Target WiFi network found, attempting connection...");
 #endif
-    int attempts = 0;
-    while (attempts < 10 && !modem.testAT(1000))
-    {
+                WiFi.begin(ssid, password);
+                wifiState = WIFI_STATE_CONNECTING;
+                wifiStateSince = now;
+                return NETWORK_STEP_MS;
+            }
+
+            if (wifiAttempts < UINT8_MAX)
+            {
+                wifiAttempts++;
+            }
 #if DEBUG
-        safePrintf("[Network] Modem not responding, attempt %d\n", attempts + 1);
+            safePrintf("[Network] WiFi network not found, scan attempt %d of %d\n", wifiAttempts, MIN_WIFI_ATTEMPTS);
 #endif
-        attempts++;
-        if (attempts > 3)
-        {
-            // Try power cycle if initial attempts fail
-            digitalWrite(BOARD_PWRKEY_PIN, LOW);
-            vTaskDelay(pdMS_TO_TICKS(100));
-            digitalWrite(BOARD_PWRKEY_PIN, HIGH);
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            digitalWrite(BOARD_PWRKEY_PIN, LOW);
-            vTaskDelay(pdMS_TO_TICKS(1000));
+            wifiState = WIFI_STATE_IDLE;
+            wifiStateSince = now;
+            return NETWORK_STEP_MS;
         }
-        else
+
+        case WIFI_STATE_CONNECTING:
+            if (linkUp)
+            {
+                metrics.wifiConnects++;
+                if (fastAttempt)
+                {
+                    metrics.fastConnects++;
+                }
+                metrics.lastWifiConnectMs = now - wifiAttemptStart;
+                safePrintf("[Network] WiFi connected in %lu ms%s\n", metrics.lastWifiConnectMs,
+                    fastAttempt ? " (fast connect)" : "");
+                fastAttempt = false;
+                rememberAssociation(ssid);
+                handover.onWiFiConnected(WiFi.RSSI());
+                wifiAttempts = 0;
+                wifiState = WIFI_STATE_CONNECTED;
+                wifiStateSince = now;
+                return NETWORK_STEP_MS;
+            }
+            if (now - wifiStateSince < (fastAttempt ? WIFI_FAST_CONNECT_TIMEOUT_MS : WIFI_CONNECT_TIMEOUT_MS))
+            {
+                return NETWORK_STEP_MS;
+            }
+            WiFi.disconnect();
+
+            if (fastAttempt)
+            {
+                // The access point moved or is gone, fall back to a full scan right away
+                safePrintln("[Network] Fast connect failed, falling back to scan");
+                metrics.fastConnectFailures++;
+                fastAttempt = false;
+                forgetAssociation();
+                WiFi.scanNetworks(true, false, false, 300, 0, ssid);
+                wifiState = WIFI_STATE_SCANNING;
+                wifiStateSince = now;
+                return NETWORK_STEP_MS;
+            }
+            if (wifiAttempts < UINT8_MAX)
+            {
+                wifiAttempts++;
+            }
+            metrics.wifiFailures++;
+#if DEBUG
+            safePrintf("[Network] WiFi connection failed, attempt %d of %d\n", wifiAttempts, MIN_WIFI_ATTEMPTS);
+#endif
+            wifiState = WIFI_STATE_IDLE;
+            wifiStateSince = now;
+            return NETWORK_STEP_MS;
+
+        case WIFI_STATE_CONNECTED:
         {
-            vTaskDelay(pdMS_TO_TICKS(1000));
+            if (!linkUp)
+            {
+                safePrintln("[Network] WiFi connection lost");
+                WiFi.disconnect();
+                wifiState = WIFI_STATE_IDLE;
+                wifiStateSince = now;
+                handover.onWiFiLost(now);
+                return NETWORK_STEP_MS;
+            }
+
+            bool changed = handover.updateRssi(WiFi.RSSI());
+            taskENTER_CRITICAL(&uplinkLock);
+            linkScorer.updateSignal(TRANSPORT_WIFI, handover.getRssi());
+            taskEXIT_CRITICAL(&uplinkLock);
+
+            if (changed)
+            {
+                safePrintf("[Network] WiFi signal %s (%d dBm)\n",
+                    handover.isDegraded() ? "degraded" : "recovered", handover.getRssi());
+            }
+            return WIFI_RSSI_POLL_MS;
         }
     }
 
-    if (attempts >= 10)
+    return NETWORK_STEP_MS;
+}
+
+/**
+ * @brief Run the modem power-on sequence one pin change at a time
+ *
+ * @return true once the sequence is complete and the boot wait has elapsed
+ */
+bool Network::stepPowerSequence(uint32_t now)
+{
+    uint32_t elapsed = now - lteStateSince;
+
+    switch (powerStep)
     {
-        safePrintln("[Network] Modem failed to respond to AT commands after 10 attempts");
-        return false;
-    }
-#if DEBUG
-    safePrintln("[Network] Modem is responding to AT commands");
+        case 0:
+#ifdef BOARD_POWERON_PIN
+            pinMode(BOARD_POWERON_PIN, OUTPUT);
+            digitalWrite(BOARD_POWERON_PIN, HIGH);
+#endif
+#ifdef MODEM_RESET_PIN
+            pinMode(MODEM_RESET_PIN, OUTPUT);
+            digitalWrite(MODEM_RESET_PIN, LOW);
 #endif
+            powerStep = 1;
+            lteStateSince = now;
+            return false;
 
-    if (!modem.init())
-    {
-        safePrintln("[Network] Failed to initialize modem");
-        return false;
-    }
+        case 1: // reset pulse
+            if (elapsed < 10)
+            {
+                return false;
+            }
+#ifdef MODEM_RESET_PIN
+            digitalWrite(MODEM_RESET_PIN, HIGH);
+#endif
+            pinMode(BOARD_PWRKEY_PIN, OUTPUT);
+            digitalWrite(BOARD_PWRKEY_PIN, LOW);
+            powerStep = 2;
+            lteStateSince = now;
+            return false;
 
+        case 2: // power key pulse
+            if (elapsed < 100)
+            {
+                return false;
+            }
+            digitalWrite(BOARD_PWRKEY_PIN, HIGH);
+            powerStep = 3;
+            lteStateSince = now;
+            return false;
+
+        case 3:
+            if (elapsed < 100)
+            {
+                return false;
+            }
+            digitalWrite(BOARD_PWRKEY_PIN, LOW);
+            modemTransport.begin(MODEM_BAUD_DEFAULT);
+            modemPower.poweredOn();
+            resetModemStatus();
 #if DEBUG
-    String name = modem.getModemName();
-    String info = modem.getModemInfo();
-    safePrintf("[Network] Modem Name: %s\n", name.c_str());
-    safePrintf("[Network] Modem Info: %s\n", info.c_str());
+            safePrintln("[Network] Modem power key sequence completed");
 #endif
+            powerStep = 4;
+            lteStateSince = now;
+            return false;
 
-#ifndef TINY_GSM_MODEM_SIM7672
-    if (!modem.setNetworkMode(MODEM_NETWORK_AUTO))
-    {
-        safePrintln("[Network] setNetworkMode failed");
-        return false;
+        default: // boot wait
+            return elapsed >= LTE_BOOT_WAIT_MS;
     }
-#if DEBUG
-    safePrintln("[Network] Network mode set to AUTO");
-#endif
-#endif
+}
 
-    safePrintln("[Network] Modem initialization completed successfully");
-    modemEnabled = true;
-    return true;
+/**
+ * @brief Start bringing up LTE
+ *
+ * @details A modem parked in low power is still booted and registered, so it skips the power
+ * sequence and goes straight to probing, which wakes it.
+ */
+void Network::startLTE(uint32_t now)
+{
+    safePrintf("[Network] Bringing up LTE (%s)...\n",
+        wifiState == WIFI_STATE_CONNECTED ? "WiFi degraded" : "WiFi unavailable");
+    lastLteAttempt = now;
+    lteRetries = 0;
+    powerStep = 0;
+    setLteState(modemEnabled ? LTE_STATE_PROBING : LTE_STATE_POWERING, now);
 }
 
-bool Network::disableModem()
+/**
+ * @brief Give up on the current LTE attempt and power the modem down
+ */
+void Network::failLTE(const char* reason)
 {
-    if (!modemEnabled)
+    safePrintf("[Network] LTE connection failed: %s, will retry after cooldown period\n", reason);
+    metrics.lteFailures++;
+    disableModem();
+    lteConnected = false;
+    setLteState(LTE_STATE_OFF, millis());
+}
+
+/**
+ * @brief Enter an LTE state with its first setup command
+ *
+ * @details A command left pending is dropped with the state. The modem is then either powered off
+ * or parked, and a late result is discarded with the URCs of the next step.
+ */
+void Network::setLteState(LteState state, uint32_t now)
+{
+    lteState = state;
+    lteStateSince = now;
+    setupStep = 0;
+    commandPending = false;
+}
+
+/**
+ * @brief Send one modem setup command and count the attempt if it is refused
+ *
+ * @details A refused command is sent again on a later step, LTE_POLL_MS apart. After
+ * LTE_SETUP_ATTEMPTS the LTE attempt is given up.
+ *
+ * @return true if the modem answered OK
+ */
+bool Network::sendSetupCommand(const char* command, uint32_t now)
+{
+    controlModem.sendAT(command);
+    if (controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS) == 1)
     {
-        safePrintln("[Network] Modem already disabled");
+        lteRetries = 0;
         return true;
     }
-
-    safePrintln("[Network] Disabling modem...");
-
-    if (modem.isGprsConnected())
+    lteRetries++;
+    lteStateSince = now;
+    safePrintf("[Network] Modem refused AT%s, attempt %d\n", command, lteRetries);
+    if (lteRetries >= LTE_SETUP_ATTEMPTS)
     {
-        modem.gprsDisconnect();
-        safePrintln("[Network] GPRS disconnected");
+        failLTE("modem setup");
     }
+    return false;
+}
 
-    safePrintln("[Network] Powering down modem...");
-    modem.poweroff();
-
-    safePrintln("[Network] Modem disabled successfully");
-    modemEnabled = false;
-    return true;
+/**
+ * @brief The data connection is up, hand LTE to the uplink
+ */
+void Network::completeLTE(uint32_t now)
+{
+    lteConnected = true;
+    taskENTER_CRITICAL(&statusLock);
+    modemStatus.setDataActive(true, now);
+    taskEXIT_CRITICAL(&statusLock);
+    metrics.lteConnects++;
+    metrics.lastLteConnectMs = now - lastLteAttempt;
+    safePrintf("[Network] LTE connection established in %lu ms\n", metrics.lastLteConnectMs);
+    lteRetries = 0;
+    setLteState(LTE_STATE_CONNECTED, now);
+    lastLteCheck = now;
 }
 
-bool Network::connectLTE(const char* apn)
+/**
+ * @brief Advance the LTE state machine by one step
+ *
+ * @details Each step issues at most one modem command, under the modem mutex. If another task is
+ * using the modem the step is skipped and retried later.
+ *
+ * @return Milliseconds until the LTE side wants the next step
+ */
+uint32_t Network::stepLTE(const char* apn, uint32_t now)
 {
-    safePrintln("[Network] Attempting LTE connection...");
+    bool wifiConnected = wifiState == WIFI_STATE_CONNECTED;
+    bool wanted = handover.isLteWanted(now, wifiConnected, wifiAttempts >= MIN_WIFI_ATTEMPTS);
 
-    if (!enableModem())
+    if (lteState == LTE_STATE_OFF)
     {
-        safePrintln("[Network] Failed to enable modem for LTE connection");
-        return false;
+        if (!wanted)
+        {
+            return NETWORK_IDLE_POLL_MS;
+        }
+        // The cooldown is for failed attempts, a parked modem can be woken at any time
+        if (!modemEnabled && lastLteAttempt != 0 && now - lastLteAttempt < LTE_RETRY_COOLDOWN_MS)
+        {
+            return LTE_RETRY_COOLDOWN_MS - (now - lastLteAttempt);
+        }
+        if (wifiState == WIFI_STATE_CONNECTED)
+        {
+            metrics.lteWarmups++;
+        }
+        startLTE(now);
+        return NETWORK_STEP_MS;
     }
 
-    safePrintln("[Network] Checking SIM status...");
-    int simRetries = 0;
-    while (simRetries < 10 && modem.getSimStatus() != SIM_READY)
+    // Break only after make: WiFi has been good for a while, nothing is in flight on LTE and the
+    // send queue has drained
+    if (handover.canReleaseLte(now, wifiConnected))
     {
-#if DEBUG
-        safePrintf("[Network] SIM not ready, waiting... attempt %d\n", simRetries + 1);
-#endif
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        simRetries++;
+        if (getLteUsers() > 0 || (httpQueue && uxQueueMessagesWaiting(httpQueue) > 0))
+        {
+            return NETWORK_STEP_MS;
+        }
+        if (!modemPower.acquire(MODEM_CHANNEL_CONTROL, 0))
+        {
+            return NETWORK_STEP_MS;
+        }
+        if (modemPower.isLowPowerReady())
+        {
+            // Keep registration and the data context, release() lets the modem sleep
+            safePrintln("[Network] WiFi connected, parking LTE modem in low power");
+            lteConnected = false;
+        }
+        else
+        {
+            safePrintln("[Network] WiFi connected, disabling LTE modem to save power");
+            if (lteState == LTE_STATE_CONNECTED)
+            {
+                disconnectLTE();
+            }
+            disableModem();
+        }
+        setLteState(LTE_STATE_OFF, now);
+        modemPower.release(MODEM_CHANNEL_CONTROL);
+        return NETWORK_IDLE_POLL_MS;
     }
 
-    if (modem.getSimStatus() != SIM_READY)
+    if (lteState == LTE_STATE_POWERING)
     {
-        safePrintln("[Network] SIM card not ready after 10 attempts, disabling modem");
-        disableModem();
-        return false;
+        if (!stepPowerSequence(now))
+        {
+            return powerStep < 4 ? 10 : NETWORK_STEP_MS;
+        }
+        setLteState(LTE_STATE_PROBING, now);
+        return NETWORK_STEP_MS;
     }
-    safePrintln("[Network] SIM card is ready");
 
-#ifdef NETWORK_APN
-    safePrintf("[Network] Set network APN : %s\n", NETWORK_APN);
-    modem.sendAT(GF("+CGDCONT=1,\"IP\",\""), NETWORK_APN, "\"");
-    if (modem.waitResponse() != 1)
+    if (lteState == LTE_STATE_CONNECTED)
     {
-        safePrintln("[Network] Set network APN error !");
+        taskENTER_CRITICAL(&statusLock);
+        bool dataLost = modemStatus.isDataLost();
+        taskEXIT_CRITICAL(&statusLock);
+        if (now - lastLteCheck < LTE_CHECK_MS && !dataLost)
+        {
+            return LTE_CHECK_MS - (now - lastLteCheck);
+        }
+    }
+    else if (lteRetries > 0 && now - lteStateSince < LTE_POLL_MS)
+    {
+        return LTE_POLL_MS - (now - lteStateSince);
     }
-#endif
 
-    safePrintln("[Network] Waiting for network registration...");
-    int regRetries = 0;
-    RegStatus regStatus = REG_UNREGISTERED;
-    int16_t sq;
+    if (!modemPower.acquire(MODEM_CHANNEL_CONTROL, 0))
+    {
+        return NETWORK_STEP_MS;
+    }
 
-    auto getRegStatusString = [](RegStatus status) -> String
-        {
-            switch (status)
-            {
-                case REG_NO_RESULT:
-                    return "REG_NO_RESULT (0)";
-                case REG_UNREGISTERED:
-                    return "REG_UNREGISTERED (1)";
-                case REG_SEARCHING:
-                    return "REG_SEARCHING (2)";
-                case REG_DENIED:
-                    return "REG_DENIED (3)";
-                case REG_OK_HOME:
-                    return "REG_OK_HOME (1)";
-                case REG_OK_ROAMING:
-                    return "REG_OK_ROAMING (5)";
-#ifdef TINY_GSM_MODEM_SIM7672
-                case REG_SMS_ONLY:
-                    return "REG_SMS_ONLY (6)";
-#endif
-                default:
-                    return "UNKNOWN (" + String(status) + ")";
-            }
-        };
+    // Let pending URCs reach the status cache before it is consulted. While a command is pending
+    // its final result is read by the state that sent it.
+    if (!commandPending && cmuxControlChannel.available())
+    {
+        controlModem.waitResponse(0, NULL, NULL);
+    }
 
-    // Ok, check network like in lilygo examples
-    while (regRetries < 60 && (regStatus != REG_OK_HOME && regStatus != REG_OK_ROAMING))
+    uint32_t nextStepMs = NETWORK_STEP_MS;
+
+    switch (lteState)
     {
-        regStatus = modem.getRegistrationStatus();
-        sq = modem.getSignalQuality();
+        case LTE_STATE_PROBING:
+            if (controlModem.testAT(NETWORK_AT_TIMEOUT_MS))
+            {
+#if DEBUG
+                safePrintln("[Network] Modem is responding to AT commands");
+#endif
+                lteRetries = 0;
+                if (modemPower.isLowPowerReady() || cmux.isActive())
+                {
+                    // Parked, init and the settings from the last boot still hold
+                    safePrintln("[Network] Modem woken from low power");
+                    setLteState(LTE_STATE_SIM_WAIT, now);
+                    break;
+                }
+                setLteState(LTE_STATE_INIT, now);
+                break;
+            }
 
+            lteRetries++;
+            lteStateSince = now;
 #if DEBUG
-        safePrintf("[Network] Registration status: %s, Signal Quality: %d\n",
-            getRegStatusString(regStatus).c_str(), sq);
+            safePrintf("[Network] Modem not responding, attempt %d\n", lteRetries);
+#endif
+            if (cmux.isActive())
+            {
+                // Most likely the modem rebooted and is back in plain AT command mode
+                modemPower.multiplexerLost();
+            }
+#if MODEM_BAUD_RATE != MODEM_BAUD_DEFAULT
+            else
+            {
+                // AT+IPR survives a modem reboot, so the modem may still be at the raised rate
+                modemTransport.setBaud(modemTransport.getBaud() == MODEM_BAUD_RATE
+                        ? MODEM_BAUD_DEFAULT
+                        : MODEM_BAUD_RATE);
+            }
 #endif
+            if (lteRetries >= LTE_PROBE_ATTEMPTS)
+            {
+                failLTE("modem not responding");
+            }
+            else if (lteRetries > 3)
+            {
+                // Power key cycle, then keep probing after the boot wait
+                powerStep = 1;
+                lteState = LTE_STATE_POWERING;
+            }
+            break;
 
-        if (regStatus == REG_OK_HOME || regStatus == REG_OK_ROAMING)
-        {
+        case LTE_STATE_INIT:
+            if (sendSetupCommand(MODEM_INIT_COMMANDS[setupStep], now) &&
+                ++setupStep == COMMAND_COUNT(MODEM_INIT_COMMANDS))
+            {
+                setLteState(LTE_STATE_BAUD, now);
+            }
             break;
-        }
-#ifdef TINY_GSM_MODEM_SIM7672
-        else if (regStatus == REG_SMS_ONLY)
+
+        case LTE_STATE_BAUD:
+            if (setupStep == 0 && modemTransport.hasFlowControl())
+            {
+                // RTS/CTS where the board wires them, before the rate goes up
+                controlModem.sendAT(GF("+IFC=2,2"));
+                controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS);
+                setupStep++;
+                break;
+            }
+            if (!raiseModemBaud())
+            {
+                failLTE("baud rate change");
+                break;
+            }
+            modemEnabled = true;
+            // init turns slow clock off, so low power has to follow it
+            setLteState(LTE_STATE_LOW_POWER, now);
+            break;
+
+        case LTE_STATE_LOW_POWER:
+            if (modemPower.configureLowPower(setupStep++))
+            {
+                setLteState(LTE_STATE_URCS, now);
+            }
+            break;
+
+        case LTE_STATE_URCS:
         {
-            safePrintln(
-                "[Network] WARNING: Modem registered for SMS only. Data services may be limited.");
-            safePrintln("[Network] Continuing with connection attempt...");
+            controlModem.sendAT(STATUS_URC_COMMANDS[setupStep]);
+            bool accepted = controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS) == 1;
+            if (setupStep < STATUS_URCS_REQUIRED)
+            {
+                urcReporting = accepted && (setupStep == 0 || urcReporting);
+            }
+            if (++setupStep < COMMAND_COUNT(STATUS_URC_COMMANDS))
+            {
+                break;
+            }
+            taskENTER_CRITICAL(&statusLock);
+            modemStatus.setUrcReporting(urcReporting);
+            taskEXIT_CRITICAL(&statusLock);
+            setLteState(LTE_STATE_MULTIPLEXER, now);
             break;
         }
+
+        case LTE_STATE_MULTIPLEXER:
+            // Last, the UART settings above are made on the plain AT port
+            modemPower.startMultiplexer();
+            safePrintln("[Network] Modem initialization completed successfully");
+            setLteState(LTE_STATE_SIM_WAIT, now);
+            break;
+
+        case LTE_STATE_SIM_WAIT:
+            if (checkSimReady(now))
+            {
+                safePrintln("[Network] SIM card is ready");
+#ifdef NETWORK_APN
+                controlModem.sendAT(GF("+CGDCONT=1,\"IP\",\""), NETWORK_APN, "\"");
+                if (controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS) != 1)
+                {
+                    safePrintln("[Network] Set network APN error !");
+                }
+#endif
+                lteRetries = 0;
+                setLteState(LTE_STATE_REGISTERING, now);
+                break;
+            }
+
+            lteRetries++;
+            lteStateSince = now;
+#if DEBUG
+            safePrintf("[Network] SIM not ready, waiting... attempt %d\n", lteRetries);
 #endif
-        else if (regStatus == REG_DENIED)
+            if (lteRetries >= LTE_SIM_ATTEMPTS)
+            {
+                failLTE("SIM card not ready");
+            }
+            break;
+
+        case LTE_STATE_REGISTERING:
         {
-            safePrintln(
-                "[Network] Registration denied by network. Check SIM card and network coverage.");
-            disableModem();
-            return false;
+            RegStatus regStatus = checkRegistration(now);
+#if DEBUG
+            safePrintf("[Network] Registration status: %s\n", regStatusName(regStatus));
+#endif
+            bool registered = regStatus == REG_OK_HOME || regStatus == REG_OK_ROAMING;
+#ifdef TINY_GSM_MODEM_SIM7672
+            if (regStatus == REG_SMS_ONLY)
+            {
+                safePrintln(
+                    "[Network] WARNING: Modem registered for SMS only. Data services may be limited.");
+                registered = true;
+            }
+#endif
+            if (registered)
+            {
+                safePrintln("[Network] Network registration successful");
+                lteRetries = 0;
+                setLteState(LTE_STATE_ATTACHING, now);
+            }
+            else if (regStatus == REG_DENIED)
+            {
+                failLTE("registration denied by network");
+            }
+            else if (lteRetries > 0 && now - lastLteAttempt > LTE_REG_TIMEOUT_MS)
+            {
+                safePrintf("[Network] Final registration status: %s\n", regStatusName(regStatus));
+                failLTE("registration timeout");
+            }
+            else
+            {
+                lteRetries = 1;
+                lteStateSince = now;
+            }
+            break;
         }
 
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        regRetries++;
+        case LTE_STATE_ATTACHING:
+            if (commandPending)
+            {
+                // AT+CGACT answers once the context is active, which can take many seconds
+                int8_t result = 0;
+                if (cmuxControlChannel.available())
+                {
+                    result = controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS);
+                }
+                if (result == 1)
+                {
+                    setLteState(LTE_STATE_OPENING, now);
+                }
+                else if (result != 0)
+                {
+                    failLTE("PDP context activation refused");
+                }
+                else if (now - commandSince > LTE_ACTIVATE_TIMEOUT_MS)
+                {
+                    failLTE("PDP context activation timeout");
+                }
+                break;
+            }
+            if (setupStep == 0)
+            {
+                if (isNetworkOpen())
+                {
+                    // Data context kept while the modem was parked
+                    safePrintln("[Network] Data connection still active");
+                    completeLTE(now);
+                    nextStepMs = LTE_CHECK_MS;
+                    break;
+                }
+                safePrintf("[Network] Connecting to APN: %s\n", apn);
+                setupStep++;
+                break;
+            }
+            if (setupStep == 1)
+            {
+                char command[96];
+                snprintf(command, sizeof(command), "+CGDCONT=1,\"IP\",\"%s\"", apn);
+                if (sendSetupCommand(command, now))
+                {
+                    setupStep++;
+                }
+                break;
+            }
+            if (setupStep < 2 + COMMAND_COUNT(SOCKET_SETUP_COMMANDS))
+            {
+                if (sendSetupCommand(SOCKET_SETUP_COMMANDS[setupStep - 2], now))
+                {
+                    setupStep++;
+                }
+                break;
+            }
+#ifdef TINY_GSM_MODEM_SIM7672
+            // AT+NETOPEN activates the context itself
+            setLteState(LTE_STATE_OPENING, now);
+#else
+            controlModem.sendAT(GF("+CGACT=1,1"));
+            commandPending = true;
+            commandSince = now;
+#endif
+            break;
+
+        case LTE_STATE_OPENING:
+            if (setupStep == 0)
+            {
+                // OK at once, the service opens in the background
+                controlModem.sendAT(GF("+NETOPEN"));
+                int8_t result = controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS, GFP(GSM_OK),
+                    GF("+IP ERROR: Network is already opened"));
+                if (result == 2)
+                {
+                    controlModem.waitResponse(NETWORK_AT_TIMEOUT_MS);
+                    completeLTE(now);
+                    nextStepMs = LTE_CHECK_MS;
+                }
+                else if (result == 1)
+                {
+                    setupStep++;
+                    commandSince = now;
+                    nextStepMs = LTE_POLL_MS;
+                }
+                else
+                {
+                    failLTE("network open refused");
+                }
+                break;
+            }
+            if (isNetworkOpen())
+            {
+                completeLTE(now);
+                nextStepMs = LTE_CHECK_MS;
+            }
+            else if (now - commandSince > LTE_NETOPEN_TIMEOUT_MS)
+            {
+                failLTE("network open timeout");
+            }
+            else
+            {
+                nextStepMs = LTE_POLL_MS;
+            }
+            break;
+
+        case LTE_STATE_CONNECTED:
+            lastLteCheck = now;
+            lteConnected = checkDataConnection(now);
+            if (!lteConnected)
+            {
+                // Re-attach with the modem as it is, it is only powered off if that fails too
+                safePrintln("[Network] Data connection lost, re-attaching");
+                metrics.lteReattaches++;
+                lastLteAttempt = now;
+                lteRetries = 0;
+                setLteState(LTE_STATE_ATTACHING, now);
+                break;
+            }
+            {
+                // CSQ 0..31 maps to -113..-51 dBm, 99 means unknown
+                int16_t csq = checkSignalQuality(now);
+                if (csq >= 0 && csq <= 31)
+                {
+                    taskENTER_CRITICAL(&uplinkLock);
+                    linkScorer.updateSignal(TRANSPORT_LTE, -113 + 2 * csq);
+                    taskEXIT_CRITICAL(&uplinkLock);
+                }
+            }
+            nextStepMs = LTE_CHECK_MS;
+            break;
+
+        default:
+            break;
     }
 
-    bool registrationOk = false;
-    if (regStatus == REG_OK_HOME || regStatus == REG_OK_ROAMING)
+    modemPower.release(MODEM_CHANNEL_CONTROL);
+    return nextStepMs;
+}
+
+/**
+ * @brief SIM state from the status cache, queried only if the cache has no usable value
+ */
+bool Network::checkSimReady(uint32_t now)
+{
+    bool ready;
+    taskENTER_CRITICAL(&statusLock);
+    bool cached = modemStatus.getSimReady(now, ready);
+    if (cached)
     {
-        registrationOk = true;
-        safePrintln("[Network] Network registration successful");
+        metrics.statusCacheHits++;
     }
-#ifdef TINY_GSM_MODEM_SIM7672
-    else if (regStatus == REG_SMS_ONLY)
+    taskEXIT_CRITICAL(&statusLock);
+    if (cached)
     {
-        registrationOk = true;
-        safePrintln("[Network] Network registration successful (SMS only mode)");
-        safePrintln("[Network] Note: Data services may be limited in this mode");
+        return ready;
     }
-#endif
-    else
+
+    ready = isSimReady();
+    taskENTER_CRITICAL(&statusLock);
+    modemStatus.setSimReady(ready, now);
+    taskEXIT_CRITICAL(&statusLock);
+    return ready;
+}
+
+RegStatus Network::checkRegistration(uint32_t now)
+{
+    int8_t status;
+    taskENTER_CRITICAL(&statusLock);
+    bool cached = modemStatus.getRegistration(now, status);
+    if (cached)
     {
-        safePrintf("[Network] Failed to register to network. Final status: %s\n", getRegStatusString(regStatus).c_str());
-        disableModem();
-        return false;
+        metrics.statusCacheHits++;
+    }
+    taskEXIT_CRITICAL(&statusLock);
+    if (cached)
+    {
+        return (RegStatus)status;
     }
 
-    safePrintf("[Network] Connecting to APN: %s\n", apn);
+    RegStatus regStatus = controlModem.getRegistrationStatus();
+    taskENTER_CRITICAL(&statusLock);
+    modemStatus.setRegistration(regStatus, now);
+    taskEXIT_CRITICAL(&statusLock);
+    return regStatus;
+}
 
-    if (!modem.gprsConnect(apn, "", ""))
+bool Network::checkDataConnection(uint32_t now)
+{
+    bool active;
+    taskENTER_CRITICAL(&statusLock);
+    bool cached = modemStatus.getDataActive(now, active);
+    if (cached)
     {
-        safePrintln("[Network] GPRS connection failed, disabling modem");
-        disableModem();
-        return false;
+        metrics.statusCacheHits++;
+    }
+    taskEXIT_CRITICAL(&statusLock);
+    if (cached)
+    {
+        return active;
     }
-    safePrintln("[Network] GPRS connection successful");
 
-    if (!modem.setNetworkActive())
+    active = controlModem.isGprsConnected();
+    taskENTER_CRITICAL(&statusLock);
+    modemStatus.setDataActive(active, now);
+    taskEXIT_CRITICAL(&statusLock);
+    return active;
+}
+
+int16_t Network::checkSignalQuality(uint32_t now)
+{
+    int16_t csq;
+    taskENTER_CRITICAL(&statusLock);
+    bool cached = modemStatus.getSignal(now, csq);
+    if (cached)
     {
-        safePrintln("[Network] Enable network failed!");
+        metrics.statusCacheHits++;
+    }
+    taskEXIT_CRITICAL(&statusLock);
+    if (cached)
+    {
+        return csq;
     }
 
-#if DEBUG
-    String ipAddress = modem.getLocalIP();
-    safePrint("Network IP: ");
-    safePrintln(ipAddress);
-#endif
+    csq = controlModem.getSignalQuality();
+    taskENTER_CRITICAL(&statusLock);
+    modemStatus.setSignal(csq, now);
+    taskEXIT_CRITICAL(&statusLock);
+    return csq;
+}
 
-    bool gprsConnected = modem.isGprsConnected();
+/**
+ * @brief Forget the cached modem status, the modem was powered on or off
+ */
+void Network::resetModemStatus()
+{
+    taskENTER_CRITICAL(&statusLock);
+    modemStatus.reset();
+    taskEXIT_CRITICAL(&statusLock);
+}
 
-    if (gprsConnected)
+bool Network::disableModem()
+{
+    if (!modemEnabled)
     {
-        safePrintln("[Network] LTE connection established successfully");
-        lteConnected = true;
+        safePrintln("[Network] Modem already disabled");
         return true;
     }
-    else
+
+    safePrintln("[Network] Disabling controlModem...");
+
+    if (controlModem.isGprsConnected())
     {
-        safePrintln("[Network] LTE connection verification failed - GPRS not connected");
-        disableModem();
-        return false;
+        controlModem.gprsDisconnect();
+        safePrintln("[Network] GPRS disconnected");
     }
+
+    safePrintln("[Network] Powering down controlModem...");
+    controlModem.poweroff();
+    modemPower.poweredOff();
+    resetModemStatus();
+
+    safePrintln("[Network] Modem disabled successfully");
+    modemEnabled = false;
+    return true;
 }
 
 void Network::disconnectLTE()
 {
     safePrintln("[Network] Disconnecting LTE...");
-    modem.gprsDisconnect();
+    controlModem.gprsDisconnect();
     safePrintln("[Network] GPRS disconnected");
     lteConnected = false;
 }
 
+/**
+ * @brief Whether the LTE data connection is up
+ *
+ * @details Returns the state kept by the LTE state machine, which checks the data connection every
+ * LTE_CHECK_MS. No modem command is sent, so callers do not need the modem mutex.
+ */
 bool Network::isLTEConnected()
 {
-    if (!modemEnabled)
-    {
-        lteConnected = false;
-        return false;
-    }
-
-    // Only check gprsconnected, nothing else works, good enough?
-    bool result = modem.isGprsConnected();
-
-    lteConnected = result;
-    return result;
+    return lteState == LTE_STATE_CONNECTED && lteConnected;
 }
 
 bool Network::isConnected()
@@ -375,117 +1268,145 @@ bool Network::isConnected()
     return isWiFiConnected() || isLTEConnected();
 }
 
-void Network::maintainConnection(const char* ssid, const char* password, const char* apn)
+/**
+ * @brief Pick the transport for one request and pin it until releaseUplink()
+ *
+ * @details When both links are up the link scorer picks the one expected to deliver the most
+ * requests per joule. While a request holds LTE the modem is not powered down, so a handover only
+ * ever happens between requests.
+ *
+ * @return Transport to use, TRANSPORT_NONE if no link is up
+ */
+Transport Network::acquireUplink()
 {
-    static int16_t wifiScanAttempts = 0;
-    static const int8_t MIN_WIFI_ATTEMPTS = 3;
-    static uint32_t lastLteAttempt = 0;
-    static const uint32_t LTE_RETRY_COOLDOWN = 60000;
-    static bool lastWifiState = false;
+    bool wifiUp = isWiFiConnected();
+    Transport transport = TRANSPORT_NONE;
 
-    bool currentWiFiStatus = isWiFiConnected();
-
-    if (currentWiFiStatus && !lastWifiState)
+    taskENTER_CRITICAL(&uplinkLock);
+    transport = linkScorer.pick(wifiUp, isLTEConnected(), lastUplink);
+    if (transport == TRANSPORT_LTE)
     {
-        safePrintln("[Network] WiFi connection restored");
-        wifiScanAttempts = 0;
+        lteUsers++;
     }
-    lastWifiState = currentWiFiStatus;
 
-    if (currentWiFiStatus)
+    bool switched = transport != TRANSPORT_NONE && lastUplink != TRANSPORT_NONE &&
+        transport != lastUplink;
+    if (transport != TRANSPORT_NONE)
     {
-        wifiScanAttempts = 0;
-
-        if (lteConnected)
-        {
-            safePrintln("[Network] WiFi connected, disabling LTE modem to save power");
-            disconnectLTE();
-            disableModem();
-            lteConnected = false;
-        }
+        lastUplink = transport;
     }
-    else
+    if (switched)
     {
-#if DEBUG
-        safePrintln("[Network] WiFi not connected, scanning for networks...");
-#endif
-        int found = WiFi.scanNetworks(false, false, false, 300, 0, ssid);
-        bool ssidFound = (found > 0);
+        metrics.handovers++;
+    }
+    taskEXIT_CRITICAL(&uplinkLock);
 
-        if (ssidFound)
-        {
 #if DEBUG
-            safePrintln("[Network] Target WiFi network found, attempting connection...");
+    if (switched)
+    {
+        safePrintf("[Network] Uplink switched to %s\n", transport == TRANSPORT_WIFI ? "WiFi" : "LTE");
+    }
 #endif
-            bool wifiConnected = connectWiFi(ssid, password);
+    return transport;
+}
 
-            if (wifiConnected)
-            {
-                wifiScanAttempts = 0;
+/**
+ * @brief Release a transport taken with acquireUplink() and record how the request went
+ *
+ * @param transport Transport returned by acquireUplink()
+ * @param delivered true if an HTTP response was received, whatever its status
+ * @param latencyMs Duration of the request
+ */
+void Network::releaseUplink(Transport transport, bool delivered, uint32_t latencyMs)
+{
+    if (transport == TRANSPORT_NONE)
+    {
+        return;
+    }
+    taskENTER_CRITICAL(&uplinkLock);
+    linkScorer.recordResult(transport, delivered, latencyMs);
+    if (transport == TRANSPORT_LTE && lteUsers > 0)
+    {
+        lteUsers--;
+    }
+    taskEXIT_CRITICAL(&uplinkLock);
+}
 
-                if (lteConnected)
-                {
-                    safePrintln("[Network] WiFi connected successfully, disabling LTE modem");
-                    disconnectLTE();
-                    disableModem();
-                    lteConnected = false;
-                }
-            }
-            else
-            {
-                wifiScanAttempts++;
-#if DEBUG
-                safePrintf("[Network] WiFi connection failed, attempt %d of %d\n", wifiScanAttempts, MIN_WIFI_ATTEMPTS);
-#endif
-            }
-        }
-        else
-        {
-            wifiScanAttempts++;
-#if DEBUG
-            safePrintf("[Network] WiFi network not found, scan attempt %d of %d\n", wifiScanAttempts, MIN_WIFI_ATTEMPTS);
-#endif
-        }
+link_stats_t Network::getLinkStats(Transport transport)
+{
+    taskENTER_CRITICAL(&uplinkLock);
+    link_stats_t stats = linkScorer.getStats(transport);
+    taskEXIT_CRITICAL(&uplinkLock);
+    return stats;
+}
 
-        if (wifiScanAttempts >= MIN_WIFI_ATTEMPTS)
-        {
-            uint32_t currentTime = millis();
+uint8_t Network::getLteUsers()
+{
+    taskENTER_CRITICAL(&uplinkLock);
+    uint8_t users = lteUsers;
+    taskEXIT_CRITICAL(&uplinkLock);
+    return users;
+}
 
-            if (!isLTEConnected())
-            {
-                if (lastLteAttempt == 0 || (currentTime - lastLteAttempt) >= LTE_RETRY_COOLDOWN)
-                {
-                    safePrintln(
-                        "[Network] Minimum WiFi attempts reached, trying LTE as fallback...");
-                    lastLteAttempt = currentTime;
-                    bool lteSuccess = connectLTE(apn);
-
-                    if (!lteSuccess)
-                    {
-                        safePrintln(
-                            "[Network] LTE connection failed, will retry after cooldown period");
-                    }
-                }
-                else
-                {
-#if DEBUG
-                    uint32_t timeRemaining = LTE_RETRY_COOLDOWN - (currentTime - lastLteAttempt);
-                    safePrintf("[Network] LTE cooldown active, %lu seconds remaining\n", timeRemaining / 1000);
-#endif
-                }
-            }
-        }
-        else
-        {
-#if DEBUG
-            safePrintln("[Network] Waiting for more WiFi attempts before trying LTE...");
-#endif
-        }
+/**
+ * @brief Advance the connection state machines by one step
+ *
+ * @details WiFi has priority. After MIN_WIFI_ATTEMPTS failed WiFi attempts the LTE modem is
+ * brought up step by step, and it is powered down again as soon as WiFi connects. The connected
+ * bit in the network event group is updated whenever connectivity changes.
+ *
+ * @return Milliseconds until the next step is due. The caller may call earlier, for example when
+ * woken by a WiFi event.
+ */
+uint32_t Network::maintainConnection(const char* ssid, const char* password, const char* apn)
+{
+    uint32_t now = millis();
+    bool wasConnected = connectedBitSet;
+
+    uint32_t wifiDelay = stepWiFi(ssid, password, now);
+    uint32_t lteDelay = stepLTE(apn, now);
+
+    bool connected = isConnected();
+    if (connected && !wasConnected)
+    {
+        metrics.lastTimeToConnectMs = millis() - outageSince;
+    }
+    else if (!connected && wasConnected)
+    {
+        outageSince = millis();
+    }
+    if (connected != connectedBitSet || !connectedBitValid)
+    {
+        connectedBitSet = connected;
+        connectedBitValid = false;
     }
+    updateConnectedBit();
 
-    if (xSemaphoreTake(networkEventMutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    uint32_t stepMs = millis() - now;
+    if (stepMs > metrics.longestStepMs)
     {
-        if (isConnected())
+        metrics.longestStepMs = stepMs;
+    }
+
+    return wifiDelay < lteDelay ? wifiDelay : lteDelay;
+}
+
+/**
+ * @brief Publish the connected state to the network event group
+ *
+ * @details The event mutex is only tried, never waited for. If it is busy the update is retried on
+ * the next step.
+ */
+void Network::updateConnectedBit()
+{
+    if (connectedBitValid)
+    {
+        return;
+    }
+
+    if (xSemaphoreTake(networkEventMutex, 0) == pdTRUE)
+    {
+        if (connectedBitSet)
         {
             xEventGroupSetBits(networkEventGroup, NETWORK_CONNECTED_BIT);
         }
@@ -494,9 +1415,25 @@ void Network::maintainConnection(const char* ssid, const char* password, const c
             xEventGroupClearBits(networkEventGroup, NETWORK_CONNECTED_BIT);
         }
         xSemaphoreGive(networkEventMutex);
+        connectedBitValid = true;
     }
-    else
-    {
-        safePrintln("[Network] Failed to access network event group in maintainConnection");
-    }
+}
+
+WiFiState Network::getWiFiState() const
+{
+    return wifiState;
+}
+
+LteState Network::getLteState() const
+{
+    return lteState;
+}
+
+network_metrics_t Network::getMetrics() const
+{
+    // The status counters are also written by the tasks that read URCs
+    taskENTER_CRITICAL(&statusLock);
+    network_metrics_t copy = metrics;
+    taskEXIT_CRITICAL(&statusLock);
+    return copy;
 }
@@ -0,0 +1,91 @@
+/**
+ * @file offlineBuffer.cpp
+ * @brief Offline Buffer Implementation
+ */
+
+#include "network/offlineBuffer.h"
+#include <cstring>
+
+OfflineBuffer::OfflineBuffer() : head(0), count(0), dropped(0)
+{
+    memset(entries, 0, sizeof(entries));
+}
+
+/**
+ * @brief Park a payload in the buffer
+ *
+ * @param data Payload to store
+ * @return true if stored without loss, false if the oldest payload had to be overwritten
+ */
+bool OfflineBuffer::push(const processed_data_t& data)
+{
+    bool lossless = true;
+
+    if (count == OFFLINE_BUFFER_CAPACITY)
+    {
+        head = (head + 1) % OFFLINE_BUFFER_CAPACITY;
+        count--;
+        dropped++;
+        lossless = false;
+    }
+
+    size_t tail = (head + count) % OFFLINE_BUFFER_CAPACITY;
+    memcpy(&entries[tail], &data, sizeof(processed_data_t));
+    entries[tail].json[sizeof(entries[tail].json) - 1] = '\0';
+    count++;
+
+    return lossless;
+}
+
+/**
+ * @brief Copy the oldest payload without removing it
+ */
+bool OfflineBuffer::peek(processed_data_t& data) const
+{
+    if (count == 0)
+    {
+        return false;
+    }
+    memcpy(&data, &entries[head], sizeof(processed_data_t));
+    return true;
+}
+
+/**
+ * @brief Remove the oldest payload
+ */
+bool OfflineBuffer::pop()
+{
+    if (count == 0)
+    {
+        return false;
+    }
+    head = (head + 1) % OFFLINE_BUFFER_CAPACITY;
+    count--;
+    return true;
+}
+
+void OfflineBuffer::clear()
+{
+    head = 0;
+    count = 0;
+}
+
+size_t OfflineBuffer::size() const
+{
+    return count;
+}
+
+bool OfflineBuffer::isEmpty() const
+{
+    return count == 0;
+}
+
+bool OfflineBuffer::isFull() const
+{
+    return count == OFFLINE_BUFFER_CAPACITY;
+}
+
+uint32_t OfflineBuffer::getDroppedCount() const
+{
+    return dropped;
+}
@@ -0,0 +1,240 @@
+/**
+ * @file positionFilter.cpp
+ * @brief Kalman Filtered Position and Velocity Implementation
+ *
+ * @details Process noise is white acceleration of standard deviation KF_ACCEL_NOISE, which covers
+ * a walker or cyclist changing pace and direction. A fix's standard deviation is its HDOP times
+ * KF_UERE_M, the user equivalent range error of a consumer receiver. Fixes whose innovation is
+ * beyond the 99.9% chi-square bound for two degrees of freedom are rejected, KF_MAX_REJECTS of
+ * them in a row mean the device really moved and the filter restarts from the fix.
+ */
+
+#include "network/positionFilter.h"
+#include <cmath>
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef KF_ACCEL_NOISE
+#define KF_ACCEL_NOISE 1.0f // m/s^2
+#endif
+#ifndef KF_UERE_M
+#define KF_UERE_M 4.0f // m per unit of HDOP
+#endif
+#ifndef KF_MIN_SATELLITES
+#define KF_MIN_SATELLITES 4
+#endif
+#ifndef KF_MAX_REJECTS
+#define KF_MAX_REJECTS 3
+#endif
+#ifndef KF_MAX_GAP_MS
+#define KF_MAX_GAP_MS 300000 // the estimate is dropped after this long without a fix
+#endif
+
+#define KF_GATE 13.8f         // chi-square, 2 degrees of freedom, 99.9%
+#define KF_UNKNOWN_HDOP 2.0f  // assumed when the receiver reports none
+#define KF_STILL_SIGMA 0.05f  // m/s, velocity of a device the accelerometer sees at rest
+#define KF_INITIAL_SPEED 5.0f // m/s, velocity uncertainty of a new track
+#define KF_RECENTER_M 5000.0f // the origin follows the device beyond this, for float precision
+#define METERS_PER_DEG_LAT 111195.0f
+#define DEG_TO_RAD 0.017453292519943295
+
+PositionFilter::PositionFilter()
+{
+    reset();
+}
+
+void PositionFilter::reset()
+{
+    valid = false;
+    rejectedRun = 0;
+    stats = {};
+}
+
+bool PositionFilter::isValid() const
+{
+    return valid;
+}
+
+/**
+ * @brief Fuse one GNSS fix
+ *
+ * @param hdop Horizontal dilution of precision, 0 if unknown
+ * @param satellites Satellites used, -1 if unknown
+ * @return true if the fix was accepted
+ */
+bool PositionFilter::update(float latitude, float longitude, float hdop, int satellites,
+    uint32_t now)
+{
+    if (satellites >= 0 && satellites < KF_MIN_SATELLITES)
+    {
+        stats.rejected++;
+        return false;
+    }
+
+    float sigma = (hdop > 0 ? hdop : KF_UNKNOWN_HDOP) * KF_UERE_M;
+    float r = sigma * sigma;
+
+    if (!valid || now - time > KF_MAX_GAP_MS)
+    {
+        start(latitude, longitude, r, now);
+        return true;
+    }
+
+    predict(now);
+
+    float zx = (float)((longitude - originLon) * metersPerDegLon);
+    float zy = (float)((latitude - originLat) * METERS_PER_DEG_LAT);
+    float yx = zx - x[0];
+    float yy = zy - x[1];
+    float s = p00 + r;
+
+    if ((yx * yx + yy * yy) / s > KF_GATE)
+    {
+        stats.rejected++;
+        if (++rejectedRun >= KF_MAX_REJECTS)
+        {
+            start(latitude, longitude, r, now);
+            return true;
+        }
+        return false;
+    }
+    rejectedRun = 0;
+
+    float k0 = p00 / s;
+    float k1 = p01 / s;
+    x[0] += k0 * yx;
+    x[1] += k0 * yy;
+    v[0] += k1 * yx;
+    v[1] += k1 * yy;
+
+    float q00 = p00, q01 = p01;
+    p00 = (1 - k0) * q00;
+    p01 = (1 - k0) * q01;
+    p11 -= k1 * q01;
+
+    stats.updates++;
+    stats.lastInnovation = sqrtf(yx * yx + yy * yy);
+    recenter();
+    return true;
+}
+
+/**
+ * @brief The accelerometer sees the device at rest, pin the velocity to zero
+ */
+void PositionFilter::zeroVelocity(uint32_t now)
+{
+    if (!valid)
+    {
+        return;
+    }
+    predict(now);
+
+    float s = p11 + KF_STILL_SIGMA * KF_STILL_SIGMA;
+    float k0 = p01 / s;
+    float k1 = p11 / s;
+    for (int i = 0; i < 2; i++)
+    {
+        float y = -v[i];
+        x[i] += k0 * y;
+        v[i] += k1 * y;
+    }
+
+    float q01 = p01, q11 = p11;
+    p00 -= k0 * q01;
+    p01 -= k0 * q11;
+    p11 -= k1 * q11;
+    stats.stationary++;
+}
+
+/**
+ * @brief Estimate at time now, extrapolated from the last update without changing the state
+ *
+ * @return false if there is no estimate
+ */
+bool PositionFilter::getEstimate(uint32_t now, position_estimate_t& estimate) const
+{
+    if (!valid || now - time > KF_MAX_GAP_MS)
+    {
+        return false;
+    }
+
+    float dt = (float)(now - time) / 1000.0f;
+    float q = KF_ACCEL_NOISE * KF_ACCEL_NOISE;
+    float e = x[0] + v[0] * dt;
+    float n = x[1] + v[1] * dt;
+    float variance = p00 + 2 * dt * p01 + dt * dt * p11 + q * dt * dt * dt / 3;
+
+    estimate.latitude = (float)(originLat + n / METERS_PER_DEG_LAT);
+    estimate.longitude = (float)(originLon + e / metersPerDegLon);
+    estimate.speed = sqrtf(v[0] * v[0] + v[1] * v[1]);
+    estimate.course = fmodf(atan2f(v[0], v[1]) / (float)DEG_TO_RAD + 360.0f, 360.0f);
+    estimate.accuracy = sqrtf(variance > 0 ? variance : 0);
+    return true;
+}
+
+position_filter_stats_t PositionFilter::getStats() const
+{
+    return stats;
+}
+
+/**
+ * @brief Advance the state to now
+ */
+void PositionFilter::predict(uint32_t now)
+{
+    float dt = (float)(now - time) / 1000.0f;
+    if (dt <= 0)
+    {
+        return;
+    }
+    float q = KF_ACCEL_NOISE * KF_ACCEL_NOISE;
+
+    for (int i = 0; i < 2; i++)
+    {
+        x[i] += v[i] * dt;
+    }
+    p00 += 2 * dt * p01 + dt * dt * p11 + q * dt * dt * dt / 3;
+    p01 += dt * p11 + q * dt * dt / 2;
+    p11 += q * dt;
+    time = now;
+}
+
+/**
+ * @brief Restart the track at a fix, with unknown velocity
+ */
+void PositionFilter::start(float latitude, float longitude, float variance, uint32_t now)
+{
+    if (valid)
+    {
+        stats.resets++;
+    }
+    valid = true;
+    originLat = latitude;
+    originLon = longitude;
+    metersPerDegLon = METERS_PER_DEG_LAT * (float)cos(originLat * DEG_TO_RAD);
+    x[0] = x[1] = 0;
+    v[0] = v[1] = 0;
+    p00 = variance;
+    p01 = 0;
+    p11 = KF_INITIAL_SPEED * KF_INITIAL_SPEED;
+    time = now;
+    rejectedRun = 0;
+    stats.updates++;
+}
+
+/**
+ * @brief Move the origin under the device once it has travelled far from it
+ */
+void PositionFilter::recenter()
+{
+    if (fabsf(x[0]) < KF_RECENTER_M && fabsf(x[1]) < KF_RECENTER_M)
+    {
+        return;
+    }
+    originLat += x[1] / METERS_PER_DEG_LAT;
+    originLon += x[0] / metersPerDegLon;
+    metersPerDegLon = METERS_PER_DEG_LAT * (float)cos(originLat * DEG_TO_RAD);
+    x[0] = x[1] = 0;
+}
@@ -0,0 +1,278 @@
+/**
+ * @file responseSink.cpp
+ * @brief Streaming HTTP Response Handlers Implementation
+ *
+ * @details JsonTokenSink scans the body one character at a time and keeps only the current key,
+ * so the token and expires_in are found whatever their order and however the body is chunked.
+ */
+
+#include "network/responseSink.h"
+#include <cstring>
+
+bool DiscardSink::write(const uint8_t* data, size_t length)
+{
+    return false;
+}
+
+bool DiscardSink::wantsBody() const
+{
+    return false;
+}
+
+CaptureSink::CaptureSink(char* buffer, size_t size)
+    : buffer(buffer), size(size), used(0), truncated(false)
+{
+    if (buffer && size > 0)
+    {
+        buffer[0] = '\0';
+    }
+}
+
+void CaptureSink::begin(int code, int contentLength)
+{
+    used = 0;
+    truncated = false;
+    if (buffer && size > 0)
+    {
+        buffer[0] = '\0';
+    }
+}
+
+bool CaptureSink::write(const uint8_t* data, size_t length)
+{
+    if (!buffer || size == 0)
+    {
+        return false;
+    }
+
+    size_t space = size - 1 - used;
+    size_t n = length < space ? length : space;
+    memcpy(buffer + used, data, n);
+    used += n;
+    buffer[used] = '\0';
+
+    if (n < length)
+    {
+        truncated = true;
+        return false;
+    }
+    return true;
+}
+
+const char* CaptureSink::c_str() const
+{
+    return buffer ? buffer : "";
+}
+
+size_t CaptureSink::length() const
+{
+    return used;
+}
+
+bool CaptureSink::isTruncated() const
+{
+    return truncated;
+}
+
+JsonTokenSink::JsonTokenSink(char* token, size_t tokenSize) : token(token), tokenSize(tokenSize)
+{
+    begin(0, -1);
+}
+
+void JsonTokenSink::begin(int code, int contentLength)
+{
+    tokenLen = 0;
+    tokenDone = false;
+    if (token && tokenSize > 0)
+    {
+        token[0] = '\0';
+    }
+
+    keyLen = 0;
+    keyOverflow = false;
+
+    field = FIELD_NONE;
+    inString = false;
+    escaped = false;
+    expectValue = false;
+    capturingToken = false;
+    inNumber = false;
+
+    expiresIn = 0;
+    expiresDone = false;
+    error = false;
+}
+
+bool JsonTokenSink::write(const uint8_t* data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        if (!consume((char)data[i]))
+        {
+            return false;
+        }
+    }
+
+    // Stop reading once both fields are known
+    return !(tokenDone && expiresDone);
+}
+
+/**
+ * @brief Feed one character to the scanner
+ *
+ * @return false if scanning cannot continue
+ */
+bool JsonTokenSink::consume(char c)
+{
+    if (inString)
+    {
+        if (!escaped && c == '\\')
+        {
+            if (capturingToken)
+            {
+                // A JWT never needs one, and a decoded control character must not reach a header
+                error = true;
+                capturingToken = false;
+                token[0] = '\0';
+                return false;
+            }
+            escaped = true;
+            return true;
+        }
+        if (!escaped && c == '"')
+        {
+            inString = false;
+            if (expectValue)
+            {
+                if (capturingToken)
+                {
+                    token[tokenLen] = '\0';
+                    tokenDone = true;
+                    capturingToken = false;
+                }
+                endValue();
+            }
+            return true;
+        }
+        escaped = false;
+
+        if (capturingToken)
+        {
+            if (tokenLen + 1 >= tokenSize)
+            {
+                error = true;
+                capturingToken = false;
+                token[0] = '\0';
+                return false;
+            }
+            token[tokenLen++] = c;
+        }
+        else if (!expectValue)
+        {
+            if (keyLen + 1 < KEY_MAX_LEN)
+            {
+                key[keyLen++] = c;
+            }
+            else
+            {
+                keyOverflow = true;
+            }
+        }
+        return true;
+    }
+
+    if (inNumber)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            uint32_t digit = c - '0';
+            expiresIn = expiresIn > (UINT32_MAX - digit) / 10 ? UINT32_MAX : expiresIn * 10 + digit;
+            return true;
+        }
+        inNumber = false;
+        expiresDone = true;
+    }
+
+    switch (c)
+    {
+        case '"':
+            inString = true;
+            if (expectValue)
+            {
+                capturingToken = field == FIELD_TOKEN && !tokenDone && token && tokenSize > 0;
+                tokenLen = 0;
+            }
+            else
+            {
+                keyLen = 0;
+                keyOverflow = false;
+            }
+            break;
+
+        case ':':
+            endKey();
+            break;
+
+        case ',':
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+            endValue();
+            break;
+
+        default:
+            if (c >= '0' && c <= '9' && expectValue && field == FIELD_EXPIRES_IN && !expiresDone)
+            {
+                inNumber = true;
+                expiresIn = c - '0';
+            }
+            break;
+    }
+    return true;
+}
+
+void JsonTokenSink::endKey()
+{
+    key[keyLen] = '\0';
+    field = FIELD_NONE;
+    if (!keyOverflow)
+    {
+        if (strcmp(key, "token") == 0)
+        {
+            field = FIELD_TOKEN;
+        }
+        else if (strcmp(key, "expires_in") == 0)
+        {
+            field = FIELD_EXPIRES_IN;
+        }
+    }
+    expectValue = true;
+}
+
+void JsonTokenSink::endValue()
+{
+    expectValue = false;
+    field = FIELD_NONE;
+    keyLen = 0;
+}
+
+bool JsonTokenSink::hasToken() const
+{
+    return tokenDone && tokenLen > 0;
+}
+
+bool JsonTokenSink::hasExpiresIn() const
+{
+    return expiresDone && expiresIn > 0;
+}
+
+uint32_t JsonTokenSink::getExpiresIn() const
+{
+    return expiresIn;
+}
+
+bool JsonTokenSink::hasError() const
+{
+    return error;
+}
@@ -0,0 +1,261 @@
+/**
+ * @file retryPolicy.cpp
+ * @brief Retry, Backoff and Circuit Breaker Policy Implementation
+ *
+ * @details On target the clock defaults to millis() and the jitter source to the hardware RNG. The
+ * host build defaults both to zero, the tests pass in their own.
+ */
+
+#include "network/retryPolicy.h"
+
+#ifdef ARDUINO
+#include "config.h"
+#include <Arduino.h>
+
+static uint32_t defaultClock()
+{
+    return millis();
+}
+
+static uint32_t defaultRandom(uint32_t upperBound)
+{
+    return upperBound ? esp_random() % upperBound : 0;
+}
+#else
+static uint32_t defaultClock()
+{
+    return 0;
+}
+
+static uint32_t defaultRandom(uint32_t)
+{
+    return 0;
+}
+#endif
+
+#ifndef RETRY_JITTER_PERCENT
+#define RETRY_JITTER_PERCENT 25
+#endif
+#ifndef BREAKER_FAILURE_THRESHOLD
+#define BREAKER_FAILURE_THRESHOLD 5
+#endif
+#ifndef BREAKER_OPEN_TIMEOUT_MS
+#define BREAKER_OPEN_TIMEOUT_MS 60000
+#endif
+
+static const retry_budget_t DEFAULT_BUDGETS[MSG_CLASS_COUNT] = {
+    {3, 2000, 16000}, // MSG_CLASS_AUTH
+    {3, 1000, 8000},  // MSG_CLASS_TELEMETRY
+    {3, 1500, 3000},  // MSG_CLASS_QUEUE, after a first wait of HTTP_QUEUE_SEND_TIMEOUT_MS
+};
+
+CircuitBreaker::CircuitBreaker(uint8_t failureThreshold, uint32_t openTimeoutMs,
+    retry_clock_fn_t clock)
+    : clock(clock ? clock : defaultClock), failureThreshold(failureThreshold),
+      openTimeoutMs(openTimeoutMs)
+{
+    reset();
+}
+
+/**
+ * @brief Check whether a request may be sent now
+ *
+ * @return true if the breaker is closed, or if it is half-open and no probe is outstanding
+ */
+bool CircuitBreaker::allowRequest()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    switch (state)
+    {
+        case STATE_CLOSED:
+            return true;
+
+        case STATE_OPEN:
+            if (clock() - openedAt < openTimeoutMs)
+            {
+                return false;
+            }
+            state = STATE_HALF_OPEN;
+            probeInFlight = true;
+            return true;
+
+        case STATE_HALF_OPEN:
+            if (probeInFlight)
+            {
+                return false;
+            }
+            probeInFlight = true;
+            return true;
+    }
+    return false;
+}
+
+void CircuitBreaker::recordSuccess()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    state = STATE_CLOSED;
+    consecutiveFailures = 0;
+    probeInFlight = false;
+}
+
+void CircuitBreaker::recordFailure()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (consecutiveFailures < UINT8_MAX)
+    {
+        consecutiveFailures++;
+    }
+
+    if (state == STATE_HALF_OPEN || consecutiveFailures >= failureThreshold)
+    {
+        trip();
+    }
+}
+
+/**
+ * @brief Give back a granted request that was never sent
+ *
+ * @details Releases the half-open probe slot without a verdict, so the next request may probe.
+ */
+void CircuitBreaker::cancelRequest()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    probeInFlight = false;
+}
+
+void CircuitBreaker::reset()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    state = STATE_CLOSED;
+    consecutiveFailures = 0;
+    openedAt = 0;
+    tripCount = 0;
+    probeInFlight = false;
+}
+
+void CircuitBreaker::trip()
+{
+    if (state != STATE_OPEN)
+    {
+        tripCount++;
+    }
+    state = STATE_OPEN;
+    openedAt = clock();
+    probeInFlight = false;
+}
+
+CircuitBreaker::State CircuitBreaker::getState() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return state;
+}
+
+uint8_t CircuitBreaker::getConsecutiveFailures() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return consecutiveFailures;
+}
+
+uint32_t CircuitBreaker::getTripCount() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return tripCount;
+}
+
+RetryPolicy::RetryPolicy(retry_clock_fn_t clock, retry_random_fn_t random)
+    : clock(clock ? clock : defaultClock), random(random ? random : defaultRandom),
+      backendBreaker(BREAKER_FAILURE_THRESHOLD, BREAKER_OPEN_TIMEOUT_MS, this->clock)
+{
+    for (int i = 0; i < MSG_CLASS_COUNT; i++)
+    {
+        budgets[i] = DEFAULT_BUDGETS[i];
+    }
+}
+
+void RetryPolicy::setBudget(MessageClass cls, const retry_budget_t& budget)
+{
+    if (cls < MSG_CLASS_COUNT)
+    {
+        budgets[cls] = budget;
+    }
+}
+
+const retry_budget_t& RetryPolicy::getBudget(MessageClass cls) const
+{
+    return budgets[cls < MSG_CLASS_COUNT ? cls : MSG_CLASS_TELEMETRY];
+}
+
+/**
+ * @brief Check whether another attempt fits in the budget
+ *
+ * @param cls Message class
+ * @param attempt Number of attempts already made
+ */
+bool RetryPolicy::shouldRetry(MessageClass cls, uint8_t attempt) const
+{
+    return attempt < getBudget(cls).maxAttempts;
+}
+
+/**
+ * @brief Delay to wait before the next attempt
+ *
+ * @details The delay doubles for every attempt, starting at the base delay and capped at the
+ * maximum delay. Up to RETRY_JITTER_PERCENT of it is then subtracted at random so that devices
+ * recovering from the same outage do not retry in lockstep.
+ *
+ * @param cls Message class
+ * @param attempt Number of attempts already made (1 after the first failure)
+ * @return Delay in milliseconds
+ */
+uint32_t RetryPolicy::backoffDelay(MessageClass cls, uint8_t attempt) const
+{
+    const retry_budget_t& budget = getBudget(cls);
+    if (attempt == 0)
+    {
+        return 0;
+    }
+
+    uint32_t delayMs = budget.baseDelayMs;
+    for (uint8_t i = 1; i < attempt && delayMs < budget.maxDelayMs; i++)
+    {
+        delayMs *= 2;
+    }
+    if (delayMs > budget.maxDelayMs)
+    {
+        delayMs = budget.maxDelayMs;
+    }
+
+    uint32_t jitterRange = (uint32_t)((uint64_t)delayMs * RETRY_JITTER_PERCENT / 100);
+    return delayMs - random(jitterRange + 1);
+}
+
+/**
+ * @brief Check whether an HTTP result is worth retrying
+ *
+ * @param httpCode Status code, or a negative transport error
+ */
+bool RetryPolicy::isRetryableStatus(int httpCode)
+{
+    return httpCode <= 0 || httpCode == 408 || httpCode == 429 || httpCode >= 500;
+}
+
+/**
+ * @brief Check whether an HTTP result indicates an unhealthy backend
+ *
+ * @details Only transport errors and server errors count towards the circuit breaker. Client
+ * errors such as 401 mean the backend is reachable.
+ */
+bool RetryPolicy::isBackendFailure(int httpCode)
+{
+    return httpCode <= 0 || httpCode >= 500;
+}
+
+CircuitBreaker& RetryPolicy::breaker()
+{
+    return backendBreaker;
+}
+
+retry_clock_fn_t RetryPolicy::getClock() const
+{
+    return clock;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file uplinkPayload.cpp
+ * @brief Uplink Payload and Request Formatting Implementation
+ *
+ * @details The sensor JSON is assembled with snprintf, each optional object into its own buffer
+ * first so that an absent one costs nothing. The login document is small and fixed, ArduinoJson
+ * only takes care of escaping the credentials.
+ */
+
+#include "network/uplinkPayload.h"
+#include <cstdio>
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef DEVICE_ID
+#define DEVICE_ID "SENTINEL-001"
+#endif
+
+/**
+ * @brief Write the track field, encoded tracks are printable ASCII in which only the backslash
+ * needs escaping
+ */
+static void escapeTrack(const char* encoded, char* out, size_t outSize)
+{
+    int len = snprintf(out, outSize, ", \"track\": \"");
+    size_t n = len > 0 ? (size_t)len : 0;
+    for (; *encoded && n + 3 < outSize; encoded++)
+    {
+        if (*encoded == '\\')
+            out[n++] = '\\';
+        out[n++] = *encoded;
+    }
+    out[n++] = '"';
+    out[n] = '\0';
+}
+
+/**
+ * @brief Write the heart_rate_summary field: heart rate range over the period, and HRV over the
+ * analyzer's window once it holds enough beats. Contact and energy are left out when the strap
+ * does not report them.
+ */
+static void formatHeartRateSummary(const sensor_data_t& data, char* out, size_t outSize)
+{
+    int len = snprintf(out, outSize, ", \"heart_rate_summary\": { \"strap\": %d, \"period\": %u, "
+                       "\"min\": %u, \"max\": %u, \"artifacts\": %u", data.hr_strap, data.hr_period,
+                       data.hr_min, data.hr_max, data.hrv_artifacts);
+    size_t n = len > 0 ? (size_t)len : 0;
+    if (data.hr_contact >= 0 && n < outSize)
+        n += snprintf(out + n, outSize - n, ", \"contact\": %d", data.hr_contact);
+    if (data.hr_energy >= 0 && n < outSize)
+        n += snprintf(out + n, outSize - n, ", \"energy\": %ld", (long)data.hr_energy);
+    if (data.hrv_beats > 0 && n < outSize)
+        n += snprintf(out + n, outSize - n, ", \"hrv\": { \"beats\": %u, \"rmssd\": %.1f, "
+                      "\"sdnn\": %.1f, \"pnn50\": %.1f }", data.hrv_beats, data.hrv_rmssd,
+                      data.hrv_sdnn, data.hrv_pnn50);
+    if (n < outSize)
+        snprintf(out + n, outSize - n, " }");
+}
+
+/**
+ * @brief Write the bluetooth field: scan duty cycle since boot, time-to-reconnect of lost straps,
+ * the connection transmit power and the radio-on time per hour
+ */
+static void formatBluetoothStats(const sensor_data_t& data, char* out, size_t outSize)
+{
+    snprintf(out, outSize, ", \"bluetooth\": { \"scan_duty\": %.2f, \"tx_power\": %d, "
+             "\"reconnects\": %lu, \"reconnect_avg_ms\": %lu, \"reconnect_max_ms\": %lu, "
+             "\"radio_ms_per_hour\": %lu }",
+             data.bt_scan_duty, data.bt_tx_power, (unsigned long)data.bt_reconnects,
+             (unsigned long)data.bt_reconnect_avg_ms, (unsigned long)data.bt_reconnect_max_ms,
+             (unsigned long)data.bt_radio_ms_per_hour);
+}
+
+/**
+ * @brief Create a Json object
+ *
+ * @details This function creates a JSON string from the sensor data and stores it in the provided
+ * buffer. The JSON string contains the following fields:
+ * - steps
+ * - humidity
+ * - gas
+ * - fall_detected
+ * - device_battery
+ * - strap_battery
+ * - heart_rate
+ * - latitude, longitude, altitude, accuracy
+ * - noise_level
+ * - track, when fixes were kept since the last upload
+ * - geofence, when a fence was entered or left
+ * - heart_rate_summary, when the Bluetooth task summarized a strap's heart rate and HRV
+ * - bluetooth, when the Bluetooth task reported its scan, reconnect and radio-on statistics
+ *
+ * @param data
+ * @param buffer
+ * @param bufferSize
+ * @return true if the JSON fit in the buffer
+ */
+bool createJson(const sensor_data_t& data, char* buffer, size_t bufferSize)
+{
+    char track[2 * TRACK_ENCODED_SIZE + 16] = "";
+    if (data.track[0] != '\0')
+    {
+        escapeTrack(data.track, track, sizeof(track));
+    }
+    char geofence[64] = "";
+    if (data.geofence >= 0)
+    {
+        snprintf(geofence, sizeof(geofence), ", \"geofence\": { \"id\": %d, \"inside\": %d }",
+                 data.geofence, data.geofence_inside);
+    }
+    char heartRateSummary[224] = "";
+    if (data.hr_strap >= 0)
+    {
+        formatHeartRateSummary(data, heartRateSummary, sizeof(heartRateSummary));
+    }
+    char bluetooth[192] = "";
+    if (data.bt_scan_duty >= 0)
+    {
+        formatBluetoothStats(data, bluetooth, sizeof(bluetooth));
+    }
+
+    int len = snprintf(buffer, bufferSize,
+                       "{\"device_id\": \"%s\", \"sensors\": { "
+                       "\"steps\": %d, "
+                       "\"temperature\": %.2f, "
+                       "\"humidity\": %.2f, "
+                       "\"gas\": { \"ppm\": %.2f }, "
+                       "\"fall_detected\": %d, "
+                       "\"device_battery\": %d, "
+                       "\"strap_battery\": \"0\", "
+                       "\"heart_rate\": %d, "
+                       "\"latitude\": %.6f, "
+                       "\"longitude\": %.6f, "
+                       "\"altitude\": %.2f, "
+                       "\"accuracy\": %.2f, "
+                       "\"noise_level\": %d%s%s%s%s } }",
+                       DEVICE_ID, data.steps, data.temperature, data.humidity, data.gasLevel,
+                       data.fall_detected, data.device_battery, data.heartRate, data.latitude,
+                       data.longitude, data.gps_altitude, data.gps_accuracy, data.noise_level,
+                       track, geofence, heartRateSummary, bluetooth);
+    return len >= 0 && len < (int)bufferSize;
+}
+
+/**
+ * @brief Format the Authorization header of a send
+ *
+ * @return true if the header fit in the buffer
+ */
+bool createBearerHeader(const char* token, char* header, size_t headerSize)
+{
+    int len = snprintf(header, headerSize, "Bearer %s", token);
+    return len > 0 && (size_t)len < headerSize;
+}
+
+/**
+ * @brief Serialize the login request
+ *
+ * @param allocator Memory for the document, released when this returns
+ * @return Length of the payload, 0 if it did not fit in the buffer or the allocator ran out
+ */
+size_t createLoginPayload(ArduinoJson::Allocator* allocator, const char* username,
+    const char* password, char* buffer, size_t bufferSize)
+{
+    JsonDocument loginDoc(allocator);
+    loginDoc["username"] = username;
+    loginDoc["password"] = password;
+    if (loginDoc.overflowed())
+    {
+        return 0;
+    }
+    size_t len = serializeJson(loginDoc, buffer, bufferSize);
+    return len > 0 && len < bufferSize - 1 ? len : 0;
+}
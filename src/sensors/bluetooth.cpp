@@ -3,7 +3,17 @@
  * @brief Bluetooth Client Class
  *
  * @details This file contains the implementation of the BluetoothClient class, which is used to
- * manage Bluetooth connections and notifications.
+ * manage Bluetooth connections and notifications. The whitelist is parsed once in begin(); scan
+ * results are matched by their numeric address. Only one connection is set up at a time, scanning
+ * resumes once no strap is between advertising and subscribed.
+ *
+ * Scanning is passive, nothing is transmitted, and the controller drops every advertisement that is
+ * not from a whitelisted address before it reaches the host. The scan interval and window come
+ * from the ScanPolicy and follow the time since a strap was lost; the connection transmit power is
+ * retuned from the straps' RSSI every RSSI_POLL_MS.
+ *
+ * A link connects with the setup profile's short intervals and switches to the streaming profile
+ * once it is subscribed; a bulk transfer switches it to the bulk profile and back.
  */
 
 #include "sensors/bluetooth.h"
@@ -12,6 +22,11 @@
 #include <Arduino.h>
 #include <NimBLEDevice.h>
 
+#ifndef STRAP_ADDRESSES
+#define STRAP_ADDRESSES STRAP_ADDRESS
+#endif
+
+
 static BluetoothClient* g_btClient = nullptr;
 
 /**
@@ -21,7 +36,6 @@ static BluetoothClient* g_btClient = nullptr;
 BluetoothClient::BluetoothClient()
 {
     g_btClient = this;
-    setConnectionState(STATE_SCANNING);
 }
 
 /**
@@ -41,17 +55,21 @@ BluetoothClient::~BluetoothClient()
         pScan->stop();
     }
 
-    cleanupClient();
+    for (size_t i = 0; i < strapCount; i++)
+    {
+        cleanupClient(straps[i]);
+    }
 
     g_btClient = nullptr;
 }
 
 /**
- * @brief Set the connect flag for the Bluetooth client
+ * @brief Set the connect flag for a whitelisted strap
  *
  * @param device The advertised device to connect to
  *
- * @details This function sets the connect flag and safely stores the device address.
+ * @details Called from the scan callback for every advertisement, so anything that is not a
+ * strap still looking for its connection is rejected by the address lookup alone.
  */
 void BluetoothClient::setConnectFlag(const NimBLEAdvertisedDevice* device)
 {
@@ -61,31 +79,73 @@ void BluetoothClient::setConnectFlag(const NimBLEAdvertisedDevice* device)
         return;
     }
 
-    targetDeviceAddress = device->getAddress();
-    hasTargetDevice = true;
-    doConnect = true;
+    int index = whitelist.indexOf(device->getAddress());
+    if (index < 0 || (size_t)index >= strapCount)
+    {
+        return;
+    }
+    Strap& strap = straps[index];
+    if (strap.state != STATE_SCANNING || strap.seen)
+    {
+        return;
+    }
+
+    strap.address = device->getAddress();
+    strap.seen = true;
+    strap.rssi = device->getRSSI();
+    safePrintf("[BT] Strap %d found: %s\n", index, strap.address.toString().c_str());
+
+    NimBLEDevice::getScan()->stop();
 }
 
 /**
  * @brief Initialize the Bluetooth client
  *
- * @details This function initializes the Bluetooth client and starts scanning for devices.
+ * @details This function parses the strap whitelist, loads it into the controller's filter accept
+ * list, initializes the Bluetooth client and starts a passive scan for the straps. Straps may
+ * advertise a public or a random static address, so both types are accepted. If the accept list is
+ * full the scan runs unfiltered and the host filters by address alone.
  */
 void BluetoothClient::begin()
 {
+    strapCount = whitelist.parse(STRAP_ADDRESSES);
+    if (strapCount > HR_MAX_STRAPS)
+    {
+        safePrintf("[BT] Only the first %d straps are used\n", HR_MAX_STRAPS);
+        strapCount = HR_MAX_STRAPS;
+    }
+    if (strapCount == 0)
+    {
+        safePrintln("[BT] No valid address in STRAP_ADDRESSES");
+    }
+
     NimBLEDevice::init("");
-    NimBLEDevice::setPower(ESP_PWR_LVL_P9);
+    txPower = ScanPolicy::maxPower();
+    NimBLEDevice::setPower(txPower);
+
+    bool filtered = strapCount > 0;
+    for (size_t i = 0; i < strapCount; i++)
+    {
+        uint64_t address = whitelist.get(i);
+        filtered = filtered &&
+            NimBLEDevice::whiteListAdd(NimBLEAddress(address, BLE_ADDR_PUBLIC)) &&
+            NimBLEDevice::whiteListAdd(NimBLEAddress(address, BLE_ADDR_RANDOM));
+    }
+    if (!filtered)
+    {
+        safePrintln("[BT] Filter accept list not set, scanning unfiltered");
+    }
+
     NimBLEScan* pScan = NimBLEDevice::getScan();
     pScan->setScanCallbacks(new ScanCallbacks(this));
-    pScan->setActiveScan(true);
-    pScan->setInterval(80);
-    pScan->setWindow(40);
+    pScan->setActiveScan(false);
+    pScan->setFilterPolicy(filtered ? BLE_HCI_SCAN_FILT_USE_WL : BLE_HCI_SCAN_FILT_NO_WL);
     pScan->setMaxResults(0);
 
-    setConnectionState(STATE_SCANNING);
-
-    safePrintln("[BT] Starting scanning...");
-    bool scanStarted = pScan->start(0, false);
+    startTime = millis();
+    scanPolicy.begin(startTime);
+    safePrintf("[BT] Starting scanning for %d straps...\n", strapCount);
+    bool scanStarted = startScan();
 
     if (!scanStarted)
     {
@@ -102,193 +162,222 @@ void BluetoothClient::begin()
 /**
  * @brief Loop function for the Bluetooth client
  *
- * @details This function uses a state machine to handle connection process with timeout protection
+ * @details This function runs each strap's state machine with timeout protection, starts at most
+ * one connection at a time and keeps scanning while a strap has not been found. A running scan is
+ * restarted when the policy steps its duty cycle down.
  */
 void BluetoothClient::loop()
 {
-    checkWatchdog();
-
     uint32_t currentTime = millis();
 
-    if (connectionState != STATE_SCANNING && connectionState != STATE_CONNECTED)
+    bool scanning = isScanning();
+    scanPolicy.update(currentTime, scanning);
+    scan_params_t params = scanPolicy.params(currentTime);
+    if (scanning && params.intervalMs != scanParams.intervalMs)
     {
-        uint32_t stateTimeout = 0;
-        switch (connectionState)
-        {
-            case STATE_CONNECTING:
-                stateTimeout = 10000;
-                break;
-            case STATE_DISCOVERING_SERVICES:
-                stateTimeout = 5000;
-                break;
-            case STATE_SUBSCRIBING:
-                stateTimeout = 3000;
-                break;
-            default:
-                stateTimeout = 8000;
-                break;
-        }
+#if DEBUG
+        safePrintf("[BT] Scan duty now %d/%d ms\n", params.windowMs, params.intervalMs);
+#endif
+        restartScanning();
+    }
 
-        if (currentTime - stateStartTime > stateTimeout)
-        {
-            handleConnectionFailure();
-            return;
-        }
+    if (currentTime - lastRssiPoll >= RSSI_POLL_MS)
+    {
+        lastRssiPoll = currentTime;
+        tuneTxPower();
+        updateLinks();
     }
 
-    switch (connectionState)
+    for (size_t i = 0; i < strapCount; i++)
     {
-        case STATE_SCANNING:
-            if (!isScanning())
+        Strap& strap = straps[i];
+        checkWatchdog(strap);
+
+        if (strap.state != STATE_SCANNING && strap.state != STATE_CONNECTED)
+        {
+            uint32_t stateTimeout = 0;
+            switch (strap.state)
             {
-#if DEBUG
-                safePrintln("[BT] Scan stopped unexpectedly, restarting...");
-#endif
-                restartScanning();
+                case STATE_CONNECTING:
+                    stateTimeout = 10000;
+                    break;
+                case STATE_DISCOVERING_SERVICES:
+                    stateTimeout = 5000;
+                    break;
+                case STATE_SUBSCRIBING:
+                    stateTimeout = 3000;
+                    break;
+                default:
+                    stateTimeout = 8000;
+                    break;
             }
 
-            if (doConnect && hasTargetDevice)
+            if (currentTime - strap.stateStartTime > stateTimeout)
             {
-                if (currentTime - lastConnectionAttempt >= CONNECTION_DELAY_MS)
-                {
-                    startConnectionAttempt();
-                }
+                handleConnectionFailure(strap);
+                continue;
             }
-            break;
-
-        case STATE_CONNECTING:
-            break;
+        }
 
-        case STATE_DISCOVERING_SERVICES:
-            break;
+        // A strap that dropped is reconnected at the address it was found at
+        if (strap.state == STATE_DISCONNECTED && currentTime - strap.lastConnectionAttempt >= 1000)
+        {
+            setConnectionState(strap, STATE_SCANNING);
+        }
+    }
 
-        case STATE_SUBSCRIBING:
-            break;
+    if (isBusy())
+    {
+        return;
+    }
 
-        case STATE_CONNECTED:
-            break;
+    for (size_t i = 0; i < strapCount; i++)
+    {
+        Strap& strap = straps[i];
+        if (strap.state == STATE_SCANNING && strap.seen &&
+            currentTime - strap.lastConnectionAttempt >= CONNECTION_DELAY_MS)
+        {
+            startConnectionAttempt(strap);
+            return;
+        }
+    }
 
-        case STATE_DISCONNECTED:
-            if (hasTargetDevice && currentTime - lastConnectionAttempt >= 1000)
-            {
-                setConnectionState(STATE_SCANNING);
-                restartScanning();
-                doConnect = true;
-            }
-            break;
+    if (needsScan() && !isScanning())
+    {
+#if DEBUG
+        safePrintln("[BT] Scan stopped, restarting...");
+#endif
+        restartScanning();
     }
 }
 
 /**
- * @brief Set connection state and update timing
+ * @brief Set a strap's connection state and update timing
  *
+ * @param strap The strap
  * @param newState The new connection state
  */
-void BluetoothClient::setConnectionState(ConnectionState newState)
+void BluetoothClient::setConnectionState(Strap& strap, ConnectionState newState)
 {
-    if (connectionState != newState)
+    if (strap.state != newState)
     {
 #if DEBUG
-        safePrintf("[BT] State: %d -> %d\n", connectionState, newState);
+        safePrintf("[BT] Strap %d state: %d -> %d\n", (int)(&strap - straps), strap.state,
+            newState);
 #endif
-        connectionState = newState;
-        stateStartTime = millis();
+        uint32_t now = millis();
+        bool lost = strap.state == STATE_CONNECTED;
+        if (newState == STATE_CONNECTED && strap.reconnecting)
+        {
+            strap.reconnecting = false;
+            scanPolicy.onReconnected(now - strap.lostAt);
+            safePrintf("[BT] Strap %d reconnected after %lu ms\n", (int)(&strap - straps),
+                now - strap.lostAt);
+        }
+        strap.state = newState;
+        strap.stateStartTime = now;
+
+        if (lost)
+        {
+            // Scan fast again and reconnect at full power
+            strap.lostAt = now;
+            strap.reconnecting = true;
+            strap.rssi = 0;
+            scanPolicy.onLost(now);
+            tuneTxPower();
+        }
     }
 }
 
 /**
  * @brief Start a connection attempt with state management
  */
-void BluetoothClient::startConnectionAttempt()
+void BluetoothClient::startConnectionAttempt(Strap& strap)
 {
-    if (!hasTargetDevice)
-    {
-#if DEBUG
-        safePrintln("[BT] No target device stored, clearing connect flag");
-#endif
-        doConnect = false;
-        return;
-    }
-
-    lastConnectionAttempt = millis();
-    connectionAttempts++;
+    strap.lastConnectionAttempt = millis();
+    strap.connectionAttempts++;
 
-    if (connectionAttempts > MAX_CONNECTION_ATTEMPTS)
+    if (strap.connectionAttempts > MAX_CONNECTION_ATTEMPTS)
     {
         safePrintln("[BT] Max connection attempts reached, restarting scan");
-        handleConnectionFailure();
+        handleConnectionFailure(strap);
         return;
     }
 
     safePrintf("[BT] Connection attempt %d/%d to %s\n",
-        connectionAttempts, MAX_CONNECTION_ATTEMPTS,
-        targetDeviceAddress.toString().c_str());
+        strap.connectionAttempts, MAX_CONNECTION_ATTEMPTS,
+        strap.address.toString().c_str());
 
-    cleanupClient();
+    cleanupClient(strap);
 
-    setConnectionState(STATE_CONNECTING);
+    if (isScanning())
+    {
+        NimBLEDevice::getScan()->stop();
+    }
+
+    setConnectionState(strap, STATE_CONNECTING);
 
-    pClient = NimBLEDevice::createClient();
-    if (!pClient)
+    strap.pClient = NimBLEDevice::createClient();
+    if (!strap.pClient)
     {
         safePrintln("[BT] Failed to create client");
-        handleConnectionFailure();
+        handleConnectionFailure(strap);
         return;
     }
 
-    pClient->setClientCallbacks(this, false);
-    //pClient->setConnectionParams(16, 32, 0, 400); // default is good enough
-    pClient->setConnectTimeout(2 * 3000); // timeout efter 3s
+    strap.pClient->setClientCallbacks(this, false);
+    const ble_conn_params_t& setup = ConnectionProfile::params(BLE_PROFILE_SETUP);
+    strap.pClient->setConnectionParams(setup.minInterval, setup.maxInterval, setup.latency,
+        setup.timeout);
+    strap.pClient->setConnectTimeout(CONNECT_TIMEOUT_MS);
 
 #if DEBUG
     safePrintln("[BT] Starting async connection...");
 #endif
 
-    bool connectResult = pClient->connect(targetDeviceAddress);
+    bool connectResult = strap.pClient->connect(strap.address);
 
     if (!connectResult)
     {
         safePrintln("[BT] Immediate connection failure");
-        handleConnectionFailure();
+        handleConnectionFailure(strap);
     }
 }
 
 /**
  * @brief Handle connection failure and reset state
  */
-void BluetoothClient::handleConnectionFailure()
+void BluetoothClient::handleConnectionFailure(Strap& strap)
 {
 #if DEBUG
     safePrintln("[BT] Handling connection failure");
 #endif
 
-    cleanupClient();
-    doConnect = false;
+    cleanupClient(strap);
 
-    if (connectionAttempts >= MAX_CONNECTION_ATTEMPTS)
+    if (strap.connectionAttempts >= MAX_CONNECTION_ATTEMPTS)
     {
-        safePrintln("[BT] Max attempts reached, clearing target device");
-        connectionAttempts = 0;
-        hasTargetDevice = false;
-        setConnectionState(STATE_SCANNING);
-        restartScanning();
+        safePrintln("[BT] Max attempts reached, scanning for the strap again");
+        strap.connectionAttempts = 0;
+        strap.seen = false;
+        setConnectionState(strap, STATE_SCANNING);
     }
     else
     {
 #if DEBUG
         safePrintln("[BT] Will retry connection");
 #endif
-        setConnectionState(STATE_DISCONNECTED);
-        lastConnectionAttempt = millis();
+        setConnectionState(strap, STATE_DISCONNECTED);
+        strap.lastConnectionAttempt = millis();
     }
 }
 
 /**
  * @brief Discover services with timeout protection
  */
-void BluetoothClient::discoverServices()
+void BluetoothClient::discoverServices(Strap& strap)
 {
-    setConnectionState(STATE_DISCOVERING_SERVICES);
+    setConnectionState(strap, STATE_DISCOVERING_SERVICES);
 
 #if DEBUG
     safePrintln("[BT] Starting service discovery...");
@@ -296,7 +385,7 @@ void BluetoothClient::discoverServices()
 
     vTaskDelay(pdMS_TO_TICKS(50));
 
-    NimBLERemoteService* heartRateService = pClient->getService(HEARTRATE_SERVICE_UUID);
+    NimBLERemoteService* heartRateService = strap.pClient->getService(HEARTRATE_SERVICE_UUID);
 
     if (heartRateService)
     {
@@ -314,47 +403,50 @@ void BluetoothClient::discoverServices()
 #if DEBUG
             safePrintln("[BT] Heart rate characteristic found, subscribing...");
 #endif
-            subscribeToCharacteristic(heartRateChar);
+            subscribeToCharacteristic(strap, heartRateChar);
         }
         else
         {
             safePrintln("[BT] HR characteristic not found or can't notify");
-            handleConnectionFailure();
+            handleConnectionFailure(strap);
         }
     }
     else
     {
         safePrintln("[BT] HR service not found");
-        handleConnectionFailure();
+        handleConnectionFailure(strap);
     }
 }
 
 /**
  * @brief Subscribe to characteristic with timeout protection
  */
-void BluetoothClient::subscribeToCharacteristic(NimBLERemoteCharacteristic* characteristic)
+void BluetoothClient::subscribeToCharacteristic(Strap& strap,
+    NimBLERemoteCharacteristic* characteristic)
 {
-    setConnectionState(STATE_SUBSCRIBING);
+    setConnectionState(strap, STATE_SUBSCRIBING);
 
     vTaskDelay(pdMS_TO_TICKS(50));
 
-    bool subscribeResult = characteristic->subscribe(true, [this](NimBLERemoteCharacteristic* c,
-        uint8_t* data, size_t len, bool isNotify)
+    bool subscribeResult = characteristic->subscribe(true,
+        [this, &strap](NimBLERemoteCharacteristic*, uint8_t* data, size_t len, bool)
         {
-            this->onHeartRateNotify(c, data, len, isNotify);
+            this->onHeartRateNotify(strap, data, len);
         });
 
     if (subscribeResult)
     {
-        safePrintln("[BT] Successfully subscribed to heart rate notifications");
-        connectionAttempts = 0;
-        lastHeartRateUpdate = millis();
-        setConnectionState(STATE_CONNECTED);
+        safePrintf("[BT] Strap %d subscribed to heart rate notifications\n",
+            (int)(&strap - straps));
+        strap.connectionAttempts = 0;
+        strap.lastHeartRateUpdate = millis();
+        applyProfile(strap, BLE_PROFILE_STREAMING);
+        setConnectionState(strap, STATE_CONNECTED);
     }
     else
     {
         safePrintln("[BT] Failed to subscribe to notifications");
-        handleConnectionFailure();
+        handleConnectionFailure(strap);
     }
 }
 
@@ -369,9 +461,11 @@ void BluetoothClient::onConnect(NimBLEClient* pClient)
 {
     safePrintln("[BT] Connected callback triggered");
 
-    if (connectionState == STATE_CONNECTING)
+    Strap* strap = findStrap(pClient);
+    if (strap && strap->state == STATE_CONNECTING)
     {
-        discoverServices();
+        strap->link.set(BLE_PROFILE_SETUP, millis());
+        discoverServices(*strap);
     }
 }
 
@@ -385,46 +479,94 @@ void BluetoothClient::onConnect(NimBLEClient* pClient)
  */
 void BluetoothClient::onDisconnect(NimBLEClient* pClient, int reason)
 {
-    safePrintf("[BT] Disconnected (reason=%d)\n", reason);
+    Strap* strap = findStrap(pClient);
+    if (!strap)
+    {
+        return;
+    }
+    safePrintf("[BT] Strap %d disconnected (reason=%d)\n", (int)(strap - straps), reason);
 
-    connectionAttempts = 0;
-    cleanupClient();
+    strap->connectionAttempts = 0;
+    cleanupClient(*strap);
 
-    setConnectionState(STATE_DISCONNECTED);
-    lastConnectionAttempt = millis();
+    setConnectionState(*strap, STATE_DISCONNECTED);
+    strap->lastConnectionAttempt = millis();
+}
 
-    if (hasTargetDevice)
+/**
+ * @brief Strap a client belongs to, nullptr if none
+ */
+BluetoothClient::Strap* BluetoothClient::findStrap(const NimBLEClient* client)
+{
+    for (size_t i = 0; i < strapCount; i++)
     {
-        doConnect = true;
+        if (straps[i].pClient && straps[i].pClient == client)
+        {
+            return &straps[i];
+        }
     }
+    return nullptr;
 }
 
 /**
- * @brief Clean up the current client connection
+ * @brief Whether a strap is between a connection attempt and its subscription
+ */
+bool BluetoothClient::isBusy() const
+{
+    for (size_t i = 0; i < strapCount; i++)
+    {
+        ConnectionState state = straps[i].state;
+        if (state == STATE_CONNECTING || state == STATE_DISCOVERING_SERVICES ||
+            state == STATE_SUBSCRIBING)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Whether a strap has not been found yet
+ */
+bool BluetoothClient::needsScan() const
+{
+    for (size_t i = 0; i < strapCount; i++)
+    {
+        if (straps[i].state == STATE_SCANNING && !straps[i].seen)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Clean up a strap's client connection
  *
- * @details Safely disconnects and deletes the current client
+ * @details Safely disconnects and deletes the client
  */
-void BluetoothClient::cleanupClient()
+void BluetoothClient::cleanupClient(Strap& strap)
 {
-    if (pClient)
+    if (strap.pClient)
     {
-        if (pClient->isConnected())
+        if (strap.pClient->isConnected())
         {
-            pClient->disconnect();
+            strap.pClient->disconnect();
         }
-        NimBLEDevice::deleteClient(pClient);
-        pClient = nullptr;
+        NimBLEDevice::deleteClient(strap.pClient);
+        strap.pClient = nullptr;
     }
+    strap.link.set(BLE_PROFILE_NONE, millis());
 }
 
 /**
- * @brief Check if currently connected to a device
+ * @brief Check if a strap is connected
  *
  * @return true if connected, false otherwise
  */
-bool BluetoothClient::isConnected() const
+bool BluetoothClient::isConnected(const Strap& strap) const
 {
-    return pClient && pClient->isConnected();
+    return strap.pClient && strap.pClient->isConnected();
 }
 
 /**
@@ -438,6 +580,108 @@ bool BluetoothClient::isScanning() const
     return pScan && pScan->isScanning();
 }
 
+/**
+ * @brief Start a continuous scan with the policy's interval and window
+ */
+bool BluetoothClient::startScan()
+{
+    scanParams = scanPolicy.params(millis());
+    NimBLEScan* pScan = NimBLEDevice::getScan();
+    pScan->setInterval(scanParams.intervalMs);
+    pScan->setWindow(scanParams.windowMs);
+    return pScan->start(0, false);
+}
+
+/**
+ * @brief Retune the connection transmit power to the weakest connected strap
+ *
+ * @details The RSSI of each connected strap is smoothed over polls. With no strap connected, or
+ * shortly after one was lost, the power goes back to the maximum so the next connection starts
+ * from a reliable link.
+ */
+void BluetoothClient::tuneTxPower()
+{
+    bool any = false;
+    int weakest = 0;
+    for (size_t i = 0; i < strapCount; i++)
+    {
+        Strap& strap = straps[i];
+        if (strap.state != STATE_CONNECTED || !isConnected(strap))
+        {
+            continue;
+        }
+        int rssi = strap.pClient->getRssi();
+        if (rssi < 0)
+        {
+            strap.rssi = strap.rssi < 0 ? (3 * strap.rssi + rssi) / 4 : rssi;
+        }
+        if (strap.rssi < 0 && (!any || strap.rssi < weakest))
+        {
+            weakest = strap.rssi;
+            any = true;
+        }
+    }
+
+    int8_t power = ScanPolicy::maxPower();
+    if (any && !scanPolicy.isRecovering(millis()))
+    {
+        power = ScanPolicy::tunePower(txPower, weakest);
+    }
+    if (power != txPower && NimBLEDevice::setPower(power, NimBLETxPowerType::Connection))
+    {
+#if DEBUG
+        safePrintf("[BT] TX power %d -> %d dBm (weakest RSSI %d dBm)\n", txPower, power, weakest);
+#endif
+        txPower = power;
+    }
+}
+
+/**
+ * @brief Negotiate a profile's connection parameters and PHY with a connected strap
+ *
+ * @details The strap may answer with other parameters; the interval it settles on is read back by
+ * updateLinks(). A strap without the 2M PHY stays on 1M, the PHY update then completes unchanged.
+ */
+bool BluetoothClient::applyProfile(Strap& strap, ble_profile_t profile)
+{
+    const ble_conn_params_t& p = ConnectionProfile::params(profile);
+    if (!strap.pClient->updateConnParams(p.minInterval, p.maxInterval, p.latency, p.timeout))
+    {
+        safePrintf("[BT] Strap %d: connection parameter update failed\n", (int)(&strap - straps));
+        return false;
+    }
+    if (p.phyMask != ConnectionProfile::params(strap.link.get()).phyMask)
+    {
+        strap.pClient->updatePhy(p.phyMask, p.phyMask);
+    }
+    if (profile == BLE_PROFILE_BULK)
+    {
+        strap.pClient->setDataLen(251); // longest link layer packet, fewer packets per transfer
+    }
+    strap.link.set(profile, millis());
+#if DEBUG
+    safePrintf("[BT] Strap %d: profile %d, interval %d-%d x 1.25 ms, latency %d\n",
+        (int)(&strap - straps), profile, p.minInterval, p.maxInterval, p.latency);
+#endif
+    return true;
+}
+
+/**
+ * @brief Read back the connection interval each connected strap runs at
+ */
+void BluetoothClient::updateLinks()
+{
+    uint32_t now = millis();
+    for (size_t i = 0; i < strapCount; i++)
+    {
+        Strap& strap = straps[i];
+        if (strap.state == STATE_CONNECTED && isConnected(strap))
+        {
+            strap.link.onNegotiated(strap.pClient->getConnInfo().getConnInterval(), now);
+        }
+    }
+}
+
 /**
  * @brief Restart the scanning process
  *
@@ -457,7 +701,7 @@ void BluetoothClient::restartScanning()
 #if DEBUG
         safePrintln("[BT] Restarting scan...");
 #endif
-        bool scanStarted = pScan->start(0, false);
+        bool scanStarted = startScan();
 
         if (!scanStarted)
         {
@@ -468,7 +712,6 @@ void BluetoothClient::restartScanning()
 #if DEBUG
             safePrintln("[BT] Scan restarted successfully");
 #endif
-            setConnectionState(STATE_SCANNING);
         }
     }
 }
@@ -476,18 +719,18 @@ void BluetoothClient::restartScanning()
 /**
  * @brief Check watchdog conditions and handle timeout scenarios
  *
- * @details Monitors heart rate updates and scan status for hangs
+ * @details Monitors a connected strap's heart rate updates for hangs
  */
-void BluetoothClient::checkWatchdog()
+void BluetoothClient::checkWatchdog(Strap& strap)
 {
     uint32_t currentTime = millis();
 
     // Check heart rate timeout only when connected
-    if (connectionState == STATE_CONNECTED &&
-        (currentTime - lastHeartRateUpdate > HEARTRATE_TIMEOUT_MS))
+    if (strap.state == STATE_CONNECTED &&
+        (currentTime - strap.lastHeartRateUpdate > HEARTRATE_TIMEOUT_MS))
     {
         safePrintln("[BT] Watchdog: Heart rate timeout, reconnecting");
-        handleConnectionFailure();
+        handleConnectionFailure(strap);
         return;
     }
 }
@@ -495,43 +738,144 @@ void BluetoothClient::checkWatchdog()
 /**
  * @brief Get the heart rate value
  *
- * @return uint8_t The heart rate value
- *
- * @details This function returns the current heart rate value.
+ * @return uint8_t The latest heart rate of the most recently updated connected strap, 0 if none
  */
 uint8_t BluetoothClient::getHeartRate() const
 {
-    // returnera 0 om felaktigt värde
-    return (heartRate == 255) ? 0 : heartRate;
+    const Strap* latest = nullptr;
+    for (size_t i = 0; i < strapCount; i++)
+    {
+        const Strap& strap = straps[i];
+        if (strap.state == STATE_CONNECTED &&
+            (!latest || (int32_t)(strap.lastHeartRateUpdate - latest->lastHeartRateUpdate) > 0))
+        {
+            latest = &strap;
+        }
+    }
+    if (!latest)
+    {
+        return 0;
+    }
+    return latest->heartRate > 255 ? 255 : latest->heartRate;
+}
+
+size_t BluetoothClient::getStrapCount() const
+{
+    return strapCount;
+}
+
+bool BluetoothClient::isStrapConnected(size_t strap) const
+{
+    return strap < strapCount && straps[strap].state == STATE_CONNECTED &&
+        isConnected(straps[strap]);
+}
+
+/**
+ * @brief Scan duty cycle and time-to-reconnect counters
+ */
+scan_stats_t BluetoothClient::getScanStats() const
+{
+    return scanPolicy.getStats(millis());
+}
+
+/**
+ * @brief Connection transmit power in dBm
+ */
+int8_t BluetoothClient::getTxPower() const
+{
+    return txPower;
+}
+
+/**
+ * @brief Radio-on time of scanning and connections, and its average per hour
+ */
+ble_radio_stats_t BluetoothClient::getRadioStats() const
+{
+    uint32_t now = millis();
+    ble_radio_stats_t stats = {};
+    stats.scanMs = scanPolicy.getStats(now).receiveTimeMs;
+    for (size_t i = 0; i < strapCount; i++)
+    {
+        stats.connectionMs += straps[i].link.getRadioOnMs(now);
+    }
+    uint32_t elapsed = now - startTime;
+    if (elapsed > 0)
+    {
+        stats.onMsPerHour =
+            (uint32_t)((uint64_t)(stats.scanMs + stats.connectionMs) * 3600000 / elapsed);
+    }
+    return stats;
+}
+
+/**
+ * @brief Switch a subscribed strap to short intervals and the 2M PHY for a bulk transfer
+ *
+ * @return false if the strap is not connected or refused the update
+ */
+bool BluetoothClient::beginBulkTransfer(size_t strap)
+{
+    if (!isStrapConnected(strap))
+    {
+        return false;
+    }
+    return straps[strap].link.get() == BLE_PROFILE_BULK ||
+        applyProfile(straps[strap], BLE_PROFILE_BULK);
+}
+
+/**
+ * @brief Return a strap to the streaming profile after a bulk transfer
+ */
+void BluetoothClient::endBulkTransfer(size_t strap)
+{
+    if (isStrapConnected(strap) && straps[strap].link.get() == BLE_PROFILE_BULK)
+    {
+        applyProfile(straps[strap], BLE_PROFILE_STREAMING);
+    }
+}
+
+/**
+ * @brief Take a strap's buffered notifications, oldest first
+ *
+ * @return Number of notifications copied to out
+ */
+size_t BluetoothClient::readSamples(size_t strap, hr_sample_t* out, size_t max)
+{
+    return strap < strapCount ? straps[strap].samples.pop(out, max) : 0;
+}
+
+size_t BluetoothClient::getPendingSamples(size_t strap) const
+{
+    return strap < strapCount ? straps[strap].samples.size() : 0;
+}
+
+uint32_t BluetoothClient::getDroppedSamples(size_t strap) const
+{
+    return strap < strapCount ? straps[strap].samples.getDropped() : 0;
 }
 
 /**
  * @brief Callback function for heart rate notifications
  *
- * @param c The characteristic that sent the notification
+ * @param strap The strap that sent the notification
  * @param data The notification data
  * @param len The length of the notification data
- * @param isNotify Whether the notification is a notify or indicate
  *
- * @details This function is called when a heart rate notification is received.
+ * @details This function is called from the BLE host task when a heart rate notification is
+ * received. The decoded notification, RR-intervals included, is buffered; one too short for the
+ * fields its flags announce is ignored.
  */
-void BluetoothClient::onHeartRateNotify(NimBLERemoteCharacteristic*, uint8_t* data, size_t len,
-    bool)
+void BluetoothClient::onHeartRateNotify(Strap& strap, uint8_t* data, size_t len)
 {
-    if (len > 0)
+    hr_sample_t sample;
+    if (!parseHeartRateMeasurement(data, len, sample.measurement))
     {
-        uint8_t flags = data[0];
-        if ((flags & 0x01) == 0)
-        {
-            heartRate = data[1];
-        }
-        else
-        {
-            heartRate = (data[2] << 8) | data[1];
-        }
-
-        lastHeartRateUpdate = millis();
+        return;
     }
+
+    sample.time = millis();
+    strap.samples.push(sample);
+    strap.heartRate = sample.measurement.bpm;
+    strap.lastHeartRateUpdate = sample.time;
 }
 
 /**
@@ -545,19 +889,5 @@ void ScanCallbacks::onResult(const NimBLEAdvertisedDevice* advertisedDevice)
 {
     if (!advertisedDevice) return;
 
-    std::string advAddr = advertisedDevice->getAddress().toString();
-    std::string targetAddr = STRAP_ADDRESS;
-
-    std::transform(advAddr.begin(), advAddr.end(), advAddr.begin(), ::tolower);
-    std::transform(targetAddr.begin(), targetAddr.end(), targetAddr.begin(), ::tolower);
-
-    if (advAddr == targetAddr)
-    {
-        safePrint("[BT] Target device found: ");
-        safePrintln(advAddr.c_str());
-
-        NimBLEDevice::getScan()->stop();
-        
-        client->setConnectFlag(advertisedDevice);
-    }
+    client->setConnectFlag(advertisedDevice);
 }
@@ -0,0 +1,95 @@
+/**
+ * @file connectionProfile.cpp
+ * @brief BLE Connection Profiles and Radio Time Accounting Implementation
+ *
+ * @details The supervision timeout of each profile is well above the 2 * (1 + latency) * interval
+ * the specification requires, so a strap using all of its latency is not dropped.
+ */
+
+#include "sensors/connectionProfile.h"
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef BT_CONN_EVENT_US
+#define BT_CONN_EVENT_US 500 // radio on per connection event, empty packets or a notification
+#endif
+
+static const ble_conn_params_t PROFILES[] = {
+    {0, 0, 0, 0, BLE_PHY_1M_MASK},                  // none
+    {12, 24, 0, 400, BLE_PHY_1M_MASK},              // setup: 15-30 ms, 4 s
+    {320, 400, 2, 600, BLE_PHY_1M_MASK},            // streaming: 400-500 ms, skip 2, 6 s
+    {6, 12, 0, 200, BLE_PHY_2M_MASK},               // bulk: 7.5-15 ms, 2 s
+};
+
+ConnectionProfile::ConnectionProfile() : profile(BLE_PROFILE_NONE), interval(0), since(0), onUs(0)
+{
+}
+
+/**
+ * @brief Parameters negotiated for a profile
+ */
+const ble_conn_params_t& ConnectionProfile::params(ble_profile_t profile)
+{
+    return PROFILES[profile <= BLE_PROFILE_BULK ? profile : BLE_PROFILE_NONE];
+}
+
+/**
+ * @brief The link switched to a profile, BLE_PROFILE_NONE once it is down
+ */
+void ConnectionProfile::set(ble_profile_t newProfile, uint32_t now)
+{
+    integrate(now);
+    profile = newProfile;
+    interval = params(newProfile).maxInterval;
+}
+
+ble_profile_t ConnectionProfile::get() const
+{
+    return profile;
+}
+
+/**
+ * @brief The interval the link actually runs at, which the peripheral may have chosen
+ *
+ * @param interval 1.25 ms
+ */
+void ConnectionProfile::onNegotiated(uint16_t newInterval, uint32_t now)
+{
+    if (profile == BLE_PROFILE_NONE || newInterval == 0 || newInterval == interval)
+    {
+        return;
+    }
+    integrate(now);
+    interval = newInterval;
+}
+
+/**
+ * @brief Estimated radio-on time of this link since it was created
+ */
+uint32_t ConnectionProfile::getRadioOnMs(uint32_t now) const
+{
+    return (uint32_t)(radioOnUs(now) / 1000);
+}
+
+uint64_t ConnectionProfile::radioOnUs(uint32_t now) const
+{
+    uint64_t elapsedUs = (uint64_t)(now - since) * 1000;
+    if (profile == BLE_PROFILE_NONE || interval == 0)
+    {
+        return onUs;
+    }
+    if (profile == BLE_PROFILE_BULK)
+    {
+        return onUs + elapsedUs;
+    }
+    uint64_t events = elapsedUs / ((uint64_t)interval * 1250);
+    return onUs + events * BT_CONN_EVENT_US;
+}
+
+void ConnectionProfile::integrate(uint32_t now)
+{
+    onUs = radioOnUs(now);
+    since = now;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file heartRateBuffer.cpp
+ * @brief Heart Rate Notification Ring Buffer Implementation
+ */
+
+#include "sensors/heartRateBuffer.h"
+
+HeartRateBuffer::HeartRateBuffer() : dropped(0)
+{
+}
+
+/**
+ * @brief Add a notification, called from the BLE host task
+ *
+ * @return false if the ring is full and the notification was dropped
+ */
+bool HeartRateBuffer::push(const hr_sample_t& sample)
+{
+    if (!samples.put(sample))
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Take up to max notifications, oldest first
+ *
+ * @return Number of notifications copied to out
+ */
+size_t HeartRateBuffer::pop(hr_sample_t* out, size_t max)
+{
+    return samples.read(out, max);
+}
+
+size_t HeartRateBuffer::size() const
+{
+    return samples.size();
+}
+
+uint32_t HeartRateBuffer::getDropped() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file heartRateMeasurement.cpp
+ * @brief Heart Rate Measurement Characteristic Parser Implementation
+ *
+ * @details RR-intervals beyond HRM_MAX_RR, which only a larger negotiated MTU allows, are dropped
+ * from the end. A trailing odd byte after the RR-intervals is ignored.
+ */
+
+#include "sensors/heartRateMeasurement.h"
+
+#define HRM_FLAG_UINT16 0x01
+#define HRM_FLAG_CONTACT_DETECTED 0x02
+#define HRM_FLAG_CONTACT_SUPPORTED 0x04
+#define HRM_FLAG_ENERGY 0x08
+#define HRM_FLAG_RR 0x10
+
+static uint16_t readUint16(const uint8_t* data)
+{
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+/**
+ * @brief Decode one notification
+ *
+ * @return false if the notification is shorter than its flags announce
+ */
+bool parseHeartRateMeasurement(const uint8_t* data, size_t length, hrm_measurement_t& measurement)
+{
+    if (!data || length < 2)
+    {
+        return false;
+    }
+
+    uint8_t flags = data[0];
+    size_t pos = 1;
+
+    if (flags & HRM_FLAG_UINT16)
+    {
+        if (length < pos + 2)
+        {
+            return false;
+        }
+        measurement.bpm = readUint16(data + pos);
+        pos += 2;
+    }
+    else
+    {
+        measurement.bpm = data[pos++];
+    }
+
+    if (flags & HRM_FLAG_CONTACT_SUPPORTED)
+    {
+        measurement.contact = (flags & HRM_FLAG_CONTACT_DETECTED) ? 1 : 0;
+    }
+    else
+    {
+        measurement.contact = -1;
+    }
+
+    measurement.energy = -1;
+    if (flags & HRM_FLAG_ENERGY)
+    {
+        if (length < pos + 2)
+        {
+            return false;
+        }
+        measurement.energy = readUint16(data + pos);
+        pos += 2;
+    }
+
+    measurement.rrCount = 0;
+    if (flags & HRM_FLAG_RR)
+    {
+        for (; pos + 2 <= length && measurement.rrCount < HRM_MAX_RR; pos += 2)
+        {
+            measurement.rr[measurement.rrCount++] = readUint16(data + pos);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file hrvAnalyzer.cpp
+ * @brief Streaming Heart Rate Variability Analyzer Implementation
+ *
+ * @details The window is a ring of intervals. Each interval stores its difference to the one before
+ * it, so when the oldest interval leaves, the difference stored in the new oldest one, which was
+ * taken against it, leaves the sums too.
+ */
+
+#include "sensors/hrvAnalyzer.h"
+#include <cmath>
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef HRV_WINDOW_MS
+#define HRV_WINDOW_MS 60000 // ultra-short-term window, enough for a stable RMSSD
+#endif
+#ifndef HRV_MIN_BEATS
+#define HRV_MIN_BEATS 30    // in the window before a summary is reported
+#endif
+#define HRV_MIN_RR_MS 300   // 200 BPM
+#define HRV_MAX_RR_MS 2000  // 30 BPM
+#define HRV_MAX_CHANGE_PCT 20
+#define HRV_MAX_REJECTS 3   // consecutive artifacts after which the new rhythm is taken as real
+
+HrvAnalyzer::HrvAnalyzer()
+{
+    reset();
+}
+
+void HrvAnalyzer::reset()
+{
+    head = 0;
+    count = 0;
+    sum = 0;
+    sumSquares = 0;
+    diffSquares = 0;
+    diffs = 0;
+    nn50 = 0;
+    last = 0;
+    reference = 0;
+    seedCount = 0;
+    consecutiveRejects = 0;
+    rejected = 0;
+}
+
+/**
+ * @brief Add the next RR-interval in ms
+ *
+ * @details The first HRV_SEED_BEATS intervals are held back until their median gives the reference
+ * they are judged by, so an artifact among them cannot become the reference and reject the good
+ * beats after it.
+ *
+ * @return false if it was rejected as an artifact, true if it was accepted or held back
+ */
+bool HrvAnalyzer::addInterval(uint16_t rr)
+{
+    if (rr < HRV_MIN_RR_MS || rr > HRV_MAX_RR_MS)
+    {
+        return reject();
+    }
+    if (reference > 0)
+    {
+        return accept(rr);
+    }
+
+    seed[seedCount++] = rr;
+    if (seedCount < HRV_SEED_BEATS)
+    {
+        return true;
+    }
+    uint16_t sorted[HRV_SEED_BEATS];
+    for (size_t i = 0; i < HRV_SEED_BEATS; i++)
+    {
+        size_t j = i;
+        for (; j > 0 && sorted[j - 1] > seed[i]; j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = seed[i];
+    }
+    reference = sorted[HRV_SEED_BEATS / 2];
+    consecutiveRejects = 0;
+    seedCount = 0;
+    for (size_t i = 0; i + 1 < HRV_SEED_BEATS; i++)
+    {
+        accept(seed[i]);
+    }
+    return accept(rr);
+}
+
+/**
+ * @brief Mark notifications as lost, so no difference is taken across them
+ */
+void HrvAnalyzer::markGap()
+{
+    last = 0;
+    seedCount = 0; // the held back intervals would be differenced across the gap
+}
+
+/**
+ * @brief HRV over the current window
+ *
+ * @return false until the window holds HRV_MIN_BEATS intervals
+ */
+bool HrvAnalyzer::getSummary(hrv_summary_t& summary) const
+{
+    if (count < HRV_MIN_BEATS || diffs == 0)
+    {
+        return false;
+    }
+
+    double n = (double)count;
+    double mean = sum / n;
+    double variance = ((double)sumSquares - (double)sum * sum / n) / (n - 1);
+
+    summary.beats = (uint16_t)count;
+    summary.meanRr = (uint16_t)(mean + 0.5);
+    summary.sdnn = (float)sqrt(variance > 0 ? variance : 0);
+    summary.rmssd = (float)sqrt((double)diffSquares / diffs);
+    summary.pnn50 = 100.0f * nn50 / diffs;
+    return true;
+}
+
+/**
+ * @brief Intervals rejected as artifacts since the last reset
+ */
+uint32_t HrvAnalyzer::getRejected() const
+{
+    return rejected;
+}
+
+/**
+ * @brief Add an interval to the window unless it jumps too far from the reference
+ */
+bool HrvAnalyzer::accept(uint16_t rr)
+{
+    if (consecutiveRejects < HRV_MAX_REJECTS)
+    {
+        uint32_t change = rr > reference ? rr - reference : reference - rr;
+        if (change * 100 > (uint32_t)reference * HRV_MAX_CHANGE_PCT)
+        {
+            return reject();
+        }
+    }
+    consecutiveRejects = 0;
+
+    if (count == HRV_MAX_BEATS)
+    {
+        evictOldest();
+    }
+
+    Beat& beat = beats[(head + count) % HRV_MAX_BEATS];
+    beat.rr = rr;
+    beat.diff = NO_DIFF;
+    if (last > 0)
+    {
+        beat.diff = (int16_t)((int32_t)rr - last);
+        uint32_t magnitude = beat.diff < 0 ? -beat.diff : beat.diff;
+        diffSquares += magnitude * magnitude;
+        diffs++;
+        if (magnitude > 50)
+        {
+            nn50++;
+        }
+    }
+    count++;
+    sum += rr;
+    sumSquares += (uint32_t)rr * rr;
+    last = rr;
+    reference = rr;
+
+    while (sum > HRV_WINDOW_MS)
+    {
+        evictOldest();
+    }
+    return true;
+}
+
+bool HrvAnalyzer::reject()
+{
+    rejected++;
+    consecutiveRejects++;
+    last = 0;
+    if (reference == 0)
+    {
+        seedCount = 0; // the held back intervals would be differenced across the artifact
+    }
+    return false;
+}
+
+void HrvAnalyzer::evictOldest()
+{
+    const Beat& oldest = beats[head];
+    sum -= oldest.rr;
+    sumSquares -= (uint32_t)oldest.rr * oldest.rr;
+    head = (head + 1) % HRV_MAX_BEATS;
+    count--;
+
+    if (count > 0)
+    {
+        Beat& next = beats[head];
+        if (next.diff != NO_DIFF)
+        {
+            uint32_t magnitude = next.diff < 0 ? -next.diff : next.diff;
+            diffSquares -= magnitude * magnitude;
+            diffs--;
+            if (magnitude > 50)
+            {
+                nn50--;
+            }
+            next.diff = NO_DIFF;
+        }
+    }
+}
@@ -0,0 +1,179 @@
+/**
+ * @file scanPolicy.cpp
+ * @brief Low-Power BLE Scan and Transmit Power Policy Implementation
+ *
+ * @details Scan parameters step down from BT_SCAN_FAST to BT_SCAN_MEDIUM and BT_SCAN_SLOW as the
+ * time since the latest strap was lost grows. Receive time is integrated from the caller's periodic
+ * update() with the parameters in force since the previous one.
+ */
+
+#include "sensors/scanPolicy.h"
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef BT_SCAN_FAST_MS
+#define BT_SCAN_FAST_MS 30000    // fast scan after a strap is lost
+#endif
+#ifndef BT_SCAN_MEDIUM_MS
+#define BT_SCAN_MEDIUM_MS 300000 // then the medium scan, until a strap has been missing this long
+#endif
+#ifndef BT_RSSI_TARGET_DBM
+#define BT_RSSI_TARGET_DBM -75   // weakest strap RSSI the link is tuned for
+#endif
+#ifndef BT_TX_MAX_DBM
+#define BT_TX_MAX_DBM 9
+#endif
+#ifndef BT_TX_MIN_DBM
+#define BT_TX_MIN_DBM -12
+#endif
+#define BT_TX_STEP_DB 3
+#define BT_TX_HYSTERESIS_DB 4   // extra margin before the power is lowered
+#define BT_RECONNECT_WEIGHT_SHIFT 2 // reconnect time average, new sample weighs 1/4
+
+static const scan_params_t BT_SCAN_FAST = {60, 30};    // 50 %
+static const scan_params_t BT_SCAN_MEDIUM = {320, 32}; // 10 %
+static const scan_params_t BT_SCAN_SLOW = {1280, 32};  // 2.5 %, finds a 1 s advertiser in seconds
+
+ScanPolicy::ScanPolicy() : startTime(0), lostSince(0), lastUpdate(0), wasScanning(false)
+{
+    scanned = BT_SCAN_FAST;
+    stats = {};
+}
+
+/**
+ * @brief Start accounting, no strap is connected yet so the scan starts fast
+ */
+void ScanPolicy::begin(uint32_t now)
+{
+    startTime = now;
+    lostSince = now;
+    lastUpdate = now;
+}
+
+/**
+ * @brief A strap disconnected, scan fast again
+ */
+void ScanPolicy::onLost(uint32_t now)
+{
+    lostSince = now;
+}
+
+/**
+ * @brief A lost strap is subscribed again
+ *
+ * @param downtimeMs Time since the strap was lost
+ */
+void ScanPolicy::onReconnected(uint32_t downtimeMs)
+{
+    stats.lastReconnectMs = downtimeMs;
+    if (downtimeMs > stats.maxReconnectMs)
+    {
+        stats.maxReconnectMs = downtimeMs;
+    }
+    if (stats.reconnects++ == 0)
+    {
+        stats.avgReconnectMs = downtimeMs;
+    }
+    else
+    {
+        int32_t delta = (int32_t)(downtimeMs - stats.avgReconnectMs);
+        stats.avgReconnectMs += delta / (1 << BT_RECONNECT_WEIGHT_SHIFT);
+    }
+}
+
+/**
+ * @brief Scan parameters for the time since the latest strap was lost
+ */
+scan_params_t ScanPolicy::params(uint32_t now) const
+{
+    uint32_t missing = now - lostSince;
+    if (missing < BT_SCAN_FAST_MS)
+    {
+        return BT_SCAN_FAST;
+    }
+    if (missing < BT_SCAN_MEDIUM_MS)
+    {
+        return BT_SCAN_MEDIUM;
+    }
+    return BT_SCAN_SLOW;
+}
+
+/**
+ * @brief Whether a strap was lost recently enough to reconnect at full power
+ */
+bool ScanPolicy::isRecovering(uint32_t now) const
+{
+    return now - lostSince < BT_SCAN_FAST_MS;
+}
+
+/**
+ * @brief Account scan time up to now
+ *
+ * @param scanning The scanner is running now, with params(now)
+ */
+void ScanPolicy::update(uint32_t now, bool scanning)
+{
+    uint32_t elapsed = now - lastUpdate;
+    if (wasScanning)
+    {
+        stats.scanTimeMs += elapsed;
+        stats.receiveTimeMs +=
+            (uint32_t)((uint64_t)elapsed * scanned.windowMs / scanned.intervalMs);
+    }
+    lastUpdate = now;
+    wasScanning = scanning;
+    scanned = params(now);
+}
+
+/**
+ * @brief Connection transmit power for the weakest connected strap's RSSI
+ *
+ * @param current Transmit power in dBm now
+ * @param rssi Smoothed RSSI in dBm
+ * @return Transmit power in dBm, raised at once when the link needs it and lowered only once the
+ * RSSI clears the step by BT_TX_HYSTERESIS_DB
+ */
+int8_t ScanPolicy::tunePower(int8_t current, int rssi)
+{
+    int margin = rssi - BT_RSSI_TARGET_DBM;
+    int steps = margin > 0 ? margin / BT_TX_STEP_DB : 0;
+    int power = BT_TX_MAX_DBM - steps * BT_TX_STEP_DB;
+    if (power < BT_TX_MIN_DBM)
+    {
+        power = BT_TX_MIN_DBM;
+    }
+    if (power >= current)
+    {
+        return (int8_t)power;
+    }
+
+    margin -= BT_TX_HYSTERESIS_DB;
+    steps = margin > 0 ? margin / BT_TX_STEP_DB : 0;
+    power = BT_TX_MAX_DBM - steps * BT_TX_STEP_DB;
+    if (power < BT_TX_MIN_DBM)
+    {
+        power = BT_TX_MIN_DBM;
+    }
+    return (int8_t)(power < current ? power : current);
+}
+
+/**
+ * @brief Transmit power in dBm while no strap is connected, or after one was lost
+ */
+int8_t ScanPolicy::maxPower()
+{
+    return BT_TX_MAX_DBM;
+}
+
+/**
+ * @brief Counters, with the duty cycle over the time since begin
+ */
+scan_stats_t ScanPolicy::getStats(uint32_t now) const
+{
+    scan_stats_t out = stats;
+    uint32_t elapsed = now - startTime;
+    out.dutyPercent = elapsed > 0 ? 100.0f * out.receiveTimeMs / elapsed : 0;
+    return out;
+}
@@ -1,22 +1,57 @@
 #include "tasks/GPStask.h"
 #include "config.h"
+#include "network/agnss.h"
+#include "network/gnssScheduler.h"
+#include "network/modemPower.h"
+#include "network/positionFilter.h"
 #include "network/network.h"
+#include "utils/geofence.h"
 #include "utils/threadsafe_serial.h"
+#include "utils/track.h"
 #include "SensorData.h"
 #include <Arduino.h>
 
 extern QueueHandle_t dataQueue;
-extern SemaphoreHandle_t modemMutex;
 extern EventGroupHandle_t networkEventGroup;
 extern SemaphoreHandle_t networkEventMutex;
 extern Network network;
 #define NETWORK_CONNECTED_BIT BIT0
 #define QUEUE_SEND_TIMEOUT_MS 1000
+#define GNSS_POLL_MS 100          // between NMEA parses while streaming
+#define GNSS_ACQUIRE_POLL_MS 2000 // between AT+CGNSSINFO queries while a fix is due
+#define GNSS_IDLE_MS 1000         // between scheduler checks while no fix is due
 
+#ifndef GNSS_STREAM_RETRY_MS
+#define GNSS_STREAM_RETRY_MS 300000 // a stream that fell back to polling is tried again after this
+#endif
+#ifndef TRACK_FLUSH_POINTS
+#define TRACK_FLUSH_POINTS 8 // kept fixes that trigger an upload
+#endif
+#ifndef TRACK_FLUSH_MS
+#define TRACK_FLUSH_MS 300000 // kept fixes are uploaded at least this often
+#endif
 
-gps_location_t gpsLocation;
+#define MPS_TO_KNOTS 1.943844f
+
+
+gps_location_t gpsLocation; // latest fix from the receiver
 GPS gps;
 
+static PositionFilter positionFilter;
+static gps_location_t smoothedLocation; // latest filtered fix that was reported
+static unsigned long lastFused = 0; // timestamp of the last fix given to the filter
+static uint32_t lastStreamStart = 0; // last attempt to start NMEA streaming
+
+#ifdef USE_TRACK_PROCESSING
+static TrackBuffer track;
+static GeofenceSet geofences;
+static uint32_t lastUpload = 0;
+
+#ifdef GEOFENCE_LIST
+static const geofence_t GEOFENCES[] = {GEOFENCE_LIST};
+#endif
+#endif
+
 void sendGPSData(const sensor_message_t& msg)
 {
     EventBits_t bits;
@@ -41,6 +76,218 @@ void sendGPSData(const sensor_message_t& msg)
     }
 }
 
+/**
+ * @brief Send a valid fix to the processing task, with the kept track and a fence transition
+ */
+static void reportLocation(const gps_location_t& location, const geofence_event_t* event = NULL)
+{
+    safePrintf("[GPS Task] Location: Lat: %.6f, Lon: %.6f, Speed: %.2f m/s, Altitude: %.2f m, Satellites: %d\n",
+        location.latitude, location.longitude, location.speed,
+        location.altitude, location.satellites);
+
+    // Prepare and send sensor message
+    sensor_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+
+    msg.data.latitude = location.latitude;
+    msg.data.longitude = location.longitude;
+    msg.data.gps_speed = location.speed;
+    msg.data.gps_altitude = location.altitude;
+    msg.data.gps_accuracy = location.accuracy;
+
+    // Mark GPS data as valid
+    msg.valid.latitude = 1;
+    msg.valid.longitude = 1;
+    msg.valid.gps_speed = 1;
+    msg.valid.gps_altitude = 1;
+    msg.valid.gps_accuracy = 1;
+
+#ifdef USE_TRACK_PROCESSING
+    // Points that do not fit stay in the buffer for the next upload
+    size_t points = track.drain(msg.data.track, sizeof(msg.data.track), millis());
+    msg.valid.track = points > 0;
+    lastUpload = millis();
+    if (event)
+    {
+        msg.data.geofence = event->fence;
+        msg.data.geofence_inside = event->inside;
+        msg.valid.geofence = 1;
+        safePrintf("[GPS Task] Geofence %s %s\n", event->inside ? "entered" : "left", event->name);
+    }
+    safePrintf("[GPS Task] Track: %u points (%u bytes), %u waiting\n", (unsigned)points,
+        (unsigned)strlen(msg.data.track), (unsigned)track.size());
+#endif
+
+    // Send to processing task
+    if (xQueueSend(dataQueue, &msg, pdMS_TO_TICKS(1000)) != pdPASS)
+    {
+        safePrintln("[GPS Task] Failed to send GPS data to queue");
+    }
+    else
+    {
+        safePrintln("[GPS Task] GPS data sent to queue successfully");
+    }
+}
+
+/**
+ * @brief Give a new receiver fix to the position filter
+ *
+ * @details While the accelerometer sees the device at rest the velocity is pinned to zero first,
+ * so jitter in the fixes does not move the estimate.
+ */
+static void fuseFix(const gps_location_t& fix, uint32_t now)
+{
+    if (gnssScheduler.getMotion() == MOTION_STATIONARY)
+    {
+        positionFilter.zeroVelocity(now);
+    }
+    if (!positionFilter.update(fix.latitude, fix.longitude, fix.accuracy, fix.satellites, now))
+    {
+        safePrintf("[GPS Task] Fix rejected by the filter (%d satellites, DOP %.1f)\n",
+            fix.satellites, fix.accuracy);
+    }
+    lastFused = fix.timestamp;
+}
+
+/**
+ * @brief The filtered position at now, with speed in knots and accuracy in metres
+ *
+ * @return false if the filter has no estimate
+ */
+static bool getSmoothedLocation(const gps_location_t& fix, uint32_t now, gps_location_t& location)
+{
+    position_estimate_t estimate;
+    if (!positionFilter.getEstimate(now, estimate))
+    {
+        return false;
+    }
+    location = fix;
+    location.latitude = estimate.latitude;
+    location.longitude = estimate.longitude;
+    location.speed = estimate.speed * MPS_TO_KNOTS;
+    location.accuracy = estimate.accuracy;
+    location.valid = true;
+    location.timestamp = now;
+    return true;
+}
+
+/**
+ * @brief Run a reported fix through the track and the geofences
+ *
+ * @details Only fixes that differ from the dead-reckoned track are kept. They are uploaded in
+ * batches of TRACK_FLUSH_POINTS or every TRACK_FLUSH_MS, a geofence transition is uploaded at
+ * once. A fix that changes nothing is not sent at all.
+ */
+static void processFix(const gps_location_t& location, uint32_t now)
+{
+#ifdef USE_TRACK_PROCESSING
+    bool kept = track.add(location.latitude, location.longitude, now);
+
+    geofence_event_t event;
+    bool transition = geofences.update(TrackBuffer::toFixed(location.latitude),
+        TrackBuffer::toFixed(location.longitude), event);
+
+    bool due = track.size() > 0 &&
+        (lastUpload == 0 || track.size() >= TRACK_FLUSH_POINTS || now - lastUpload >= TRACK_FLUSH_MS);
+    if (transition || due)
+    {
+        reportLocation(location, transition ? &event : NULL);
+    }
+    else if (!kept)
+    {
+        safePrintln("[GPS Task] Fix on the predicted track, not sent");
+    }
+#else
+    reportLocation(location);
+#endif
+}
+
+/**
+ * @brief Give the just enabled engine its assistance data, must be called with the GNSS channel
+ * held
+ *
+ * @return true if the engine starts assisted
+ */
+static bool injectAssistance()
+{
+#ifdef USE_AGNSS
+    return agnss.inject();
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Power the GNSS engine up with a hot start and resume NMEA, the scheduler wants a fix
+ *
+ * @return true if the engine is running
+ */
+static bool startEngine()
+{
+    if (!modemPower.acquire(MODEM_CHANNEL_GNSS, pdMS_TO_TICKS(5000)))
+    {
+        return false;
+    }
+    bool started = gps.enableGPS();
+    bool assisted = false;
+    if (started)
+    {
+        assisted = injectAssistance();
+        gps.hotStart();
+        gps.startNmeaStream();
+        lastStreamStart = millis();
+    }
+    modemPower.release(MODEM_CHANNEL_GNSS);
+
+    if (started)
+    {
+        gnssScheduler.onEngineOn(millis(), assisted);
+        safePrintf("[GPS Task] Motion or heartbeat, GNSS engine hot started%s\n",
+            assisted ? " with assistance data" : "");
+    }
+    return started;
+}
+
+/**
+ * @brief Power the GNSS engine down, the device is at rest
+ *
+ * @return true if the engine was stopped
+ */
+static bool stopEngine()
+{
+    if (!modemPower.acquire(MODEM_CHANNEL_GNSS, pdMS_TO_TICKS(5000)))
+    {
+        return false;
+    }
+    if (gps.isStreaming())
+    {
+        gps.stopNmeaStream();
+    }
+    bool stopped = gps.disableGPS();
+    modemPower.release(MODEM_CHANNEL_GNSS);
+
+    if (stopped)
+    {
+#ifdef USE_TRACK_PROCESSING
+        // The resting position ends the track, nothing else is kept until the engine restarts
+        if (track.size() > 0 && smoothedLocation.valid)
+        {
+            reportLocation(smoothedLocation);
+        }
+#endif
+        uint32_t now = millis();
+        gnssScheduler.onEngineOff(now);
+        gnss_schedule_stats_t stats = gnssScheduler.getStats(now);
+        safePrintf("[GPS Task] Stationary, GNSS engine off. Fixes: %lu, acquisitions: %lu "
+                   "(%lu timed out, %lu assisted), time to fix: %lu ms (avg %lu ms, "
+                   "assisted %lu ms, unassisted %lu ms), energy per fix: %lu mJ\n",
+            stats.fixes, stats.acquisitions, stats.timeouts, stats.assisted, stats.lastTimeToFixMs,
+            stats.avgTimeToFixMs, stats.avgAssistedTimeToFixMs, stats.avgUnassistedTimeToFixMs,
+            stats.energyPerFixMj);
+    }
+    return stopped;
+}
+
 void gpsTask(void* pvParameters)
 {
     safePrintln("[GPS Task] GPS task started, waiting for network connection...");
@@ -72,20 +319,36 @@ void gpsTask(void* pvParameters)
 
     safePrintln("[GPS Task] Network available, initializing GPS...");
 
-    if (xSemaphoreTake(modemMutex, pdMS_TO_TICKS(10000)) == pdTRUE)
+#if defined(USE_TRACK_PROCESSING) && defined(GEOFENCE_LIST)
+    for (size_t i = 0; i < sizeof(GEOFENCES) / sizeof(GEOFENCES[0]); i++)
+    {
+        if (!geofences.add(GEOFENCES[i]))
+        {
+            safePrintf("[GPS Task] Geofence %s ignored, too many fences or vertices\n",
+                GEOFENCES[i].name);
+        }
+    }
+#endif
+
+    if (modemPower.acquire(MODEM_CHANNEL_GNSS, pdMS_TO_TICKS(10000)))
     {
         gps.begin();
 
         if (!gps.enableGPS())
         {
             safePrintln("[GPS Task] Failed to enable GPS");
-            xSemaphoreGive(modemMutex);
+            modemPower.release(MODEM_CHANNEL_GNSS);
             vTaskDelete(NULL);
             return;
         }
 
-        safePrintln("[GPS Task] GPS enabled, waiting for fix...");
-        xSemaphoreGive(modemMutex);
+        bool assisted = injectAssistance();
+        gps.startNmeaStream();
+        lastStreamStart = millis();
+        gnssScheduler.onEngineOn(millis(), assisted);
+        safePrintf("[GPS Task] GPS enabled%s, waiting for fix...\n",
+            assisted ? " with assistance data" : "");
+        modemPower.release(MODEM_CHANNEL_GNSS);
     }
     else
     {
@@ -93,59 +356,104 @@ void gpsTask(void* pvParameters)
         vTaskDelete(NULL);
         return;
     }
+
+    bool engineOn = true;
     while (true)
     {
-        // Take mutex before any modem/GPS operations
-        if (xSemaphoreTake(modemMutex, pdMS_TO_TICKS(5000)) == pdTRUE)
+        uint32_t now = millis();
+        bool wanted = gnssScheduler.wantEngineOn(now);
+        if (wanted != engineOn)
         {
-            if (gps.getGPSLocation(gpsLocation))
+            bool switched = wanted ? startEngine() : stopEngine();
+            if (switched)
+            {
+                engineOn = wanted;
+            }
+            else
             {
-                if (gpsLocation.valid)
+                vTaskDelay(pdMS_TO_TICKS(GNSS_IDLE_MS));
+            }
+            continue;
+        }
+
+        if (!engineOn)
+        {
+            vTaskDelay(pdMS_TO_TICKS(GNSS_IDLE_MS));
+            continue;
+        }
+
+        if (gps.isStreaming())
+        {
+            // NMEA is parsed as it arrives, the modem is only needed again if the stream stops
+            if (!gps.pollNmeaStream())
+            {
+                if (modemPower.acquire(MODEM_CHANNEL_GNSS, pdMS_TO_TICKS(5000)))
                 {
-                    safePrintf("[GPS Task] Location: Lat: %.6f, Lon: %.6f, Speed: %.2f m/s, Altitude: %.2f m, Satellites: %d\n",
-                        gpsLocation.latitude, gpsLocation.longitude, gpsLocation.speed,
-                        gpsLocation.altitude, gpsLocation.satellites);
-
-                    // Release mutex before queue operations (don't hold it too long)
-                    xSemaphoreGive(modemMutex);
-
-                    // Prepare and send sensor message
-                    sensor_message_t msg;
-                    memset(&msg, 0, sizeof(msg));
-
-                    msg.data.latitude = gpsLocation.latitude;
-                    msg.data.longitude = gpsLocation.longitude;
-                    msg.data.gps_speed = gpsLocation.speed;
-                    msg.data.gps_altitude = gpsLocation.altitude;
-                    msg.data.gps_accuracy = gpsLocation.accuracy;
-
-                    // Mark GPS data as valid
-                    msg.valid.latitude = 1;
-                    msg.valid.longitude = 1;
-                    msg.valid.gps_speed = 1;
-                    msg.valid.gps_altitude = 1;
-                    msg.valid.gps_accuracy = 1;
-
-                    // Send to processing task
-                    if (xQueueSend(dataQueue, &msg, pdMS_TO_TICKS(1000)) != pdPASS)
-                    {
-                        safePrintln("[GPS Task] Failed to send GPS data to queue");
-                    }
-                    else
-                    {
-                        safePrintln("[GPS Task] GPS data sent to queue successfully");
-                    }
+                    gps.stopNmeaStream();
+                    modemPower.release(MODEM_CHANNEL_GNSS);
                 }
-                else
+                lastStreamStart = now;
+                continue;
+            }
+            // Every fix feeds the filter, only due ones are reported
+            if (gps.getGPSLocation(gpsLocation) && gpsLocation.timestamp != lastFused)
+            {
+                fuseFix(gpsLocation, now);
+            }
+            if (gnssScheduler.fixDue(now) && gpsLocation.valid &&
+                getSmoothedLocation(gpsLocation, now, smoothedLocation))
+            {
+                gnssScheduler.onFix(smoothedLocation.speed, now);
+                processFix(smoothedLocation, now);
+            }
+            vTaskDelay(pdMS_TO_TICKS(GNSS_POLL_MS));
+            continue;
+        }
+
+        // A quiet stream or a closed multiplexer is not permanent, streaming is re-armed
+        if (gps.canStream() && now - lastStreamStart >= GNSS_STREAM_RETRY_MS)
+        {
+            if (modemPower.acquire(MODEM_CHANNEL_GNSS, pdMS_TO_TICKS(5000)))
+            {
+                if (gps.startNmeaStream())
                 {
-                    safePrintln("[GPS Task] Invalid GPS data received");
-                    xSemaphoreGive(modemMutex);
+                    safePrintln("[GPS Task] NMEA stream re-armed");
                 }
+                modemPower.release(MODEM_CHANNEL_GNSS);
             }
-            else
+            lastStreamStart = now;
+            continue;
+        }
+
+        if (!gnssScheduler.fixDue(now))
+        {
+            vTaskDelay(pdMS_TO_TICKS(GNSS_IDLE_MS));
+            continue;
+        }
+
+        // Take mutex before any modem/GPS operations
+        if (modemPower.acquire(MODEM_CHANNEL_GNSS, pdMS_TO_TICKS(5000)))
+        {
+            bool located = gps.getGPSLocation(gpsLocation);
+            modemPower.release(MODEM_CHANNEL_GNSS);
+
+            if (!located)
             {
                 safePrintln("[GPS Task] Failed to get GPS location");
-                xSemaphoreGive(modemMutex);
+            }
+            else if (!gpsLocation.valid)
+            {
+                safePrintln("[GPS Task] Invalid GPS data received");
+            }
+            else
+            {
+                uint32_t fixTime = millis();
+                fuseFix(gpsLocation, fixTime);
+                if (getSmoothedLocation(gpsLocation, fixTime, smoothedLocation))
+                {
+                    gnssScheduler.onFix(smoothedLocation.speed, fixTime);
+                    processFix(smoothedLocation, fixTime);
+                }
             }
         }
         else
@@ -153,7 +461,7 @@ void gpsTask(void* pvParameters)
             safePrintln("[GPS Task] Failed to take modem mutex - skipping GPS read");
         }
 
-        // Wait before next GPS reading (30 seconds is better for GPS and battery)
-        vTaskDelay(pdMS_TO_TICKS(30000));
+        // Until a fix is due again, fixDue() keeps the modem free
+        vTaskDelay(pdMS_TO_TICKS(GNSS_ACQUIRE_POLL_MS));
     }
-}
\ No newline at end of file
+}
@@ -9,12 +9,14 @@
 
 #include "tasks/accelerometerTask.h"
 #include "SensorData.h"
+#include "network/gnssScheduler.h"
 #include "sensors/accelerometer.h"
 #include "utils/threadsafe_serial.h"
 #include <Arduino.h>
 #include <cstring>
 
 #define QUEUE_SEND_TIMEOUT_MS 1000
+#define MOTION_WINDOW_MS 2000 // total acceleration is compared over windows this long
 
 extern QueueHandle_t dataQueue;
 extern EventGroupHandle_t networkEventGroup;
@@ -77,9 +79,17 @@ void accelTask(void* pvParameters)
     float lastTotal = 0.0f;
     bool wasHigh = false;
 
+    // Motion detection: the spread of total acceleration within a window
+    uint32_t windowStart = 0;
+    float windowMin = 0.0f;
+    float windowMax = 0.0f;
+    uint32_t lastMotionTime = 0;
+    bool moving = true; // the scheduler starts out treating the device as moving
+
     now = millis();
     lastStepTime = now;
     lastStepSendTime = now;
+    lastMotionTime = now; // moving until shown otherwise
 
     for (size_t i = 0; i < 3; i++)
     {
@@ -178,6 +188,28 @@ void accelTask(void* pvParameters)
 
         lastTotal = currentTotal;
 
+        // Motion detection for GNSS duty cycling, only changes are reported
+        if (windowStart == 0 || now - windowStart >= MOTION_WINDOW_MS)
+        {
+            if (windowStart != 0 && windowMax - windowMin > MOTION_THRESHOLD)
+            {
+                lastMotionTime = now;
+            }
+            windowStart = now;
+            windowMin = currentTotal;
+            windowMax = currentTotal;
+        }
+        windowMin = min(windowMin, currentTotal);
+        windowMax = max(windowMax, currentTotal);
+
+        bool nowMoving = now - lastMotionTime < STATIONARY_TIMEOUT_MS;
+        if (nowMoving != moving)
+        {
+            safePrintf("[Accel Task] %s\n", nowMoving ? "Motion detected" : "Stationary");
+            moving = nowMoving;
+            gnssScheduler.setMotion(moving, now);
+        }
+
         // Send step data every 5 minutes if changed
         if (now - lastStepSendTime > FIVE_MINUTES_MS && totalSteps != lastSentSteps)
         {
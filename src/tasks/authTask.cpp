@@ -0,0 +1,170 @@
+/**
+ * @file authTask.cpp
+ * @brief Authentication Task Implementation File
+ *
+ * @details This file contains the implementation of the authTask function and the token store. The
+ * token is only ever replaced by this task, and only cleared by invalidateAuthToken(), so a send in
+ * progress keeps using the old token while a renewal runs in the background.
+ */
+
+#include "tasks/authTask.h"
+#include "config.h"
+#include "network/network.h"
+#include "network/retryPolicy.h"
+#include "tasks/communicationTask.h"
+#include "utils/threadsafe_serial.h"
+#include <Arduino.h>
+#include <cstring>
+
+#define AUTH_IDLE_POLL_MS 5000
+#define AUTH_MIN_SLEEP_MS 1000
+
+extern SemaphoreHandle_t authMutex;
+extern TaskHandle_t authTaskHandle;
+extern Network network;
+
+static char authToken[AUTH_TOKEN_MAX_LEN] = "";
+static char pendingToken[AUTH_TOKEN_MAX_LEN];
+static uint32_t tokenIssuedAt = 0;
+static uint32_t tokenLifetimeMs = 0;
+static RetryPolicy refreshPolicy; // backoff between failed refresh rounds, only used by this task
+
+bool getAuthToken(char* token, size_t tokenSize)
+{
+    bool ready = false;
+    if (xSemaphoreTake(authMutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    {
+        size_t len = strlen(authToken);
+        if (len > 0 && len < tokenSize)
+        {
+            memcpy(token, authToken, len + 1);
+            ready = true;
+        }
+        xSemaphoreGive(authMutex);
+    }
+    return ready;
+}
+
+bool isAuthTokenReady()
+{
+    bool ready = false;
+    if (xSemaphoreTake(authMutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    {
+        ready = authToken[0] != '\0';
+        xSemaphoreGive(authMutex);
+    }
+    return ready;
+}
+
+void invalidateAuthToken()
+{
+    if (xSemaphoreTake(authMutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    {
+        authToken[0] = '\0';
+        tokenLifetimeMs = 0;
+        xSemaphoreGive(authMutex);
+    }
+    requestAuthRefresh();
+}
+
+/**
+ * @brief Wake the refresher
+ *
+ * @details The request is the task notification itself, it stays pending until the task takes it.
+ */
+void requestAuthRefresh()
+{
+    if (authTaskHandle)
+    {
+        xTaskNotifyGive(authTaskHandle);
+    }
+}
+
+/**
+ * @brief Time until the current token should be renewed
+ *
+ * @details Tokens with a lifetime shorter than twice the margin are renewed at half-life.
+ *
+ * @return 0 if a refresh is due now, otherwise milliseconds until it is
+ */
+static uint32_t msUntilRefresh()
+{
+    uint32_t remaining = 0;
+    if (xSemaphoreTake(authMutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    {
+        if (authToken[0] != '\0')
+        {
+            uint32_t margin = TOKEN_REFRESH_MARGIN_MS;
+            if (margin > tokenLifetimeMs / 2)
+            {
+                margin = tokenLifetimeMs / 2;
+            }
+            uint32_t age = millis() - tokenIssuedAt;
+            uint32_t refreshAt = tokenLifetimeMs - margin;
+            remaining = age < refreshAt ? refreshAt - age : 0;
+        }
+        xSemaphoreGive(authMutex);
+    }
+    return remaining;
+}
+
+void authTask(void* pvParameters)
+{
+    uint8_t failedRounds = 0;
+    bool refreshRequested = false;
+
+    safePrintln("[Auth Task] Token refresher started");
+
+    while (true)
+    {
+        uint32_t sleepMs = refreshRequested ? 0 : msUntilRefresh();
+
+        if (sleepMs == 0)
+        {
+            if (!network.isConnected())
+            {
+                sleepMs = AUTH_IDLE_POLL_MS;
+            }
+            else
+            {
+                uint32_t lifetimeMs = 0;
+                refreshRequested = false;
+
+                safePrintln("[Auth Task] Refreshing backend JWT token...");
+                if (authenticateWithBackend(pendingToken, sizeof(pendingToken), lifetimeMs))
+                {
+                    if (xSemaphoreTake(authMutex, pdMS_TO_TICKS(1000)) == pdTRUE)
+                    {
+                        memcpy(authToken, pendingToken, sizeof(authToken));
+                        tokenIssuedAt = millis();
+                        tokenLifetimeMs = lifetimeMs;
+                        xSemaphoreGive(authMutex);
+                    }
+                    failedRounds = 0;
+                    sleepMs = msUntilRefresh();
+                }
+                else
+                {
+                    if (failedRounds < UINT8_MAX)
+                    {
+                        failedRounds++;
+                    }
+                    sleepMs = refreshPolicy.backoffDelay(MSG_CLASS_AUTH, failedRounds);
+                    safePrintf("[Auth Task] Token refresh failed, retrying in %lu ms\n", sleepMs);
+                }
+            }
+        }
+
+        if (sleepMs < AUTH_MIN_SLEEP_MS)
+        {
+            sleepMs = AUTH_MIN_SLEEP_MS;
+        }
+
+        // Sleep until renewal is due, or until invalidateAuthToken()/requestAuthRefresh(). A request
+        // stays pending while the network is down.
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleepMs)) > 0)
+        {
+            refreshRequested = true;
+        }
+    }
+}
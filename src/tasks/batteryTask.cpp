@@ -13,6 +13,7 @@
 #include "SensorData.h"
 #include "battery.h"
 #include "config.h"
+#include "network/gnssScheduler.h"
 #include "utils/threadsafe_serial.h"
 #include <Arduino.h>
 #include <cstring>
@@ -102,6 +103,7 @@ void batteryTask(void* parameter)
             msg.valid.device_battery = 1;
 
             sendBatteryData(msg);
+            gnssScheduler.setBatteryPercent(newBatteryPercent);
 
             safePrintf("[Battery Task] Voltage: %.2f V (%lu mV), Percent: %d %%\n", voltage, voltage_mv, newBatteryPercent);
 
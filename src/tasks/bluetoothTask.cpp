@@ -1,6 +1,6 @@
 /**
  * @file bluetoothTask.cpp
- * @brief
+ * @brief Bluetooth Task Implementation
  *
  * @details This file contains the implementation of the bluetoothTask function, which is used to
  * handle Bluetooth operations in a FreeRTOS task.
@@ -11,11 +11,19 @@
 #include "SensorData.h"
 #include "config.h"
 #include "sensors/bluetooth.h"
+#include "sensors/hrvAnalyzer.h"
 #include "utils/threadsafe_serial.h"
 #include <Arduino.h>
 #include <cstring>
 
 #define QUEUE_SEND_TIMEOUT_MS 1000
+#define BT_LOOP_MS 1000 // between state machine runs and buffer drains
+#define HR_GAP_SLACK_MS 1500 // notification delay beyond its RR-intervals that means lost beats
+#define BT_STATS_MS 300000 // scan, power and radio counters are sent this often
+
+#ifndef HR_SUMMARY_MS
+#define HR_SUMMARY_MS 15000 // a heart rate and HRV summary is sent this often per strap
+#endif
 
 extern QueueHandle_t dataQueue;
 extern EventGroupHandle_t networkEventGroup;
@@ -46,22 +54,191 @@ void sendBluetoothData(const sensor_message_t& msg)
     }
 }
 
+/**
+ * @brief Heart rate and HRV of one strap since its last summary
+ */
+struct StrapSummary
+{
+    HrvAnalyzer hrv;
+    uint32_t periodStart = 0;
+    uint32_t lastTime = 0;      // of the previous notification
+    uint32_t lastDropped = 0;
+    uint32_t lastRejected = 0;
+    uint16_t notifications = 0;
+    uint32_t bpmSum = 0;
+    uint8_t minBpm = 255;
+    uint8_t maxBpm = 0;
+    int8_t contact = -1;
+    int32_t energy = -1;
+};
+
+/**
+ * @brief Feed one notification into the strap's summary and HRV analyzer
+ *
+ * @details RR-intervals are converted from the strap's 1/1024 s to milliseconds. Beats are missing
+ * before a notification if the buffer dropped some or if more time passed since the previous one
+ * than its RR-intervals account for; no successive difference is then taken across them. A strap
+ * sends no RR-interval when no beat ended since its previous notification. Intervals measured
+ * without skin contact are not analyzed.
+ */
+static void addSample(StrapSummary& summary, const hr_sample_t& sample, bool dropped)
+{
+    const hrm_measurement_t& m = sample.measurement;
+    uint8_t bpm = m.bpm > 255 ? 255 : m.bpm;
+
+    if (summary.notifications == 0)
+    {
+        summary.periodStart = sample.time;
+        summary.bpmSum = 0;
+        summary.minBpm = 255;
+        summary.maxBpm = 0;
+        summary.contact = m.contact;
+    }
+    summary.notifications++;
+    summary.bpmSum += bpm;
+    summary.minBpm = bpm < summary.minBpm ? bpm : summary.minBpm;
+    summary.maxBpm = bpm > summary.maxBpm ? bpm : summary.maxBpm;
+    if (m.contact == 0)
+    {
+        summary.contact = 0;
+    }
+    if (m.energy >= 0)
+    {
+        summary.energy = m.energy;
+    }
+
+    uint32_t rrSum = 0;
+    uint16_t rr[HRM_MAX_RR];
+    for (uint8_t i = 0; i < m.rrCount; i++)
+    {
+        rr[i] = (uint16_t)(((uint32_t)m.rr[i] * 1000 + 512) / 1024);
+        rrSum += rr[i];
+    }
+    bool gap = dropped || m.contact == 0 ||
+        sample.time - summary.lastTime > rrSum + HR_GAP_SLACK_MS;
+    summary.lastTime = sample.time;
+
+    if (gap)
+    {
+        summary.hrv.markGap();
+    }
+    if (m.contact != 0)
+    {
+        for (uint8_t i = 0; i < m.rrCount; i++)
+        {
+            summary.hrv.addInterval(rr[i]);
+        }
+    }
+}
+
+/**
+ * @brief Drain one strap's buffered notifications into its summary
+ */
+static void drainSamples(BluetoothClient& client, size_t strap, StrapSummary& summary)
+{
+    hr_sample_t samples[8];
+    uint32_t dropped = client.getDroppedSamples(strap);
+    bool lost = dropped != summary.lastDropped;
+    summary.lastDropped = dropped;
+
+    size_t n;
+    while ((n = client.readSamples(strap, samples, 8)) > 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            addSample(summary, samples[i], lost);
+            lost = false;
+        }
+    }
+}
+
+/**
+ * @brief Send one strap's summary to the processing task and start a new period
+ */
+static void sendHeartRateSummary(size_t strap, StrapSummary& summary)
+{
+    sensor_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    sensor_data_t& data = msg.data;
+
+    uint32_t rejected = summary.hrv.getRejected();
+    hrv_summary_t hrv;
+    if (summary.hrv.getSummary(hrv))
+    {
+        data.hrv_beats = hrv.beats;
+        data.hrv_rmssd = hrv.rmssd;
+        data.hrv_sdnn = hrv.sdnn;
+        data.hrv_pnn50 = hrv.pnn50;
+    }
+    data.hrv_artifacts = (uint16_t)(rejected - summary.lastRejected);
+    data.hr_strap = (int)strap;
+    data.hr_period = (uint16_t)((millis() - summary.periodStart) / 1000);
+    data.hr_min = summary.minBpm;
+    data.hr_max = summary.maxBpm;
+    data.hr_contact = summary.contact;
+    data.hr_energy = summary.energy;
+    data.heartRate = (summary.bpmSum + summary.notifications / 2) / summary.notifications;
+    msg.valid.heartRate = 1;
+    msg.valid.hr_summary = 1;
+
+#if DEBUG
+    safePrintf("[BT Task] Strap %d: %d-%d BPM, RMSSD %.1f ms, SDNN %.1f ms, pNN50 %.1f%%, "
+        "%d beats, %d artifacts\n", strap, data.hr_min, data.hr_max, data.hrv_rmssd,
+        data.hrv_sdnn, data.hrv_pnn50, data.hrv_beats, data.hrv_artifacts);
+#endif
+    sendBluetoothData(msg);
+
+    summary.lastRejected = rejected;
+    summary.notifications = 0;
+}
+
+/**
+ * @brief Send the scan duty cycle, reconnect times, transmit power and radio-on time to the
+ * processing task
+ */
+static void sendBluetoothStats(const BluetoothClient& client)
+{
+    sensor_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    sensor_data_t& data = msg.data;
+
+    scan_stats_t scan = client.getScanStats();
+    data.bt_scan_duty = scan.dutyPercent;
+    data.bt_reconnects = scan.reconnects;
+    data.bt_reconnect_avg_ms = scan.avgReconnectMs;
+    data.bt_reconnect_max_ms = scan.maxReconnectMs;
+    data.bt_tx_power = client.getTxPower();
+    ble_radio_stats_t radio = client.getRadioStats();
+    data.bt_radio_ms_per_hour = radio.onMsPerHour;
+    msg.valid.bt_stats = 1;
+
+#if DEBUG
+    safePrintf("[BT Task] Scan duty %.2f%% (%lu s scanning), TX %d dBm, %lu reconnects "
+        "(last %lu ms, avg %lu ms, max %lu ms)\n", scan.dutyPercent,
+        scan.scanTimeMs / 1000, data.bt_tx_power, scan.reconnects,
+        scan.lastReconnectMs, scan.avgReconnectMs, scan.maxReconnectMs);
+    safePrintf("[BT Task] Radio on %lu ms/h (scan %lu ms, connections %lu ms)\n",
+        radio.onMsPerHour, radio.scanMs, radio.connectionMs);
+#endif
+    sendBluetoothData(msg);
+}
+
 /**
  * @brief bluetoothTask function
  *
- * @details This function handles Bluetooth operations in a FreeRTOS task. It reads heart rate data
- * from the Bluetooth client and sends it to a queue for processing.
+ * @details This function handles Bluetooth operations in a FreeRTOS task. It runs the Bluetooth
+ * client, drains each strap's heart rate notifications into a streaming HRV analyzer every loop,
+ * and sends the processing task a summary per strap every HR_SUMMARY_MS instead of the raw beats.
+ * The scan duty cycle, time-to-reconnect, transmit power and radio-on time are sent every
+ * BT_STATS_MS.
  *
  * @param pvParameters
  */
 void bluetoothTask(void* pvParameters)
 {
-    sensor_message_t msg;
-    memset(&msg, 0, sizeof(msg));
     BluetoothClient bClient;
-    int oldHeartRate = -1;
-    int newHeartRate = 0;
-    uint32_t lastDataSend = 0;
+    static StrapSummary summaries[HR_MAX_STRAPS];
+    uint32_t lastStats = 0;
 
     bClient.begin();
 
@@ -69,31 +246,23 @@ void bluetoothTask(void* pvParameters)
     {
         bClient.loop();
 
-        newHeartRate = bClient.getHeartRate();
         uint32_t currentTime = millis();
-
-        // Check if we should send data (first reading, any change or periodic update)
-        bool shouldSendData = (oldHeartRate == -1) ||
-            (newHeartRate != oldHeartRate) && (currentTime - lastDataSend > 10000 && newHeartRate > 0);
-
-        if (shouldSendData)
+        for (size_t strap = 0; strap < bClient.getStrapCount(); strap++)
         {
-            msg.data.heartRate = newHeartRate;
-            msg.valid.heartRate = 1;
-            sendBluetoothData(msg);
-            lastDataSend = currentTime;
-
-#if DEBUG
-            if (oldHeartRate == -1 || abs(newHeartRate - oldHeartRate) > 3)
+            StrapSummary& summary = summaries[strap];
+            drainSamples(bClient, strap, summary);
+            if (summary.notifications > 0 && currentTime - summary.periodStart >= HR_SUMMARY_MS)
             {
-                safePrint("[BT Task] HR: ");
-                safePrint(newHeartRate);
-                safePrintln(" BPM");
+                sendHeartRateSummary(strap, summary);
             }
-#endif
         }
 
-        oldHeartRate = newHeartRate;
-        vTaskDelay(pdMS_TO_TICKS(5000));
+        if (currentTime - lastStats >= BT_STATS_MS)
+        {
+            lastStats = currentTime;
+            sendBluetoothStats(bClient);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(BT_LOOP_MS));
     }
 }
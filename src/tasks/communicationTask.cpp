@@ -13,148 +13,150 @@
 #include "SensorData.h"
 #include "WiFi.h"
 #include "config.h"
+#include "network/modemPower.h"
 #include "network/network.h"
+#include "network/offlineBuffer.h"
+#include "network/responseSink.h"
+#include "network/retryPolicy.h"
+#include "network/uplinkPayload.h"
+#include "tasks/authTask.h"
 #include "tasks/communicationTask.h"
+#include "utils/gzipEncoder.h"
+#include "utils/jsonArena.h"
 #include "utils/threadsafe_serial.h"
 #include <Arduino.h>
 #include <HTTPClient.h>
 #include <TinyGSM.h>
 #include <TinyGsmClient.h>
+#include <WiFiClientSecure.h>
 #include <cstring>
-#include <ArduinoJson.h>
 
 extern QueueHandle_t httpQueue;
-extern SemaphoreHandle_t modemMutex;
 extern TinyGsm modem;
 extern Network network;
 
-String currentJWTToken = "";
-unsigned long tokenExpiryTime = 0;
+RetryPolicy uplinkPolicy;
+static OfflineBuffer offlineBuffer;
 
-String createBearerHeader(const String& token)
-{
-    return "Bearer " + token;
-}
+// URLs are concatenated at compile time, no per-send formatting
+static const char DATA_URL[] = BACKEND_URL API_ENDPOINT;
+static const char AUTH_URL[] = BACKEND_URL AUTH_ENDPOINT;
 
-bool parseAuthResponse(const String& response, String& token)
-{
-    JsonDocument responseDoc;
-    DeserializationError error = deserializeJson(responseDoc, response);
+// Only used from the auth task (login payload)
+static JsonArena<JSON_ARENA_SIZE> authArena;
+static char loginPayload[AUTH_PAYLOAD_SIZE] = "";
+static WiFiClients authClients;
 
-    if (error)
-    {
-        safePrintln("[CommTask] Failed to parse authentication response");
+// Only used from the communication task
+static char sendToken[AUTH_TOKEN_MAX_LEN];
+static char sendAuthHeader[AUTH_HEADER_MAX_LEN];
+static WiFiClients sendClients;
 #if DEBUG
-        safePrintf("[CommTask] JSON Error: %s\n", error.c_str());
-        safePrintf("[CommTask] Response: %s\n", response.c_str());
+static char sendDebugBody[HTTP_DEBUG_BODY_SIZE];
+#endif
+#ifdef USE_PAYLOAD_COMPRESSION
+static GzipEncoder gzipEncoder;
+static uint8_t sendCompressed[sizeof(processed_data_t) + GZIP_OVERHEAD];
 #endif
-        return false;
-    }
-
-    if (responseDoc["data"]["token"].is<String>())
-    {
-        token = responseDoc["data"]["token"].as<String>();
-
-        unsigned long expiresIn = 0;
-        if (responseDoc["data"]["expires_in"].is<unsigned long>())
-        {
-            expiresIn = responseDoc["data"]["expires_in"].as<unsigned long>();
-        }
-        else if (responseDoc["expires_in"].is<unsigned long>())
-        {
-            expiresIn = responseDoc["expires_in"].as<unsigned long>();
-        }
 
-        tokenExpiryTime = expiresIn > 0 ? millis() + (expiresIn * 1000) : millis() + DEFAULT_TOKEN_EXPIRY_MS;
+void handleHttpResponse(const HttpResponse& response, const char* context)
+{
+    safePrintf("[CommTask] HTTP %s: %d\n", context, response.code);
 
-        safePrintln("[CommTask] Authentication successful");
-        return true;
-    }
-    else if (responseDoc["token"].is<String>())
+    if (response.success)
     {
-        token = responseDoc["token"].as<String>();
-
-        unsigned long expiresIn = 0;
-        if (responseDoc["expires_in"].is<unsigned long>())
+        if (response.code == 401)
         {
-            expiresIn = responseDoc["expires_in"].as<unsigned long>();
+            safePrintf("[CommTask] AUTHENTICATION ERROR 401 (%s)! Token may be expired or invalid.\n", context);
+            invalidateAuthToken();
         }
-
-        tokenExpiryTime = expiresIn > 0 ? millis() + (expiresIn * 1000) : millis() + DEFAULT_TOKEN_EXPIRY_MS;
-
-        safePrintln("[CommTask] Authentication successful");
-        return true;
     }
     else
     {
-        safePrintln("[CommTask] No token in authentication response");
-        return false;
+        safePrintf("[CommTask] Error sending HTTP POST (%s)\n", context);
     }
 }
 
-void handleHttpResponse(const HttpResponse& response, const char* context)
+/**
+ * @brief Stream the response body from the WiFi client into the sink
+ *
+ * @details The request is made with HTTP/1.0, so the body is never chunked and ends either at
+ * Content-Length or when the server closes the connection. Reading stops as soon as the sink has
+ * what it needs; the rest is dropped when the connection is closed.
+ */
+static void streamWiFiBody(HTTPClient& http, ResponseSink& sink)
 {
-    safePrintf("[CommTask] HTTP %s: %d\n", context, response.code);
+    WiFiClient* stream = http.getStreamPtr();
+    int remaining = http.getSize();
+    uint8_t chunk[HTTP_STREAM_CHUNK_SIZE];
+    uint32_t lastData = millis();
 
-    if (response.success)
+    while (stream && (remaining > 0 || remaining == -1) && millis() - lastData < AUTH_TIMEOUT_MS)
     {
-        if (response.code == 401)
+        int available = stream->available();
+        if (available <= 0)
         {
-            safePrintf("[CommTask] AUTHENTICATION ERROR 401 (%s)! Token may be expired or invalid.\n", context);
-#if DEBUG
-            safePrintf("[CommTask] Full response: %s\n", response.body.c_str());
-#endif
-            currentJWTToken = "";
-            tokenExpiryTime = 0;
+            if (!stream->connected())
+            {
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(1));
+            continue;
         }
-        else if (response.body.length() > 50)
+
+        size_t want = remaining > 0 ? (size_t)remaining : (size_t)available;
+        int n = stream->read(chunk, want < sizeof(chunk) ? want : sizeof(chunk));
+        if (n <= 0)
         {
-#if DEBUG
-            safePrintf("[CommTask] Response: %.50s...\n", response.body.c_str());
-#endif
+            continue;
         }
-        else
+        if (remaining > 0)
         {
-#if DEBUG
-            safePrintf("[CommTask] Response: %s\n", response.body.c_str());
-#endif
+            remaining -= n;
+        }
+        lastData = millis();
+
+        if (!sink.write(chunk, n))
+        {
+            break;
         }
-    }
-    else
-    {
-        safePrintf("[CommTask] Error sending HTTP POST (%s)\n", context);
     }
 }
 
-HttpResponse performWiFiRequest(const char* url, const char* payload, const char* authHeader)
+HttpResponse performWiFiRequest(WiFiClients& clients, const char* url, const uint8_t* payload,
+    size_t payloadLength, ResponseSink& sink, const char* authHeader, const char* contentEncoding)
 {
     HTTPClient http;
-    WiFiClientSecure* secureClient = nullptr;
-    WiFiClient* insecureClient = nullptr;
     bool httpStarted = false;
     HttpResponse response;
 
 #if DEBUG
     safePrintf("[CommTask] WiFi request to: %s\n", url);
-    safePrintf("[CommTask] Payload size: %d\n", strlen(payload));
+    safePrintf("[CommTask] Payload size: %d\n", payloadLength);
 #endif
 
     if (strncmp(url, "https://", 8) == 0)
     {
-        secureClient = new WiFiClientSecure();
-        secureClient->setInsecure();
-        secureClient->setTimeout(AUTH_TIMEOUT_MS / 1000);
-        secureClient->setHandshakeTimeout(30);
-        httpStarted = http.begin(*secureClient, url);
+        if (!clients.secure)
+        {
+            clients.secure = new WiFiClientSecure();
+            clients.secure->setInsecure();
+            clients.secure->setTimeout(AUTH_TIMEOUT_MS / 1000);
+            clients.secure->setHandshakeTimeout(30);
+        }
+        httpStarted = http.begin(*clients.secure, url);
 #if DEBUG
         safePrintln("[CommTask] Using HTTPS client");
 #endif
     }
     else if (strncmp(url, "http://", 7) == 0)
     {
-        insecureClient = new WiFiClient();
-        insecureClient->setTimeout(AUTH_TIMEOUT_MS / 1000);
-        httpStarted = http.begin(*insecureClient, url);
+        if (!clients.plain)
+        {
+            clients.plain = new WiFiClient();
+            clients.plain->setTimeout(AUTH_TIMEOUT_MS / 1000);
+        }
+        httpStarted = http.begin(*clients.plain, url);
 #if DEBUG
         safePrintln("[CommTask] Using HTTP client");
 #endif
@@ -167,40 +169,43 @@ HttpResponse performWiFiRequest(const char* url, const char* payload, const char
 
     if (httpStarted)
     {
+        http.useHTTP10(true);
         http.addHeader("Content-Type", "application/json");
         http.addHeader("User-Agent", "ESP32-Sentinel/1.0");
-        if (authHeader && strlen(authHeader) > 0)
+        if (authHeader && authHeader[0] != '\0')
         {
             http.addHeader("Authorization", authHeader);
         }
+        if (contentEncoding)
+        {
+            http.addHeader("Content-Encoding", contentEncoding);
+        }
         http.setTimeout(AUTH_TIMEOUT_MS);
 
-        int httpResponseCode = http.POST(payload);
-        String responseBody = http.getString();
-        response = HttpResponse(httpResponseCode, responseBody);
+        int httpResponseCode = http.POST((uint8_t*)payload, payloadLength);
+        response = HttpResponse(httpResponseCode);
+        if (httpResponseCode > 0)
+        {
+            sink.begin(httpResponseCode, http.getSize());
+            if (sink.wantsBody())
+            {
+                streamWiFiBody(http, sink);
+            }
+            sink.end();
+        }
 
         http.end();
     }
 
-    if (secureClient)
-    {
-        delete secureClient;
-        secureClient = nullptr;
-    }
-    if (insecureClient)
-    {
-        delete insecureClient;
-        insecureClient = nullptr;
-    }
-
     return response;
 }
 
-HttpResponse performLTERequest(const char* url, const char* payload, const char* authHeader)
+HttpResponse performLTERequest(const char* url, const uint8_t* payload, size_t payloadLength,
+    ResponseSink& sink, const char* authHeader, const char* contentEncoding)
 {
     HttpResponse response;
 
-    if (xSemaphoreTake(modemMutex, pdMS_TO_TICKS(10000)) != pdTRUE)
+    if (!modemPower.acquire(MODEM_CHANNEL_DATA, pdMS_TO_TICKS(10000)))
     {
         safePrintln("[CommTask] Failed to acquire modem mutex for LTE communication");
         return response;
@@ -208,13 +213,13 @@ HttpResponse performLTERequest(const char* url, const char* payload, const char*
 
 #if DEBUG
     safePrintf("[CommTask] LTE request to: %s\n", url);
-    safePrintf("[CommTask] Payload size: %d\n", strlen(payload));
+    safePrintf("[CommTask] Payload size: %d\n", payloadLength);
 #endif
 
     if (!modem.https_begin())
     {
         safePrintln("[CommTask] Failed to initialize HTTPS for LTE");
-        xSemaphoreGive(modemMutex);
+        modemPower.release(MODEM_CHANNEL_DATA);
         return response;
     }
 
@@ -222,148 +227,366 @@ HttpResponse performLTERequest(const char* url, const char* payload, const char*
     {
         safePrintln("[CommTask] Failed to set URL for LTE request");
         modem.https_end();
-        xSemaphoreGive(modemMutex);
+        modemPower.release(MODEM_CHANNEL_DATA);
         return response;
     }
 
     modem.https_set_accept_type("application/json");
     modem.https_add_header("Content-Type", "application/json");
     modem.https_set_user_agent("ESP32-Sentinel/1.0");
-    if (authHeader && strlen(authHeader) > 0)
+    if (authHeader && authHeader[0] != '\0')
     {
         modem.https_add_header("Authorization", authHeader);
     }
+    if (contentEncoding)
+    {
+        modem.https_add_header("Content-Encoding", contentEncoding);
+    }
 
-    int httpCode = modem.https_post(payload);
-    String responseBody = modem.https_body();
-    response = HttpResponse(httpCode, responseBody);
+    int httpCode = modem.https_post((uint8_t*)payload, payloadLength);
+    response = HttpResponse(httpCode);
+    if (httpCode > 0)
+    {
+        if (sink.wantsBody())
+        {
+            // The body stays in the modem and is read in chunks, only as far as the sink needs
+            size_t total = modem.https_get_size();
+            uint8_t chunk[HTTP_STREAM_CHUNK_SIZE];
+            size_t offset = 0;
 
-    modem.https_end();
-    xSemaphoreGive(modemMutex);
+            sink.begin(httpCode, (int)total);
+            while (offset < total)
+            {
+                size_t want = total - offset < sizeof(chunk) ? total - offset : sizeof(chunk);
+                int n = modem.https_body(chunk, want, offset);
+                if (n <= 0)
+                {
+                    break;
+                }
+                offset += n;
+                if (!sink.write(chunk, n))
+                {
+                    break;
+                }
+            }
+        }
+        else
+        {
+            sink.begin(httpCode, -1);
+        }
+        sink.end();
+    }
 
+    modem.https_end();
+    modemPower.release(MODEM_CHANNEL_DATA);
     return response;
 }
 
-void sendDataWithAuth(const char* jsonPayload)
+int sendDataWithAuth(const char* jsonPayload)
 {
-    String dataUrl = String(BACKEND_URL) + API_ENDPOINT;
-
-    if (currentJWTToken.isEmpty() || millis() > tokenExpiryTime - TOKEN_REFRESH_MARGIN_MS)
+    if (!getAuthToken(sendToken, sizeof(sendToken)))
     {
-        safePrintln("[CommTask] Refreshing backend JWT token...");
-        authenticateWithBackend(currentJWTToken);
+        requestAuthRefresh();
+        return HTTP_CODE_AUTH_NOT_READY;
     }
-    sendJson(dataUrl.c_str(), jsonPayload, currentJWTToken);
+    return sendJson(DATA_URL, jsonPayload, sendToken);
 }
 
-bool authenticateWithBackend(String& token)
+/**
+ * @brief Serialize the login payload once into its static buffer
+ */
+static bool buildLoginPayload()
 {
-    bool success = false;
-    int attempts = 0;
+    if (loginPayload[0] != '\0')
+    {
+        return true;
+    }
 
-    String authUrl = String(BACKEND_URL) + AUTH_ENDPOINT;
+    authArena.reset();
+    size_t len = createLoginPayload(
+        &authArena, AUTH_USERNAME, AUTH_PASSWORD, loginPayload, sizeof(loginPayload));
+#if DEBUG
+    safePrintf("[CommTask] Auth arena high water: %d of %d bytes\n", authArena.getHighWater(),
+        JSON_ARENA_SIZE);
+#endif
+    authArena.reset();
 
-    JsonDocument loginDoc;
-    loginDoc["username"] = AUTH_USERNAME;
-    loginDoc["password"] = AUTH_PASSWORD;
+    if (len == 0)
+    {
+        safePrintln("[CommTask] Login payload does not fit in buffer");
+        loginPayload[0] = '\0';
+        return false;
+    }
+    return true;
+}
 
-    String loginPayload;
-    serializeJson(loginDoc, loginPayload);
+bool authenticateWithBackend(char* token, size_t tokenSize, uint32_t& lifetimeMs)
+{
+    bool success = false;
+    uint8_t attempts = 0;
+    HttpResponse response;
+    JsonTokenSink tokenSink(token, tokenSize);
+
+    if (!buildLoginPayload())
+    {
+        return false;
+    }
 
 #if DEBUG
-    safePrintf("[CommTask] Authenticating with backend at: %s\n", authUrl.c_str());
-    safePrintf("[CommTask] Auth payload: %s\n", loginPayload.c_str());
+    safePrintf("[CommTask] Authenticating with backend at: %s\n", AUTH_URL);
+    safePrintf("[CommTask] Auth payload: %s\n", loginPayload);
 #endif
 
-    while (attempts < AUTH_RETRY_ATTEMPTS && !success)
+    while (uplinkPolicy.shouldRetry(MSG_CLASS_AUTH, attempts) && !success)
     {
+        if (!uplinkPolicy.breaker().allowRequest())
+        {
+            safePrintln("[CommTask] Backend circuit open, skipping authentication");
+            break;
+        }
+
         attempts++;
         if (attempts > 1)
         {
 #if DEBUG
-            safePrintf("[CommTask] Authentication attempt %d of %d\n", attempts, AUTH_RETRY_ATTEMPTS);
+            safePrintf("[CommTask] Authentication attempt %d of %d\n", attempts,
+                uplinkPolicy.getBudget(MSG_CLASS_AUTH).maxAttempts);
 #endif
         }
 
-        HttpResponse response;
-
-        if (network.isWiFiConnected())
+        Transport transport = network.acquireUplink();
+        uint32_t startedAt = millis();
+        if (transport == TRANSPORT_WIFI)
         {
-            response = performWiFiRequest(authUrl.c_str(), loginPayload.c_str());
+            response = performWiFiRequest(authClients, AUTH_URL, (const uint8_t*)loginPayload,
+                strlen(loginPayload), tokenSink);
         }
-        else if (network.isLTEConnected())
+        else if (transport == TRANSPORT_LTE)
         {
-            response = performLTERequest(authUrl.c_str(), loginPayload.c_str());
+            response = performLTERequest(AUTH_URL, (const uint8_t*)loginPayload,
+                strlen(loginPayload), tokenSink);
         }
         else
         {
             safePrintln("[CommTask] No network available for authentication");
+            uplinkPolicy.breaker().cancelRequest();
             break;
         }
+        network.releaseUplink(transport, response.success, millis() - startedAt);
+
+        if (RetryPolicy::isBackendFailure(response.code))
+        {
+            uplinkPolicy.breaker().recordFailure();
+        }
+        else
+        {
+            uplinkPolicy.breaker().recordSuccess();
+        }
 
         if (response.code == 200)
         {
-            success = parseAuthResponse(response.body, token);
+            if (tokenSink.hasToken())
+            {
+                uint32_t expiresIn = tokenSink.getExpiresIn();
+                if (expiresIn > UINT32_MAX / 1000)
+                {
+                    expiresIn = UINT32_MAX / 1000; // saturated or beyond what millis() can time
+                }
+                lifetimeMs = tokenSink.hasExpiresIn() ? expiresIn * 1000 : DEFAULT_TOKEN_EXPIRY_MS;
+                safePrintln("[CommTask] Authentication successful");
+                success = true;
+            }
+            else if (tokenSink.hasError())
+            {
+                safePrintf("[CommTask] Token is escaped or does not fit in %d bytes\n", tokenSize);
+                break;
+            }
+            else
+            {
+                safePrintln("[CommTask] No token in authentication response");
+            }
         }
-        else if (response.code == 401)
+        else if (!RetryPolicy::isRetryableStatus(response.code))
         {
             safePrintf("[CommTask] Authentication failed with code: %d\n", response.code);
-#if DEBUG
-            safePrintf("[CommTask] Error response: %s\n", response.body.c_str());
-#endif
             break;
         }
         else
         {
             safePrintf("[CommTask] Authentication failed with code: %d\n", response.code);
-#if DEBUG
-            safePrintf("[CommTask] Error response: %s\n", response.body.c_str());
-#endif
         }
 
-        if (attempts < AUTH_RETRY_ATTEMPTS && !success)
+        if (!success && uplinkPolicy.shouldRetry(MSG_CLASS_AUTH, attempts))
         {
+            uint32_t delayMs = uplinkPolicy.backoffDelay(MSG_CLASS_AUTH, attempts);
 #if DEBUG
-            safePrintln("[CommTask] Retrying authentication in 2 seconds...");
+            safePrintf("[CommTask] Retrying authentication in %lu ms...\n", delayMs);
 #endif
-            vTaskDelay(pdMS_TO_TICKS(2000));
+            vTaskDelay(pdMS_TO_TICKS(delayMs));
         }
     }
 
-    if (!success && attempts >= AUTH_RETRY_ATTEMPTS)
+    if (!success && !uplinkPolicy.shouldRetry(MSG_CLASS_AUTH, attempts))
     {
-        safePrint("[CommTask] Authentication failed after ");
-        safePrint(AUTH_RETRY_ATTEMPTS);
-        safePrintln(" attempts");
+        safePrintf("[CommTask] Authentication failed after %d attempts\n", attempts);
     }
 
     return success;
 }
 
-void sendJson(const char* url, const char* jsonPayload, const String& token)
+int sendJson(const char* url, const char* jsonPayload, const char* token)
 {
-    String authHeader = createBearerHeader(token);
     HttpResponse response;
 
+    if (!createBearerHeader(token, sendAuthHeader, sizeof(sendAuthHeader)))
+    {
+        safePrintln("[CommTask] Authorization header does not fit in buffer");
+        return HTTP_CODE_AUTH_NOT_READY;
+    }
+
 #if DEBUG
-    safePrint("[CommTask] Using backend JWT token: ");
-    safePrintln(token.substring(0, 20) + "...");
+    safePrintf("[CommTask] Using backend JWT token: %.20s...\n", token);
+    // Keep the start of the body for the log, telemetry never needs more
+    CaptureSink sink(sendDebugBody, sizeof(sendDebugBody));
+#else
+    DiscardSink sink;
 #endif
 
-    if (network.isWiFiConnected())
+    const uint8_t* body = (const uint8_t*)jsonPayload;
+    size_t bodyLength = strlen(jsonPayload);
+    const char* contentEncoding = nullptr;
+
+#ifdef USE_PAYLOAD_COMPRESSION
+    // Only send the compressed form when it is actually smaller
+    if (bodyLength >= COMPRESSION_MIN_SIZE)
     {
-        response = performWiFiRequest(url, jsonPayload, authHeader.c_str());
+        size_t compressedLength =
+            gzipEncoder.compress(body, bodyLength, sendCompressed, sizeof(sendCompressed));
+        if (compressedLength > 0 && compressedLength < bodyLength)
+        {
+#if DEBUG
+            safePrintf("[CommTask] Payload compressed %d -> %d bytes\n", bodyLength,
+                compressedLength);
+#endif
+            body = sendCompressed;
+            bodyLength = compressedLength;
+            contentEncoding = "gzip";
+        }
+    }
+#endif
+
+    // The transport is pinned for the whole request, handovers happen between requests
+    Transport transport = network.acquireUplink();
+    uint32_t startedAt = millis();
+    if (transport == TRANSPORT_WIFI)
+    {
+        response = performWiFiRequest(
+            sendClients, url, body, bodyLength, sink, sendAuthHeader, contentEncoding);
         handleHttpResponse(response, "WiFi (Backend)");
     }
-    else if (network.isLTEConnected())
+    else if (transport == TRANSPORT_LTE)
     {
-        response = performLTERequest(url, jsonPayload, authHeader.c_str());
+        response = performLTERequest(url, body, bodyLength, sink, sendAuthHeader, contentEncoding);
         handleHttpResponse(response, "LTE (Backend)");
     }
     else
     {
         safePrintln("[CommTask] No network available for backend communication");
     }
+    network.releaseUplink(transport, response.success, millis() - startedAt);
+
+#if DEBUG
+    if (sink.length() > 0)
+    {
+        safePrintf("[CommTask] Response: %s%s\n", sink.c_str(), sink.isTruncated() ? "..." : "");
+    }
+#endif
+
+    return response.code;
+}
+
+/**
+ * @brief Deliver one payload, retrying with backoff within the telemetry budget
+ *
+ * @param data Payload to deliver
+ * @return true if the payload is done with (delivered or permanently rejected), false if it should
+ * be parked in the offline buffer
+ */
+static bool deliverWithRetry(const processed_data_t& data)
+{
+    uint8_t attempts = 0;
+
+    while (uplinkPolicy.shouldRetry(MSG_CLASS_TELEMETRY, attempts))
+    {
+        if (!network.isConnected())
+        {
+            return false;
+        }
+        if (!isAuthTokenReady())
+        {
+            requestAuthRefresh();
+            return false;
+        }
+        if (!uplinkPolicy.breaker().allowRequest())
+        {
+            return false;
+        }
+
+        attempts++;
+        int code = sendDataWithAuth(data.json);
+
+        if (code == HTTP_CODE_AUTH_NOT_READY)
+        {
+            // Nothing was sent, so the breaker gets no verdict either way
+            uplinkPolicy.breaker().cancelRequest();
+            return false;
+        }
+
+        if (code >= 200 && code < 300)
+        {
+            uplinkPolicy.breaker().recordSuccess();
+            return true;
+        }
+
+        if (RetryPolicy::isBackendFailure(code))
+        {
+            uplinkPolicy.breaker().recordFailure();
+        }
+        else
+        {
+            uplinkPolicy.breaker().recordSuccess();
+        }
+
+        if (code == 401)
+        {
+            // Token was rejected and invalidated, keep the payload until a new one is issued
+            return false;
+        }
+
+        if (!RetryPolicy::isRetryableStatus(code))
+        {
+            safePrintf("[CommTask] Payload rejected with code %d, dropping\n", code);
+            return true;
+        }
+
+        if (uplinkPolicy.shouldRetry(MSG_CLASS_TELEMETRY, attempts))
+        {
+            vTaskDelay(pdMS_TO_TICKS(uplinkPolicy.backoffDelay(MSG_CLASS_TELEMETRY, attempts)));
+        }
+    }
+
+    return false;
+}
+
+static void parkPayload(const processed_data_t& data)
+{
+    if (!offlineBuffer.push(data))
+    {
+        safePrintln("[CommTask] Offline buffer full, oldest payload dropped");
+    }
+#if DEBUG
+    safePrintf("[CommTask] Payload parked, %d in offline buffer\n", offlineBuffer.size());
+#endif
 }
 
 /**
@@ -372,7 +595,8 @@ void sendJson(const char* url, const char* jsonPayload, const String& token)
  * @details This function handles communication operations in a FreeRTOS task. It reads processed
  * data from a queue and sends it to the network. The task runs in an infinite loop, waiting for
  * data to be available in the queue. When data is received, it is sent to the network for
- * processing.
+ * processing. Payloads that cannot be delivered within the retry budget, or while the backend
+ * circuit breaker is open, are parked in the offline buffer and drained once sends succeed again.
  *
  * @param pvParameters
  */
@@ -383,27 +607,33 @@ void communicationTask(void* pvParameters)
 
     while (true)
     {
+        bool backendHealthy = true;
+
         if (xQueueReceive(httpQueue, &outgoingData, pdMS_TO_TICKS(1000)))
         {
-            if (network.isWiFiConnected())
+            if (!network.isConnected())
             {
-#if DEBUG
-                safePrintln("[CommTask] Sending via WiFi...");
-#endif
-                sendDataWithAuth(outgoingData.json);
+                safePrintln("[CommTask] No network available, parking data.");
+                parkPayload(outgoingData);
+                backendHealthy = false;
             }
-            else if (network.isLTEConnected())
+            else if (!deliverWithRetry(outgoingData))
             {
-#if DEBUG
-                safePrintln("[CommTask] Sending via LTE...");
-#endif
-                sendDataWithAuth(outgoingData.json);
+                parkPayload(outgoingData);
+                backendHealthy = false;
             }
-            else
+
+            memset(&outgoingData, 0, sizeof(outgoingData));
+        }
+
+        // Drain one parked payload per cycle, oldest first, once the backend answers again
+        if (backendHealthy && !offlineBuffer.isEmpty() && network.isConnected())
+        {
+            offlineBuffer.peek(outgoingData);
+            if (deliverWithRetry(outgoingData))
             {
-                safePrintln("[CommTask] No network available, cannot send data.");
+                offlineBuffer.pop();
             }
-
             memset(&outgoingData, 0, sizeof(outgoingData));
         }
         vTaskDelay(pdMS_TO_TICKS(2000));
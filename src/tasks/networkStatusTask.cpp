@@ -1,5 +1,8 @@
 #include "tasks/networkStatusTask.h"
 #include "config.h"
+#include "network/cmux.h"
+#include "network/modemPower.h"
+#include "network/modemTransport.h"
 #include "network/network.h"
 #include "utils/threadsafe_serial.h"
 #include <Arduino.h>
@@ -54,37 +57,50 @@ void networkStatusTask(void* pvParameters)
 
     while (true)
     {
-        network.maintainConnection(WIFI_SSID, PASSWORD, NETWORK_APN);
+        uint32_t nextStepMs = network.maintainConnection(WIFI_SSID, PASSWORD, NETWORK_APN);
 
-        if (xSemaphoreTake(networkEventMutex, pdMS_TO_TICKS(1000)) == pdTRUE)
+        // maintainConnection() keeps the connected bit up to date, only log transitions here
+        bool isConnected = network.isConnected();
+        if (isConnected && !lastConnectionState)
         {
-            bool isConnected = network.isConnected();
-            if (isConnected)
-            {
-                xEventGroupSetBits(networkEventGroup, NETWORK_CONNECTED_BIT);
-                if (!lastConnectionState)
-                {
-                    safePrintln("[Net Task] Connected to internet");
-                    lastConnectionState = true;
-                }
-            }
-            else
+            network_metrics_t metrics = network.getMetrics();
+            safePrintf("[Net Task] Connected to internet after %lu ms\n", metrics.lastTimeToConnectMs);
+#if DEBUG
+            safePrintf("[Net Task] WiFi %lu/%lu, LTE %lu/%lu connects/failures (%lu re-attaches), "
+                "longest step %lu ms\n",
+                metrics.wifiConnects, metrics.wifiFailures, metrics.lteConnects,
+                metrics.lteFailures, metrics.lteReattaches, metrics.longestStepMs);
+            link_stats_t wifiLink = network.getLinkStats(TRANSPORT_WIFI);
+            link_stats_t lteLink = network.getLinkStats(TRANSPORT_LTE);
+            safePrintf("[Net Task] Link score WiFi %.2f (%.0f%%, %.0f ms), LTE %.2f (%.0f%%, %.0f ms)\n",
+                wifiLink.score, wifiLink.successRate * 100, wifiLink.latencyMs, lteLink.score,
+                lteLink.successRate * 100, lteLink.latencyMs);
+            modem_power_stats_t power = modemPower.getStats();
+            safePrintf("[Net Task] Modem status: %lu URCs, %lu checks answered from cache\n",
+                metrics.statusUrcs, metrics.statusCacheHits);
+            safePrintf("[Net Task] Modem %lu wakes (last %lu ms, max %lu ms), %lu cold boots, ~%lu mJ\n",
+                power.wakes, power.lastWakeLatencyMs, power.maxWakeLatencyMs, power.coldBoots,
+                power.energyMj);
+            modem_transport_stats_t uart = modemTransport.getStats();
+            safePrintf("[Net Task] Modem UART %lu baud, %lu bytes in, %lu out, %lu overflows\n",
+                uart.baud, uart.bytesIn, uart.bytesOut, uart.rxOverflows);
+            if (cmux.isActive())
             {
-                xEventGroupClearBits(networkEventGroup, NETWORK_CONNECTED_BIT);
-                if (lastConnectionState)
-                {
-                    safePrintln("[Net Task] Connection lost, retrying...");
-                    lastConnectionState = false;
-                }
+                cmux_stats_t mux = cmux.getStats();
+                safePrintf("[Net Task] CMUX %lu frames in, %lu out, %lu bad FCS, %lu overflows, "
+                    "%lu pauses\n",
+                    mux.framesIn, mux.framesOut, mux.fcsErrors, mux.rxOverflows, mux.flowStops);
             }
-            xSemaphoreGive(networkEventMutex);
+#endif
+            lastConnectionState = true;
         }
-        else
+        else if (!isConnected && lastConnectionState)
         {
-            safePrintln("[Net Task] Failed to access network event group, continuing...");
+            safePrintln("[Net Task] Connection lost, retrying...");
+            lastConnectionState = false;
         }
 
-        uint32_t delayTime = lastConnectionState ? 10000 : 30000;
-        vTaskDelay(pdMS_TO_TICKS(delayTime));
+        // Sleep until the next step is due or a WiFi event wakes the task
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(nextStepMs));
     }
 }
@@ -11,64 +11,18 @@
 #include "tasks/processingTask.h"
 #include "SensorData.h"
 #include "config.h"
+#include "network/retryPolicy.h"
+#include "network/uplinkPayload.h"
 #include "utils/threadsafe_serial.h"
 #include <Arduino.h>
 
-#define JSON_BUFFER_SIZE 512
+#define JSON_BUFFER_SIZE 1024
 #define HTTP_QUEUE_SEND_TIMEOUT_MS 2000
-#define HTTP_QUEUE_SEND_RETRIES 3
 #define DATA_QUEUE_RECEIVE_TIMEOUT_MS 1000
 
 extern QueueHandle_t dataQueue;
 extern QueueHandle_t httpQueue;
 
-/**
- * @brief Create a Json object
- *
- * @details This function creates a JSON string from the sensor data and stores it in the provided
- * buffer. The JSON string contains the following fields:
- * - steps
- * - humidity
- * - gas
- * - fall_detected
- * - device_battery
- * - strap_battery
- * - heart_rate
- * - noise_level
- *
- * @param data
- * @param buffer
- * @param bufferSize
- * @return true
- * @return false
- */
-bool createJson(const sensor_data_t &data, char *buffer, size_t bufferSize)
-{
-    int len = snprintf(buffer, bufferSize,
-                       "{\"device_id\": \"%s\", \"sensors\": { "
-                       "\"steps\": %d, "
-                       "\"temperature\": %.2f, "
-                       "\"humidity\": %.2f, "
-                       "\"gas\": { \"ppm\": %.2f }, "
-                       "\"fall_detected\": %d, "
-                       "\"device_battery\": %d, "
-                       "\"strap_battery\": \"0\", "
-                       "\"heart_rate\": %d, "
-                       "\"latitude\": %.6f, "
-                       "\"longitude\": %.6f, "
-                       "\"altitude\": %.2f, "
-                       "\"accuracy\": %.2f, "
-                       "\"noise_level\": %d } }",
-                       DEVICE_ID, data.steps, data.temperature, data.humidity, data.gasLevel,
-                       data.fall_detected, data.device_battery, data.heartRate, data.latitude, data.longitude, data.gps_altitude, data.gps_accuracy, data.noise_level);
-    if (len < 0 || len >= (int)bufferSize)
-    {
-        safePrintln("[Proc Task] JSON creation failed or truncated.");
-        return false;
-    }
-    return true;
-}
-
 // we send empty data in struct so validation is needed to not overwite with null
 static void updateLatestData(sensor_data_t &latest, const sensor_message_t &incoming)
 {
@@ -106,6 +60,49 @@ static void updateLatestData(sensor_data_t &latest, const sensor_message_t &inco
         latest.gps_altitude = incoming.data.gps_altitude;
     if (incoming.valid.gps_accuracy)
         latest.gps_accuracy = incoming.data.gps_accuracy;
+    // track, geofence, heart rate summary and BLE stats are events, kept until a JSON carrying them
+    // is queued
+    if (incoming.valid.track)
+        memcpy(latest.track, incoming.data.track, sizeof(latest.track));
+    if (incoming.valid.geofence)
+    {
+        latest.geofence = incoming.data.geofence;
+        latest.geofence_inside = incoming.data.geofence_inside;
+    }
+    if (incoming.valid.hr_summary)
+    {
+        latest.hr_strap = incoming.data.hr_strap;
+        latest.hr_period = incoming.data.hr_period;
+        latest.hr_min = incoming.data.hr_min;
+        latest.hr_max = incoming.data.hr_max;
+        latest.hr_contact = incoming.data.hr_contact;
+        latest.hr_energy = incoming.data.hr_energy;
+        latest.hrv_beats = incoming.data.hrv_beats;
+        latest.hrv_artifacts = incoming.data.hrv_artifacts;
+        latest.hrv_rmssd = incoming.data.hrv_rmssd;
+        latest.hrv_sdnn = incoming.data.hrv_sdnn;
+        latest.hrv_pnn50 = incoming.data.hrv_pnn50;
+    }
+    if (incoming.valid.bt_stats)
+    {
+        latest.bt_scan_duty = incoming.data.bt_scan_duty;
+        latest.bt_reconnects = incoming.data.bt_reconnects;
+        latest.bt_reconnect_avg_ms = incoming.data.bt_reconnect_avg_ms;
+        latest.bt_reconnect_max_ms = incoming.data.bt_reconnect_max_ms;
+        latest.bt_tx_power = incoming.data.bt_tx_power;
+        latest.bt_radio_ms_per_hour = incoming.data.bt_radio_ms_per_hour;
+    }
+}
+
+/**
+ * @brief Forget the events once they are on their way
+ */
+static void clearEvents(sensor_data_t& latest)
+{
+    latest.track[0] = '\0';
+    latest.geofence = -1;
+    latest.hr_strap = -1;
+    latest.bt_scan_duty = -1;
 }
 
 /**
@@ -124,8 +121,10 @@ void processingTask(void *pvParameters)
     sensor_data_t latestData;
     processed_data_t processedData;
     char buffer[JSON_BUFFER_SIZE];
+    RetryPolicy queuePolicy;
 
     memset(&latestData, 0, sizeof(latestData));
+    clearEvents(latestData);
     memset(&processedData, 0, sizeof(processedData));
 
     while (true)
@@ -134,7 +133,14 @@ void processingTask(void *pvParameters)
         {
             updateLatestData(latestData, incoming);
 
-            if (createJson(latestData, buffer, sizeof(buffer)))
+            bool created = createJson(latestData, buffer, sizeof(buffer));
+            if (!created)
+            {
+                safePrintln("[Proc Task] JSON creation failed or truncated.");
+                // Events that do not fit would fail every following message as well
+                clearEvents(latestData);
+            }
+            else
             {
                 // null terminate buffer
                 buffer[sizeof(buffer) - 1] = '\0';
@@ -148,24 +154,26 @@ void processingTask(void *pvParameters)
                 strncpy(processedData.json, buffer, sizeof(processedData.json) - 1);
                 processedData.json[sizeof(processedData.json) - 1] = '\0';
 
-                int retries = 0;
+                // The first attempt waits as long as before, later ones with growing backoff, so
+                // a busy communication task gets about 6 s in total to make room
+                uint8_t attempts = 0;
                 bool sent = false;
-                while (retries < HTTP_QUEUE_SEND_RETRIES && !sent)
+                while (!sent && queuePolicy.shouldRetry(MSG_CLASS_QUEUE, attempts))
+                {
+                    uint32_t waitMs = attempts == 0
+                        ? HTTP_QUEUE_SEND_TIMEOUT_MS
+                        : queuePolicy.backoffDelay(MSG_CLASS_QUEUE, attempts);
+                    attempts++;
+                    sent = xQueueSend(httpQueue, &processedData, pdMS_TO_TICKS(waitMs)) == pdPASS;
+                }
+                if (sent)
+                {
+                    clearEvents(latestData);
+                }
+                else
                 {
-                    if (xQueueSend(httpQueue, &processedData,
-                                   HTTP_QUEUE_SEND_TIMEOUT_MS / portTICK_PERIOD_MS) == pdPASS)
-                    {
-                        sent = true;
-                    }
-                    else
-                    {
-                        retries++;
-                        if (retries >= HTTP_QUEUE_SEND_RETRIES)
-                        {
-                            safePrintln(
-                                "[Proc Task] Failed to send JSON to HTTP queue after retries.");
-                        }
-                    }
+                    // The events go out with the next message instead
+                    safePrintln("[Proc Task] Failed to send JSON to HTTP queue after retries.");
                 }
             }
         }
@@ -0,0 +1,147 @@
+/**
+ * @file addressSet.cpp
+ * @brief Bluetooth Address Whitelist Implementation
+ *
+ * @details Addresses are hashed with a Fibonacci multiply, which spreads the few vendor-prefixed
+ * addresses of a whitelist evenly over the slots. Collisions are resolved by linear probing.
+ */
+
+#include "utils/addressSet.h"
+
+#define ADDRESS_TEXT_LENGTH 17 // "aa:bb:cc:dd:ee:ff"
+
+AddressSet::AddressSet() : count(0)
+{
+    for (size_t i = 0; i < SLOTS; i++)
+    {
+        slots[i] = -1;
+    }
+}
+
+/**
+ * @brief Add every address of a comma separated list, whitespace around entries is ignored
+ *
+ * @return Number of addresses added, malformed and duplicate entries are skipped
+ */
+size_t AddressSet::parse(const char* list)
+{
+    size_t added = 0;
+    while (list && *list)
+    {
+        while (*list == ' ' || *list == ',')
+        {
+            list++;
+        }
+        const char* start = list;
+        while (*list && *list != ',' && *list != ' ')
+        {
+            list++;
+        }
+
+        uint64_t address;
+        if (list > start && parseAddress(start, list - start, address) && add(address))
+        {
+            added++;
+        }
+    }
+    return added;
+}
+
+/**
+ * @brief Add one address
+ *
+ * @return false if it is already in the set or the set is full
+ */
+bool AddressSet::add(uint64_t address)
+{
+    if (count >= ADDRESS_SET_MAX || indexOf(address) >= 0)
+    {
+        return false;
+    }
+    size_t slot = slotOf(address);
+    while (slots[slot] >= 0)
+    {
+        slot = (slot + 1) % SLOTS;
+    }
+    slots[slot] = (int8_t)count;
+    addresses[count++] = address;
+    return true;
+}
+
+/**
+ * @brief Position the address was added at, -1 if it is not in the set
+ */
+int AddressSet::indexOf(uint64_t address) const
+{
+    size_t slot = slotOf(address);
+    for (size_t probes = 0; probes < SLOTS; probes++, slot = (slot + 1) % SLOTS)
+    {
+        int8_t index = slots[slot];
+        if (index < 0)
+        {
+            return -1;
+        }
+        if (addresses[index] == address)
+        {
+            return index;
+        }
+    }
+    return -1;
+}
+
+uint64_t AddressSet::get(size_t index) const
+{
+    return index < count ? addresses[index] : 0;
+}
+
+size_t AddressSet::size() const
+{
+    return count;
+}
+
+/**
+ * @brief Parse "aa:bb:cc:dd:ee:ff", either case, most significant byte first
+ */
+bool AddressSet::parseAddress(const char* text, size_t length, uint64_t& address)
+{
+    if (length != ADDRESS_TEXT_LENGTH)
+    {
+        return false;
+    }
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        char c = text[i];
+        if (i % 3 == 2)
+        {
+            if (c != ':' && c != '-')
+            {
+                return false;
+            }
+            continue;
+        }
+
+        uint8_t nibble;
+        if (c >= '0' && c <= '9')
+        {
+            nibble = c - '0';
+        }
+        else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+        {
+            nibble = (c | 0x20) - 'a' + 10;
+        }
+        else
+        {
+            return false;
+        }
+        value = (value << 4) | nibble;
+    }
+    address = value;
+    return true;
+}
+
+size_t AddressSet::slotOf(uint64_t address)
+{
+    return (size_t)((address * 0x9E3779B97F4A7C15ull) >> 32) % SLOTS;
+}
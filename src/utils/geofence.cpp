@@ -0,0 +1,137 @@
+/**
+ * @file geofence.cpp
+ * @brief Polygon Geofences Implementation
+ *
+ * @details Longitude is treated as a plane coordinate, which is fine for fences of a few
+ * kilometres that do not cross the antimeridian. The side of the first fix is taken as it is and
+ * not reported as a transition, the device may well boot inside a fence.
+ */
+
+#include "utils/geofence.h"
+#include "utils/track.h"
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef GEOFENCE_CONFIRM_FIXES
+#define GEOFENCE_CONFIRM_FIXES 2
+#endif
+
+GeofenceSet::GeofenceSet() : count(0)
+{
+}
+
+/**
+ * @brief Add a polygon of at least three vertices
+ *
+ * @return false if the polygon is invalid or the set is full
+ */
+bool GeofenceSet::add(const geofence_t& fence)
+{
+    if (count >= GEOFENCE_MAX_FENCES || fence.count < 3 || fence.count > GEOFENCE_MAX_VERTICES)
+    {
+        return false;
+    }
+
+    fence_state_t& f = fences[count++];
+    f.name = fence.name;
+    f.count = fence.count;
+    for (uint8_t i = 0; i < fence.count; i++)
+    {
+        f.vertices[2 * i] = TrackBuffer::toFixed(fence.vertices[i].latitude);
+        f.vertices[2 * i + 1] = TrackBuffer::toFixed(fence.vertices[i].longitude);
+    }
+    f.known = false;
+    f.inside = false;
+    f.streak = 0;
+    return true;
+}
+
+size_t GeofenceSet::size() const
+{
+    return count;
+}
+
+/**
+ * @brief Evaluate a fix against every fence
+ *
+ * @details At most one transition is reported per call; another fence that changed side at the
+ * same time is reported by the next call.
+ *
+ * @param latitude Fix latitude, 1e-5 degree
+ * @param longitude Fix longitude, 1e-5 degree
+ * @param event Receives the transition
+ * @return true if event holds a transition
+ */
+bool GeofenceSet::update(int32_t latitude, int32_t longitude, geofence_event_t& event)
+{
+    bool reported = false;
+    for (size_t i = 0; i < count; i++)
+    {
+        fence_state_t& f = fences[i];
+        bool inside = contains(f.vertices, f.count, latitude, longitude);
+        if (!f.known)
+        {
+            f.known = true;
+            f.inside = inside;
+            continue;
+        }
+        if (inside == f.inside)
+        {
+            f.streak = 0;
+            continue;
+        }
+
+        if (f.streak < GEOFENCE_CONFIRM_FIXES)
+        {
+            f.streak++;
+        }
+        if (f.streak < GEOFENCE_CONFIRM_FIXES || reported)
+        {
+            continue; // a reported transition leaves the streak confirmed for the next call
+        }
+
+        f.inside = inside;
+        f.streak = 0;
+        event.fence = (uint8_t)i;
+        event.name = f.name;
+        event.inside = inside;
+        reported = true;
+    }
+    return reported;
+}
+
+bool GeofenceSet::isInside(uint8_t fence) const
+{
+    return fence < count && fences[fence].known && fences[fence].inside;
+}
+
+/**
+ * @brief Even-odd test of a point against a polygon
+ *
+ * @param vertices Latitude, longitude pairs in 1e-5 degree
+ * @param count Number of vertices
+ */
+bool GeofenceSet::contains(const int32_t* vertices, uint8_t count, int32_t latitude,
+    int32_t longitude)
+{
+    bool inside = false;
+    for (uint8_t i = 0, j = count - 1; i < count; j = i++)
+    {
+        int64_t yi = vertices[2 * i], xi = vertices[2 * i + 1];
+        int64_t yj = vertices[2 * j], xj = vertices[2 * j + 1];
+        if ((yi > latitude) == (yj > latitude))
+        {
+            continue;
+        }
+        // Crossing longitude of the edge at this latitude, compared without dividing
+        int64_t lhs = (longitude - xi) * (yj - yi);
+        int64_t rhs = (xj - xi) * (latitude - yi);
+        if (yj > yi ? lhs < rhs : lhs > rhs)
+        {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
@@ -0,0 +1,230 @@
+/**
+ * @file gzipEncoder.cpp
+ * @brief Small Gzip Encoder Implementation
+ *
+ * @details Deflate details follow RFC 1951 section 3.2.6 (fixed Huffman codes). Huffman codes are
+ * defined most significant bit first while the rest of the stream is packed least significant bit
+ * first, so codes are bit-reversed before they are written.
+ */
+
+#include "utils/gzipEncoder.h"
+#include <cstring>
+
+#define GZIP_MIN_MATCH 3
+#define GZIP_MAX_MATCH 258
+#define GZIP_MAX_DISTANCE 32768
+
+static const uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DISTANCE_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static inline uint16_t hash3(const uint8_t* p)
+{
+    uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (uint16_t)((v * 2654435761u) >> (32 - GZIP_HASH_BITS));
+}
+
+GzipEncoder::GzipEncoder()
+    : out(nullptr), outSize(0), outPos(0), bitBuffer(0), bitCount(0), overflow(false)
+{
+    memset(head, 0, sizeof(head));
+}
+
+size_t GzipEncoder::compress(const uint8_t* input, size_t length, uint8_t* output,
+    size_t outputSize)
+{
+    if (!input || !output || length > GZIP_MAX_INPUT)
+    {
+        return 0;
+    }
+
+    out = output;
+    outSize = outputSize;
+    outPos = 0;
+    bitBuffer = 0;
+    bitCount = 0;
+    overflow = false;
+    memset(head, 0, sizeof(head));
+
+    // Header: magic, deflate, no flags, no mtime, no extra flags, unknown OS
+    static const uint8_t HEADER[10] = {0x1f, 0x8b, 0x08, 0, 0, 0, 0, 0, 0, 0xff};
+    for (size_t i = 0; i < sizeof(HEADER); i++)
+    {
+        putByte(HEADER[i]);
+    }
+
+    // One final block with fixed Huffman codes
+    putBits(1, 1);
+    putBits(1, 2);
+
+    size_t pos = 0;
+    while (pos < length && !overflow)
+    {
+        uint16_t matchLength = 0;
+        uint16_t matchDistance = 0;
+
+        if (pos + GZIP_MIN_MATCH <= length)
+        {
+            uint16_t h = hash3(input + pos);
+            size_t candidate = head[h];
+            head[h] = (uint16_t)(pos + 1);
+
+            if (candidate > 0 && pos - (candidate - 1) <= GZIP_MAX_DISTANCE)
+            {
+                size_t start = candidate - 1;
+                size_t limit = length - pos < GZIP_MAX_MATCH ? length - pos : GZIP_MAX_MATCH;
+                size_t n = 0;
+                while (n < limit && input[start + n] == input[pos + n])
+                {
+                    n++;
+                }
+                if (n >= GZIP_MIN_MATCH)
+                {
+                    matchLength = (uint16_t)n;
+                    matchDistance = (uint16_t)(pos - start);
+                }
+            }
+        }
+
+        if (matchLength > 0)
+        {
+            putMatch(matchLength, matchDistance);
+            // Index the positions inside the match so later data can refer to them
+            for (size_t i = pos + 1; i < pos + matchLength && i + GZIP_MIN_MATCH <= length; i++)
+            {
+                head[hash3(input + i)] = (uint16_t)(i + 1);
+            }
+            pos += matchLength;
+        }
+        else
+        {
+            putLiteral(input[pos]);
+            pos++;
+        }
+    }
+
+    // End of block
+    putCode(0, 7);
+    flushBits();
+
+    // Trailer: CRC32 and input size, little endian
+    uint32_t crc = crc32(input, length);
+    for (int i = 0; i < 4; i++)
+    {
+        putByte((uint8_t)(crc >> (8 * i)));
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        putByte((uint8_t)(length >> (8 * i)));
+    }
+
+    return overflow ? 0 : outPos;
+}
+
+void GzipEncoder::putBits(uint32_t value, uint8_t count)
+{
+    bitBuffer |= value << bitCount;
+    bitCount += count;
+    while (bitCount >= 8)
+    {
+        putByte((uint8_t)bitBuffer);
+        bitBuffer >>= 8;
+        bitCount -= 8;
+    }
+}
+
+/**
+ * @brief Write a Huffman code, reversing it into stream bit order
+ */
+void GzipEncoder::putCode(uint16_t code, uint8_t count)
+{
+    uint16_t reversed = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    putBits(reversed, count);
+}
+
+void GzipEncoder::putByte(uint8_t value)
+{
+    if (outPos < outSize)
+    {
+        out[outPos++] = value;
+    }
+    else
+    {
+        overflow = true;
+    }
+}
+
+void GzipEncoder::putLiteral(uint8_t value)
+{
+    if (value < 144)
+    {
+        putCode(0x30 + value, 8);
+    }
+    else
+    {
+        putCode(0x190 + (value - 144), 9);
+    }
+}
+
+void GzipEncoder::putMatch(uint16_t length, uint16_t distance)
+{
+    uint8_t lengthIndex = 28;
+    while (LENGTH_BASE[lengthIndex] > length)
+    {
+        lengthIndex--;
+    }
+    uint16_t symbol = 257 + lengthIndex;
+    if (symbol < 280)
+    {
+        putCode(symbol - 256, 7);
+    }
+    else
+    {
+        putCode(0xc0 + (symbol - 280), 8);
+    }
+    putBits(length - LENGTH_BASE[lengthIndex], LENGTH_EXTRA[lengthIndex]);
+
+    uint8_t distanceIndex = 29;
+    while (DISTANCE_BASE[distanceIndex] > distance)
+    {
+        distanceIndex--;
+    }
+    putCode(distanceIndex, 5);
+    putBits(distance - DISTANCE_BASE[distanceIndex], DISTANCE_EXTRA[distanceIndex]);
+}
+
+void GzipEncoder::flushBits()
+{
+    if (bitCount > 0)
+    {
+        putByte((uint8_t)bitBuffer);
+    }
+    bitBuffer = 0;
+    bitCount = 0;
+}
+
+uint32_t GzipEncoder::crc32(const uint8_t* data, size_t length)
+{
+    // Nibble table for the reflected polynomial 0xEDB88320
+    static const uint32_t TABLE[16] = {0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190,
+        0x6b6b51f4, 0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+        0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ TABLE[crc & 0x0f];
+        crc = (crc >> 4) ^ TABLE[crc & 0x0f];
+    }
+    return crc ^ 0xffffffff;
+}
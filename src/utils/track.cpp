@@ -0,0 +1,205 @@
+/**
+ * @file track.cpp
+ * @brief GPS Track Simplification and Delta Encoding Implementation
+ *
+ * @details Distances use the equirectangular approximation, which is well within a metre at the
+ * tolerances involved. The predictor is reset by a gap longer than TRACK_MAX_GAP_MS, so a device
+ * that was stationary does not extrapolate an old velocity, and such a gap always keeps the fix.
+ */
+
+#include "utils/track.h"
+#include <cmath>
+
+#ifdef ARDUINO
+#include "config.h"
+#endif
+
+#ifndef TRACK_TOLERANCE_M
+#define TRACK_TOLERANCE_M 25.0f // distance from the predicted position that keeps a fix
+#endif
+#ifndef TRACK_MAX_GAP_MS
+#define TRACK_MAX_GAP_MS 600000 // a fix is kept at least this often
+#endif
+
+#define METERS_PER_UNIT (6371008.8f * 3.14159265f / 180.0f / TRACK_SCALE)
+#define TRACK_VARINT_CHUNK 0x20 // polyline encoding: 5 bits per character
+#define TRACK_VARINT_BASE 63    // '?', first printable character used
+
+TrackBuffer::TrackBuffer()
+{
+    clear();
+}
+
+void TrackBuffer::clear()
+{
+    head = 0;
+    count = 0;
+    kept = 0;
+    dropped = 0;
+}
+
+/**
+ * @brief Offer a fix to the track
+ *
+ * @return true if the fix was kept
+ */
+bool TrackBuffer::add(float latitude, float longitude, uint32_t now)
+{
+    track_point_t point = {toFixed(latitude), toFixed(longitude), now};
+
+    track_point_t predicted;
+    if (predict(now, predicted) && deviationMeters(point, predicted) <= TRACK_TOLERANCE_M)
+    {
+        return false;
+    }
+
+    last[1] = last[0];
+    last[0] = point;
+    if (kept < 2)
+    {
+        kept++;
+    }
+
+    if (count == TRACK_MAX_POINTS)
+    {
+        head = (head + 1) % TRACK_MAX_POINTS;
+        count--;
+        dropped++;
+    }
+    points[(head + count) % TRACK_MAX_POINTS] = point;
+    count++;
+    return true;
+}
+
+/**
+ * @brief Encode the oldest kept fixes and remove them from the buffer
+ *
+ * @param out Receives the NUL-terminated encoding, only whole points are written
+ * @param outSize Size of out
+ * @param now Time the encoding is sent, ages are relative to it
+ * @return Number of points encoded
+ */
+size_t TrackBuffer::drain(char* out, size_t outSize, uint32_t now)
+{
+    if (outSize == 0)
+    {
+        return 0;
+    }
+
+    size_t used = 0;
+    size_t encoded = 0;
+    int32_t previous[3] = {0, 0, 0};
+    while (encoded < count)
+    {
+        const track_point_t& p = points[(head + encoded) % TRACK_MAX_POINTS];
+        int32_t value[3] = {p.latitude, p.longitude, (int32_t)((now - p.time) / 1000)};
+
+        // Leave room for the terminator, a point that does not fit waits for the next drain
+        size_t n = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            size_t written = encodeValue(value[i] - previous[i], out + used + n,
+                outSize - 1 - used - n);
+            if (written == 0)
+            {
+                n = 0;
+                break;
+            }
+            n += written;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+
+        used += n;
+        encoded++;
+        for (int i = 0; i < 3; i++)
+        {
+            previous[i] = value[i];
+        }
+    }
+
+    out[used] = '\0';
+    head = (head + encoded) % TRACK_MAX_POINTS;
+    count -= encoded;
+    return encoded;
+}
+
+size_t TrackBuffer::size() const
+{
+    return count;
+}
+
+uint32_t TrackBuffer::getDroppedCount() const
+{
+    return dropped;
+}
+
+int32_t TrackBuffer::toFixed(float degrees)
+{
+    return (int32_t)lroundf(degrees * TRACK_SCALE);
+}
+
+/**
+ * @brief Distance between two points, in metres
+ */
+float TrackBuffer::deviationMeters(const track_point_t& a, const track_point_t& b)
+{
+    float latitude = (a.latitude + b.latitude) * 0.5f / TRACK_SCALE * 3.14159265f / 180.0f;
+    float dy = (float)(a.latitude - b.latitude) * METERS_PER_UNIT;
+    float dx = (float)(a.longitude - b.longitude) * METERS_PER_UNIT * cosf(latitude);
+    return sqrtf(dx * dx + dy * dy);
+}
+
+/**
+ * @brief Dead-reckoned position at time
+ *
+ * @return false if nothing can be predicted and the fix must be kept
+ */
+bool TrackBuffer::predict(uint32_t time, track_point_t& predicted) const
+{
+    if (kept == 0 || time - last[0].time > TRACK_MAX_GAP_MS)
+    {
+        return false;
+    }
+
+    predicted = last[0];
+    predicted.time = time;
+    uint32_t span = last[0].time - last[1].time;
+    if (kept < 2 || span == 0 || span > TRACK_MAX_GAP_MS)
+    {
+        return true; // no velocity yet, assume standing still
+    }
+
+    float elapsed = (float)(time - last[0].time) / span;
+    predicted.latitude += lroundf((last[0].latitude - last[1].latitude) * elapsed);
+    predicted.longitude += lroundf((last[0].longitude - last[1].longitude) * elapsed);
+    return true;
+}
+
+/**
+ * @brief Write one signed value as a polyline varint
+ *
+ * @return Characters written, 0 if they do not fit
+ */
+size_t TrackBuffer::encodeValue(int32_t value, char* out, size_t outSize)
+{
+    uint32_t v = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); // zigzag
+    size_t n = 0;
+    do
+    {
+        if (n == outSize)
+        {
+            return 0;
+        }
+        uint32_t chunk = v & (TRACK_VARINT_CHUNK - 1);
+        v >>= 5;
+        if (v)
+        {
+            chunk |= TRACK_VARINT_CHUNK;
+        }
+        out[n++] = (char)(chunk + TRACK_VARINT_BASE);
+    } while (v);
+    return n;
+}
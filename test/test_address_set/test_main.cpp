@@ -0,0 +1,90 @@
+/**
+ * @file test_main.cpp
+ * @brief AddressSet Tests
+ *
+ * @details Parses whitelists the way STRAP_ADDRESSES is written, malformed entries included, and
+ * checks that lookups return the position each address was added at, also when every address of a
+ * full set shares a vendor prefix and the slots have to be probed.
+ */
+
+#include "utils/addressSet.h"
+#include <unity.h>
+
+#define MAX_ADDRESSES 4 // ADDRESS_SET_MAX
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_address_is_parsed_in_either_case()
+{
+    uint64_t address;
+    TEST_ASSERT_TRUE(AddressSet::parseAddress("A0:9E:1A:12:34:ef", 17, address));
+    TEST_ASSERT_TRUE(address == 0xA09E1A1234EFull);
+    TEST_ASSERT_TRUE(AddressSet::parseAddress("a0-9e-1a-12-34-EF", 17, address));
+    TEST_ASSERT_TRUE(address == 0xA09E1A1234EFull);
+}
+
+static void test_malformed_addresses_are_rejected()
+{
+    uint64_t address;
+    TEST_ASSERT_FALSE(AddressSet::parseAddress("a0:9e:1a:12:34:e", 16, address));
+    TEST_ASSERT_FALSE(AddressSet::parseAddress("a0:9e:1a:12:34:eg", 17, address));
+    TEST_ASSERT_FALSE(AddressSet::parseAddress("a0:9e:1a.12:34:ef", 17, address));
+    TEST_ASSERT_FALSE(AddressSet::parseAddress("a0:9e:1a:12:34:ef0", 18, address));
+}
+
+static void test_list_skips_malformed_and_duplicate_entries()
+{
+    AddressSet set;
+    TEST_ASSERT_EQUAL_size_t(2,
+        set.parse(" a0:9e:1a:00:00:01, nonsense,,A0:9E:1A:00:00:01 ,a0:9e:1a:00:00:02"));
+    TEST_ASSERT_EQUAL_size_t(2, set.size());
+    TEST_ASSERT_EQUAL_INT(0, set.indexOf(0xA09E1A000001ull));
+    TEST_ASSERT_EQUAL_INT(1, set.indexOf(0xA09E1A000002ull));
+    TEST_ASSERT_TRUE(set.get(1) == 0xA09E1A000002ull);
+    TEST_ASSERT_TRUE(set.get(2) == 0);
+}
+
+static void test_empty_list_gives_an_empty_set()
+{
+    AddressSet set;
+    TEST_ASSERT_EQUAL_size_t(0, set.parse(""));
+    TEST_ASSERT_EQUAL_size_t(0, set.parse(nullptr));
+    TEST_ASSERT_EQUAL_INT(-1, set.indexOf(0));
+}
+
+static void test_full_set_keeps_every_index()
+{
+    AddressSet set;
+    for (uint64_t i = 0; i < MAX_ADDRESSES; i++)
+    {
+        TEST_ASSERT_TRUE(set.add(0xA09E1A000000ull + i));
+    }
+    TEST_ASSERT_FALSE(set.add(0xA09E1A0000FFull));
+    TEST_ASSERT_FALSE(set.add(0xA09E1A000000ull));
+
+    for (uint64_t i = 0; i < MAX_ADDRESSES; i++)
+    {
+        TEST_ASSERT_EQUAL_INT((int)i, set.indexOf(0xA09E1A000000ull + i));
+    }
+    for (uint64_t i = MAX_ADDRESSES; i < 1000; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(-1, set.indexOf(0xA09E1A000000ull + i));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_address_is_parsed_in_either_case);
+    RUN_TEST(test_malformed_addresses_are_rejected);
+    RUN_TEST(test_list_skips_malformed_and_duplicate_entries);
+    RUN_TEST(test_empty_list_gives_an_empty_set);
+    RUN_TEST(test_full_set_keeps_every_index);
+    return UNITY_END();
+}
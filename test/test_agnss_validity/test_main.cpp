@@ -0,0 +1,88 @@
+/**
+ * @file test_main.cpp
+ * @brief AgnssValidity Tests
+ *
+ * @details Checks when data fetched by the modem still counts: until it is AGNSS_VALIDITY_S old
+ * and only while the modem has not been powered up again, across a wrap of the millisecond clock.
+ * Also checks that failed fetches are spaced AGNSS_RETRY_MS apart.
+ */
+
+#include "network/agnssValidity.h"
+#include <unity.h>
+
+#define VALIDITY_MS 86400000UL // AGNSS_VALIDITY_S
+#define RETRY_MS 600000        // AGNSS_RETRY_MS
+#define BOOT 3
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_nothing_fetched_is_not_valid()
+{
+    AgnssValidity validity;
+    TEST_ASSERT_FALSE(validity.isValid(0, 0));
+    TEST_ASSERT_FALSE(validity.isValid(5000, BOOT));
+    TEST_ASSERT_EQUAL_UINT32(0, validity.getAgeS(5000, BOOT));
+    TEST_ASSERT_TRUE(validity.mayFetch(0));
+}
+
+static void test_data_expires_with_age()
+{
+    AgnssValidity validity;
+    validity.onAttempt(1000);
+    validity.onFetched(1000, BOOT);
+
+    TEST_ASSERT_TRUE(validity.isValid(1000, BOOT));
+    TEST_ASSERT_EQUAL_UINT32(3600, validity.getAgeS(1000 + 3600000, BOOT));
+    TEST_ASSERT_TRUE(validity.isValid(1000 + VALIDITY_MS - 1, BOOT));
+    TEST_ASSERT_FALSE(validity.isValid(1000 + VALIDITY_MS, BOOT));
+    TEST_ASSERT_EQUAL_UINT32(0, validity.getAgeS(1000 + VALIDITY_MS, BOOT));
+}
+
+static void test_modem_power_up_loses_the_data()
+{
+    AgnssValidity validity;
+    validity.onFetched(1000, BOOT);
+    TEST_ASSERT_FALSE(validity.isValid(2000, BOOT + 1));
+    TEST_ASSERT_EQUAL_UINT32(0, validity.getAgeS(2000, BOOT + 1));
+
+    // A fetch after the power-up counts again
+    validity.onFetched(3000, BOOT + 1);
+    TEST_ASSERT_TRUE(validity.isValid(4000, BOOT + 1));
+    TEST_ASSERT_FALSE(validity.isValid(4000, BOOT));
+}
+
+static void test_age_across_clock_wrap()
+{
+    AgnssValidity validity;
+    validity.onFetched(0xFFFFF000, BOOT);
+    uint32_t later = 0xFFFFF000 + 10000; // wrapped
+    TEST_ASSERT_TRUE(validity.isValid(later, BOOT));
+    TEST_ASSERT_EQUAL_UINT32(10, validity.getAgeS(later, BOOT));
+}
+
+static void test_failed_fetches_are_spaced()
+{
+    AgnssValidity validity;
+    validity.onAttempt(1000);
+    TEST_ASSERT_FALSE(validity.mayFetch(1000));
+    TEST_ASSERT_FALSE(validity.mayFetch(1000 + RETRY_MS - 1));
+    TEST_ASSERT_TRUE(validity.mayFetch(1000 + RETRY_MS));
+    TEST_ASSERT_FALSE(validity.isValid(1000 + RETRY_MS, BOOT));
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_nothing_fetched_is_not_valid);
+    RUN_TEST(test_data_expires_with_age);
+    RUN_TEST(test_modem_power_up_loses_the_data);
+    RUN_TEST(test_age_across_clock_wrap);
+    RUN_TEST(test_failed_fetches_are_spaced);
+    return UNITY_END();
+}
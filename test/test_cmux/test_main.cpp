@@ -0,0 +1,312 @@
+/**
+ * @file test_main.cpp
+ * @brief CMUX Codec and Demultiplexer Tests
+ *
+ * @details The codec cases round-trip frames of every length class and check a known SABM frame
+ * byte for byte. The demultiplexer cases feed it what a modem sends with three channels busy at
+ * once: responses split into 31 byte frames and interleaved across DLCIs, control frames in
+ * between and noise on the line. Each channel must get its own bytes in order. The flow control
+ * cases fill one channel until the demultiplexer pauses it, and check that the other channels go
+ * on and that it is resumed once its reader catches up. The reset case drops a session while a
+ * channel is paused, half read and has a frame half received, as when the modem reboots.
+ */
+
+#include "network/cmuxDemux.h"
+#include <cstring>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+#define MODEM_N1 31
+#define DATA_DLCI 1
+
+static CmuxDemux demux;
+static std::vector<std::vector<uint8_t>> replies;
+
+static std::vector<uint8_t> frame(uint8_t dlci, uint8_t control, bool command,
+    const uint8_t* info = NULL, size_t length = 0)
+{
+    std::vector<uint8_t> out(length + CMUX_FRAME_OVERHEAD);
+    size_t n = CmuxCodec::encode(dlci, control, command, info, length, out.data(), out.size());
+    TEST_ASSERT_GREATER_THAN(0, n);
+    out.resize(n);
+    return out;
+}
+
+static void feed(const std::vector<uint8_t>& bytes)
+{
+    uint8_t reply[CMUX_REPLY_SIZE];
+    for (uint8_t byte : bytes)
+    {
+        size_t n = demux.feed(byte, reply, sizeof(reply));
+        if (n > 0)
+        {
+            replies.push_back(std::vector<uint8_t>(reply, reply + n));
+        }
+    }
+}
+
+/**
+ * @brief Decode a reply the demultiplexer sent back to the modem
+ */
+static cmux_frame_t decodeReply(const std::vector<uint8_t>& bytes, CmuxCodec& codec)
+{
+    cmux_frame_t decoded = {};
+    bool complete = false;
+    for (uint8_t byte : bytes)
+    {
+        complete = codec.decode(byte, decoded) || complete;
+    }
+    TEST_ASSERT_TRUE(complete);
+    return decoded;
+}
+
+static std::string drain(uint8_t dlci, size_t limit = SIZE_MAX)
+{
+    std::string text;
+    uint8_t c;
+    while (text.size() < limit && demux.ring(dlci).get(&c))
+    {
+        text += (char)c;
+    }
+    return text;
+}
+
+/**
+ * @brief A response as the modem sends it, in frames of at most N1 bytes
+ */
+static std::vector<std::vector<uint8_t>> response(uint8_t dlci, const std::string& text)
+{
+    std::vector<std::vector<uint8_t>> frames;
+    for (size_t i = 0; i < text.size(); i += MODEM_N1)
+    {
+        size_t n = text.size() - i < MODEM_N1 ? text.size() - i : MODEM_N1;
+        frames.push_back(frame(dlci, CMUX_UIH, false, (const uint8_t*)text.data() + i, n));
+    }
+    return frames;
+}
+
+void setUp()
+{
+    demux.reset();
+    replies.clear();
+}
+
+void tearDown()
+{
+}
+
+static void test_codec_round_trips_every_length_class()
+{
+    uint8_t data[CMUX_MAX_INFO];
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (uint8_t)i;
+    }
+
+    const size_t lengths[] = {0, 1, 31, 127, 128, CMUX_MAX_INFO};
+    for (size_t length : lengths)
+    {
+        std::vector<uint8_t> bytes = frame(5, CMUX_UIH, true, data, length);
+        CmuxCodec codec;
+        cmux_frame_t decoded = decodeReply(bytes, codec);
+
+        TEST_ASSERT_EQUAL_UINT8(5, decoded.dlci);
+        TEST_ASSERT_EQUAL_UINT8(CMUX_UIH, decoded.control);
+        TEST_ASSERT_TRUE(decoded.command);
+        TEST_ASSERT_EQUAL_size_t(length, decoded.length);
+        TEST_ASSERT_EQUAL_MEMORY(data, decoded.info, length);
+    }
+}
+
+static void test_codec_known_frame_and_corruption()
+{
+    // SABM with P on DLCI 0, as every 27.010 trace starts
+    const uint8_t sabm[] = {0xF9, 0x03, 0x3F, 0x01, 0x1C, 0xF9};
+    std::vector<uint8_t> bytes = frame(0, CMUX_SABM | CMUX_PF, true);
+    TEST_ASSERT_EQUAL_size_t(sizeof(sabm), bytes.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(sabm, bytes.data(), sizeof(sabm));
+
+    bytes[2] ^= 0x40;
+    CmuxCodec codec;
+    cmux_frame_t decoded;
+    for (uint8_t byte : bytes)
+    {
+        TEST_ASSERT_FALSE(codec.decode(byte, decoded));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, codec.getFcsErrors());
+}
+
+static void test_interleaved_channels_keep_their_order()
+{
+    std::string texts[CMUX_CHANNELS];
+    std::vector<std::vector<uint8_t>> perChannel[CMUX_CHANNELS];
+    for (uint8_t dlci = 1; dlci < CMUX_CHANNELS; dlci++)
+    {
+        texts[dlci] = "\r\n+R" + std::to_string(dlci) + ": " +
+            std::string(150, (char)('A' + dlci)) + std::to_string(dlci * 1000) + "\r\n\r\nOK\r\n";
+        perChannel[dlci] = response(dlci, texts[dlci]);
+    }
+
+    // Round robin over the channels, with an MSC response and line noise mixed in
+    std::vector<uint8_t> line = {'x', 'y', CMUX_FLAG, CMUX_FLAG};
+    const uint8_t mscResponse[] = {CMUX_MSG_MSC, 0x05, (1 << 2) | CMUX_CR | CMUX_EA, 0x8D};
+    for (size_t i = 0; i < 10; i++)
+    {
+        for (uint8_t dlci = 1; dlci < CMUX_CHANNELS; dlci++)
+        {
+            if (i < perChannel[dlci].size())
+            {
+                line.insert(line.end(), perChannel[dlci][i].begin(), perChannel[dlci][i].end());
+            }
+        }
+        if (i == 2)
+        {
+            std::vector<uint8_t> msc = frame(0, CMUX_UIH, false, mscResponse, sizeof(mscResponse));
+            line.insert(line.end(), msc.begin(), msc.end());
+        }
+    }
+    feed(line);
+
+    for (uint8_t dlci = 1; dlci < CMUX_CHANNELS; dlci++)
+    {
+        TEST_ASSERT_EQUAL_STRING(texts[dlci].c_str(), drain(dlci).c_str());
+    }
+    TEST_ASSERT_EQUAL_size_t(0, replies.size());
+    TEST_ASSERT_EQUAL_UINT32(0, demux.getRxOverflows());
+}
+
+static void test_channel_open_and_refusal()
+{
+    feed(frame(1, CMUX_UA | CMUX_PF, true));
+    feed(frame(2, CMUX_DM | CMUX_PF, true));
+
+    TEST_ASSERT_TRUE(demux.isOpened(1));
+    TEST_ASSERT_FALSE(demux.isOpened(2));
+    TEST_ASSERT_TRUE(demux.isRefused(2));
+}
+
+static void test_modem_msc_is_echoed_as_response()
+{
+    const uint8_t command[] = {CMUX_MSG_MSC | CMUX_CR, 0x05, (2 << 2) | CMUX_CR | CMUX_EA, 0x8D};
+    feed(frame(0, CMUX_UIH, true, command, sizeof(command)));
+
+    TEST_ASSERT_EQUAL_size_t(1, replies.size());
+    CmuxCodec codec;
+    cmux_frame_t reply = decodeReply(replies[0], codec);
+    TEST_ASSERT_EQUAL_UINT8(0, reply.dlci);
+    TEST_ASSERT_EQUAL_size_t(sizeof(command), reply.length);
+    TEST_ASSERT_EQUAL_UINT8(CMUX_MSG_MSC, reply.info[0]);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(command + 1, reply.info + 1, sizeof(command) - 1);
+}
+
+static void test_disconnect_is_acknowledged()
+{
+    feed(frame(0, CMUX_DISC | CMUX_PF, true));
+
+    TEST_ASSERT_TRUE(demux.isClosed());
+    TEST_ASSERT_EQUAL_size_t(1, replies.size());
+    CmuxCodec codec;
+    cmux_frame_t reply = decodeReply(replies[0], codec);
+    TEST_ASSERT_EQUAL_UINT8(CMUX_UA, reply.control);
+    TEST_ASSERT_TRUE(reply.pf);
+}
+
+static void test_full_channel_is_paused_and_resumed()
+{
+    std::string bulk(CMUX_CHANNEL_RX_BUFFER, 'd');
+    std::vector<std::vector<uint8_t>> frames = response(DATA_DLCI, bulk);
+
+    // Fill the data channel until the modem is asked to pause it
+    size_t sent = 0;
+    while (sent < frames.size() && replies.empty())
+    {
+        feed(frames[sent++]);
+    }
+    TEST_ASSERT_TRUE(demux.isStopped(DATA_DLCI));
+    TEST_ASSERT_EQUAL_UINT32(1, demux.getFlowStops());
+    TEST_ASSERT_LESS_THAN(CMUX_FLOW_STOP_FREE, demux.ring(DATA_DLCI).free());
+
+    CmuxCodec codec;
+    cmux_frame_t stop = decodeReply(replies[0], codec);
+    TEST_ASSERT_EQUAL_UINT8(0, stop.dlci);
+    TEST_ASSERT_EQUAL_UINT8(CMUX_MSG_MSC | CMUX_CR, stop.info[0]);
+    TEST_ASSERT_EQUAL_UINT8(DATA_DLCI, stop.info[2] >> 2);
+    TEST_ASSERT_TRUE(stop.info[3] & 0x02);
+
+    // Frames already in flight still arrive, another channel is not held up
+    feed(frames[sent++]);
+    feed(response(2, "\r\nOK\r\n")[0]);
+    TEST_ASSERT_EQUAL_STRING("\r\nOK\r\n", drain(2).c_str());
+    TEST_ASSERT_EQUAL_size_t(1, replies.size());
+    TEST_ASSERT_EQUAL_UINT32(0, demux.getRxOverflows());
+
+    // A little reading is not enough to resume
+    uint8_t reply[CMUX_REPLY_SIZE];
+    drain(DATA_DLCI, 64);
+    TEST_ASSERT_EQUAL_size_t(0, demux.release(DATA_DLCI, reply, sizeof(reply)));
+
+    drain(DATA_DLCI, CMUX_CHANNEL_RX_BUFFER / 2);
+    size_t n = demux.release(DATA_DLCI, reply, sizeof(reply));
+    TEST_ASSERT_GREATER_THAN(0, n);
+    TEST_ASSERT_FALSE(demux.isStopped(DATA_DLCI));
+    cmux_frame_t go = decodeReply(std::vector<uint8_t>(reply, reply + n), codec);
+    TEST_ASSERT_FALSE(go.info[3] & 0x02);
+}
+
+static void test_overflow_is_counted_when_the_modem_ignores_the_pause()
+{
+    std::string bulk(CMUX_CHANNEL_RX_BUFFER + 200, 'd');
+    for (const std::vector<uint8_t>& f : response(DATA_DLCI, bulk))
+    {
+        feed(f);
+    }
+
+    TEST_ASSERT_EQUAL_size_t(1, replies.size());
+    TEST_ASSERT_GREATER_THAN(0, demux.getRxOverflows());
+    TEST_ASSERT_EQUAL_size_t(CMUX_CHANNEL_RX_BUFFER, drain(DATA_DLCI).size());
+}
+
+static void test_reset_mid_read_starts_clean()
+{
+    std::vector<std::vector<uint8_t>> frames = response(DATA_DLCI, std::string(1500, 'd'));
+    for (const std::vector<uint8_t>& f : frames)
+    {
+        feed(f);
+    }
+    TEST_ASSERT_TRUE(demux.isStopped(DATA_DLCI));
+    drain(DATA_DLCI, 100);
+    std::vector<uint8_t> half = response(2, "\r\n+CGNSSINFO: 1,2,3\r\n")[0];
+    half.resize(half.size() / 2);
+    feed(half);
+
+    uint32_t flowStops = demux.getFlowStops();
+    demux.reset();
+    TEST_ASSERT_EQUAL_INT(0, demux.ring(DATA_DLCI).size());
+    TEST_ASSERT_FALSE(demux.isStopped(DATA_DLCI));
+    TEST_ASSERT_FALSE(demux.isOpened(DATA_DLCI));
+    TEST_ASSERT_EQUAL_UINT32(flowStops, demux.getFlowStops());
+
+    // The reader finds nothing to resume, the half frame is not completed by the next session
+    uint8_t reply[CMUX_REPLY_SIZE];
+    TEST_ASSERT_EQUAL_size_t(0, demux.release(DATA_DLCI, reply, sizeof(reply)));
+    feed(response(2, "\r\nOK\r\n")[0]);
+    feed(response(DATA_DLCI, "\r\nOK\r\n")[0]);
+    TEST_ASSERT_EQUAL_STRING("\r\nOK\r\n", drain(2).c_str());
+    TEST_ASSERT_EQUAL_STRING("\r\nOK\r\n", drain(DATA_DLCI).c_str());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_codec_round_trips_every_length_class);
+    RUN_TEST(test_codec_known_frame_and_corruption);
+    RUN_TEST(test_interleaved_channels_keep_their_order);
+    RUN_TEST(test_channel_open_and_refusal);
+    RUN_TEST(test_modem_msc_is_echoed_as_response);
+    RUN_TEST(test_disconnect_is_acknowledged);
+    RUN_TEST(test_full_channel_is_paused_and_resumed);
+    RUN_TEST(test_overflow_is_counted_when_the_modem_ignores_the_pause);
+    RUN_TEST(test_reset_mid_read_starts_clean);
+    return UNITY_END();
+}
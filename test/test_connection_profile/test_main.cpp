@@ -0,0 +1,99 @@
+/**
+ * @file test_main.cpp
+ * @brief ConnectionProfile Tests
+ *
+ * @details Checks that every profile's supervision timeout leaves room for its slave latency, and
+ * integrates the radio-on time of a link through setup, an hour of streaming at the interval the
+ * strap negotiated, a bulk transfer and a disconnect.
+ */
+
+#include "sensors/connectionProfile.h"
+#include <cstdio>
+#include <unity.h>
+
+#define EVENT_US 500 // BT_CONN_EVENT_US
+#define HOUR_MS 3600000u
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_timeouts_allow_for_latency()
+{
+    for (int p = BLE_PROFILE_SETUP; p <= BLE_PROFILE_BULK; p++)
+    {
+        const ble_conn_params_t& params = ConnectionProfile::params((ble_profile_t)p);
+        TEST_ASSERT_TRUE(params.minInterval <= params.maxInterval);
+        // timeout in 10 ms, interval in 1.25 ms
+        uint32_t requiredUs = 2u * (1 + params.latency) * params.maxInterval * 1250;
+        TEST_ASSERT_GREATER_THAN_UINT32(requiredUs, (uint32_t)params.timeout * 10000);
+    }
+    TEST_ASSERT_EQUAL_UINT8(BLE_PHY_2M_MASK, ConnectionProfile::params(BLE_PROFILE_BULK).phyMask);
+    TEST_ASSERT_EQUAL_UINT8(BLE_PHY_1M_MASK,
+        ConnectionProfile::params(BLE_PROFILE_STREAMING).phyMask);
+}
+
+static void test_streaming_hour_at_the_negotiated_interval()
+{
+    ConnectionProfile link;
+    link.set(BLE_PROFILE_STREAMING, 0);
+
+    // 500 ms until the strap settles on 400 ms
+    TEST_ASSERT_EQUAL_UINT32(60 * EVENT_US / 1000, link.getRadioOnMs(30000));
+    link.onNegotiated(320, 30000);
+    uint32_t onMs = link.getRadioOnMs(30000 + HOUR_MS);
+    TEST_ASSERT_EQUAL_UINT32((60 + 9000) * EVENT_US / 1000, onMs);
+
+    char line[80];
+    snprintf(line, sizeof(line), "streaming hour: radio on %lu ms", (unsigned long)onMs);
+    TEST_MESSAGE(line);
+}
+
+static void test_setup_costs_more_than_streaming()
+{
+    ConnectionProfile setup, streaming;
+    setup.set(BLE_PROFILE_SETUP, 0);
+    streaming.set(BLE_PROFILE_STREAMING, 0);
+
+    // 30 ms against 500 ms intervals
+    TEST_ASSERT_EQUAL_UINT32(2000 / 30 * EVENT_US / 1000, setup.getRadioOnMs(2000));
+    TEST_ASSERT_EQUAL_UINT32(4 * EVENT_US / 1000, streaming.getRadioOnMs(2000));
+}
+
+static void test_bulk_transfer_keeps_the_radio_on()
+{
+    ConnectionProfile link;
+    link.set(BLE_PROFILE_STREAMING, 0);
+    link.set(BLE_PROFILE_BULK, 10000);
+    link.set(BLE_PROFILE_STREAMING, 15000);
+
+    TEST_ASSERT_EQUAL_INT(BLE_PROFILE_STREAMING, link.get());
+    TEST_ASSERT_EQUAL_UINT32(20 * EVENT_US / 1000 + 5000, link.getRadioOnMs(15000));
+}
+
+static void test_disconnected_link_stops_counting()
+{
+    ConnectionProfile link;
+    link.set(BLE_PROFILE_STREAMING, 0);
+    link.set(BLE_PROFILE_NONE, 10000);
+    link.onNegotiated(6, 20000);
+
+    uint32_t onMs = link.getRadioOnMs(10000);
+    TEST_ASSERT_EQUAL_UINT32(onMs, link.getRadioOnMs(HOUR_MS));
+    TEST_ASSERT_EQUAL_INT(BLE_PROFILE_NONE, link.get());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_timeouts_allow_for_latency);
+    RUN_TEST(test_streaming_hour_at_the_negotiated_interval);
+    RUN_TEST(test_setup_costs_more_than_streaming);
+    RUN_TEST(test_bulk_transfer_keeps_the_radio_on);
+    RUN_TEST(test_disconnected_link_stops_counting);
+    return UNITY_END();
+}
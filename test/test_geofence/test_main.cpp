@@ -0,0 +1,151 @@
+/**
+ * @file test_main.cpp
+ * @brief GeofenceSet Tests
+ *
+ * @details Checks the integer ray cast against a square and a concave polygon, and the transition
+ * logic: no event for the first fix, an event only after GEOFENCE_CONFIRM_FIXES fixes in a row,
+ * no flapping on an edge, and two fences changing side on the same fix reported one call apart.
+ */
+
+#include "utils/geofence.h"
+#include "utils/track.h"
+#include <unity.h>
+
+#define CONFIRM_FIXES 2 // GEOFENCE_CONFIRM_FIXES
+
+static const geofence_t SQUARE = {"square", 4,
+    {{59.9130f, 10.7500f}, {59.9130f, 10.7530f}, {59.9115f, 10.7530f}, {59.9115f, 10.7500f}}};
+
+// A U open to the north, the notch between the arms is outside
+static const geofence_t HORSESHOE = {"horseshoe", 8,
+    {{59.9200f, 10.7600f}, {59.9200f, 10.7610f}, {59.9170f, 10.7610f}, {59.9170f, 10.7620f},
+        {59.9200f, 10.7620f}, {59.9200f, 10.7630f}, {59.9160f, 10.7630f},
+        {59.9160f, 10.7600f}}};
+
+static bool update(GeofenceSet& set, float latitude, float longitude, geofence_event_t& event)
+{
+    return set.update(TrackBuffer::toFixed(latitude), TrackBuffer::toFixed(longitude), event);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_rejects_invalid_fences()
+{
+    GeofenceSet set;
+    geofence_t line = {"line", 2, {{59.91f, 10.75f}, {59.92f, 10.76f}}};
+
+    TEST_ASSERT_FALSE(set.add(line));
+    for (int i = 0; i < GEOFENCE_MAX_FENCES; i++)
+    {
+        TEST_ASSERT_TRUE(set.add(SQUARE));
+    }
+    TEST_ASSERT_FALSE(set.add(SQUARE));
+    TEST_ASSERT_EQUAL_size_t(GEOFENCE_MAX_FENCES, set.size());
+}
+
+static void test_contains_square_and_concave_polygon()
+{
+    GeofenceSet set;
+    set.add(SQUARE);
+    set.add(HORSESHOE);
+    geofence_event_t event;
+
+    update(set, 59.9125f, 10.7515f, event);
+    TEST_ASSERT_TRUE(set.isInside(0));
+    TEST_ASSERT_FALSE(set.isInside(1));
+
+    GeofenceSet arms;
+    arms.add(HORSESHOE);
+    update(arms, 59.9190f, 10.7605f, event); // west arm
+    TEST_ASSERT_TRUE(arms.isInside(0));
+
+    GeofenceSet notch;
+    notch.add(HORSESHOE);
+    update(notch, 59.9190f, 10.7615f, event); // between the arms
+    TEST_ASSERT_FALSE(notch.isInside(0));
+
+    GeofenceSet base;
+    base.add(HORSESHOE);
+    update(base, 59.9165f, 10.7615f, event); // below the notch
+    TEST_ASSERT_TRUE(base.isInside(0));
+}
+
+static void test_first_fix_is_not_a_transition()
+{
+    GeofenceSet set;
+    set.add(SQUARE);
+    geofence_event_t event;
+
+    TEST_ASSERT_FALSE(update(set, 59.9125f, 10.7515f, event));
+    TEST_ASSERT_TRUE(set.isInside(0));
+}
+
+static void test_transition_needs_confirmation()
+{
+    GeofenceSet set;
+    set.add(SQUARE);
+    geofence_event_t event;
+    update(set, 59.9140f, 10.7515f, event);
+
+    for (int i = 1; i < CONFIRM_FIXES; i++)
+    {
+        TEST_ASSERT_FALSE(update(set, 59.9125f, 10.7515f, event));
+    }
+    TEST_ASSERT_TRUE(update(set, 59.9125f, 10.7515f, event));
+    TEST_ASSERT_EQUAL_UINT8(0, event.fence);
+    TEST_ASSERT_EQUAL_STRING("square", event.name);
+    TEST_ASSERT_TRUE(event.inside);
+    TEST_ASSERT_FALSE(update(set, 59.9125f, 10.7515f, event));
+}
+
+static void test_jitter_on_the_edge_does_not_flap()
+{
+    GeofenceSet set;
+    set.add(SQUARE);
+    geofence_event_t event;
+    update(set, 59.91305f, 10.7515f, event);
+
+    for (int i = 0; i < 50; i++)
+    {
+        float latitude = i % 2 ? 59.91305f : 59.91295f; // +-5 m across the north edge
+        TEST_ASSERT_FALSE(update(set, latitude, 10.7515f, event));
+    }
+    TEST_ASSERT_FALSE(set.isInside(0));
+}
+
+static void test_simultaneous_transitions_are_reported_in_turn()
+{
+    GeofenceSet set;
+    set.add(SQUARE);
+    set.add(SQUARE);
+    geofence_event_t event;
+    update(set, 59.9140f, 10.7515f, event);
+    for (int i = 1; i < CONFIRM_FIXES; i++)
+    {
+        update(set, 59.9125f, 10.7515f, event);
+    }
+
+    TEST_ASSERT_TRUE(update(set, 59.9125f, 10.7515f, event));
+    TEST_ASSERT_EQUAL_UINT8(0, event.fence);
+    TEST_ASSERT_TRUE(update(set, 59.9125f, 10.7515f, event));
+    TEST_ASSERT_EQUAL_UINT8(1, event.fence);
+    TEST_ASSERT_FALSE(update(set, 59.9125f, 10.7515f, event));
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rejects_invalid_fences);
+    RUN_TEST(test_contains_square_and_concave_polygon);
+    RUN_TEST(test_first_fix_is_not_a_transition);
+    RUN_TEST(test_transition_needs_confirmation);
+    RUN_TEST(test_jitter_on_the_edge_does_not_flap);
+    RUN_TEST(test_simultaneous_transitions_are_reported_in_turn);
+    return UNITY_END();
+}
@@ -0,0 +1,196 @@
+/**
+ * @file test_main.cpp
+ * @brief GnssScheduler Tests
+ *
+ * @details Drives the scheduler with a fake clock the way the GPS task does: the engine is started
+ * and stopped whenever wantEngineOn() changes, and a fix is reported whenever one is due and the
+ * sky is visible. Covers coming to rest, heartbeat starts with and without sky view, and the fix
+ * interval at speed and on a low battery.
+ */
+
+#include "network/gnssScheduler.h"
+#include <cstdio>
+#include <unity.h>
+
+#define STEP_MS 1000
+#define MOVING_INTERVAL_MS 30000  // GNSS_MOVING_INTERVAL_MS
+#define FAST_INTERVAL_MS 5000     // GNSS_FAST_INTERVAL_MS
+#define ACQUIRE_TIMEOUT_MS 120000 // GNSS_ACQUIRE_TIMEOUT_MS
+#define HEARTBEAT_MS 1800000      // GNSS_HEARTBEAT_MS
+#define TIME_TO_FIX_MS 4000       // hot start
+
+/**
+ * @brief The GPS task loop against a fake clock
+ */
+struct GpsTask
+{
+    GnssScheduler scheduler;
+    uint32_t now = 1000;
+    bool engineOn = false;
+    uint32_t engineStarted = 0;
+    uint32_t engineStops = 0;
+
+    GpsTask()
+    {
+        scheduler.onEngineOn(now);
+        engineOn = true;
+        engineStarted = now;
+    }
+
+    /**
+     * @param sky A fix comes TIME_TO_FIX_MS after each engine start
+     */
+    void run(uint32_t durationMs, bool sky, float speedKnots = 0)
+    {
+        for (uint32_t end = now + durationMs; now < end; now += STEP_MS)
+        {
+            bool wanted = scheduler.wantEngineOn(now);
+            if (wanted != engineOn)
+            {
+                engineOn = wanted;
+                if (engineOn)
+                {
+                    scheduler.onEngineOn(now);
+                    engineStarted = now;
+                }
+                else
+                {
+                    scheduler.onEngineOff(now);
+                    engineStops++;
+                }
+            }
+            if (engineOn && sky && now - engineStarted >= TIME_TO_FIX_MS &&
+                scheduler.fixDue(now))
+            {
+                scheduler.onFix(speedKnots, now);
+            }
+        }
+    }
+};
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_engine_stops_after_the_resting_fix()
+{
+    GpsTask task;
+    task.run(60000, true, 2);
+    task.scheduler.setMotion(false, task.now);
+    TEST_ASSERT_TRUE(task.scheduler.fixDue(task.now));
+
+    // The fix, then the stop on the next step
+    task.run(STEP_MS * 2, true);
+    TEST_ASSERT_FALSE(task.engineOn);
+    TEST_ASSERT_EQUAL_UINT32(0, task.scheduler.getStats(task.now).timeouts);
+}
+
+static void test_heartbeat_runs_until_its_own_fix()
+{
+    GpsTask task;
+    task.run(60000, true, 2);
+    task.scheduler.setMotion(false, task.now);
+    task.run(STEP_MS * 2, true);
+    uint32_t fixes = task.scheduler.getStats(task.now).fixes;
+
+    // Stopped one step ago
+    task.run(HEARTBEAT_MS - STEP_MS * 2, true);
+    TEST_ASSERT_FALSE(task.engineOn);
+
+    // The fix that ended the last run must not stop the heartbeat run at once
+    task.run(STEP_MS * 2, false);
+    TEST_ASSERT_TRUE(task.engineOn);
+    task.run(TIME_TO_FIX_MS, false);
+    TEST_ASSERT_TRUE(task.engineOn);
+    TEST_ASSERT_TRUE(task.scheduler.fixDue(task.now));
+
+    task.run(STEP_MS * 2, true);
+    TEST_ASSERT_FALSE(task.engineOn);
+    gnss_schedule_stats_t stats = task.scheduler.getStats(task.now);
+    TEST_ASSERT_EQUAL_UINT32(fixes + 1, stats.fixes);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.acquisitions);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.timeouts);
+}
+
+static void test_heartbeat_without_sky_times_out()
+{
+    GpsTask task;
+    task.run(60000, true, 2);
+    task.scheduler.setMotion(false, task.now);
+    task.run(STEP_MS * 2, true);
+    task.run(HEARTBEAT_MS, false);
+    TEST_ASSERT_TRUE(task.engineOn);
+
+    task.run(ACQUIRE_TIMEOUT_MS, false);
+    TEST_ASSERT_FALSE(task.engineOn);
+    TEST_ASSERT_EQUAL_UINT32(1, task.scheduler.getStats(task.now).timeouts);
+}
+
+static void test_a_day_at_rest_takes_one_fix_per_heartbeat()
+{
+    GpsTask task;
+    task.run(60000, true, 2);
+    task.scheduler.setMotion(false, task.now);
+    uint32_t restStart = task.now;
+    uint32_t fixes = task.scheduler.getStats(task.now).fixes;
+
+    task.run(24 * 3600000u, true);
+    gnss_schedule_stats_t stats = task.scheduler.getStats(task.now);
+    uint32_t heartbeats = stats.acquisitions - 1;
+
+    char line[128];
+    snprintf(line, sizeof(line), "24 h at rest: %lu heartbeats, engine on %lu s, %lu mJ",
+        (unsigned long)heartbeats, (unsigned long)(stats.onTimeMs / 1000),
+        (unsigned long)stats.energyMj);
+    TEST_MESSAGE(line);
+
+    uint32_t cycle = HEARTBEAT_MS + TIME_TO_FIX_MS;
+    TEST_ASSERT_EQUAL_UINT32((task.now - restStart) / cycle, heartbeats);
+    TEST_ASSERT_EQUAL_UINT32(fixes + 1 + heartbeats, stats.fixes);
+    TEST_ASSERT_EQUAL_UINT32(heartbeats, task.engineStops - 1);
+}
+
+static void test_motion_restarts_the_engine()
+{
+    GpsTask task;
+    task.scheduler.setMotion(false, task.now);
+    task.run(10000, true);
+    TEST_ASSERT_FALSE(task.engineOn);
+
+    task.scheduler.setMotion(true, task.now);
+    task.run(STEP_MS, true);
+    TEST_ASSERT_TRUE(task.engineOn);
+}
+
+static void test_interval_follows_speed_and_battery()
+{
+    GpsTask task;
+    task.run(60000, true, 2);
+    TEST_ASSERT_EQUAL_UINT32(MOVING_INTERVAL_MS, task.scheduler.fixInterval());
+
+    task.run(60000, true, 20);
+    TEST_ASSERT_EQUAL_UINT32(FAST_INTERVAL_MS, task.scheduler.fixInterval());
+
+    task.scheduler.setBatteryPercent(40);
+    TEST_ASSERT_EQUAL_UINT32(FAST_INTERVAL_MS * 2, task.scheduler.fixInterval());
+    task.scheduler.setBatteryPercent(10);
+    TEST_ASSERT_EQUAL_UINT32(FAST_INTERVAL_MS * 4, task.scheduler.fixInterval());
+    task.scheduler.setBatteryPercent(-5);
+    TEST_ASSERT_EQUAL_UINT32(FAST_INTERVAL_MS, task.scheduler.fixInterval());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_engine_stops_after_the_resting_fix);
+    RUN_TEST(test_heartbeat_runs_until_its_own_fix);
+    RUN_TEST(test_heartbeat_without_sky_times_out);
+    RUN_TEST(test_a_day_at_rest_takes_one_fix_per_heartbeat);
+    RUN_TEST(test_motion_restarts_the_engine);
+    RUN_TEST(test_interval_follows_speed_and_battery);
+    return UNITY_END();
+}
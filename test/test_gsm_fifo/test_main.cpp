@@ -0,0 +1,371 @@
+/**
+ * @file test_main.cpp
+ * @brief TinyGsmFifo Tests and Benchmark
+ *
+ * @details The stress cases run a producer and a consumer thread on one ring, the way the UART
+ * reader and a CMUX channel's reader share it, and check that a counting sequence arrives complete
+ * and in order through the single-element and the bulk API. The benchmarks compare the ring with
+ * the modulo-indexed fifo it replaced on one thread, since the old one was not safe across two,
+ * and measure the ring alone between two threads.
+ */
+
+#include <thread>
+#define TINY_GSM_FIFO_YIELD() std::this_thread::yield()
+
+#include "TinyGsmFifo.h"
+#include <chrono>
+#include <cstdio>
+#include <unity.h>
+
+#define STRESS_ELEMENTS 5000000u
+#define BENCH_BYTES 50000000u
+#define UART_BURST 64 // bytes the reader finds per wake-up
+
+/**
+ * @brief The fifo before the SPSC rewrite, kept for the benchmark
+ */
+template <class T, unsigned N>
+class LegacyFifo
+{
+public:
+    LegacyFifo() : _w(0), _r(0)
+    {
+    }
+
+    int free()
+    {
+        int s = _r - _w;
+        if (s <= 0)
+            s += N;
+        return s - 1;
+    }
+
+    size_t size()
+    {
+        int s = _w - _r;
+        if (s < 0)
+            s += N;
+        return s;
+    }
+
+    bool put(const T& c)
+    {
+        int i = _inc(_w);
+        if (i == _r)
+            return false;
+        _b[_w] = c;
+        _w = i;
+        return true;
+    }
+
+    bool get(T* p)
+    {
+        if (_r == _w)
+            return false;
+        *p = _b[_r];
+        _r = _inc(_r);
+        return true;
+    }
+
+    int put(const T* p, int n)
+    {
+        int c = n;
+        while (c)
+        {
+            int f = free();
+            if (f == 0)
+                break;
+            if (c < f) f = c;
+            int m = N - _w;
+            if (f > m) f = m;
+            memcpy(&_b[_w], p, f);
+            _w = _inc(_w, f);
+            c -= f;
+            p += f;
+        }
+        return n - c;
+    }
+
+    int get(T* p, int n)
+    {
+        int c = n;
+        while (c)
+        {
+            int f = size();
+            if (f == 0)
+                break;
+            if (c < f) f = c;
+            int m = N - _r;
+            if (f > m) f = m;
+            memcpy(p, &_b[_r], f);
+            _r = _inc(_r, f);
+            c -= f;
+            p += f;
+        }
+        return n - c;
+    }
+
+private:
+    int _inc(int i, int n = 1)
+    {
+        return (i + n) % N;
+    }
+
+    T _b[N];
+    int _w;
+    int _r;
+};
+
+static TinyGsmFifo<uint32_t, 1024> shared;
+
+void setUp()
+{
+    shared.clear();
+}
+
+void tearDown()
+{
+}
+
+static void test_capacity_rounds_up_to_a_power_of_two()
+{
+    TEST_ASSERT_EQUAL_size_t(64, (TinyGsmFifo<uint8_t, 64>::CAPACITY));
+    TEST_ASSERT_EQUAL_size_t(128, (TinyGsmFifo<uint8_t, 100>::CAPACITY));
+}
+
+static void test_every_slot_is_usable()
+{
+    TinyGsmFifo<uint8_t, 8> fifo;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        TEST_ASSERT_TRUE(fifo.put(i));
+    }
+    TEST_ASSERT_FALSE(fifo.put(8));
+    TEST_ASSERT_EQUAL_INT(0, fifo.free());
+    TEST_ASSERT_EQUAL_size_t(8, fifo.size());
+
+    uint8_t first;
+    TEST_ASSERT_TRUE(fifo.get(&first));
+    TEST_ASSERT_EQUAL_UINT8(0, first);
+    TEST_ASSERT_TRUE(fifo.put(8));
+}
+
+static void test_bulk_read_and_peek_wrap()
+{
+    TinyGsmFifo<uint8_t, 8> fifo;
+    const uint8_t data[] = {1, 2, 3, 4, 5, 6};
+    uint8_t out[8];
+
+    TEST_ASSERT_EQUAL_size_t(6, fifo.write(data, 6));
+    TEST_ASSERT_EQUAL_size_t(5, fifo.read(out, 5));
+    // Write position is at 6, this wraps past the end of the storage
+    TEST_ASSERT_EQUAL_size_t(6, fifo.write(data, 6));
+    TEST_ASSERT_EQUAL_size_t(7, fifo.peek(out, 8));
+    TEST_ASSERT_EQUAL_size_t(7, fifo.read(out, 8));
+
+    const uint8_t expected[] = {6, 1, 2, 3, 4, 5, 6};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out, 7);
+    TEST_ASSERT_FALSE(fifo.readable());
+}
+
+static void test_span_is_contiguous_up_to_the_end()
+{
+    TinyGsmFifo<uint8_t, 8> fifo;
+    uint8_t scratch[5];
+    fifo.write(scratch, 5);
+    fifo.read(scratch, 5);
+
+    uint8_t* span;
+    TEST_ASSERT_EQUAL_size_t(3, fifo.writeSpan(&span));
+    fifo.commit(3);
+    const uint8_t* readSpan;
+    TEST_ASSERT_EQUAL_size_t(3, fifo.readSpan(&readSpan));
+}
+
+static void test_stress_single_elements()
+{
+    bool ordered = true;
+    std::thread producer([] {
+        uint32_t next = 0;
+        while (next < STRESS_ELEMENTS)
+        {
+            if (shared.put(next))
+            {
+                next++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::thread consumer([&ordered] {
+        uint32_t expected = 0;
+        while (expected < STRESS_ELEMENTS)
+        {
+            uint32_t value;
+            if (!shared.get(&value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            ordered = ordered && value == expected;
+            expected++;
+        }
+    });
+    producer.join();
+    consumer.join();
+
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_FALSE(shared.readable());
+}
+
+static void test_stress_bulk()
+{
+    bool ordered = true;
+    // Odd chunk sizes, so the spans split at every possible offset
+    std::thread producer([] {
+        uint32_t chunk[97];
+        uint32_t next = 0;
+        while (next < STRESS_ELEMENTS)
+        {
+            uint32_t n = STRESS_ELEMENTS - next < 97 ? STRESS_ELEMENTS - next : 97;
+            for (uint32_t i = 0; i < n; i++)
+            {
+                chunk[i] = next + i;
+            }
+            next += shared.put(chunk, (int)n, true);
+        }
+    });
+    std::thread consumer([&ordered] {
+        uint32_t chunk[131];
+        uint32_t expected = 0;
+        while (expected < STRESS_ELEMENTS)
+        {
+            int n = shared.get(chunk, 131, false);
+            for (int i = 0; i < n; i++)
+            {
+                ordered = ordered && chunk[i] == expected;
+                expected++;
+            }
+            if (n == 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    producer.join();
+    consumer.join();
+
+    TEST_ASSERT_TRUE(ordered);
+}
+
+/**
+ * @brief Move BENCH_BYTES through a fifo in UART bursts, drained by the client's bulk get()
+ *
+ * @param perByte Fill with one put() per byte, as the socket reads did before the span API
+ * @return Throughput in MB/s
+ */
+template <class Fifo>
+static double benchmarkBursts(Fifo& fifo, bool perByte)
+{
+    uint8_t burst[UART_BURST];
+    uint8_t out[UART_BURST];
+    for (int i = 0; i < UART_BURST; i++)
+    {
+        burst[i] = (uint8_t)(i + 1);
+    }
+    uint32_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t done = 0; done < BENCH_BYTES; done += UART_BURST)
+    {
+        if (perByte)
+        {
+            for (int i = 0; i < UART_BURST; i++)
+            {
+                fifo.put(burst[i]);
+            }
+        }
+        else
+        {
+            fifo.put(burst, UART_BURST);
+        }
+        fifo.get(out, UART_BURST);
+        checksum += out[UART_BURST - 1];
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_EQUAL_UINT32(BENCH_BYTES / UART_BURST * UART_BURST, checksum);
+    return BENCH_BYTES / seconds / 1e6;
+}
+
+static void test_benchmark_against_legacy_fifo()
+{
+    static TinyGsmFifo<uint8_t, 1024> ring;
+    static LegacyFifo<uint8_t, 1024> legacy;
+
+    double legacyPerByte = benchmarkBursts(legacy, true);
+    double ringPerByte = benchmarkBursts(ring, true);
+    double legacyBulk = benchmarkBursts(legacy, false);
+    double ringBulk = benchmarkBursts(ring, false);
+
+    char line[160];
+    snprintf(line, sizeof(line), "%d byte bursts, put() per byte: legacy %.0f MB/s, ring %.0f MB/s",
+        UART_BURST, legacyPerByte, ringPerByte);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "%d byte bursts, bulk put(): legacy %.0f MB/s, ring %.0f MB/s",
+        UART_BURST, legacyBulk, ringBulk);
+    TEST_MESSAGE(line);
+
+    // What the socket reads gained: a span copy instead of a put() per byte
+    TEST_ASSERT_GREATER_THAN_FLOAT(legacyPerByte, ringBulk);
+}
+
+static void test_benchmark_across_threads()
+{
+    static TinyGsmFifo<uint8_t, 2048> ring;
+    std::thread producer([] {
+        uint8_t burst[UART_BURST] = {};
+        for (uint32_t done = 0; done < BENCH_BYTES; done += UART_BURST)
+        {
+            ring.put(burst, UART_BURST, true);
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    uint8_t out[256];
+    uint32_t received = 0;
+    while (received < BENCH_BYTES)
+    {
+        int n = ring.get(out, sizeof(out), false);
+        if (n == 0)
+        {
+            std::this_thread::yield();
+        }
+        received += n;
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    producer.join();
+
+    char line[96];
+    snprintf(line, sizeof(line), "producer and consumer thread: %.0f MB/s",
+        BENCH_BYTES / seconds / 1e6);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_BYTES, received);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_capacity_rounds_up_to_a_power_of_two);
+    RUN_TEST(test_every_slot_is_usable);
+    RUN_TEST(test_bulk_read_and_peek_wrap);
+    RUN_TEST(test_span_is_contiguous_up_to_the_end);
+    RUN_TEST(test_stress_single_elements);
+    RUN_TEST(test_stress_bulk);
+    RUN_TEST(test_benchmark_against_legacy_fifo);
+    RUN_TEST(test_benchmark_across_threads);
+    return UNITY_END();
+}
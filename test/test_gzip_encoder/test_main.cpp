@@ -0,0 +1,326 @@
+/**
+ * @file test_main.cpp
+ * @brief GzipEncoder Tests and Benchmark
+ *
+ * @details Every stream is decoded again by a minimal inflater for the single fixed-Huffman block
+ * the encoder writes, and its CRC and length trailer are checked. The benchmarks compress a
+ * telemetry payload of the shape createJson() builds, alone and as a batch of ten, and report ratio
+ * and time.
+ */
+
+#include "utils/gzipEncoder.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <unity.h>
+
+#define BENCH_ROUNDS 2000
+
+static const char TELEMETRY[] =
+    "{\"device_id\": \"sentinel-01\", \"sensors\": { \"steps\": 1234, \"temperature\": 21.50, "
+    "\"humidity\": 45.20, \"gas\": { \"ppm\": 12.34 }, \"fall_detected\": 0, "
+    "\"device_battery\": 87, \"strap_battery\": \"0\", \"heart_rate\": 72, "
+    "\"latitude\": 59.913868, \"longitude\": 10.752245, \"altitude\": 23.40, "
+    "\"accuracy\": 3.70, \"noise_level\": 0, \"heart_rate_summary\": { \"strap\": 0, "
+    "\"period\": 15, \"min\": 68, \"max\": 75, \"contact\": 1, \"hrv\": { \"beats\": 61, "
+    "\"artifacts\": 0, \"rmssd\": 41.2, \"sdnn\": 52.8, \"pnn50\": 18.0 } } } }";
+
+static GzipEncoder encoder;
+static uint8_t stream[GZIP_MAX_INPUT + 1024];
+static uint8_t input[GZIP_MAX_INPUT + 1];
+static uint8_t decoded[GZIP_MAX_INPUT + 1];
+
+/**
+ * @brief Bit reader over a deflate stream, least significant bit first
+ */
+struct BitReader
+{
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    uint32_t bits;
+    uint8_t count;
+
+    int bit()
+    {
+        if (count == 0)
+        {
+            if (pos >= size)
+            {
+                return -1;
+            }
+            bits = data[pos++];
+            count = 8;
+        }
+        int b = bits & 1;
+        bits >>= 1;
+        count--;
+        return b;
+    }
+
+    int take(uint8_t n)
+    {
+        int value = 0;
+        for (uint8_t i = 0; i < n; i++)
+        {
+            int b = bit();
+            if (b < 0)
+            {
+                return -1;
+            }
+            value |= b << i;
+        }
+        return value;
+    }
+
+    // Huffman codes are packed most significant bit first
+    int code(uint8_t n, int value)
+    {
+        for (uint8_t i = 0; i < n; i++)
+        {
+            int b = bit();
+            if (b < 0)
+            {
+                return -1;
+            }
+            value = (value << 1) | b;
+        }
+        return value;
+    }
+};
+
+static int fixedLiteralLength(BitReader& reader)
+{
+    int code = reader.code(7, 0);
+    if (code < 0)
+    {
+        return -1;
+    }
+    if (code <= 0x17)
+    {
+        return 256 + code;
+    }
+    code = reader.code(1, code);
+    if (code >= 0x30 && code <= 0xbf)
+    {
+        return code - 0x30;
+    }
+    if (code >= 0xc0 && code <= 0xc7)
+    {
+        return 280 + code - 0xc0;
+    }
+    code = reader.code(1, code);
+    return code >= 0x190 && code <= 0x1ff ? 144 + code - 0x190 : -1;
+}
+
+static uint32_t crc32(const uint8_t* data, size_t length)
+{
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++)
+        {
+            crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t readLe32(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @return Decoded length, or -1 if the stream is not what the encoder should have written
+ */
+static long inflate(const uint8_t* gz, size_t gzLength, uint8_t* out, size_t outSize)
+{
+    static const uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const uint8_t LENGTH_EXTRA[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const uint16_t DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97,
+        129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385,
+        24577};
+    static const uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7,
+        8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    if (gzLength < GZIP_OVERHEAD || gz[0] != 0x1f || gz[1] != 0x8b || gz[2] != 8)
+    {
+        return -1;
+    }
+
+    BitReader reader = {gz + 10, gzLength - 18, 0, 0, 0};
+    if (reader.take(1) != 1 || reader.take(2) != 1)
+    {
+        return -1; // one final block with fixed codes
+    }
+
+    size_t n = 0;
+    while (true)
+    {
+        int symbol = fixedLiteralLength(reader);
+        if (symbol < 0 || symbol > 285)
+        {
+            return -1;
+        }
+        if (symbol < 256)
+        {
+            if (n >= outSize)
+            {
+                return -1;
+            }
+            out[n++] = (uint8_t)symbol;
+            continue;
+        }
+        if (symbol == 256)
+        {
+            break;
+        }
+
+        int index = symbol - 257;
+        int extra = reader.take(LENGTH_EXTRA[index]);
+        int distanceCode = reader.code(5, 0);
+        if (extra < 0 || distanceCode < 0 || distanceCode > 29)
+        {
+            return -1;
+        }
+        int distanceExtra = reader.take(DISTANCE_EXTRA[distanceCode]);
+        if (distanceExtra < 0)
+        {
+            return -1;
+        }
+        size_t length = LENGTH_BASE[index] + extra;
+        size_t distance = DISTANCE_BASE[distanceCode] + distanceExtra;
+        if (distance > n || n + length > outSize)
+        {
+            return -1;
+        }
+        for (size_t i = 0; i < length; i++, n++)
+        {
+            out[n] = out[n - distance];
+        }
+    }
+
+    const uint8_t* trailer = gz + gzLength - 8;
+    if (readLe32(trailer) != crc32(out, n) || readLe32(trailer + 4) != n)
+    {
+        return -1;
+    }
+    return (long)n;
+}
+
+static void assertRoundTrip(const uint8_t* data, size_t length)
+{
+    size_t compressed = encoder.compress(data, length, stream, sizeof(stream));
+    TEST_ASSERT_GREATER_THAN(0, compressed);
+    TEST_ASSERT_EQUAL_INT((long)length, inflate(stream, compressed, decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL_MEMORY(data, decoded, length);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_round_trips_telemetry()
+{
+    assertRoundTrip((const uint8_t*)TELEMETRY, strlen(TELEMETRY));
+}
+
+static void test_round_trips_empty_and_short_input()
+{
+    assertRoundTrip((const uint8_t*)"", 0);
+    assertRoundTrip((const uint8_t*)"ab", 2);
+    assertRoundTrip((const uint8_t*)"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", 41);
+}
+
+static void test_round_trips_the_largest_input()
+{
+    uint32_t state = 12345;
+    for (size_t i = 0; i < GZIP_MAX_INPUT; i++)
+    {
+        state = state * 1103515245 + 12345;
+        // Runs of repeated text mixed with noise, so long and far matches both occur
+        input[i] = (i / 4096) % 2 ? TELEMETRY[i % 97] : (uint8_t)(state >> 24);
+    }
+    assertRoundTrip(input, GZIP_MAX_INPUT);
+}
+
+static void test_rejects_oversized_input()
+{
+    size_t compressed = encoder.compress(input, GZIP_MAX_INPUT + 1, stream, sizeof(stream));
+    TEST_ASSERT_EQUAL_size_t(0, compressed);
+}
+
+static void test_rejects_small_output()
+{
+    TEST_ASSERT_EQUAL_size_t(0, encoder.compress((const uint8_t*)TELEMETRY, strlen(TELEMETRY),
+                                    stream, 64));
+}
+
+static double benchmark(const uint8_t* data, size_t length, size_t& compressed)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_ROUNDS; i++)
+    {
+        compressed = encoder.compress(data, length, stream, sizeof(stream));
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+               .count() / BENCH_ROUNDS;
+}
+
+static void report(const char* name, size_t length, size_t compressed, double us)
+{
+    char line[128];
+    snprintf(line, sizeof(line), "%s: %zu -> %zu bytes (%.1f%%), %.2f us", name, length,
+        compressed, 100.0 * compressed / length, us);
+    TEST_MESSAGE(line);
+}
+
+static void test_benchmark_single_payload()
+{
+    size_t length = strlen(TELEMETRY);
+    size_t compressed = 0;
+    double us = benchmark((const uint8_t*)TELEMETRY, length, compressed);
+    report("single payload", length, compressed, us);
+
+    // A lone payload has few repeats, the gain is small but must not turn into a loss
+    TEST_ASSERT_LESS_THAN(length * 9 / 10, compressed);
+}
+
+static void test_benchmark_batch_of_ten()
+{
+    size_t length = 0;
+    input[length++] = '[';
+    for (int i = 0; i < 10; i++)
+    {
+        // Vary the readings like consecutive samples do
+        length += snprintf((char*)input + length, sizeof(input) - length, "%s%.*s%d%s",
+            i ? "," : "", 51, TELEMETRY, 1234 + 7 * i, TELEMETRY + 55);
+    }
+    input[length++] = ']';
+
+    size_t compressed = 0;
+    double us = benchmark(input, length, compressed);
+    report("batch of ten", length, compressed, us);
+    TEST_ASSERT_LESS_THAN(length * 4 / 10, compressed);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trips_telemetry);
+    RUN_TEST(test_round_trips_empty_and_short_input);
+    RUN_TEST(test_round_trips_the_largest_input);
+    RUN_TEST(test_rejects_oversized_input);
+    RUN_TEST(test_rejects_small_output);
+    RUN_TEST(test_benchmark_single_payload);
+    RUN_TEST(test_benchmark_batch_of_ten);
+    return UNITY_END();
+}
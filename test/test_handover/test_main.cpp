@@ -0,0 +1,243 @@
+/**
+ * @file test_main.cpp
+ * @brief Handover Link Model
+ *
+ * @details Runs HandoverPolicy against a simulated WiFi access point and LTE modem in 100 ms steps
+ * and measures the gap, the time with neither link up. WiFi drops below WIFI_DROP_DBM and rejoins
+ * above WIFI_JOIN_DBM after a fast reconnect, LTE takes LTE_ATTACH_MS from power-on to a data
+ * connection. Each scenario is also run with break-before-make, where LTE only starts once WiFi
+ * has failed MIN_WIFI_ATTEMPTS times and stops as soon as WiFi is back, to show what the warm-up
+ * saves.
+ */
+
+#include "network/handoverPolicy.h"
+#include <cstdio>
+#include <unity.h>
+
+#define STEP_MS 100
+#define RSSI_POLL_MS 2000       // WIFI_RSSI_POLL_MS of the network manager
+#define WIFI_DROP_DBM -88       // association lost below this
+#define WIFI_JOIN_DBM -80       // a reconnect succeeds above this
+#define WIFI_ATTEMPT_MS 2000    // fast reconnect to the cached BSSID
+#define WIFI_RETRY_MS 5000      // between failed attempts
+#define MIN_WIFI_ATTEMPTS 3
+#define LTE_ATTACH_MS 12000     // power-on, registration and data context
+#define HOLD_MS 15000           // HANDOVER_HOLD_MS
+#define NO_AP -127
+
+typedef int16_t (*rssi_trace_t)(uint32_t t);
+
+typedef struct
+{
+    uint32_t gapMs;        // neither link up
+    uint32_t lteOnMs;      // modem powered
+    uint32_t lteStarts;
+    uint32_t lteReleasedAt; // last time LTE was taken down, 0 if never
+} link_result_t;
+
+/**
+ * @brief Run a trace through the policy, or through break-before-make
+ *
+ * @param wifiAtStart WiFi is associated at t = 0, otherwise the device boots without it
+ * @param measureFrom Gaps before this time are not counted, for scenarios that boot on LTE
+ */
+static link_result_t simulate(rssi_trace_t trace, uint32_t durationMs, bool makeBeforeBreak,
+    bool wifiAtStart = true, uint32_t measureFrom = 0)
+{
+    HandoverPolicy policy;
+    link_result_t result = {};
+    bool wifiUp = false;
+    uint8_t attempts = 0;
+    uint32_t nextAttempt = WIFI_ATTEMPT_MS;
+    uint32_t nextPoll = RSSI_POLL_MS;
+    bool lteOn = false;
+    uint32_t lteReadyAt = 0;
+
+    policy.begin(0);
+    if (wifiAtStart)
+    {
+        wifiUp = true;
+        policy.onWiFiConnected(trace(0));
+    }
+
+    for (uint32_t t = 0; t < durationMs; t += STEP_MS)
+    {
+        int16_t rssi = trace(t);
+
+        if (wifiUp && rssi < WIFI_DROP_DBM)
+        {
+            wifiUp = false;
+            policy.onWiFiLost(t);
+            nextAttempt = t + WIFI_ATTEMPT_MS;
+        }
+        else if (!wifiUp && t >= nextAttempt)
+        {
+            if (rssi >= WIFI_JOIN_DBM)
+            {
+                wifiUp = true;
+                attempts = 0;
+                policy.onWiFiConnected(rssi);
+                nextPoll = t + RSSI_POLL_MS;
+            }
+            else
+            {
+                if (attempts < UINT8_MAX)
+                {
+                    attempts++;
+                }
+                nextAttempt = t + WIFI_RETRY_MS + WIFI_ATTEMPT_MS;
+            }
+        }
+        if (wifiUp && t >= nextPoll)
+        {
+            policy.updateRssi(rssi);
+            nextPoll = t + RSSI_POLL_MS;
+        }
+
+        bool gaveUp = attempts >= MIN_WIFI_ATTEMPTS;
+        bool wanted = makeBeforeBreak ? policy.isLteWanted(t, wifiUp, gaveUp) : !wifiUp && gaveUp;
+        bool release = makeBeforeBreak ? policy.canReleaseLte(t, wifiUp) : wifiUp;
+        if (!lteOn && wanted)
+        {
+            lteOn = true;
+            lteReadyAt = t + LTE_ATTACH_MS;
+            result.lteStarts++;
+        }
+        else if (lteOn && !wanted && release)
+        {
+            lteOn = false;
+            result.lteReleasedAt = t;
+        }
+
+        bool lteUp = lteOn && t >= lteReadyAt;
+        if (t >= measureFrom && !wifiUp && !lteUp)
+        {
+            result.gapMs += STEP_MS;
+        }
+        if (lteOn)
+        {
+            result.lteOnMs += STEP_MS;
+        }
+    }
+    return result;
+}
+
+static void report(const char* scenario, const link_result_t& mbb, const link_result_t& bbm)
+{
+    char line[160];
+    snprintf(line, sizeof(line),
+        "%s: gap %lu ms (break-before-make %lu ms), LTE on %lu s (%lu s), %lu starts (%lu)",
+        scenario, (unsigned long)mbb.gapMs, (unsigned long)bbm.gapMs,
+        (unsigned long)mbb.lteOnMs / 1000, (unsigned long)bbm.lteOnMs / 1000,
+        (unsigned long)mbb.lteStarts, (unsigned long)bbm.lteStarts);
+    TEST_MESSAGE(line);
+}
+
+// Walking away from the access point, -55 dBm to -95 dBm over two minutes
+static int16_t walkAway(uint32_t t)
+{
+    return (int16_t)(-55 - (int32_t)(t / 3000));
+}
+
+// The access point loses power after 30 s
+static int16_t accessPointOff(uint32_t t)
+{
+    return t < 30000 ? -55 : NO_AP;
+}
+
+// A 1.5 s dropout, shorter than a fast reconnect plus the grace period
+static int16_t briefDropout(uint32_t t)
+{
+    return t >= 30000 && t < 31500 ? NO_AP : -55;
+}
+
+// Hovering around the warm-up threshold with +-4 dB of noise
+static int16_t noisyEdge(uint32_t t)
+{
+    uint32_t x = t / RSSI_POLL_MS * 2654435761u;
+    return (int16_t)(-74 + (int32_t)((x >> 16) % 9) - 4);
+}
+
+// Booting out of range and walking back, -95 dBm to -55 dBm from 60 s to 120 s
+static int16_t walkBack(uint32_t t)
+{
+    if (t < 60000)
+    {
+        return -95;
+    }
+    int32_t rssi = -95 + (int32_t)((t - 60000) / 1500);
+    return (int16_t)(rssi > -55 ? -55 : rssi);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_walk_away_hands_over_without_a_gap()
+{
+    link_result_t mbb = simulate(walkAway, 180000, true);
+    link_result_t bbm = simulate(walkAway, 180000, false);
+    report("walk away", mbb, bbm);
+
+    TEST_ASSERT_EQUAL_UINT32(0, mbb.gapMs);
+    TEST_ASSERT_EQUAL_UINT32(1, mbb.lteStarts);
+    TEST_ASSERT_GREATER_THAN(LTE_ATTACH_MS, bbm.gapMs);
+}
+
+static void test_sudden_loss_gap_is_grace_plus_attach()
+{
+    link_result_t mbb = simulate(accessPointOff, 120000, true);
+    link_result_t bbm = simulate(accessPointOff, 120000, false);
+    report("access point off", mbb, bbm);
+
+    // WIFI_LOSS_GRACE_MS, then a cold attach
+    TEST_ASSERT_LESS_OR_EQUAL(3000 + LTE_ATTACH_MS + STEP_MS, mbb.gapMs);
+    TEST_ASSERT_LESS_THAN(bbm.gapMs, mbb.gapMs);
+}
+
+static void test_brief_dropout_does_not_start_lte()
+{
+    link_result_t mbb = simulate(briefDropout, 60000, true);
+
+    TEST_ASSERT_EQUAL_UINT32(0, mbb.lteStarts);
+    TEST_ASSERT_EQUAL_UINT32(WIFI_ATTEMPT_MS, mbb.gapMs);
+}
+
+static void test_noisy_signal_does_not_toggle_lte()
+{
+    link_result_t mbb = simulate(noisyEdge, 600000, true);
+    link_result_t bbm = simulate(noisyEdge, 600000, false);
+    report("noisy edge", mbb, bbm);
+
+    TEST_ASSERT_LESS_OR_EQUAL(1, mbb.lteStarts);
+    TEST_ASSERT_EQUAL_UINT32(0, mbb.gapMs);
+}
+
+static void test_walk_back_releases_lte_after_hold()
+{
+    link_result_t mbb = simulate(walkBack, 240000, true, false, 60000);
+    link_result_t bbm = simulate(walkBack, 240000, false, false, 60000);
+    report("walk back", mbb, bbm);
+
+    TEST_ASSERT_EQUAL_UINT32(0, mbb.gapMs);
+    TEST_ASSERT_EQUAL_UINT32(1, mbb.lteStarts);
+    TEST_ASSERT_NOT_EQUAL(0, mbb.lteReleasedAt);
+
+    // WiFi rejoins at -80 dBm (82.5 s) and its average clears -70 dBm a few polls later
+    TEST_ASSERT_GREATER_OR_EQUAL(82500 + HOLD_MS, mbb.lteReleasedAt);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_walk_away_hands_over_without_a_gap);
+    RUN_TEST(test_sudden_loss_gap_is_grace_plus_attach);
+    RUN_TEST(test_brief_dropout_does_not_start_lte);
+    RUN_TEST(test_noisy_signal_does_not_toggle_lte);
+    RUN_TEST(test_walk_back_releases_lte_after_hold);
+    return UNITY_END();
+}
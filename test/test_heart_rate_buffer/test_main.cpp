@@ -0,0 +1,119 @@
+/**
+ * @file test_main.cpp
+ * @brief HeartRateBuffer Tests
+ *
+ * @details Checks that notifications come out oldest first across the wrap of the ring, that a full
+ * ring drops and counts new ones instead of overwriting, and that a producer thread standing in for
+ * the BLE host task and a consumer draining in batches like the Bluetooth task lose nothing.
+ */
+
+#include "sensors/heartRateBuffer.h"
+#include <thread>
+#include <unity.h>
+
+#define CAPACITY 32 // HR_BUFFER_CAPACITY
+#define BATCH 8
+#define STRESS_SAMPLES 1000000u
+
+static hr_sample_t sample(uint32_t n)
+{
+    hr_sample_t s = {};
+    s.time = n;
+    s.measurement.bpm = (uint16_t)(n % 200);
+    s.measurement.rrCount = 1;
+    s.measurement.rr[0] = (uint16_t)n;
+    return s;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_samples_come_out_in_order_across_the_wrap()
+{
+    HeartRateBuffer buffer;
+    hr_sample_t out[BATCH];
+    uint32_t next = 0, expected = 0;
+
+    for (int round = 0; round < 20; round++)
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            TEST_ASSERT_TRUE(buffer.push(sample(next++)));
+        }
+        size_t n = buffer.pop(out, BATCH);
+        TEST_ASSERT_EQUAL_size_t(5, n);
+        for (size_t i = 0; i < n; i++, expected++)
+        {
+            TEST_ASSERT_EQUAL_UINT32(expected, out[i].time);
+            TEST_ASSERT_EQUAL_UINT16((uint16_t)expected, out[i].measurement.rr[0]);
+        }
+    }
+    TEST_ASSERT_EQUAL_size_t(0, buffer.size());
+}
+
+static void test_full_buffer_drops_the_newest()
+{
+    HeartRateBuffer buffer;
+    for (uint32_t i = 0; i < CAPACITY; i++)
+    {
+        TEST_ASSERT_TRUE(buffer.push(sample(i)));
+    }
+    TEST_ASSERT_FALSE(buffer.push(sample(CAPACITY)));
+    TEST_ASSERT_FALSE(buffer.push(sample(CAPACITY + 1)));
+    TEST_ASSERT_EQUAL_size_t(CAPACITY, buffer.size());
+    TEST_ASSERT_EQUAL_UINT32(2, buffer.getDropped());
+
+    hr_sample_t out[CAPACITY];
+    TEST_ASSERT_EQUAL_size_t(CAPACITY, buffer.pop(out, CAPACITY));
+    TEST_ASSERT_EQUAL_UINT32(0, out[0].time);
+    TEST_ASSERT_EQUAL_UINT32(CAPACITY - 1, out[CAPACITY - 1].time);
+    TEST_ASSERT_TRUE(buffer.push(sample(CAPACITY)));
+}
+
+static void test_producer_and_consumer_threads_lose_nothing()
+{
+    HeartRateBuffer buffer;
+    std::thread producer([&buffer]() {
+        for (uint32_t i = 0; i < STRESS_SAMPLES; i++)
+        {
+            while (!buffer.push(sample(i)))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    hr_sample_t out[BATCH];
+    uint32_t expected = 0;
+    bool ordered = true;
+    while (expected < STRESS_SAMPLES)
+    {
+        size_t n = buffer.pop(out, BATCH);
+        for (size_t i = 0; i < n; i++, expected++)
+        {
+            ordered &= out[i].time == expected && out[i].measurement.rr[0] == (uint16_t)expected;
+        }
+        if (n == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL_size_t(0, buffer.size());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_samples_come_out_in_order_across_the_wrap);
+    RUN_TEST(test_full_buffer_drops_the_newest);
+    RUN_TEST(test_producer_and_consumer_threads_lose_nothing);
+    return UNITY_END();
+}
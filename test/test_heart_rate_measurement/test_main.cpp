@@ -0,0 +1,97 @@
+/**
+ * @file test_main.cpp
+ * @brief Heart Rate Measurement Parser Tests
+ *
+ * @details Decodes notifications as src/ble-emulator sends them (contact detected, uint8 rate and
+ * the RR-intervals of the last three seconds) and the other field layouts the characteristic
+ * allows, and checks that notifications shorter than their flags announce are rejected.
+ */
+
+#include "sensors/heartRateMeasurement.h"
+#include <unity.h>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_emulator_notification()
+{
+    // 0x16: contact supported and detected, RR-intervals; 72 BPM, 850 and 812 ms in 1/1024 s
+    const uint8_t data[] = {0x16, 72, 0x66, 0x03, 0x40, 0x03};
+    hrm_measurement_t m;
+
+    TEST_ASSERT_TRUE(parseHeartRateMeasurement(data, sizeof(data), m));
+    TEST_ASSERT_EQUAL_UINT16(72, m.bpm);
+    TEST_ASSERT_EQUAL_INT8(1, m.contact);
+    TEST_ASSERT_EQUAL_INT32(-1, m.energy);
+    TEST_ASSERT_EQUAL_UINT8(2, m.rrCount);
+    TEST_ASSERT_EQUAL_UINT16(870, m.rr[0]);
+    TEST_ASSERT_EQUAL_UINT16(832, m.rr[1]);
+}
+
+static void test_uint16_rate_and_energy()
+{
+    // 0x19: uint16 rate, energy, RR-intervals; no contact support
+    const uint8_t data[] = {0x19, 0x2C, 0x01, 0x10, 0x27, 0x00, 0x04};
+    hrm_measurement_t m;
+
+    TEST_ASSERT_TRUE(parseHeartRateMeasurement(data, sizeof(data), m));
+    TEST_ASSERT_EQUAL_UINT16(300, m.bpm);
+    TEST_ASSERT_EQUAL_INT8(-1, m.contact);
+    TEST_ASSERT_EQUAL_INT32(10000, m.energy);
+    TEST_ASSERT_EQUAL_UINT8(1, m.rrCount);
+    TEST_ASSERT_EQUAL_UINT16(1024, m.rr[0]);
+}
+
+static void test_contact_lost()
+{
+    const uint8_t data[] = {0x04, 0};
+    hrm_measurement_t m;
+
+    TEST_ASSERT_TRUE(parseHeartRateMeasurement(data, sizeof(data), m));
+    TEST_ASSERT_EQUAL_INT8(0, m.contact);
+    TEST_ASSERT_EQUAL_UINT8(0, m.rrCount);
+}
+
+static void test_truncated_notifications_are_rejected()
+{
+    const uint8_t rate16[] = {0x01, 0x48};
+    const uint8_t energy[] = {0x08, 72, 0x10};
+    hrm_measurement_t m;
+
+    TEST_ASSERT_FALSE(parseHeartRateMeasurement(rate16, sizeof(rate16), m));
+    TEST_ASSERT_FALSE(parseHeartRateMeasurement(energy, sizeof(energy), m));
+    TEST_ASSERT_FALSE(parseHeartRateMeasurement(rate16, 1, m));
+    TEST_ASSERT_FALSE(parseHeartRateMeasurement(nullptr, 6, m));
+}
+
+static void test_extra_intervals_and_odd_byte_are_dropped()
+{
+    uint8_t data[2 + 2 * (HRM_MAX_RR + 2) + 1] = {0x10, 60};
+    for (size_t i = 2; i + 1 < sizeof(data); i += 2)
+    {
+        data[i] = (uint8_t)i;
+        data[i + 1] = 0x04;
+    }
+    hrm_measurement_t m;
+
+    TEST_ASSERT_TRUE(parseHeartRateMeasurement(data, sizeof(data), m));
+    TEST_ASSERT_EQUAL_UINT8(HRM_MAX_RR, m.rrCount);
+    TEST_ASSERT_EQUAL_UINT16(0x0402, m.rr[0]);
+    TEST_ASSERT_EQUAL_UINT16(0x0400 + 2 * HRM_MAX_RR, m.rr[HRM_MAX_RR - 1]);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_emulator_notification);
+    RUN_TEST(test_uint16_rate_and_energy);
+    RUN_TEST(test_contact_lost);
+    RUN_TEST(test_truncated_notifications_are_rejected);
+    RUN_TEST(test_extra_intervals_and_odd_byte_are_dropped);
+    return UNITY_END();
+}
@@ -0,0 +1,234 @@
+/**
+ * @file test_main.cpp
+ * @brief HrvAnalyzer Tests
+ *
+ * @details Replays ten minutes of src/ble-emulator notifications (a rate wandering between 60 and
+ * 100 BPM, every beat jittered by up to 40 ms) through the parser and the 1/1024 s to ms conversion
+ * of the Bluetooth task, and compares the streaming summary with RMSSD, SDNN and pNN50 computed
+ * directly over the window. The artifact cases check that a bad first interval is not taken as the
+ * reference and that no difference is taken across a rejected interval or a gap.
+ */
+
+#include "sensors/heartRateMeasurement.h"
+#include "sensors/hrvAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <unity.h>
+#include <vector>
+
+#define WINDOW_MS 60000 // HRV_WINDOW_MS
+#define MIN_BEATS 30    // HRV_MIN_BEATS
+#define EMULATOR_PERIOD_MS 3000
+#define EMULATOR_MINUTES 10
+
+/**
+ * @brief The notifications of src/ble-emulator, one per EMULATOR_PERIOD_MS
+ */
+static std::vector<std::vector<uint8_t>> emulatorNotifications()
+{
+    std::mt19937 random(11);
+    auto between = [&random](int low, int high) { return low + (int)(random() % (high - low)); };
+    std::vector<std::vector<uint8_t>> notifications;
+    int heartRate = 70;
+    uint32_t beatClock = 0;
+
+    for (uint32_t now = EMULATOR_PERIOD_MS; now <= EMULATOR_MINUTES * 60000;
+         now += EMULATOR_PERIOD_MS)
+    {
+        heartRate = std::min(100, std::max(60, heartRate + between(-3, 4)));
+        std::vector<uint8_t> data = {0x16, (uint8_t)heartRate};
+        while (beatClock < now && data.size() + 2 <= 2 + 2 * HRM_MAX_RR)
+        {
+            uint32_t rr = 60000 / heartRate + between(-40, 41);
+            uint32_t rr1024 = (rr * 1024 + 500) / 1000;
+            data.push_back(rr1024 & 0xff);
+            data.push_back(rr1024 >> 8);
+            beatClock += rr;
+        }
+        notifications.push_back(data);
+    }
+    return notifications;
+}
+
+/**
+ * @brief RMSSD, SDNN and pNN50 of the last WINDOW_MS of intervals, computed directly
+ */
+static hrv_summary_t direct(const std::vector<uint16_t>& intervals)
+{
+    size_t first = intervals.size();
+    uint32_t total = 0;
+    while (first > 0 && total + intervals[first - 1] <= WINDOW_MS)
+    {
+        total += intervals[--first];
+    }
+
+    double n = (double)(intervals.size() - first), mean = total / n;
+    double variance = 0, squares = 0;
+    int diffs = 0, nn50 = 0;
+    for (size_t i = first; i < intervals.size(); i++)
+    {
+        variance += (intervals[i] - mean) * (intervals[i] - mean);
+        if (i > first)
+        {
+            int diff = intervals[i] - intervals[i - 1];
+            squares += diff * diff;
+            nn50 += abs(diff) > 50;
+            diffs++;
+        }
+    }
+
+    hrv_summary_t summary;
+    summary.beats = (uint16_t)n;
+    summary.meanRr = (uint16_t)(mean + 0.5);
+    summary.sdnn = (float)sqrt(variance / (n - 1));
+    summary.rmssd = (float)sqrt(squares / diffs);
+    summary.pnn50 = 100.0f * nn50 / diffs;
+    return summary;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_emulator_stream_matches_direct_computation()
+{
+    HrvAnalyzer hrv;
+    std::vector<uint16_t> intervals;
+    for (const std::vector<uint8_t>& data : emulatorNotifications())
+    {
+        hrm_measurement_t m;
+        TEST_ASSERT_TRUE(parseHeartRateMeasurement(data.data(), data.size(), m));
+        for (uint8_t i = 0; i < m.rrCount; i++)
+        {
+            uint16_t rr = (uint16_t)(((uint32_t)m.rr[i] * 1000 + 512) / 1024);
+            hrv.addInterval(rr);
+            intervals.push_back(rr);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, hrv.getRejected());
+
+    hrv_summary_t summary;
+    hrv_summary_t expected = direct(intervals);
+    TEST_ASSERT_TRUE(hrv.getSummary(summary));
+    TEST_ASSERT_EQUAL_UINT16(expected.beats, summary.beats);
+    TEST_ASSERT_EQUAL_UINT16(expected.meanRr, summary.meanRr);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, expected.rmssd, summary.rmssd);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, expected.sdnn, summary.sdnn);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, expected.pnn50, summary.pnn50);
+}
+
+static void test_no_summary_before_enough_beats()
+{
+    HrvAnalyzer hrv;
+    hrv_summary_t summary;
+    for (int i = 0; i < MIN_BEATS - 1; i++)
+    {
+        hrv.addInterval(i % 2 ? 790 : 810);
+    }
+    TEST_ASSERT_FALSE(hrv.getSummary(summary));
+    hrv.addInterval(800);
+    TEST_ASSERT_TRUE(hrv.getSummary(summary));
+}
+
+static void test_artifact_first_is_not_the_reference()
+{
+    HrvAnalyzer hrv;
+    hrv.addInterval(400); // ectopic beat while the strap settles
+    for (int i = 0; i < MIN_BEATS; i++)
+    {
+        hrv.addInterval(i % 2 ? 790 : 810);
+    }
+
+    hrv_summary_t summary;
+    TEST_ASSERT_EQUAL_UINT32(1, hrv.getRejected());
+    TEST_ASSERT_TRUE(hrv.getSummary(summary));
+    TEST_ASSERT_EQUAL_UINT16(MIN_BEATS, summary.beats);
+    TEST_ASSERT_EQUAL_UINT16(800, summary.meanRr);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f, summary.rmssd);
+}
+
+static void test_artifact_among_the_seed_is_not_differenced()
+{
+    HrvAnalyzer hrv;
+    hrv.addInterval(820);
+    hrv.addInterval(830);
+    TEST_ASSERT_FALSE(hrv.addInterval(250)); // out of range while the first beats are held back
+    for (int i = 0; i < MIN_BEATS; i++)
+    {
+        hrv.addInterval(i % 2 ? 810 : 790);
+    }
+
+    hrv_summary_t summary;
+    TEST_ASSERT_EQUAL_UINT32(1, hrv.getRejected());
+    TEST_ASSERT_TRUE(hrv.getSummary(summary));
+    TEST_ASSERT_EQUAL_UINT16(MIN_BEATS, summary.beats);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f, summary.rmssd);
+}
+
+static void test_artifact_is_not_differenced()
+{
+    HrvAnalyzer hrv;
+    for (int i = 0; i < MIN_BEATS; i++)
+    {
+        hrv.addInterval(i % 2 ? 790 : 810);
+    }
+    TEST_ASSERT_FALSE(hrv.addInterval(1600)); // missed beat
+    TEST_ASSERT_TRUE(hrv.addInterval(850));
+
+    hrv_summary_t summary;
+    TEST_ASSERT_TRUE(hrv.getSummary(summary));
+    TEST_ASSERT_EQUAL_UINT16(MIN_BEATS + 1, summary.beats);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f, summary.rmssd);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, summary.pnn50);
+}
+
+static void test_gap_is_not_differenced()
+{
+    HrvAnalyzer hrv;
+    for (int i = 0; i < MIN_BEATS; i++)
+    {
+        hrv.addInterval(i % 2 ? 790 : 810);
+    }
+    hrv.markGap();
+    hrv.addInterval(870);
+
+    hrv_summary_t summary;
+    TEST_ASSERT_TRUE(hrv.getSummary(summary));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f, summary.rmssd);
+    TEST_ASSERT_EQUAL_UINT32(0, hrv.getRejected());
+}
+
+static void test_new_rhythm_is_taken_after_repeated_rejects()
+{
+    HrvAnalyzer hrv;
+    for (int i = 0; i < MIN_BEATS; i++)
+    {
+        hrv.addInterval(800);
+    }
+    int accepted = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        accepted += hrv.addInterval(500); // sprint start, 120 BPM
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, hrv.getRejected());
+    TEST_ASSERT_EQUAL_INT(7, accepted);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_emulator_stream_matches_direct_computation);
+    RUN_TEST(test_no_summary_before_enough_beats);
+    RUN_TEST(test_artifact_first_is_not_the_reference);
+    RUN_TEST(test_artifact_among_the_seed_is_not_differenced);
+    RUN_TEST(test_artifact_is_not_differenced);
+    RUN_TEST(test_gap_is_not_differenced);
+    RUN_TEST(test_new_rhythm_is_taken_after_repeated_rejects);
+    return UNITY_END();
+}
@@ -0,0 +1,72 @@
+/**
+ * @file test_main.cpp
+ * @brief JsonArena Tests
+ *
+ * @details Covers the bump allocator's in-place growth of the latest block, copies of older ones,
+ * exhaustion and reset(). The send path that uses it is soaked in test_uplink_payload.
+ */
+
+#include "utils/jsonArena.h"
+#include <unity.h>
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_latest_block_grows_in_place()
+{
+    JsonArena<256> arena;
+    void* block = arena.allocate(10);
+
+    TEST_ASSERT_NOT_NULL(block);
+    TEST_ASSERT_TRUE(arena.reallocate(block, 40) == block);
+    TEST_ASSERT_TRUE(arena.reallocate(block, 8) == block);
+}
+
+static void test_older_block_is_copied()
+{
+    JsonArena<256> arena;
+    char* older = static_cast<char*>(arena.allocate(8));
+    memcpy(older, "sentinel", 8);
+    arena.allocate(8);
+
+    char* moved = static_cast<char*>(arena.reallocate(older, 32));
+    TEST_ASSERT_NOT_NULL(moved);
+    TEST_ASSERT_TRUE(moved != older);
+    TEST_ASSERT_EQUAL_MEMORY("sentinel", moved, 8);
+}
+
+static void test_exhaustion_fails_and_is_counted()
+{
+    JsonArena<128> arena;
+
+    TEST_ASSERT_NULL(arena.allocate(1000));
+    void* block = arena.allocate(16);
+    TEST_ASSERT_NULL(arena.reallocate(block, 1000));
+    TEST_ASSERT_EQUAL_UINT32(2, arena.getFailures());
+}
+
+static void test_reset_releases_everything()
+{
+    JsonArena<128> arena;
+    arena.allocate(16);
+    arena.allocate(16);
+
+    arena.reset();
+    TEST_ASSERT_EQUAL_size_t(0, arena.getUsed());
+    TEST_ASSERT_GREATER_THAN(0, arena.getHighWater());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_latest_block_grows_in_place);
+    RUN_TEST(test_older_block_is_copied);
+    RUN_TEST(test_exhaustion_fails_and_is_counted);
+    RUN_TEST(test_reset_releases_everything);
+    return UNITY_END();
+}
@@ -0,0 +1,150 @@
+/**
+ * @file test_main.cpp
+ * @brief LinkScorer Tests
+ *
+ * @details Checks the switch margin of pick() with two transports that share an energy profile and
+ * differ only in signal, so the score ratio is known exactly. The recovery cases drive WiFi down
+ * with failed requests until LTE takes over, then feed it nothing but signal updates, as the
+ * network manager does for the unused link, and check that it is tried again.
+ */
+
+#include "network/linkScorer.h"
+#include <unity.h>
+
+// LINK_SWITCH_MARGIN of the scorer
+#define SWITCH_MARGIN 0.2f
+
+static const link_profile_t SAME_PROFILE = {350, 40, 300, -90, -65};
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_picks_the_only_link_up()
+{
+    LinkScorer scorer;
+
+    TEST_ASSERT_EQUAL(TRANSPORT_NONE, scorer.pick(false, false, TRANSPORT_WIFI));
+    TEST_ASSERT_EQUAL(TRANSPORT_WIFI, scorer.pick(true, false, TRANSPORT_LTE));
+    TEST_ASSERT_EQUAL(TRANSPORT_LTE, scorer.pick(false, true, TRANSPORT_WIFI));
+}
+
+static void test_prefers_wifi_by_default()
+{
+    LinkScorer scorer;
+
+    TEST_ASSERT_GREATER_THAN_FLOAT(scorer.score(TRANSPORT_LTE), scorer.score(TRANSPORT_WIFI));
+    TEST_ASSERT_EQUAL(TRANSPORT_WIFI, scorer.pick(true, true, TRANSPORT_NONE));
+    TEST_ASSERT_EQUAL(TRANSPORT_WIFI, scorer.pick(true, true, TRANSPORT_LTE));
+}
+
+static void test_keeps_current_link_within_margin()
+{
+    LinkScorer scorer;
+    scorer.setProfile(TRANSPORT_LTE, SAME_PROFILE);
+
+    // -68 dBm is 22/25 of the way from floor to good, LTE scores 14% better
+    scorer.updateSignal(TRANSPORT_WIFI, -68);
+    float ratio = scorer.score(TRANSPORT_LTE) / scorer.score(TRANSPORT_WIFI);
+    TEST_ASSERT_GREATER_THAN_FLOAT(1.0f, ratio);
+    TEST_ASSERT_LESS_THAN_FLOAT(1.0f + SWITCH_MARGIN, ratio);
+
+    TEST_ASSERT_EQUAL(TRANSPORT_WIFI, scorer.pick(true, true, TRANSPORT_WIFI));
+    TEST_ASSERT_EQUAL(TRANSPORT_LTE, scorer.pick(true, true, TRANSPORT_LTE));
+    TEST_ASSERT_EQUAL(TRANSPORT_LTE, scorer.pick(true, true, TRANSPORT_NONE));
+}
+
+static void test_switches_beyond_margin()
+{
+    LinkScorer scorer;
+    scorer.setProfile(TRANSPORT_LTE, SAME_PROFILE);
+
+    // -70 dBm leaves a factor of 0.8, LTE scores 25% better
+    scorer.updateSignal(TRANSPORT_WIFI, -70);
+    TEST_ASSERT_EQUAL(TRANSPORT_LTE, scorer.pick(true, true, TRANSPORT_WIFI));
+
+    // And back once WiFi is as much better
+    scorer.updateSignal(TRANSPORT_WIFI, -60);
+    scorer.updateSignal(TRANSPORT_LTE, -70);
+    TEST_ASSERT_EQUAL(TRANSPORT_WIFI, scorer.pick(true, true, TRANSPORT_LTE));
+}
+
+static void test_failures_do_not_move_latency()
+{
+    LinkScorer scorer;
+    float prior = scorer.getStats(TRANSPORT_WIFI).latencyMs;
+
+    scorer.recordResult(TRANSPORT_WIFI, false, 30000);
+    link_stats_t stats = scorer.getStats(TRANSPORT_WIFI);
+    TEST_ASSERT_EQUAL_FLOAT(prior, stats.latencyMs);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.failures);
+
+    scorer.recordResult(TRANSPORT_WIFI, true, 1100);
+    TEST_ASSERT_EQUAL_FLOAT(prior + (1100 - prior) / 8, scorer.getStats(TRANSPORT_WIFI).latencyMs);
+}
+
+static void test_failing_wifi_hands_over_and_recovers()
+{
+    LinkScorer scorer;
+    Transport current = TRANSPORT_WIFI;
+
+    int failures = 0;
+    while (current == TRANSPORT_WIFI && failures < 100)
+    {
+        scorer.recordResult(TRANSPORT_WIFI, false, 0);
+        failures++;
+        current = scorer.pick(true, true, current);
+    }
+    TEST_ASSERT_EQUAL(TRANSPORT_LTE, current);
+    float lowest = scorer.getStats(TRANSPORT_WIFI).successRate;
+
+    // Only LTE carries requests now, WiFi sees RSSI polls alone
+    int updates = 0;
+    while (current == TRANSPORT_LTE && updates < 1000)
+    {
+        scorer.recordResult(TRANSPORT_LTE, true, 1500);
+        scorer.updateSignal(TRANSPORT_WIFI, -60);
+        updates++;
+        current = scorer.pick(true, true, current);
+    }
+    TEST_ASSERT_EQUAL(TRANSPORT_WIFI, current);
+    TEST_ASSERT_GREATER_THAN(1, updates);
+    TEST_ASSERT_GREATER_THAN_FLOAT(lowest, scorer.getStats(TRANSPORT_WIFI).successRate);
+}
+
+static void test_recovery_drifts_towards_one()
+{
+    LinkScorer scorer;
+    for (int i = 0; i < 20; i++)
+    {
+        scorer.recordResult(TRANSPORT_LTE, false, 0);
+    }
+
+    float previous = scorer.getStats(TRANSPORT_LTE).successRate;
+    for (int i = 0; i < 200; i++)
+    {
+        scorer.updateSignal(TRANSPORT_LTE, -90);
+        float rate = scorer.getStats(TRANSPORT_LTE).successRate;
+        TEST_ASSERT_GREATER_THAN_FLOAT(previous, rate);
+        TEST_ASSERT_LESS_OR_EQUAL_FLOAT(1.0f, rate);
+        previous = rate;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 1.0f, previous);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_picks_the_only_link_up);
+    RUN_TEST(test_prefers_wifi_by_default);
+    RUN_TEST(test_keeps_current_link_within_margin);
+    RUN_TEST(test_switches_beyond_margin);
+    RUN_TEST(test_failures_do_not_move_latency);
+    RUN_TEST(test_failing_wifi_hands_over_and_recovers);
+    RUN_TEST(test_recovery_drifts_towards_one);
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+/**
+ * @file test_main.cpp
+ * @brief ModemStatusCache Tests
+ *
+ * @details Feeds the cache the URC lines an A76xx sends, and the solicited answers that reach the
+ * URC handler when a caller only waited for OK, and checks which values are served from the cache
+ * and for how long.
+ */
+
+#include "network/modemStatus.h"
+#include <unity.h>
+
+// MODEM_REG_TTL_MS of the cache
+#define REG_TTL_MS 30000
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_empty_cache_answers_nothing()
+{
+    ModemStatusCache cache;
+    bool flag;
+    int8_t status;
+    int16_t csq;
+
+    TEST_ASSERT_FALSE(cache.getSimReady(100, flag));
+    TEST_ASSERT_FALSE(cache.getRegistration(100, status));
+    TEST_ASSERT_FALSE(cache.getDataActive(100, flag));
+    TEST_ASSERT_FALSE(cache.getSignal(100, csq));
+}
+
+static void test_sim_ready_is_cached_without_reporting()
+{
+    ModemStatusCache cache;
+    bool ready = false;
+
+    TEST_ASSERT_TRUE(cache.onUrc("+CPIN:", " READY", 100));
+    TEST_ASSERT_TRUE(cache.getSimReady(200, ready));
+    TEST_ASSERT_TRUE(ready);
+
+    // A SIM that is not ready is always queried again
+    cache.onUrc("+CPIN:", " SIM PIN", 300);
+    TEST_ASSERT_FALSE(cache.getSimReady(400, ready));
+}
+
+static void test_registration_needs_reporting()
+{
+    ModemStatusCache cache;
+    int8_t status;
+
+    TEST_ASSERT_FALSE(cache.onUrc("+CEREG:", " 1,5", 100));
+    cache.setRegistration(1, 100);
+    TEST_ASSERT_FALSE(cache.getRegistration(200, status));
+
+    cache.setUrcReporting(true);
+    TEST_ASSERT_TRUE(cache.getRegistration(200, status));
+    TEST_ASSERT_EQUAL_INT8(1, status);
+}
+
+static void test_registration_urc_and_answer_forms()
+{
+    ModemStatusCache cache;
+    cache.setUrcReporting(true);
+    int8_t status;
+
+    cache.onUrc("+CEREG:", " 2", 100);
+    TEST_ASSERT_TRUE(cache.getRegistration(200, status));
+    TEST_ASSERT_EQUAL_INT8(2, status);
+
+    // Answer to AT+CEREG?, "<n>,<stat>"
+    cache.onUrc("+CEREG:", " 1,5", 300);
+    TEST_ASSERT_TRUE(cache.getRegistration(400, status));
+    TEST_ASSERT_EQUAL_INT8(5, status);
+
+    // URC with location, "<stat>,<tac>,<ci>,<AcT>"
+    cache.onUrc("+CEREG:", " 1,\"1A2B\",\"01C3D4E5\",7", 500);
+    TEST_ASSERT_TRUE(cache.getRegistration(600, status));
+    TEST_ASSERT_EQUAL_INT8(1, status);
+
+    TEST_ASSERT_FALSE(cache.getRegistration(500 + REG_TTL_MS, status));
+}
+
+static void test_deactivation_is_trusted_past_the_ttl()
+{
+    ModemStatusCache cache;
+    cache.setUrcReporting(true);
+    bool active = true;
+
+    cache.setDataActive(true, 100);
+    TEST_ASSERT_TRUE(cache.getDataActive(200, active));
+    TEST_ASSERT_TRUE(active);
+
+    TEST_ASSERT_TRUE(cache.onUrc("+CGEV:", " NW PDN DEACT 1", 300));
+    TEST_ASSERT_TRUE(cache.isDataLost());
+    TEST_ASSERT_TRUE(cache.getDataActive(1000000, active));
+    TEST_ASSERT_FALSE(active);
+
+    TEST_ASSERT_TRUE(cache.onUrc("+CGEV:", " ME PDN ACT 1", 400));
+    TEST_ASSERT_FALSE(cache.isDataLost());
+    TEST_ASSERT_TRUE(cache.getDataActive(500, active));
+    TEST_ASSERT_TRUE(active);
+}
+
+static void test_signal_and_reset()
+{
+    ModemStatusCache cache;
+    int16_t csq = 0;
+
+    TEST_ASSERT_TRUE(cache.onUrc("+CSQ:", " 20,99", 100));
+    TEST_ASSERT_TRUE(cache.getSignal(200, csq));
+    TEST_ASSERT_EQUAL_INT16(20, csq);
+    TEST_ASSERT_FALSE(cache.onUrc("+CMTI:", " \"SM\",1", 300));
+
+    cache.reset();
+    TEST_ASSERT_FALSE(cache.getSignal(400, csq));
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_cache_answers_nothing);
+    RUN_TEST(test_sim_ready_is_cached_without_reporting);
+    RUN_TEST(test_registration_needs_reporting);
+    RUN_TEST(test_registration_urc_and_answer_forms);
+    RUN_TEST(test_deactivation_is_trusted_past_the_ttl);
+    RUN_TEST(test_signal_and_reset);
+    return UNITY_END();
+}
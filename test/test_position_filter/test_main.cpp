@@ -0,0 +1,248 @@
+/**
+ * @file test_main.cpp
+ * @brief PositionFilter Tests and Evaluation
+ *
+ * @details The evaluation replays simulated 30-minute 1 Hz logs of a walk, a walk with stops and a
+ * drive. Fixes carry HDOP 0.8-1.8 with 4 m of error per unit, 2% are multipath outliers 80 m off
+ * and 2.5% come from three satellites. It compares the RMS position error of the filtered estimate
+ * with that of the raw fixes, both over all fixes and over the clean ones alone, and must beat
+ * both.
+ */
+
+#include "network/positionFilter.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <unity.h>
+
+#define FIXES 1800
+#define SETTLE_FIXES 30 // the first half minute is not scored
+#define ORIGIN_LAT 59.91
+#define ORIGIN_LON 10.75
+#define METERS_PER_DEGREE 111195.0
+#define MAX_GAP_MS 300000 // KF_MAX_GAP_MS
+
+typedef enum
+{
+    TRACE_WALK,
+    TRACE_WALK_WITH_STOPS,
+    TRACE_DRIVE,
+} trace_t;
+
+typedef struct
+{
+    double rawRms;     // m, every fix as the receiver reported it
+    double cleanRms;   // m, fixes without an injected outlier
+    double filterRms;  // m, the estimate at each fix
+    double speedRms;   // m/s
+    position_filter_stats_t stats;
+} evaluation_t;
+
+static evaluation_t evaluate(trace_t trace)
+{
+    std::mt19937 random(3);
+    std::normal_distribution<double> normal(0, 1);
+    PositionFilter filter;
+    double metersPerDegLon = METERS_PER_DEGREE * cos(ORIGIN_LAT * M_PI / 180);
+    double east = 0, north = 0, heading = 0.3;
+    double rawSum = 0, cleanSum = 0, filterSum = 0, speedSum = 0;
+    int scored = 0, clean = 0;
+
+    for (int i = 0; i < FIXES; i++)
+    {
+        uint32_t now = 1000 + i * 1000;
+        bool stopped = trace == TRACE_WALK_WITH_STOPS && (i / 300) % 2 == 1;
+        double speed = stopped ? 0 : trace == TRACE_DRIVE ? 14 : 1.4;
+        if (i % 120 == 0)
+        {
+            heading += 0.6;
+        }
+        east += speed * sin(heading);
+        north += speed * cos(heading);
+
+        float hdop = 0.8f + (random() % 100) / 100.0f;
+        int satellites = 6 + random() % 6;
+        double sigma = hdop * 4.0 / sqrt(2.0);
+        double errorEast = normal(random) * sigma;
+        double errorNorth = normal(random) * sigma;
+        bool outlier = false;
+        if (random() % 50 == 0)
+        {
+            errorEast += 80; // multipath
+            outlier = true;
+        }
+        if (random() % 40 == 0)
+        {
+            satellites = 3;
+            errorEast += 40;
+            outlier = true;
+        }
+
+        if (stopped)
+        {
+            filter.zeroVelocity(now);
+        }
+        filter.update((float)(ORIGIN_LAT + (north + errorNorth) / METERS_PER_DEGREE),
+            (float)(ORIGIN_LON + (east + errorEast) / metersPerDegLon), hdop, satellites, now);
+
+        position_estimate_t estimate;
+        if (i < SETTLE_FIXES || !filter.getEstimate(now, estimate))
+        {
+            continue;
+        }
+        double fe = (estimate.longitude - ORIGIN_LON) * metersPerDegLon - east;
+        double fn = (estimate.latitude - ORIGIN_LAT) * METERS_PER_DEGREE - north;
+        double raw = errorEast * errorEast + errorNorth * errorNorth;
+        rawSum += raw;
+        if (!outlier)
+        {
+            cleanSum += raw;
+            clean++;
+        }
+        filterSum += fe * fe + fn * fn;
+        speedSum += (estimate.speed - speed) * (estimate.speed - speed);
+        scored++;
+    }
+
+    evaluation_t result;
+    result.rawRms = sqrt(rawSum / scored);
+    result.cleanRms = sqrt(cleanSum / clean);
+    result.filterRms = sqrt(filterSum / scored);
+    result.speedRms = sqrt(speedSum / scored);
+    result.stats = filter.getStats();
+    return result;
+}
+
+static void report(const char* name, const evaluation_t& result)
+{
+    char line[192];
+    snprintf(line, sizeof(line),
+        "%s: RMS raw %.2f m, clean fixes %.2f m, filtered %.2f m, speed %.2f m/s, "
+        "%lu accepted, %lu rejected, %lu resets",
+        name, result.rawRms, result.cleanRms, result.filterRms, result.speedRms,
+        (unsigned long)result.stats.updates, (unsigned long)result.stats.rejected,
+        (unsigned long)result.stats.resets);
+    TEST_MESSAGE(line);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_few_satellites_are_rejected()
+{
+    PositionFilter filter;
+    TEST_ASSERT_FALSE(filter.update(59.91f, 10.75f, 1.0f, 3, 1000));
+    TEST_ASSERT_FALSE(filter.isValid());
+    TEST_ASSERT_TRUE(filter.update(59.91f, 10.75f, 1.0f, -1, 2000));
+    TEST_ASSERT_EQUAL_UINT32(1, filter.getStats().rejected);
+}
+
+static void test_outliers_are_gated_and_a_run_restarts()
+{
+    PositionFilter filter;
+    for (uint32_t t = 1000; t <= 20000; t += 1000)
+    {
+        filter.update(59.91f, 10.75f, 1.0f, 8, t);
+    }
+
+    float jump = (float)(59.91 + 500 / METERS_PER_DEGREE);
+    TEST_ASSERT_FALSE(filter.update(jump, 10.75f, 1.0f, 8, 21000));
+    TEST_ASSERT_FALSE(filter.update(jump, 10.75f, 1.0f, 8, 22000));
+    TEST_ASSERT_TRUE(filter.update(jump, 10.75f, 1.0f, 8, 23000));
+
+    position_estimate_t estimate;
+    TEST_ASSERT_TRUE(filter.getEstimate(23000, estimate));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, jump, estimate.latitude);
+    TEST_ASSERT_EQUAL_UINT32(1, filter.getStats().resets);
+}
+
+static void test_estimate_expires_after_a_gap()
+{
+    PositionFilter filter;
+    filter.update(59.91f, 10.75f, 1.0f, 8, 1000);
+    position_estimate_t estimate;
+
+    TEST_ASSERT_TRUE(filter.getEstimate(1000 + MAX_GAP_MS, estimate));
+    TEST_ASSERT_FALSE(filter.getEstimate(1001 + MAX_GAP_MS, estimate));
+}
+
+static void test_estimate_extrapolates_between_fixes()
+{
+    PositionFilter filter;
+    double step = 30 * 1.4 / METERS_PER_DEGREE; // 1.4 m/s north, a fix every 30 s
+    for (int i = 0; i < 10; i++)
+    {
+        filter.update((float)(59.91 + i * step), 10.75f, 1.0f, 8, 1000 + i * 30000);
+    }
+
+    position_estimate_t estimate;
+    TEST_ASSERT_TRUE(filter.getEstimate(1000 + 9 * 30000 + 15000, estimate));
+    double north = (estimate.latitude - 59.91) * METERS_PER_DEGREE;
+    TEST_ASSERT_FLOAT_WITHIN(5.0f, (9 * 30 + 15) * 1.4f, (float)north);
+    TEST_ASSERT_FLOAT_WITHIN(0.3f, 1.4f, estimate.speed);
+    TEST_ASSERT_TRUE(estimate.course < 10 || estimate.course > 350);
+}
+
+static void test_zero_velocity_pins_speed()
+{
+    PositionFilter filter;
+    for (int i = 0; i < 20; i++)
+    {
+        filter.update((float)(59.91 + i * 1.4 / METERS_PER_DEGREE), 10.75f, 1.0f, 8,
+            1000 + i * 1000);
+    }
+    for (int i = 0; i < 5; i++)
+    {
+        filter.zeroVelocity(21000 + i * 1000);
+    }
+
+    position_estimate_t estimate;
+    filter.getEstimate(26000, estimate);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.1f, estimate.speed);
+    TEST_ASSERT_EQUAL_UINT32(5, filter.getStats().stationary);
+}
+
+static void assertImproves(const char* name, trace_t trace)
+{
+    evaluation_t result = evaluate(trace);
+    report(name, result);
+
+    // Better than the receiver even with the outliers left out of its score
+    TEST_ASSERT_LESS_THAN_FLOAT(result.cleanRms * 0.8, result.filterRms);
+    TEST_ASSERT_LESS_THAN_FLOAT(result.rawRms / 2, result.filterRms);
+    TEST_ASSERT_LESS_THAN_FLOAT(1.0f, result.speedRms);
+}
+
+static void test_evaluate_walk()
+{
+    assertImproves("walk", TRACE_WALK);
+}
+
+static void test_evaluate_walk_with_stops()
+{
+    assertImproves("walk with stops", TRACE_WALK_WITH_STOPS);
+}
+
+static void test_evaluate_drive()
+{
+    assertImproves("drive", TRACE_DRIVE);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_few_satellites_are_rejected);
+    RUN_TEST(test_outliers_are_gated_and_a_run_restarts);
+    RUN_TEST(test_estimate_expires_after_a_gap);
+    RUN_TEST(test_estimate_extrapolates_between_fixes);
+    RUN_TEST(test_zero_velocity_pins_speed);
+    RUN_TEST(test_evaluate_walk);
+    RUN_TEST(test_evaluate_walk_with_stops);
+    RUN_TEST(test_evaluate_drive);
+    return UNITY_END();
+}
@@ -0,0 +1,189 @@
+/**
+ * @file test_main.cpp
+ * @brief TinyGsmResponseMatcher Tests and Benchmark
+ *
+ * @details Replays a recorded A76xx session, from boot URCs through an HTTP POST and its read-back,
+ * through the matcher and through the String/endsWith() loop that waitResponse() used before it,
+ * with the patterns the A7670 class registers. Both must report the same responses in the same
+ * order; the benchmark then times both over the same transcript.
+ */
+
+#include "TinyGsmResponseMatcher.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+#define GSM_NL "\r\n"
+#define TRANSCRIPT_REPEATS 2000
+
+// r1..r5 of waitResponse() followed by the URCs it handles itself
+static const char* const PATTERNS[] = {"OK" GSM_NL, "ERROR" GSM_NL, GSM_NL "+CME ERROR:",
+    GSM_NL "+CMS ERROR:", "+HTTPACTION:", GSM_NL "+CIPRXGET:", GSM_NL "+RECEIVE:", "+IPCLOSE:",
+    "+CIPEVENT:"};
+static const size_t PATTERN_COUNT = sizeof(PATTERNS) / sizeof(PATTERNS[0]);
+
+static const char SESSION[] =
+    GSM_NL "+CPIN: READY" GSM_NL GSM_NL "SMS DONE" GSM_NL "AT+CSQ" GSM_NL GSM_NL "+CSQ: 20,99"
+    GSM_NL GSM_NL "OK" GSM_NL "AT+CEREG?" GSM_NL GSM_NL "+CEREG: 1,1" GSM_NL GSM_NL "OK" GSM_NL
+    "AT+HTTPACTION=1" GSM_NL GSM_NL "OK" GSM_NL GSM_NL "+HTTPACTION: 1,200,532" GSM_NL
+    "AT+HTTPREAD=0,64" GSM_NL GSM_NL "+HTTPREAD: 64" GSM_NL
+    "{\"token\":\"eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9.abcdefgh\"}" GSM_NL "+HTTPREAD: 0" GSM_NL
+    GSM_NL "OK" GSM_NL "AT+X" GSM_NL GSM_NL "ERROR" GSM_NL "AT+Y" GSM_NL GSM_NL
+    "+CME ERROR: 10" GSM_NL GSM_NL "+IPCLOSE: 0,1" GSM_NL;
+
+static std::string transcript;
+
+/**
+ * @brief The previous waitResponse() loop: grow a String, test every pattern after every byte
+ */
+static int matchString(const std::string& input, size_t& pos)
+{
+    std::string data;
+    while (pos < input.size())
+    {
+        data += input[pos++];
+        for (size_t i = 0; i < PATTERN_COUNT; i++)
+        {
+            size_t len = strlen(PATTERNS[i]);
+            if (data.size() >= len && data.compare(data.size() - len, len, PATTERNS[i]) == 0)
+            {
+                return (int)i;
+            }
+        }
+    }
+    return -1;
+}
+
+static int matchTail(const std::string& input, size_t& pos)
+{
+    TinyGsmResponseMatcher matcher;
+    for (const char* pattern : PATTERNS)
+    {
+        matcher.add(pattern);
+    }
+    while (pos < input.size())
+    {
+        int8_t hit = matcher.push(input[pos++]);
+        if (hit >= 0)
+        {
+            return hit;
+        }
+    }
+    return -1;
+}
+
+static std::vector<int> replay(int (*match)(const std::string&, size_t&))
+{
+    std::vector<int> hits;
+    size_t pos = 0;
+    while (pos < transcript.size())
+    {
+        hits.push_back(match(transcript, pos));
+    }
+    return hits;
+}
+
+static double benchmark(int (*match)(const std::string&, size_t&))
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t pos = 0;
+    while (pos < transcript.size())
+    {
+        match(transcript, pos);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_matches_string_loop_on_session()
+{
+    std::vector<int> expected = replay(matchString);
+    std::vector<int> actual = replay(matchTail);
+
+    TEST_ASSERT_EQUAL_size_t(expected.size(), actual.size());
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected.data(), actual.data(), expected.size());
+}
+
+static void test_earlier_pattern_wins()
+{
+    TinyGsmResponseMatcher matcher;
+    TEST_ASSERT_EQUAL_INT8(0, matcher.add("OK" GSM_NL));
+    TEST_ASSERT_EQUAL_INT8(1, matcher.add("K" GSM_NL));
+
+    int8_t hit = -1;
+    for (const char* c = "OK" GSM_NL; *c; c++)
+    {
+        hit = matcher.push(*c);
+    }
+    TEST_ASSERT_EQUAL_INT8(0, hit);
+}
+
+static void test_unused_slot_is_not_registered()
+{
+    TinyGsmResponseMatcher matcher;
+    TEST_ASSERT_EQUAL_INT8(-1, matcher.add(NULL));
+    TEST_ASSERT_EQUAL_INT8(0, matcher.add("OK" GSM_NL));
+}
+
+static void test_longest_pattern_matches_across_the_ring()
+{
+    char pattern[TinyGsmResponseMatcher::MAX_PATTERN_LEN + 1];
+    for (size_t i = 0; i < TinyGsmResponseMatcher::MAX_PATTERN_LEN; i++)
+    {
+        pattern[i] = (char)('a' + i % 26);
+    }
+    pattern[TinyGsmResponseMatcher::MAX_PATTERN_LEN] = '\0';
+
+    TinyGsmResponseMatcher matcher;
+    TEST_ASSERT_EQUAL_INT8(0, matcher.add(pattern));
+
+    // Start mid-ring so the match wraps around the end of the buffer
+    for (const char* c = "noise" GSM_NL; *c; c++)
+    {
+        matcher.push(*c);
+    }
+    int8_t hit = -1;
+    for (const char* c = pattern; *c; c++)
+    {
+        hit = matcher.push(*c);
+    }
+    TEST_ASSERT_EQUAL_INT8(0, hit);
+}
+
+static void test_benchmark_session()
+{
+    double stringMs = benchmark(matchString);
+    double tailMs = benchmark(matchTail);
+
+    char line[128];
+    snprintf(line, sizeof(line), "%zu bytes: String/endsWith %.1f ms, matcher %.1f ms (%.1fx)",
+        transcript.size(), stringMs, tailMs, stringMs / tailMs);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_THAN_FLOAT(stringMs, tailMs);
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 0; i < TRANSCRIPT_REPEATS; i++)
+    {
+        transcript += SESSION;
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_string_loop_on_session);
+    RUN_TEST(test_earlier_pattern_wins);
+    RUN_TEST(test_unused_slot_is_not_registered);
+    RUN_TEST(test_longest_pattern_matches_across_the_ring);
+    RUN_TEST(test_benchmark_session);
+    return UNITY_END();
+}
@@ -0,0 +1,172 @@
+/**
+ * @file test_main.cpp
+ * @brief Response Sink Tests
+ *
+ * @details Feeds authentication bodies to JsonTokenSink in every chunking down to single bytes,
+ * with the token before and after its lifetime, nested in objects and arrays, too long for the
+ * buffer and escaped, and checks that CaptureSink keeps a terminated prefix and stops once full.
+ */
+
+#include "network/responseSink.h"
+#include <cstring>
+#include <unity.h>
+
+#define TOKEN_SIZE 32
+
+/**
+ * @brief Feed a body to a sink in chunks of the given size
+ *
+ * @return false if the sink stopped reading
+ */
+static bool feed(ResponseSink& sink, const char* body, size_t chunk)
+{
+    sink.begin(200, (int)strlen(body));
+    bool reading = true;
+    for (size_t i = 0; reading && i < strlen(body); i += chunk)
+    {
+        size_t n = strlen(body) - i < chunk ? strlen(body) - i : chunk;
+        reading = sink.write((const uint8_t*)body + i, n);
+    }
+    sink.end();
+    return reading;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_token_and_lifetime_in_any_chunking()
+{
+    const char* bodies[] = {
+        "{\"token\": \"eyJhbGciOiJIUzI1NiJ9.e30.sig\", \"expires_in\": 3600}",
+        "{\"expires_in\":3600,\"token\":\"eyJhbGciOiJIUzI1NiJ9.e30.sig\"}",
+    };
+    char token[TOKEN_SIZE];
+    JsonTokenSink sink(token, sizeof(token));
+
+    for (const char* body : bodies)
+    {
+        for (size_t chunk = 1; chunk <= strlen(body); chunk++)
+        {
+            feed(sink, body, chunk);
+            TEST_ASSERT_TRUE(sink.hasToken());
+            TEST_ASSERT_EQUAL_STRING("eyJhbGciOiJIUzI1NiJ9.e30.sig", token);
+            TEST_ASSERT_TRUE(sink.hasExpiresIn());
+            TEST_ASSERT_EQUAL_UINT32(3600, sink.getExpiresIn());
+            TEST_ASSERT_FALSE(sink.hasError());
+        }
+    }
+}
+
+static void test_reading_stops_once_both_are_known()
+{
+    char token[TOKEN_SIZE];
+    JsonTokenSink sink(token, sizeof(token));
+    TEST_ASSERT_FALSE(
+        feed(sink, "{\"token\":\"abc\",\"expires_in\":60,\"user\":{\"name\":\"x\"}}", 64));
+    TEST_ASSERT_TRUE(feed(sink, "{\"token\":\"abc\"}", 64));
+    TEST_ASSERT_TRUE(sink.hasToken());
+    TEST_ASSERT_FALSE(sink.hasExpiresIn());
+}
+
+static void test_nested_objects_and_arrays()
+{
+    const char* body = "{\"type\":\"token\",\"scopes\":[\"token\",\"read\"],"
+                       "\"data\":{\"items\":[1,{\"a\":[]}],\"auth\":{\"token\":\"nested\","
+                       "\"expires_in\":900}},\"token\":\"outer\"}";
+    char token[TOKEN_SIZE];
+    JsonTokenSink sink(token, sizeof(token));
+
+    for (size_t chunk = 1; chunk <= strlen(body); chunk++)
+    {
+        feed(sink, body, chunk);
+        TEST_ASSERT_EQUAL_STRING("nested", token);
+        TEST_ASSERT_EQUAL_UINT32(900, sink.getExpiresIn());
+    }
+}
+
+static void test_token_too_long_is_an_error()
+{
+    char token[8];
+    JsonTokenSink sink(token, sizeof(token));
+    TEST_ASSERT_FALSE(feed(sink, "{\"token\":\"12345678\",\"expires_in\":60}", 3));
+    TEST_ASSERT_FALSE(sink.hasToken());
+    TEST_ASSERT_TRUE(sink.hasError());
+    TEST_ASSERT_EQUAL_STRING("", token);
+
+    feed(sink, "{\"token\":\"1234567\"}", 3);
+    TEST_ASSERT_TRUE(sink.hasToken());
+    TEST_ASSERT_FALSE(sink.hasError());
+}
+
+static void test_escaped_token_is_rejected()
+{
+    const char* bodies[] = {
+        "{\"token\":\"abc\\ndef\"}",
+        "{\"token\":\"abc\\u0041\"}",
+        "{\"token\":\"abc\\\"def\"}",
+    };
+    char token[TOKEN_SIZE];
+    JsonTokenSink sink(token, sizeof(token));
+
+    for (const char* body : bodies)
+    {
+        TEST_ASSERT_FALSE(feed(sink, body, 1));
+        TEST_ASSERT_FALSE(sink.hasToken());
+        TEST_ASSERT_TRUE(sink.hasError());
+        TEST_ASSERT_EQUAL_STRING("", token);
+    }
+
+    // Escapes elsewhere in the body are skipped over
+    feed(sink, "{\"msg\":\"say \\\"token\\\": \\\"x\\\"\",\"token\":\"abc\"}", 1);
+    TEST_ASSERT_TRUE(sink.hasToken());
+    TEST_ASSERT_EQUAL_STRING("abc", token);
+}
+
+static void test_huge_lifetime_saturates()
+{
+    char token[TOKEN_SIZE];
+    JsonTokenSink sink(token, sizeof(token));
+    feed(sink, "{\"expires_in\":99999999999,\"token\":\"abc\"}", 4);
+    TEST_ASSERT_TRUE(sink.hasExpiresIn());
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, sink.getExpiresIn());
+}
+
+static void test_capture_is_truncated_and_terminated()
+{
+    char buffer[8];
+    CaptureSink sink(buffer, sizeof(buffer));
+
+    TEST_ASSERT_TRUE(feed(sink, "{\"a\":1}", 2));
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1}", sink.c_str());
+    TEST_ASSERT_FALSE(sink.isTruncated());
+
+    TEST_ASSERT_FALSE(feed(sink, "{\"error\":\"bad request\"}", 5));
+    TEST_ASSERT_TRUE(sink.isTruncated());
+    TEST_ASSERT_EQUAL_size_t(7, sink.length());
+    TEST_ASSERT_EQUAL_STRING("{\"error", sink.c_str());
+}
+
+static void test_discard_reads_nothing()
+{
+    DiscardSink sink;
+    TEST_ASSERT_FALSE(sink.wantsBody());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_token_and_lifetime_in_any_chunking);
+    RUN_TEST(test_reading_stops_once_both_are_known);
+    RUN_TEST(test_nested_objects_and_arrays);
+    RUN_TEST(test_token_too_long_is_an_error);
+    RUN_TEST(test_escaped_token_is_rejected);
+    RUN_TEST(test_huge_lifetime_saturates);
+    RUN_TEST(test_capture_is_truncated_and_terminated);
+    RUN_TEST(test_discard_reads_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,229 @@
+/**
+ * @file test_main.cpp
+ * @brief RetryPolicy and CircuitBreaker Tests
+ *
+ * @details Drives the backoff schedule and the breaker's closed, open and half-open transitions
+ * with a fake clock and a jitter source that always takes the full jitter range, and checks that
+ * two threads sharing a half-open breaker are granted a single probe between them.
+ */
+
+#include "network/retryPolicy.h"
+#include <atomic>
+#include <thread>
+#include <unity.h>
+
+static uint32_t fakeNow;
+
+static uint32_t fakeClock()
+{
+    return fakeNow;
+}
+
+static uint32_t noJitter(uint32_t)
+{
+    return 0;
+}
+
+static uint32_t fullJitter(uint32_t upperBound)
+{
+    return upperBound ? upperBound - 1 : 0;
+}
+
+void setUp()
+{
+    fakeNow = 1000;
+}
+
+void tearDown()
+{
+}
+
+static void test_backoff_doubles_up_to_the_cap()
+{
+    RetryPolicy policy(fakeClock, noJitter);
+    policy.setBudget(MSG_CLASS_TELEMETRY, {6, 1000, 8000});
+
+    TEST_ASSERT_EQUAL_UINT32(0, policy.backoffDelay(MSG_CLASS_TELEMETRY, 0));
+    TEST_ASSERT_EQUAL_UINT32(1000, policy.backoffDelay(MSG_CLASS_TELEMETRY, 1));
+    TEST_ASSERT_EQUAL_UINT32(2000, policy.backoffDelay(MSG_CLASS_TELEMETRY, 2));
+    TEST_ASSERT_EQUAL_UINT32(4000, policy.backoffDelay(MSG_CLASS_TELEMETRY, 3));
+    TEST_ASSERT_EQUAL_UINT32(8000, policy.backoffDelay(MSG_CLASS_TELEMETRY, 4));
+    TEST_ASSERT_EQUAL_UINT32(8000, policy.backoffDelay(MSG_CLASS_TELEMETRY, 5));
+}
+
+static void test_jitter_takes_at_most_a_quarter()
+{
+    RetryPolicy policy(fakeClock, fullJitter);
+    policy.setBudget(MSG_CLASS_AUTH, {3, 2000, 16000});
+
+    TEST_ASSERT_EQUAL_UINT32(1500, policy.backoffDelay(MSG_CLASS_AUTH, 1));
+    TEST_ASSERT_EQUAL_UINT32(3000, policy.backoffDelay(MSG_CLASS_AUTH, 2));
+}
+
+static void test_budget_limits_attempts()
+{
+    RetryPolicy policy(fakeClock, noJitter);
+    policy.setBudget(MSG_CLASS_QUEUE, {3, 100, 100});
+
+    TEST_ASSERT_TRUE(policy.shouldRetry(MSG_CLASS_QUEUE, 0));
+    TEST_ASSERT_TRUE(policy.shouldRetry(MSG_CLASS_QUEUE, 2));
+    TEST_ASSERT_FALSE(policy.shouldRetry(MSG_CLASS_QUEUE, 3));
+}
+
+static void test_status_classification()
+{
+    TEST_ASSERT_TRUE(RetryPolicy::isRetryableStatus(-1));
+    TEST_ASSERT_TRUE(RetryPolicy::isRetryableStatus(429));
+    TEST_ASSERT_TRUE(RetryPolicy::isRetryableStatus(503));
+    TEST_ASSERT_FALSE(RetryPolicy::isRetryableStatus(400));
+    TEST_ASSERT_FALSE(RetryPolicy::isRetryableStatus(401));
+
+    TEST_ASSERT_TRUE(RetryPolicy::isBackendFailure(0));
+    TEST_ASSERT_TRUE(RetryPolicy::isBackendFailure(500));
+    TEST_ASSERT_FALSE(RetryPolicy::isBackendFailure(429));
+    TEST_ASSERT_FALSE(RetryPolicy::isBackendFailure(401));
+}
+
+static void test_breaker_opens_after_threshold()
+{
+    CircuitBreaker breaker(3, 60000, fakeClock);
+
+    for (int i = 0; i < 2; i++)
+    {
+        TEST_ASSERT_TRUE(breaker.allowRequest());
+        breaker.recordFailure();
+        TEST_ASSERT_EQUAL(CircuitBreaker::STATE_CLOSED, breaker.getState());
+    }
+    TEST_ASSERT_TRUE(breaker.allowRequest());
+    breaker.recordFailure();
+
+    TEST_ASSERT_EQUAL(CircuitBreaker::STATE_OPEN, breaker.getState());
+    TEST_ASSERT_EQUAL_UINT32(1, breaker.getTripCount());
+    TEST_ASSERT_FALSE(breaker.allowRequest());
+}
+
+static void test_success_resets_failure_count()
+{
+    CircuitBreaker breaker(3, 60000, fakeClock);
+
+    breaker.recordFailure();
+    breaker.recordFailure();
+    breaker.recordSuccess();
+    breaker.recordFailure();
+
+    TEST_ASSERT_EQUAL(CircuitBreaker::STATE_CLOSED, breaker.getState());
+    TEST_ASSERT_EQUAL_UINT8(1, breaker.getConsecutiveFailures());
+}
+
+static void test_half_open_allows_a_single_probe()
+{
+    CircuitBreaker breaker(1, 60000, fakeClock);
+    breaker.recordFailure();
+
+    fakeNow += 59999;
+    TEST_ASSERT_FALSE(breaker.allowRequest());
+
+    fakeNow += 1;
+    TEST_ASSERT_TRUE(breaker.allowRequest());
+    TEST_ASSERT_EQUAL(CircuitBreaker::STATE_HALF_OPEN, breaker.getState());
+    TEST_ASSERT_FALSE(breaker.allowRequest());
+
+    breaker.recordSuccess();
+    TEST_ASSERT_EQUAL(CircuitBreaker::STATE_CLOSED, breaker.getState());
+    TEST_ASSERT_TRUE(breaker.allowRequest());
+}
+
+static void test_failed_probe_reopens_for_a_full_timeout()
+{
+    CircuitBreaker breaker(1, 60000, fakeClock);
+    breaker.recordFailure();
+
+    fakeNow += 60000;
+    TEST_ASSERT_TRUE(breaker.allowRequest());
+    breaker.recordFailure();
+
+    TEST_ASSERT_EQUAL(CircuitBreaker::STATE_OPEN, breaker.getState());
+    TEST_ASSERT_EQUAL_UINT32(2, breaker.getTripCount());
+    fakeNow += 59999;
+    TEST_ASSERT_FALSE(breaker.allowRequest());
+    fakeNow += 1;
+    TEST_ASSERT_TRUE(breaker.allowRequest());
+}
+
+static void test_cancelled_probe_frees_the_slot()
+{
+    CircuitBreaker breaker(1, 60000, fakeClock);
+    breaker.recordFailure();
+    fakeNow += 60000;
+
+    TEST_ASSERT_TRUE(breaker.allowRequest());
+    breaker.cancelRequest();
+
+    TEST_ASSERT_EQUAL(CircuitBreaker::STATE_HALF_OPEN, breaker.getState());
+    TEST_ASSERT_TRUE(breaker.allowRequest());
+}
+
+static void test_open_timeout_survives_clock_wrap()
+{
+    CircuitBreaker breaker(1, 60000, fakeClock);
+    fakeNow = UINT32_MAX - 1000;
+    breaker.recordFailure();
+
+    fakeNow += 30000;
+    TEST_ASSERT_FALSE(breaker.allowRequest());
+    fakeNow += 30000;
+    TEST_ASSERT_TRUE(breaker.allowRequest());
+}
+
+static void test_concurrent_callers_get_one_probe()
+{
+    CircuitBreaker breaker(1, 1000, fakeClock);
+
+    for (int round = 0; round < 200; round++)
+    {
+        breaker.recordFailure();
+        fakeNow += 1000;
+
+        std::atomic<bool> go(false);
+        std::atomic<int> granted(0);
+        auto caller = [&]()
+        {
+            while (!go)
+            {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < 50; i++)
+            {
+                if (breaker.allowRequest())
+                {
+                    granted++;
+                }
+            }
+        };
+        std::thread auth(caller);
+        std::thread telemetry(caller);
+        go = true;
+        auth.join();
+        telemetry.join();
+
+        TEST_ASSERT_EQUAL_INT(1, granted.load());
+        breaker.recordFailure();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_backoff_doubles_up_to_the_cap);
+    RUN_TEST(test_jitter_takes_at_most_a_quarter);
+    RUN_TEST(test_budget_limits_attempts);
+    RUN_TEST(test_status_classification);
+    RUN_TEST(test_breaker_opens_after_threshold);
+    RUN_TEST(test_success_resets_failure_count);
+    RUN_TEST(test_half_open_allows_a_single_probe);
+    RUN_TEST(test_failed_probe_reopens_for_a_full_timeout);
+    RUN_TEST(test_cancelled_probe_frees_the_slot);
+    RUN_TEST(test_open_timeout_survives_clock_wrap);
+    RUN_TEST(test_concurrent_callers_get_one_probe);
+    return UNITY_END();
+}
@@ -0,0 +1,142 @@
+/**
+ * @file test_main.cpp
+ * @brief ScanPolicy Tests
+ *
+ * @details Steps the policy with a fake clock the way the Bluetooth client does, once a second, and
+ * checks the scan parameters after a loss, the receive time and duty cycle they add up to, the
+ * reconnect averages and the transmit power steps with their hysteresis.
+ */
+
+#include "sensors/scanPolicy.h"
+#include <cstdio>
+#include <unity.h>
+
+#define STEP_MS 1000
+#define FAST_MS 30000    // BT_SCAN_FAST_MS
+#define MEDIUM_MS 300000 // BT_SCAN_MEDIUM_MS
+#define TX_MAX_DBM 9     // BT_TX_MAX_DBM
+#define TX_MIN_DBM -12   // BT_TX_MIN_DBM
+#define RSSI_TARGET_DBM -75
+
+/**
+ * @brief Update once a step from start to end, both included
+ */
+static void run(ScanPolicy& policy, uint32_t start, uint32_t end, bool scanning)
+{
+    for (uint32_t now = start; now <= end; now += STEP_MS)
+    {
+        policy.update(now, scanning);
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_scan_slows_down_while_a_strap_is_missing()
+{
+    ScanPolicy policy;
+    policy.begin(0);
+
+    TEST_ASSERT_EQUAL_UINT16(60, policy.params(0).intervalMs);
+    TEST_ASSERT_EQUAL_UINT16(30, policy.params(FAST_MS - 1).windowMs);
+    TEST_ASSERT_TRUE(policy.isRecovering(FAST_MS - 1));
+
+    TEST_ASSERT_EQUAL_UINT16(320, policy.params(FAST_MS).intervalMs);
+    TEST_ASSERT_FALSE(policy.isRecovering(FAST_MS));
+    TEST_ASSERT_EQUAL_UINT16(1280, policy.params(MEDIUM_MS).intervalMs);
+
+    policy.onLost(MEDIUM_MS + 5000);
+    TEST_ASSERT_EQUAL_UINT16(60, policy.params(MEDIUM_MS + 5000).intervalMs);
+    TEST_ASSERT_TRUE(policy.isRecovering(MEDIUM_MS + 5000));
+}
+
+static void test_duty_cycle_over_ten_minutes_of_scanning()
+{
+    ScanPolicy policy;
+    policy.begin(0);
+    run(policy, 0, 600000, true);
+
+    // 30 s at 50 %, 270 s at 10 %, 300 s at 2.5 %
+    scan_stats_t stats = policy.getStats(600000);
+    TEST_ASSERT_EQUAL_UINT32(600000, stats.scanTimeMs);
+    TEST_ASSERT_EQUAL_UINT32(15000 + 27000 + 7500, stats.receiveTimeMs);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 8.25f, stats.dutyPercent);
+
+    char line[96];
+    snprintf(line, sizeof(line), "10 min without the strap: duty %.2f%%", stats.dutyPercent);
+    TEST_MESSAGE(line);
+}
+
+static void test_time_connected_is_not_scanning()
+{
+    ScanPolicy policy;
+    policy.begin(0);
+    run(policy, 0, 10000, true);
+    run(policy, 11000, 3600000, false);
+
+    scan_stats_t stats = policy.getStats(3600000);
+    TEST_ASSERT_EQUAL_UINT32(11000, stats.scanTimeMs);
+    TEST_ASSERT_EQUAL_UINT32(5500, stats.receiveTimeMs);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.2f, stats.dutyPercent);
+}
+
+static void test_reconnect_times_are_averaged()
+{
+    ScanPolicy policy;
+    policy.begin(0);
+    policy.onReconnected(1000);
+    policy.onReconnected(2000);
+    policy.onReconnected(600);
+
+    scan_stats_t stats = policy.getStats(10000);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.reconnects);
+    TEST_ASSERT_EQUAL_UINT32(600, stats.lastReconnectMs);
+    TEST_ASSERT_EQUAL_UINT32(2000, stats.maxReconnectMs);
+    TEST_ASSERT_EQUAL_UINT32(1250 + (600 - 1250) / 4, stats.avgReconnectMs);
+}
+
+static void test_power_is_raised_at_once_and_lowered_with_hysteresis()
+{
+    int8_t power = ScanPolicy::maxPower();
+    TEST_ASSERT_EQUAL_INT8(TX_MAX_DBM, power);
+    TEST_ASSERT_EQUAL_INT8(TX_MAX_DBM, ScanPolicy::tunePower(power, RSSI_TARGET_DBM));
+
+    // 15 dB to spare is five steps, less the hysteresis three
+    power = ScanPolicy::tunePower(power, RSSI_TARGET_DBM + 15);
+    TEST_ASSERT_EQUAL_INT8(TX_MAX_DBM - 9, power);
+    TEST_ASSERT_EQUAL_INT8(power, ScanPolicy::tunePower(power, RSSI_TARGET_DBM + 12));
+    TEST_ASSERT_EQUAL_INT8(power, ScanPolicy::tunePower(power, RSSI_TARGET_DBM + 15));
+    TEST_ASSERT_EQUAL_INT8(power - 3, ScanPolicy::tunePower(power, RSSI_TARGET_DBM + 16));
+
+    // A weaker strap gets the power back at once
+    TEST_ASSERT_EQUAL_INT8(TX_MAX_DBM - 3, ScanPolicy::tunePower(power, RSSI_TARGET_DBM + 4));
+    TEST_ASSERT_EQUAL_INT8(TX_MAX_DBM, ScanPolicy::tunePower(power, RSSI_TARGET_DBM - 10));
+}
+
+static void test_power_stays_within_limits()
+{
+    int8_t power = ScanPolicy::maxPower();
+    for (int i = 0; i < 10; i++)
+    {
+        power = ScanPolicy::tunePower(power, -20);
+    }
+    TEST_ASSERT_EQUAL_INT8(TX_MIN_DBM, power);
+    TEST_ASSERT_EQUAL_INT8(TX_MAX_DBM, ScanPolicy::tunePower(power, -100));
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_scan_slows_down_while_a_strap_is_missing);
+    RUN_TEST(test_duty_cycle_over_ten_minutes_of_scanning);
+    RUN_TEST(test_time_connected_is_not_scanning);
+    RUN_TEST(test_reconnect_times_are_averaged);
+    RUN_TEST(test_power_is_raised_at_once_and_lowered_with_hysteresis);
+    RUN_TEST(test_power_stays_within_limits);
+    return UNITY_END();
+}
@@ -0,0 +1,290 @@
+/**
+ * @file test_main.cpp
+ * @brief TinyGPSPlus Differential Test and Benchmark
+ *
+ * @details Replays generated GNRMC/GNGGA traffic with GSV, GSA and VTG sentences in between,
+ * checksum failures and a randomly corrupted copy through the vendored parser and the copy from
+ * before bulk decoding (legacyTinyGps.h). After every completed sentence all decoded fields must
+ * match, whether the new parser is fed a character or a buffer at a time. The benchmark reports
+ * sentences per second for the old per-character loop and the new bulk decode.
+ */
+
+#include "legacyTinyGps.h"
+#include <TinyGPS++.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unity.h>
+
+#define TRAFFIC_EPOCHS 5000 // one RMC, GGA, two GSV, GSA and VTG each
+#define FUZZ_BYTES 200000
+#define FUZZ_EDITS 3000
+#define BENCH_ROUNDS 5
+#define READ_CHUNK 128 // GNSS_READ_CHUNK of the receiver
+
+unsigned long millis()
+{
+    return 0;
+}
+
+/**
+ * @brief Every field the receiver reads, plus the counters
+ */
+struct Snapshot
+{
+    uint16_t latDeg, lngDeg;
+    uint32_t latBillionths, lngBillionths;
+    bool latNegative, lngNegative, locationValid;
+    uint32_t date, time, speed, course, hdop, satellites;
+    int32_t altitude;
+    uint32_t passed, failed, withFix, chars;
+
+    bool operator==(const Snapshot& other) const
+    {
+        return memcmp(this, &other, sizeof(*this)) == 0;
+    }
+};
+
+template <typename Parser> static Snapshot snapshot(Parser& parser)
+{
+    Snapshot s;
+    memset(&s, 0, sizeof(s)); // padding takes part in the comparison
+    s.latDeg = parser.location.rawLat().deg;
+    s.latBillionths = parser.location.rawLat().billionths;
+    s.latNegative = parser.location.rawLat().negative;
+    s.lngDeg = parser.location.rawLng().deg;
+    s.lngBillionths = parser.location.rawLng().billionths;
+    s.lngNegative = parser.location.rawLng().negative;
+    s.locationValid = parser.location.isValid();
+    s.date = parser.date.value();
+    s.time = parser.time.value();
+    s.speed = parser.speed.value();
+    s.course = parser.course.value();
+    s.hdop = parser.hdop.value();
+    s.satellites = parser.satellites.value();
+    s.altitude = parser.altitude.value();
+    s.passed = parser.passedChecksum();
+    s.failed = parser.failedChecksum();
+    s.withFix = parser.sentencesWithFix();
+    s.chars = parser.charsProcessed();
+    return s;
+}
+
+static std::string sentence(const char* body)
+{
+    uint8_t parity = 0;
+    for (const char* p = body; *p; p++)
+    {
+        parity ^= (uint8_t)*p;
+    }
+    char trailer[8];
+    snprintf(trailer, sizeof(trailer), "*%02X\r\n", parity);
+    return std::string("$") + body + trailer;
+}
+
+static std::string traffic()
+{
+    std::string log;
+    std::mt19937 random(42);
+    auto next = [&random](unsigned range) { return (unsigned)(random() % range); };
+    char body[128];
+
+    for (int i = 0; i < TRAFFIC_EPOCHS; i++)
+    {
+        int hh = i / 3600 % 24, mm = i / 60 % 60, ss = i % 60;
+        double lat = 4807.038 + next(100000) / 1e5;
+        double lng = 1131.000 + next(100000) / 1e5;
+        snprintf(body, sizeof(body), "GNRMC,%02d%02d%02d.00,A,%.5f,N,%.5f,E,%u.%03u,%u.%u,230394,"
+            "003.1,W", hh, mm, ss, lat, lng, next(100), next(1000), next(360), next(10));
+        log += sentence(body);
+        snprintf(body, sizeof(body), "GNGGA,%02d%02d%02d.00,%.5f,S,%.5f,W,1,%02u,0.%u,%u.%u,M,46.9,"
+            "M,,", hh, mm, ss, lat, lng, next(20), next(10), next(900), next(10));
+        log += sentence(body);
+        log += sentence("GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00");
+        log += sentence("GLGSV,2,1,08,65,23,045,30,66,45,120,35,72,10,300,,81,67,200,40");
+        log += sentence("GNGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1");
+        log += sentence("GPVTG,054.7,T,034.4,M,005.5,N,010.2,K");
+        if (i % 50 == 0)
+        {
+            // Two checksum failures, neither counts as a sentence
+            log += "$GPRMC,garbage,,*ZZ\r\n$GPGGA,1,2,3*00\r\n";
+        }
+    }
+    return log;
+}
+
+static std::string corrupted(const std::string& log)
+{
+    static const char NOISE[] = "$,*\r\n-+ 0123456789.ABCXYZ";
+    std::string fuzz = log.substr(0, FUZZ_BYTES);
+    std::mt19937 random(7);
+    for (int i = 0; i < FUZZ_EDITS; i++)
+    {
+        fuzz[random() % fuzz.size()] = NOISE[random() % (sizeof(NOISE) - 1)];
+    }
+    return fuzz;
+}
+
+/**
+ * @brief Feed both parsers in step and compare them after every sentence
+ *
+ * @param chunk Buffer size for the new parser, 0 feeds it one character at a time
+ * @return Number of sentences compared
+ */
+static size_t replay(const std::string& log, size_t chunk)
+{
+    legacy::TinyGPSPlus reference;
+    TinyGPSPlus parser;
+    size_t sentences = 0;
+
+    for (size_t i = 0; i < log.size(); i++)
+    {
+        bool expected = reference.encode(log[i]);
+        bool decoded = chunk == 0 ? parser.encode(log[i]) : parser.encode(&log[i], 1) == 1;
+        TEST_ASSERT_EQUAL(expected, decoded);
+        if (expected)
+        {
+            sentences++;
+            Snapshot a = snapshot(reference);
+            Snapshot b = snapshot(parser);
+            if (!(a == b))
+            {
+                char message[64];
+                snprintf(message, sizeof(message), "fields differ after byte %zu", i);
+                TEST_FAIL_MESSAGE(message);
+            }
+        }
+    }
+    return sentences;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_known_sentence_is_decoded()
+{
+    TinyGPSPlus parser;
+    std::string rmc = sentence("GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W");
+
+    TEST_ASSERT_EQUAL_size_t(1, parser.encode(rmc.data(), rmc.size()));
+    TEST_ASSERT_TRUE(parser.location.isValid());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 48.1173f, parser.location.lat());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 11.516667f, parser.location.lng());
+    TEST_ASSERT_EQUAL_UINT32(230394, parser.date.value());
+    TEST_ASSERT_EQUAL_UINT32(12351900, parser.time.value());
+    TEST_ASSERT_EQUAL_UINT32(2240, parser.speed.value());
+}
+
+static void test_character_decode_matches_legacy()
+{
+    std::string log = traffic();
+    TEST_ASSERT_EQUAL_size_t(TRAFFIC_EPOCHS * 6, replay(log, 0));
+}
+
+static void test_buffer_decode_matches_legacy()
+{
+    std::string log = traffic();
+    TEST_ASSERT_EQUAL_size_t(TRAFFIC_EPOCHS * 6, replay(log, 1));
+}
+
+static void test_corrupted_input_matches_legacy()
+{
+    std::string fuzz = corrupted(traffic());
+    TEST_ASSERT_GREATER_THAN(0, replay(fuzz, 0));
+    replay(fuzz, 1);
+}
+
+static void test_chunk_boundaries_do_not_matter()
+{
+    std::string log = traffic() + corrupted(traffic());
+    legacy::TinyGPSPlus reference;
+    size_t expected = 0;
+    for (char c : log)
+    {
+        expected += reference.encode(c);
+    }
+
+    static const size_t CHUNKS[] = {2, 7, 64, READ_CHUNK, 1000};
+    for (size_t chunk : CHUNKS)
+    {
+        TinyGPSPlus parser;
+        size_t sentences = 0;
+        for (size_t i = 0; i < log.size(); i += chunk)
+        {
+            sentences += parser.encode(log.data() + i, std::min(chunk, log.size() - i));
+        }
+        TEST_ASSERT_EQUAL_size_t(expected, sentences);
+        TEST_ASSERT_TRUE(snapshot(reference) == snapshot(parser));
+    }
+}
+
+template <typename Decode> static double sentencesPerSecond(const std::string& log, Decode decode)
+{
+    size_t sentences = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < BENCH_ROUNDS; round++)
+    {
+        sentences += decode(log);
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return sentences / s;
+}
+
+static void test_benchmark_bulk_decode()
+{
+    std::string log = traffic();
+
+    double before = sentencesPerSecond(log, [](const std::string& data) {
+        legacy::TinyGPSPlus parser;
+        size_t n = 0;
+        for (char c : data)
+        {
+            n += parser.encode(c);
+        }
+        return n;
+    });
+    double character = sentencesPerSecond(log, [](const std::string& data) {
+        TinyGPSPlus parser;
+        size_t n = 0;
+        for (char c : data)
+        {
+            n += parser.encode(c);
+        }
+        return n;
+    });
+    double bulk = sentencesPerSecond(log, [](const std::string& data) {
+        TinyGPSPlus parser;
+        size_t n = 0;
+        for (size_t i = 0; i < data.size(); i += READ_CHUNK)
+        {
+            n += parser.encode(data.data() + i, std::min((size_t)READ_CHUNK, data.size() - i));
+        }
+        return n;
+    });
+
+    char line[128];
+    snprintf(line, sizeof(line),
+        "legacy per character %.0f/s, per character %.0f/s, %d-byte buffers %.0f/s (%.2fx)",
+        before, character, READ_CHUNK, bulk, bulk / before);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_GREATER_THAN_FLOAT(before, bulk);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_known_sentence_is_decoded);
+    RUN_TEST(test_character_decode_matches_legacy);
+    RUN_TEST(test_buffer_decode_matches_legacy);
+    RUN_TEST(test_corrupted_input_matches_legacy);
+    RUN_TEST(test_chunk_boundaries_do_not_matter);
+    RUN_TEST(test_benchmark_bulk_decode);
+    return UNITY_END();
+}
@@ -0,0 +1,288 @@
+/**
+ * @file test_main.cpp
+ * @brief TrackBuffer Tests and Benchmark
+ *
+ * @details Every drained track is decoded again (polyline varints of latitude, longitude and age)
+ * and compared with the kept fixes. The benchmark runs synthetic walk, cycle and drive tracks with
+ * 4 m of GPS noise through the buffer, uploads every TRACK_FLUSH_POINTS kept fixes, and replays
+ * the decoded track with the device's own dead reckoning to measure the error at every original
+ * fix against the bytes sent.
+ */
+
+#include "utils/track.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+#define TOLERANCE_M 25.0      // TRACK_TOLERANCE_M
+#define MAX_GAP_MS 600000     // TRACK_MAX_GAP_MS
+#define FLUSH_POINTS 8        // TRACK_FLUSH_POINTS of the GPS task
+#define ENCODED_SIZE 160      // TRACK_ENCODED_SIZE of the sensor message
+#define JSON_BYTES_PER_FIX 40 // "latitude": 59.912345, "longitude": 10.754321
+#define METERS_PER_DEGREE 111195.0
+
+struct Fix
+{
+    double latitude;
+    double longitude;
+    uint32_t time;
+};
+
+/**
+ * @brief Decode a drained track, ages are turned back into times relative to now
+ */
+static std::vector<Fix> decode(const char* track, uint32_t now)
+{
+    std::vector<Fix> fixes;
+    int64_t sum[3] = {0, 0, 0};
+    const char* p = track;
+    while (*p)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t v = 0;
+            int shift = 0;
+            int c;
+            do
+            {
+                c = *p++ - 63;
+                TEST_ASSERT_TRUE(c >= 0 && c < 64);
+                v |= (uint32_t)(c & 31) << shift;
+                shift += 5;
+            } while (c >= 32);
+            sum[k] += (int32_t)((v >> 1) ^ (0 - (v & 1)));
+        }
+        fixes.push_back({(double)sum[0] / TRACK_SCALE, (double)sum[1] / TRACK_SCALE,
+            now - (uint32_t)sum[2] * 1000});
+    }
+    return fixes;
+}
+
+static double distance(double lat1, double lon1, double lat2, double lon2)
+{
+    double y = (lat1 - lat2) * METERS_PER_DEGREE;
+    double x = (lon1 - lon2) * METERS_PER_DEGREE * cos(lat1 * M_PI / 180);
+    return sqrt(x * x + y * y);
+}
+
+/**
+ * @brief Walk, cycle or drive with a turn every 40 fixes
+ */
+static std::vector<Fix> route(double speedMps, uint32_t intervalMs, int fixes, std::mt19937& random)
+{
+    std::normal_distribution<double> noise(0, 4.0);
+    std::vector<Fix> route;
+    double latitude = 59.91, longitude = 10.75, heading = 0;
+    uint32_t t = 1000;
+    for (int i = 0; i < fixes; i++)
+    {
+        if (i % 40 == 0)
+        {
+            heading += ((int)(random() % 180) - 90) * M_PI / 180;
+        }
+        double metres = speedMps * intervalMs / 1000.0;
+        double scale = METERS_PER_DEGREE * cos(latitude * M_PI / 180);
+        latitude += metres * cos(heading) / METERS_PER_DEGREE;
+        longitude += metres * sin(heading) / scale;
+        route.push_back({latitude + noise(random) / METERS_PER_DEGREE,
+            longitude + noise(random) / scale, t});
+        t += intervalMs;
+    }
+    return route;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_first_fix_is_kept()
+{
+    TrackBuffer track;
+    TEST_ASSERT_TRUE(track.add(59.91f, 10.75f, 1000));
+    TEST_ASSERT_EQUAL_size_t(1, track.size());
+}
+
+static void test_standing_still_keeps_nothing_until_the_gap()
+{
+    TrackBuffer track;
+    track.add(59.91f, 10.75f, 1000);
+    for (uint32_t t = 31000; t <= MAX_GAP_MS; t += 30000)
+    {
+        TEST_ASSERT_FALSE(track.add(59.91005f, 10.75005f, t));
+    }
+    TEST_ASSERT_TRUE(track.add(59.91f, 10.75f, MAX_GAP_MS + 31000));
+}
+
+static void test_straight_line_keeps_two_and_a_turn_keeps_more()
+{
+    TrackBuffer track;
+    uint32_t t = 1000;
+    float latitude = 59.91f;
+    for (int i = 0; i < 20; i++, t += 5000)
+    {
+        track.add(latitude, 10.75f, t);
+        latitude += 0.0005f; // 55 m north per fix
+    }
+    TEST_ASSERT_EQUAL_size_t(2, track.size());
+
+    TEST_ASSERT_TRUE(track.add(latitude - 0.0005f, 10.7510f, t));
+}
+
+static void test_drain_round_trips()
+{
+    TrackBuffer track;
+    std::vector<Fix> kept;
+    const float lat[] = {59.91f, 59.9101f, 59.9150f, 59.9120f, 59.9000f};
+    const float lon[] = {10.75f, 10.7600f, 10.7450f, 10.7300f, 10.7700f};
+    for (int i = 0; i < 5; i++)
+    {
+        uint32_t t = 1000 + i * 60000;
+        TEST_ASSERT_TRUE(track.add(lat[i], lon[i], t));
+        kept.push_back({lat[i], lon[i], t});
+    }
+
+    char out[ENCODED_SIZE];
+    uint32_t now = 400000;
+    TEST_ASSERT_EQUAL_size_t(5, track.drain(out, sizeof(out), now));
+    TEST_ASSERT_EQUAL_size_t(0, track.size());
+
+    std::vector<Fix> decoded = decode(out, now);
+    TEST_ASSERT_EQUAL_size_t(kept.size(), decoded.size());
+    for (size_t i = 0; i < kept.size(); i++)
+    {
+        TEST_ASSERT_EQUAL_INT32(TrackBuffer::toFixed(kept[i].latitude),
+            lround(decoded[i].latitude * TRACK_SCALE));
+        TEST_ASSERT_EQUAL_INT32(TrackBuffer::toFixed(kept[i].longitude),
+            lround(decoded[i].longitude * TRACK_SCALE));
+        TEST_ASSERT_EQUAL_UINT32(kept[i].time, decoded[i].time);
+    }
+}
+
+static void test_short_buffer_drains_whole_points_only()
+{
+    TrackBuffer track;
+    for (int i = 0; i < 4; i++)
+    {
+        track.add(59.91f + i * 0.01f, 10.75f - i * 0.01f, 1000 + i * 700000);
+    }
+
+    char out[20]; // room for the first point, which is relative to zero, not for all four
+    size_t first = track.drain(out, sizeof(out), 3000000);
+    TEST_ASSERT_GREATER_THAN(0, first);
+    TEST_ASSERT_LESS_THAN(4, first);
+    TEST_ASSERT_EQUAL_size_t(first, decode(out, 3000000).size());
+    TEST_ASSERT_EQUAL_size_t(4 - first, track.size());
+}
+
+static void test_overflow_drops_the_oldest()
+{
+    TrackBuffer track;
+    for (int i = 0; i < TRACK_MAX_POINTS + 3; i++)
+    {
+        track.add(59.91f, 10.75f, 1000 + i * (MAX_GAP_MS + 1000));
+    }
+    TEST_ASSERT_EQUAL_size_t(TRACK_MAX_POINTS, track.size());
+    TEST_ASSERT_EQUAL_UINT32(3, track.getDroppedCount());
+}
+
+/**
+ * @brief Largest distance between a fix and the position the uploaded track predicts for it
+ */
+static double replayError(const std::vector<Fix>& fixes, const std::vector<Fix>& uploaded)
+{
+    double worst = 0;
+    size_t i = 0;
+    for (const Fix& fix : fixes)
+    {
+        while (i + 1 < uploaded.size() && uploaded[i + 1].time <= fix.time)
+        {
+            i++;
+        }
+        double latitude = uploaded[i].latitude, longitude = uploaded[i].longitude;
+        uint32_t span = i > 0 ? uploaded[i].time - uploaded[i - 1].time : 0;
+        if (span > 0 && span <= MAX_GAP_MS && fix.time - uploaded[i].time <= MAX_GAP_MS)
+        {
+            double elapsed = (double)(fix.time - uploaded[i].time) / span;
+            latitude += (uploaded[i].latitude - uploaded[i - 1].latitude) * elapsed;
+            longitude += (uploaded[i].longitude - uploaded[i - 1].longitude) * elapsed;
+        }
+        worst = std::max(worst, distance(fix.latitude, fix.longitude, latitude, longitude));
+    }
+    return worst;
+}
+
+static void benchmark(const char* name, double speedMps, uint32_t intervalMs, int count)
+{
+    std::mt19937 random(7);
+    std::vector<Fix> fixes = route(speedMps, intervalMs, count, random);
+    std::vector<Fix> uploaded;
+    TrackBuffer track;
+    size_t kept = 0, bytes = 0, uploads = 0;
+    char out[ENCODED_SIZE];
+
+    for (size_t i = 0; i < fixes.size(); i++)
+    {
+        const Fix& fix = fixes[i];
+        kept += track.add((float)fix.latitude, (float)fix.longitude, fix.time);
+        if (track.size() >= FLUSH_POINTS || (i + 1 == fixes.size() && track.size() > 0))
+        {
+            TEST_ASSERT_EQUAL_size_t(track.size(), track.drain(out, sizeof(out), fix.time));
+            std::vector<Fix> decoded = decode(out, fix.time);
+            uploaded.insert(uploaded.end(), decoded.begin(), decoded.end());
+            bytes += strlen(out);
+            uploads++;
+        }
+    }
+
+    double error = replayError(fixes, uploaded);
+    size_t json = fixes.size() * JSON_BYTES_PER_FIX;
+    char line[160];
+    snprintf(line, sizeof(line),
+        "%s: %zu fixes, %zu kept (%.1f%%), %zu uploads, %zu B vs %zu B of JSON, max error %.1f m",
+        name, fixes.size(), kept, 100.0 * kept / fixes.size(), uploads, bytes, json, error);
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL_size_t(kept, uploaded.size());
+    // Fixed-point rounding and whole-second ages add a little to the tolerance
+    TEST_ASSERT_LESS_THAN_FLOAT(TOLERANCE_M + 2.0, error);
+    TEST_ASSERT_LESS_THAN(json / 10, bytes);
+}
+
+static void test_benchmark_walk()
+{
+    benchmark("walk", 1.4, 30000, 240);
+}
+
+static void test_benchmark_cycle()
+{
+    benchmark("cycle", 5.0, 5000, 720);
+}
+
+static void test_benchmark_drive()
+{
+    benchmark("drive", 15.0, 5000, 720);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_fix_is_kept);
+    RUN_TEST(test_standing_still_keeps_nothing_until_the_gap);
+    RUN_TEST(test_straight_line_keeps_two_and_a_turn_keeps_more);
+    RUN_TEST(test_drain_round_trips);
+    RUN_TEST(test_short_buffer_drains_whole_points_only);
+    RUN_TEST(test_overflow_drops_the_oldest);
+    RUN_TEST(test_benchmark_walk);
+    RUN_TEST(test_benchmark_cycle);
+    RUN_TEST(test_benchmark_drive);
+    return UNITY_END();
+}
@@ -0,0 +1,255 @@
+/**
+ * @file test_main.cpp
+ * @brief Uplink Payload Tests
+ *
+ * @details Checks the sensor JSON with and without its optional objects, the Authorization header
+ * and the login document, then soaks the send path: sensor JSON, gzip, header, the login document
+ * in the JSON arena and the token scan of the login response, for SOAK_SENDS sends. operator new
+ * is counted everywhere, malloc where glibc lets it be interposed; neither may be called once the
+ * first sends have warmed up.
+ */
+
+#include "network/responseSink.h"
+#include "network/uplinkPayload.h"
+#include "utils/gzipEncoder.h"
+#include "utils/jsonArena.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <unity.h>
+
+#define JSON_SIZE 1024        // processed_data_t json
+#define ARENA_SIZE 1024       // JSON_ARENA_SIZE
+#define LOGIN_SIZE 256        // AUTH_PAYLOAD_SIZE
+#define TOKEN_SIZE 512        // AUTH_TOKEN_MAX_LEN
+#define HEADER_SIZE (TOKEN_SIZE + 7)
+#define WARM_UP_SENDS 10
+#define SOAK_SENDS 20000
+
+static volatile uint32_t newCalls;
+static volatile uint32_t mallocCalls;
+
+void* operator new(size_t size)
+{
+    newCalls++;
+    void* p = malloc(size);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    free(p);
+}
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+
+extern "C" void* malloc(size_t size)
+{
+    mallocCalls++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+    mallocCalls++;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size)
+{
+    mallocCalls++;
+    return __libc_realloc(p, size);
+}
+#endif
+
+static sensor_data_t reading()
+{
+    sensor_data_t data;
+    memset(&data, 0, sizeof(data));
+    data.device_battery = 87;
+    data.steps = 4211;
+    data.temperature = 21.5f;
+    data.humidity = 40.25f;
+    data.heartRate = 72;
+    data.latitude = 59.329323f;
+    data.longitude = 18.068581f;
+    data.geofence = -1;
+    data.hr_strap = -1;
+    data.bt_scan_duty = -1;
+    return data;
+}
+
+/**
+ * @brief A reading with every optional object present
+ */
+static sensor_data_t fullReading()
+{
+    sensor_data_t data = reading();
+    strcpy(data.track, "_p~iF~ps|U_ulLnnqC_mqNvxq`@\\\\");
+    data.geofence = 2;
+    data.geofence_inside = true;
+    data.hr_strap = 0;
+    data.hr_period = 60;
+    data.hr_min = 64;
+    data.hr_max = 91;
+    data.hr_contact = 1;
+    data.hr_energy = 12;
+    data.hrv_beats = 71;
+    data.hrv_rmssd = 41.2f;
+    data.hrv_sdnn = 55.7f;
+    data.hrv_pnn50 = 18.3f;
+    data.bt_scan_duty = 2.51f;
+    data.bt_tx_power = -3;
+    data.bt_reconnects = 4;
+    data.bt_reconnect_avg_ms = 1830;
+    data.bt_reconnect_max_ms = 4120;
+    data.bt_radio_ms_per_hour = 4530;
+    return data;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_json_leaves_out_absent_objects()
+{
+    char json[JSON_SIZE];
+    TEST_ASSERT_TRUE(createJson(reading(), json, sizeof(json)));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"steps\": 4211"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"latitude\": 59.329323"));
+    TEST_ASSERT_NULL(strstr(json, "track"));
+    TEST_ASSERT_NULL(strstr(json, "geofence"));
+    TEST_ASSERT_NULL(strstr(json, "heart_rate_summary"));
+    TEST_ASSERT_NULL(strstr(json, "bluetooth"));
+}
+
+static void test_json_with_every_object_fits()
+{
+    char json[JSON_SIZE];
+    TEST_ASSERT_TRUE(createJson(fullReading(), json, sizeof(json)));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"track\": \"_p~iF~ps|U_ulLnnqC_mqNvxq`@\\\\\\\\\""));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"geofence\": { \"id\": 2, \"inside\": 1 }"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"hrv\": { \"beats\": 71, \"rmssd\": 41.2"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"radio_ms_per_hour\": 4530 }"));
+    TEST_ASSERT_EQUAL_STRING(" } }", json + strlen(json) - 4);
+
+    TEST_ASSERT_FALSE(createJson(fullReading(), json, strlen(json)));
+}
+
+static void test_bearer_header_must_fit()
+{
+    char header[17];
+    TEST_ASSERT_TRUE(createBearerHeader("abc.def.g", header, sizeof(header)));
+    TEST_ASSERT_EQUAL_STRING("Bearer abc.def.g", header);
+    TEST_ASSERT_FALSE(createBearerHeader("abc.def.gh", header, sizeof(header)));
+}
+
+static void test_login_payload_escapes_credentials()
+{
+    JsonArena<ARENA_SIZE> arena;
+    char login[LOGIN_SIZE];
+    size_t len = createLoginPayload(&arena, "sentinel", "pa\"ss\\word", login, sizeof(login));
+
+    TEST_ASSERT_EQUAL_size_t(strlen(login), len);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"username\":\"sentinel\",\"password\":\"pa\\\"ss\\\\word\"}", login);
+    TEST_ASSERT_EQUAL_size_t(0, createLoginPayload(&arena, "sentinel", "secret", login, 20));
+}
+
+static void test_send_path_does_not_allocate()
+{
+    static JsonArena<ARENA_SIZE> arena;
+    static GzipEncoder gzip;
+    static char json[JSON_SIZE];
+    static uint8_t compressed[JSON_SIZE + GZIP_OVERHEAD];
+    static char header[HEADER_SIZE];
+    static char login[LOGIN_SIZE];
+    static char token[TOKEN_SIZE];
+    const char response[] = "{\"data\":{\"token\":\"eyJhbGciOiJIUzI1NiJ9.eyJzdWIiOiIxIn0.c2ln\","
+                            "\"expires_in\":3600}}";
+    sensor_data_t data = fullReading();
+    uint32_t newBefore = 0, mallocBefore = 0;
+    size_t highWater = 0;
+    bool ok = true;
+
+    for (uint32_t send = 0; send < WARM_UP_SENDS + SOAK_SENDS; send++)
+    {
+        if (send == WARM_UP_SENDS)
+        {
+            newBefore = newCalls;
+            mallocBefore = mallocCalls;
+            highWater = arena.getHighWater();
+        }
+        data.steps = (int)send;
+
+        ok &= createJson(data, json, sizeof(json));
+        ok &= gzip.compress((const uint8_t*)json, strlen(json), compressed, sizeof(compressed)) > 0;
+
+        arena.reset();
+        ok &= createLoginPayload(&arena, "sentinel", "secret", login, sizeof(login)) > 0;
+        arena.reset();
+
+        JsonTokenSink sink(token, sizeof(token));
+        sink.begin(200, (int)strlen(response));
+        sink.write((const uint8_t*)response, strlen(response));
+        ok &= sink.hasToken();
+        ok &= createBearerHeader(token, header, sizeof(header));
+    }
+    uint32_t newDelta = newCalls - newBefore;
+    uint32_t mallocDelta = mallocCalls - mallocBefore;
+
+    char line[112];
+    snprintf(line, sizeof(line), "%d sends: %lu new, %lu malloc after warm-up, arena %lu B",
+        SOAK_SENDS, (unsigned long)newDelta, (unsigned long)mallocDelta,
+        (unsigned long)arena.getHighWater());
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_TRUE(ok);
+    TEST_ASSERT_EQUAL_UINT32(0, newDelta);
+    TEST_ASSERT_EQUAL_UINT32(0, mallocDelta);
+    TEST_ASSERT_EQUAL_size_t(highWater, arena.getHighWater());
+    TEST_ASSERT_EQUAL_UINT32(0, arena.getFailures());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_json_leaves_out_absent_objects);
+    RUN_TEST(test_json_with_every_object_fits);
+    RUN_TEST(test_bearer_header_must_fit);
+    RUN_TEST(test_login_payload_escapes_credentials);
+    RUN_TEST(test_send_path_does_not_allocate);
+    return UNITY_END();
+}